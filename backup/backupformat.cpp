@@ -0,0 +1,337 @@
+#include "backup/backupformat.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QtEndian>
+
+const QByteArray BackupFormat::Magic = QByteArray("NIMOBAK") + char(BackupFormat::Version);
+const QByteArray BackupFormat::TrailerMagic = QByteArray("NIMOEND") + char(BackupFormat::Version);
+
+QJsonObject BackupTableEntry::toJson() const
+{
+    return QJsonObject{
+        {"name", name},
+        {"columns", QJsonArray::fromStringList(columns)},
+        {"mode", mode},
+        {"since", since},
+        {"offset", offset},
+        {"rows", rows},
+        {"rawBytes", rawBytes},
+        {"compressedBytes", compressedBytes},
+        {"blocks", blocks},
+        {"sha256", sha256}
+    };
+}
+
+BackupTableEntry BackupTableEntry::fromJson(const QJsonObject& object)
+{
+    BackupTableEntry entry;
+    entry.name = object.value("name").toString();
+    for (const QJsonValue& column : object.value("columns").toArray()) {
+        entry.columns.append(column.toString());
+    }
+    entry.mode = object.value("mode").toString("complete");
+    entry.since = object.value("since").toString();
+    entry.offset = object.value("offset").toInteger();
+    entry.rows = object.value("rows").toInteger();
+    entry.rawBytes = object.value("rawBytes").toInteger();
+    entry.compressedBytes = object.value("compressedBytes").toInteger();
+    entry.blocks = object.value("blocks").toInt();
+    entry.sha256 = object.value("sha256").toString();
+    return entry;
+}
+
+const BackupTableEntry* BackupManifest::table(const QString& name) const
+{
+    for (const BackupTableEntry& entry : tables) {
+        if (entry.name == name) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+QJsonObject BackupManifest::toJson() const
+{
+    QJsonArray tableArray;
+    for (const BackupTableEntry& entry : tables) {
+        tableArray.append(entry.toJson());
+    }
+
+    return QJsonObject{
+        {"format", BackupFormat::Version},
+        {"id", id},
+        {"kind", kind},
+        {"parentId", parentId},
+        {"baseId", baseId},
+        {"createdAt", createdAt.toString(Qt::ISODateWithMs)},
+        {"snapshotAt", snapshotAt},
+        {"database", database},
+        {"serverVersion", serverVersion},
+        {"schemaVersion", schemaVersion},
+        {"tables", tableArray}
+    };
+}
+
+BackupManifest BackupManifest::fromJson(const QJsonObject& object)
+{
+    BackupManifest manifest;
+    manifest.id = object.value("id").toString();
+    manifest.kind = object.value("kind").toString();
+    manifest.parentId = object.value("parentId").toString();
+    manifest.baseId = object.value("baseId").toString();
+    manifest.createdAt = QDateTime::fromString(object.value("createdAt").toString(), Qt::ISODateWithMs);
+    manifest.snapshotAt = object.value("snapshotAt").toString();
+    manifest.database = object.value("database").toString();
+    manifest.serverVersion = object.value("serverVersion").toInt();
+    manifest.schemaVersion = object.value("schemaVersion").toInt();
+    for (const QJsonValue& table : object.value("tables").toArray()) {
+        manifest.tables.append(BackupTableEntry::fromJson(table.toObject()));
+    }
+    return manifest;
+}
+
+BackupArchiveWriter::BackupArchiveWriter()
+    : m_archiveHash(QCryptographicHash::Sha256)
+    , m_tableHash(QCryptographicHash::Sha256)
+{
+}
+
+bool BackupArchiveWriter::open(const QString& filePath)
+{
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::WriteOnly)) {
+        m_error = m_file.errorString();
+        return false;
+    }
+    m_archiveHash.reset();
+    return write(BackupFormat::Magic);
+}
+
+void BackupArchiveWriter::beginTable(const QString& name, const QStringList& columns)
+{
+    m_table = BackupTableEntry();
+    m_table.name = name;
+    m_table.columns = columns;
+    m_table.offset = m_file.pos();
+    m_tableHash.reset();
+    m_buffer.clear();
+    m_buffer.reserve(BackupFormat::BlockSize);
+}
+
+bool BackupArchiveWriter::append(const char* data, qsizetype size)
+{
+    m_tableHash.addData(QByteArrayView(data, size));
+    m_table.rawBytes += size;
+
+    // Blocks are cut at exactly BlockSize; the COPY stream is simply
+    // concatenated again on restore, so rows may span blocks
+    while (size > 0) {
+        const qsizetype take = qMin<qsizetype>(size, BackupFormat::BlockSize - m_buffer.size());
+        m_buffer.append(data, take);
+        data += take;
+        size -= take;
+        if (m_buffer.size() == BackupFormat::BlockSize && !flushBlock()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+BackupTableEntry BackupArchiveWriter::endTable(qint64 rows)
+{
+    if (!m_buffer.isEmpty()) {
+        flushBlock();
+    }
+    write(QByteArray(1, BackupFormat::TableEndFrame));
+
+    m_table.rows = rows;
+    m_table.sha256 = QString::fromLatin1(m_tableHash.result().toHex());
+    return m_table;
+}
+
+bool BackupArchiveWriter::finish(const BackupManifest& manifest)
+{
+    const qint64 manifestOffset = m_file.pos();
+    const QByteArray json = QJsonDocument(manifest.toJson()).toJson(QJsonDocument::Compact);
+
+    char header[5];
+    header[0] = BackupFormat::ManifestFrame;
+    qToLittleEndian<quint32>(static_cast<quint32>(json.size()), header + 1);
+    if (!write(QByteArray(header, sizeof(header))) || !write(json)) {
+        return false;
+    }
+
+    // The trailer's own bytes are not part of the checksum
+    char offset[8];
+    qToLittleEndian<quint64>(static_cast<quint64>(manifestOffset), offset);
+    const QByteArray trailer = QByteArray(offset, sizeof(offset)) + m_archiveHash.result()
+                               + BackupFormat::TrailerMagic;
+    if (m_file.write(trailer) != trailer.size()) {
+        m_error = m_file.errorString();
+        return false;
+    }
+
+    if (!m_file.commit()) {
+        m_error = m_file.errorString();
+        return false;
+    }
+    return true;
+}
+
+void BackupArchiveWriter::cancel()
+{
+    m_file.cancelWriting();
+}
+
+bool BackupArchiveWriter::write(const QByteArray& bytes)
+{
+    if (m_file.write(bytes) != bytes.size()) {
+        m_error = m_file.errorString();
+        return false;
+    }
+    m_archiveHash.addData(bytes);
+    return true;
+}
+
+bool BackupArchiveWriter::flushBlock()
+{
+    // Level 1: COPY binary is mostly fixed-width fields and compresses well
+    // even at the fastest setting, which keeps export bound by the server
+    const QByteArray compressed = qCompress(m_buffer, 1);
+
+    char header[9];
+    header[0] = BackupFormat::BlockFrame;
+    qToLittleEndian<quint32>(static_cast<quint32>(m_buffer.size()), header + 1);
+    qToLittleEndian<quint32>(static_cast<quint32>(compressed.size()), header + 5);
+
+    m_table.compressedBytes += compressed.size();
+    m_table.blocks++;
+    m_buffer.clear();
+    return write(QByteArray(header, sizeof(header))) && write(compressed);
+}
+
+BackupArchiveReader::BackupArchiveReader()
+    : m_manifestOffset(0)
+    , m_tableHash(QCryptographicHash::Sha256)
+{
+}
+
+bool BackupArchiveReader::open(const QString& filePath)
+{
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_error = m_file.errorString();
+        return false;
+    }
+
+    const qint64 size = m_file.size();
+    if (size < BackupFormat::Magic.size() + BackupFormat::TrailerSize
+        || m_file.read(BackupFormat::Magic.size()) != BackupFormat::Magic) {
+        m_error = "Not a Nimo backup archive";
+        return false;
+    }
+
+    m_file.seek(size - BackupFormat::TrailerSize);
+    const QByteArray trailer = m_file.read(BackupFormat::TrailerSize);
+    if (!trailer.endsWith(BackupFormat::TrailerMagic)) {
+        m_error = "Archive is truncated";
+        return false;
+    }
+    m_manifestOffset = static_cast<qint64>(qFromLittleEndian<quint64>(trailer.constData()));
+    m_archiveSha256 = trailer.mid(8, 32);
+
+    char header[5];
+    if (!m_file.seek(m_manifestOffset)
+        || m_file.read(header, sizeof(header)) != sizeof(header)
+        || header[0] != BackupFormat::ManifestFrame) {
+        m_error = "Manifest not found";
+        return false;
+    }
+    const quint32 length = qFromLittleEndian<quint32>(header + 1);
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(m_file.read(length), &parseError);
+    if (parseError.error != QJsonParseError::NoError || !document.isObject()) {
+        m_error = QString("Manifest is corrupt: %1").arg(parseError.errorString());
+        return false;
+    }
+
+    m_manifest = BackupManifest::fromJson(document.object());
+    return true;
+}
+
+void BackupArchiveReader::close()
+{
+    m_file.close();
+}
+
+bool BackupArchiveReader::verify()
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    m_file.seek(0);
+    qint64 remaining = m_file.size() - BackupFormat::TrailerSize;
+    while (remaining > 0) {
+        const QByteArray chunk = m_file.read(qMin<qint64>(remaining, BackupFormat::BlockSize));
+        if (chunk.isEmpty()) {
+            m_error = m_file.errorString();
+            return false;
+        }
+        hash.addData(chunk);
+        remaining -= chunk.size();
+    }
+
+    if (hash.result() != m_archiveSha256) {
+        m_error = "Archive checksum mismatch";
+        return false;
+    }
+    return true;
+}
+
+bool BackupArchiveReader::beginTable(const BackupTableEntry& entry)
+{
+    m_table = entry;
+    m_tableHash.reset();
+    if (entry.offset <= 0 || entry.offset >= m_manifestOffset || !m_file.seek(entry.offset)) {
+        m_error = QString("Table %1 is outside the archive").arg(entry.name);
+        return false;
+    }
+    return true;
+}
+
+bool BackupArchiveReader::readBlock(QByteArray* raw)
+{
+    raw->clear();
+
+    char type = 0;
+    if (!m_file.getChar(&type)) {
+        m_error = QString("Table %1 is truncated").arg(m_table.name);
+        return false;
+    }
+
+    if (type == BackupFormat::TableEndFrame) {
+        if (QString::fromLatin1(m_tableHash.result().toHex()) != m_table.sha256) {
+            m_error = QString("Table %1 checksum mismatch").arg(m_table.name);
+            return false;
+        }
+        return true;
+    }
+
+    char header[8];
+    if (type != BackupFormat::BlockFrame || m_file.read(header, sizeof(header)) != sizeof(header)) {
+        m_error = QString("Table %1 has a corrupt block").arg(m_table.name);
+        return false;
+    }
+    const quint32 rawSize = qFromLittleEndian<quint32>(header);
+    const quint32 compressedSize = qFromLittleEndian<quint32>(header + 4);
+    if (rawSize > static_cast<quint32>(BackupFormat::BlockSize)) {
+        m_error = QString("Table %1 has an oversized block").arg(m_table.name);
+        return false;
+    }
+
+    *raw = qUncompress(m_file.read(compressedSize));
+    if (raw->size() != static_cast<qsizetype>(rawSize) || rawSize == 0) {
+        m_error = QString("Table %1 has a corrupt block").arg(m_table.name);
+        return false;
+    }
+    m_tableHash.addData(*raw);
+    return true;
+}
@@ -0,0 +1,139 @@
+#ifndef BACKUPFORMAT_H
+#define BACKUPFORMAT_H
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonObject>
+#include <QList>
+#include <QSaveFile>
+#include <QString>
+#include <QStringList>
+
+// Backup archives (*.nimobak) hold the binary COPY stream of each table:
+//
+//   "NIMOBAK" + version
+//   per table:  blocks of ['B'][uint32 LE raw size][uint32 LE compressed size][zlib data]
+//               then ['E']
+//   manifest:   ['M'][uint32 LE size][JSON]
+//   trailer:    [uint64 LE manifest offset][SHA-256 of everything before the trailer]["NIMOEND" + version]
+//
+// The manifest is written last, once row counts and checksums are known, so
+// an archive is produced in one pass with a single block in memory. It
+// lists every table with its columns, the offset of its first block and the
+// SHA-256 of its uncompressed COPY data.
+//
+// An incremental archive has the same layout. Its small tables are still
+// complete; the others hold only rows changed since its parent's snapshot.
+namespace BackupFormat
+{
+extern const QByteArray Magic;
+extern const QByteArray TrailerMagic;
+constexpr quint8 Version = 1;
+constexpr int BlockSize = 1 << 20;
+constexpr int TrailerSize = 8 + 32 + 8;
+
+enum FrameType : char {
+    BlockFrame = 'B',
+    TableEndFrame = 'E',
+    ManifestFrame = 'M'
+};
+} // namespace BackupFormat
+
+struct BackupTableEntry {
+    QString name;
+    QStringList columns;
+    // complete: every row of the table; delta: rows changed since `since`
+    QString mode = "complete";
+    QString since;
+    qint64 offset = 0;
+    qint64 rows = 0;
+    qint64 rawBytes = 0;
+    qint64 compressedBytes = 0;
+    int blocks = 0;
+    QString sha256;
+
+    QJsonObject toJson() const;
+    static BackupTableEntry fromJson(const QJsonObject& object);
+};
+
+struct BackupManifest {
+    QString id;
+    // full, or incremental on top of parentId (and ultimately baseId)
+    QString kind = "full";
+    QString parentId;
+    QString baseId;
+    QDateTime createdAt;
+    // Server time of the snapshot the tables were copied from
+    QString snapshotAt;
+    QString database;
+    int serverVersion = 0;
+    int schemaVersion = 0;
+    QList<BackupTableEntry> tables;
+
+    const BackupTableEntry* table(const QString& name) const;
+    QJsonObject toJson() const;
+    static BackupManifest fromJson(const QJsonObject& object);
+};
+
+class BackupArchiveWriter
+{
+public:
+    BackupArchiveWriter();
+
+    bool open(const QString& filePath);
+    void beginTable(const QString& name, const QStringList& columns);
+    // Buffers COPY data; full blocks are compressed and written as they fill
+    bool append(const char* data, qsizetype size);
+    BackupTableEntry endTable(qint64 rows);
+    // Writes manifest and trailer and replaces the target file
+    bool finish(const BackupManifest& manifest);
+    void cancel();
+
+    QString errorString() const { return m_error; }
+
+private:
+    bool write(const QByteArray& bytes);
+    bool flushBlock();
+
+    QSaveFile m_file;
+    QCryptographicHash m_archiveHash;
+    QCryptographicHash m_tableHash;
+    BackupTableEntry m_table;
+    QByteArray m_buffer;
+    QString m_error;
+};
+
+class BackupArchiveReader
+{
+public:
+    BackupArchiveReader();
+
+    // Reads trailer and manifest; the tables are read on demand
+    bool open(const QString& filePath);
+    void close();
+    // Recomputes the archive checksum over the whole file
+    bool verify();
+
+    const BackupManifest& manifest() const { return m_manifest; }
+    qint64 fileSize() const { return m_file.size(); }
+
+    bool beginTable(const BackupTableEntry& entry);
+    // Next uncompressed block of the current table. At the end of the table
+    // *raw is left empty and the table checksum has been checked.
+    bool readBlock(QByteArray* raw);
+
+    QString errorString() const { return m_error; }
+
+private:
+    QFile m_file;
+    BackupManifest m_manifest;
+    QByteArray m_archiveSha256;
+    qint64 m_manifestOffset;
+    QCryptographicHash m_tableHash;
+    BackupTableEntry m_table;
+    QString m_error;
+};
+
+#endif // BACKUPFORMAT_H
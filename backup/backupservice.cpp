@@ -0,0 +1,834 @@
+#include "backup/backupservice.h"
+#include "backup/pgcopy.h"
+#include "database/slowquerylog.h"
+#include "database/sqlarrays.h"
+#include "logging/logger.h"
+#include "logging/requestscope.h"
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QSet>
+#include <QSqlDriver>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QUuid>
+
+namespace
+{
+QString quoted(QSqlDatabase& db, const QString& identifier)
+{
+    return db.driver()->escapeIdentifier(identifier, QSqlDriver::TableName);
+}
+
+QString columnList(QSqlDatabase& db, const QStringList& columns)
+{
+    QStringList escaped;
+    for (const QString& column : columns) {
+        escaped << db.driver()->escapeIdentifier(column, QSqlDriver::FieldName);
+    }
+    return escaped.join(", ");
+}
+
+QString literal(const QString& text)
+{
+    return "'" + QString(text).replace('\'', "''") + "'";
+}
+
+QStringList tableNames()
+{
+    QStringList names;
+    for (const BackupService::TableSpec& spec : BackupService::tableSpecs()) {
+        names << spec.name;
+    }
+    return names;
+}
+
+const BackupService::TableSpec* tableSpec(const QString& name)
+{
+    for (const BackupService::TableSpec& spec : BackupService::tableSpecs()) {
+        if (spec.name == name) {
+            return &spec;
+        }
+    }
+    return nullptr;
+}
+
+qint64 totalRows(const BackupManifest& manifest)
+{
+    qint64 rows = 0;
+    for (const BackupTableEntry& entry : manifest.tables) {
+        rows += entry.rows;
+    }
+    return rows;
+}
+}
+
+BackupService::BackupService(const QString& sourceConnection, QObject *parent)
+    : QObject(parent)
+    , m_sourceConnection(sourceConnection)
+    , m_connectionName(QString("%1_backup").arg(sourceConnection))
+    , m_overlapSeconds(300)
+{
+}
+
+BackupService::~BackupService()
+{
+    closeConnection();
+}
+
+const QList<BackupService::TableSpec>& BackupService::tableSpecs()
+{
+    // Goals are few, and a hard delete leaves no updated_at behind, so they
+    // are copied whole every time; the occurrences and streaks of a goal
+    // that disappears go with it. Occurrences merge on (goal_id, date), the
+    // key sync matches them on as well. Superseded occurrences come first:
+    // merging one clears its key before an occurrence moved off it arrives
+    // at its new date under the same id.
+    static const QList<TableSpec> specs = {
+        {"schema_migrations", QString(), {"version"}, QString()},
+        {"goals", QString(), {"id"}, QString()},
+        {"superseded_occurrences", "updated_at", {"goal_id", "date"}, "goal_id", "synced_at",
+         "occurrences"},
+        {"occurrences", "updated_at", {"goal_id", "date"}, "goal_id", "synced_at"},
+        {"daily_scores", "updated_at", {"date"}, QString()},
+        {"weekly_scores", "updated_at", {"week_start"}, QString()},
+        {"monthly_scores", "updated_at", {"month_start"}, QString()},
+        {"yearly_scores", "updated_at", {"year_start"}, QString()},
+        {"streaks", "updated_at", {"id"}, "goal_id"},
+        {"streak_days", "updated_at", {"date"}, QString()},
+        {"applied_mutations", "applied_at", {"mutation_id"}, QString()},
+        {"sync_state", QString(), {"peer", "table_name", "direction"}, QString()}
+    };
+    return specs;
+}
+
+bool BackupService::exportBackup(const QString& filePath, BackupManifest* manifest, QString* error)
+{
+    RequestScope scope("BackupService::exportBackup", "BACKUP", {
+                                                                    {"path", filePath}
+                                                                });
+    QElapsedTimer timer;
+    timer.start();
+    error->clear();
+
+    if (!exportArchive(scope, filePath, nullptr, manifest, error)) {
+        return false;
+    }
+
+    scope.logSuccess({
+        {"backupId", manifest->id},
+        {"tables", manifest->tables.size()},
+        {"rows", totalRows(*manifest)},
+        {"bytes", QFileInfo(filePath).size()},
+        {"durationMs", timer.elapsed()}
+    });
+    return true;
+}
+
+bool BackupService::exportIncremental(const QString& parentPath, const QString& filePath,
+                                      BackupManifest* manifest, QString* error)
+{
+    RequestScope scope("BackupService::exportIncremental", "BACKUP", {
+                                                                         {"path", filePath},
+                                                                         {"parent", parentPath}
+                                                                     });
+    QElapsedTimer timer;
+    timer.start();
+    error->clear();
+
+    // Only the parent's manifest is needed, not its tables
+    BackupArchiveReader reader;
+    if (!reader.open(parentPath)) {
+        *error = reader.errorString();
+        scope.logError(*error, "BACKUP_CORRUPT");
+        return false;
+    }
+    const BackupManifest parent = reader.manifest();
+    reader.close();
+    if (parent.snapshotAt.isEmpty()) {
+        *error = QString("Backup %1 has no snapshot time").arg(parent.id);
+        scope.logError(*error, "BACKUP_UNSUPPORTED");
+        return false;
+    }
+
+    if (!exportArchive(scope, filePath, &parent, manifest, error)) {
+        return false;
+    }
+
+    scope.logSuccess({
+        {"backupId", manifest->id},
+        {"parentId", parent.id},
+        {"since", parent.snapshotAt},
+        {"tables", manifest->tables.size()},
+        {"rows", totalRows(*manifest)},
+        {"bytes", QFileInfo(filePath).size()},
+        {"durationMs", timer.elapsed()}
+    });
+    return true;
+}
+
+bool BackupService::verifyBackup(const QString& filePath, BackupManifest* manifest, QString* error)
+{
+    BackupArchiveReader reader;
+    if (!reader.open(filePath) || !reader.verify()) {
+        *error = reader.errorString();
+        return false;
+    }
+    *manifest = reader.manifest();
+    return true;
+}
+
+bool BackupService::resolveChain(const QStringList& filePaths, QStringList* ordered, QString* error)
+{
+    ordered->clear();
+
+    QHash<QString, QString> pathById;
+    QHash<QString, BackupManifest> manifests;
+    QSet<QString> parentIds;
+    for (const QString& path : filePaths) {
+        BackupArchiveReader reader;
+        if (!reader.open(path)) {
+            *error = QString("%1: %2").arg(path, reader.errorString());
+            return false;
+        }
+        const BackupManifest& manifest = reader.manifest();
+        if (pathById.contains(manifest.id)) {
+            *error = QString("%1 and %2 are the same backup").arg(pathById.value(manifest.id), path);
+            return false;
+        }
+        pathById.insert(manifest.id, path);
+        manifests.insert(manifest.id, manifest);
+        if (!manifest.parentId.isEmpty()) {
+            parentIds.insert(manifest.parentId);
+        }
+    }
+
+    // The newest archive is the one nothing else builds on
+    QStringList tips;
+    for (auto it = manifests.cbegin(); it != manifests.cend(); ++it) {
+        if (!parentIds.contains(it.key())) {
+            tips << it.key();
+        }
+    }
+    if (tips.size() != 1) {
+        QStringList tipPaths;
+        for (const QString& id : std::as_const(tips)) {
+            tipPaths << pathById.value(id);
+        }
+        *error = QString("Backups do not form a single chain; it ends in %1").arg(tipPaths.join(", "));
+        return false;
+    }
+
+    QString id = tips.first();
+    while (true) {
+        const BackupManifest manifest = manifests.value(id);
+        ordered->prepend(pathById.value(id));
+        if (manifest.kind == "full") {
+            break;
+        }
+        if (manifest.kind != "incremental" || ordered->size() > filePaths.size()) {
+            *error = QString("%1 is not a valid backup chain").arg(pathById.value(id));
+            return false;
+        }
+        if (!manifests.contains(manifest.parentId)) {
+            *error = QString("%1 needs backup %2, which was not given")
+                         .arg(pathById.value(id), manifest.parentId);
+            return false;
+        }
+        id = manifest.parentId;
+    }
+
+    if (ordered->size() != filePaths.size()) {
+        *error = QString("Some backups are not part of the chain ending in %1").arg(ordered->last());
+        return false;
+    }
+    return true;
+}
+
+bool BackupService::restoreBackup(const QString& filePath, BackupManifest* manifest, QString* error)
+{
+    return restoreChain({filePath}, manifest, error);
+}
+
+bool BackupService::restoreChain(const QStringList& filePaths, BackupManifest* manifest, QString* error)
+{
+    RequestScope scope("BackupService::restoreChain", "RESTORE", {
+                                                                     {"files", QJsonArray::fromStringList(filePaths)}
+                                                                 });
+    QElapsedTimer timer;
+    timer.start();
+    error->clear();
+
+    // Reject a damaged or incomplete chain before touching the database
+    QList<BackupArchiveReader*> readers;
+    if (!openChain(filePaths, &readers, error)) {
+        scope.logError(*error, "BACKUP_CORRUPT");
+        return false;
+    }
+    *manifest = readers.last()->manifest();
+
+    QStringList restored;
+    for (const BackupArchiveReader* reader : std::as_const(readers)) {
+        for (const BackupTableEntry& entry : reader->manifest().tables) {
+            if (!restored.contains(entry.name)) {
+                restored << entry.name;
+            }
+        }
+    }
+
+    if (!openConnection(error)) {
+        scope.logError(*error, "DB_CONNECTION_FAILED");
+        qDeleteAll(readers);
+        return false;
+    }
+
+    bool ok = m_db.transaction();
+    if (!ok) {
+        *error = m_db.lastError().text();
+        scope.logError(*error, "SQL_EXEC_FAILED");
+    }
+    ok = ok && applyChain(scope, readers, error);
+    if (ok && !m_db.commit()) {
+        *error = m_db.lastError().text();
+        scope.logError(*error, "SQL_EXEC_FAILED");
+        ok = false;
+    }
+    const int archives = readers.size();
+    qDeleteAll(readers);
+    if (!ok) {
+        m_db.rollback();
+        closeConnection();
+        return false;
+    }
+
+    // Fresh statistics, or the planner sees the truncated tables as empty
+    QStringList analyzed;
+    for (const QString& table : std::as_const(restored)) {
+        analyzed << quoted(m_db, table);
+    }
+    QString analyzeError;
+    if (!exec("ANALYZE " + analyzed.join(", "), &analyzeError)) {
+        Logger::instance().warn("BackupService::restoreChain", "backup",
+                                "ANALYZE after restore failed", {
+                                    {"errorMessage", analyzeError}
+                                });
+    }
+    closeConnection();
+
+    scope.logSuccess({
+        {"backupId", manifest->id},
+        {"archives", archives},
+        {"tables", restored.size()},
+        {"durationMs", timer.elapsed()}
+    });
+    return true;
+}
+
+bool BackupService::consolidate(const QStringList& filePaths, const QString& outputPath,
+                                BackupManifest* manifest, QString* error)
+{
+    RequestScope scope("BackupService::consolidate", "BACKUP", {
+                                                                   {"files", QJsonArray::fromStringList(filePaths)},
+                                                                   {"path", outputPath}
+                                                               });
+    QElapsedTimer timer;
+    timer.start();
+    error->clear();
+
+    QList<BackupArchiveReader*> readers;
+    if (!openChain(filePaths, &readers, error)) {
+        scope.logError(*error, "BACKUP_CORRUPT");
+        return false;
+    }
+    const BackupManifest tip = readers.last()->manifest();
+    const int archives = readers.size();
+
+    QStringList tables;
+    for (const BackupArchiveReader* reader : std::as_const(readers)) {
+        for (const BackupTableEntry& entry : reader->manifest().tables) {
+            if (!tables.contains(entry.name)) {
+                tables << entry.name;
+            }
+        }
+    }
+
+    if (!openConnection(error)) {
+        scope.logError(*error, "DB_CONNECTION_FAILED");
+        qDeleteAll(readers);
+        return false;
+    }
+
+    // The chain is replayed into empty copies of its tables in a scratch
+    // schema that is rolled back afterwards; the live tables are neither
+    // read nor locked
+    bool ok = m_db.transaction();
+    if (!ok) {
+        *error = m_db.lastError().text();
+    }
+    QString liveSchema;
+    if (ok) {
+        QSqlQuery query(m_db);
+        ok = query.exec("SELECT current_schema()") && query.next();
+        if (ok) {
+            liveSchema = quoted(m_db, query.value(0).toString());
+        } else {
+            *error = query.lastError().text();
+        }
+    }
+    ok = ok && exec("CREATE SCHEMA nimo_consolidate", error);
+    for (const TableSpec& spec : tableSpecs()) {
+        if (ok && tables.contains(spec.name)) {
+            ok = exec(QString("CREATE TABLE nimo_consolidate.%1 (LIKE %2.%1 INCLUDING ALL)")
+                          .arg(quoted(m_db, spec.name), liveSchema),
+                      error);
+        }
+    }
+    ok = ok && exec("SET LOCAL search_path = nimo_consolidate", error);
+    if (!ok) {
+        scope.logError(*error, "SQL_EXEC_FAILED");
+    }
+
+    ok = ok && applyChain(scope, readers, error);
+    qDeleteAll(readers);
+
+    QHash<QString, QStringList> columns;
+    if (ok && !readSnapshot(manifest, &columns, error)) {
+        scope.logError(*error, "SQL_EXEC_FAILED");
+        ok = false;
+    }
+    if (ok) {
+        // It stands in for the chain's newest archive: incrementals taken
+        // on top of it continue from the same snapshot
+        manifest->snapshotAt = tip.snapshotAt;
+        manifest->database = tip.database;
+        if (!writeArchive(outputPath, columns, nullptr, manifest, error)) {
+            scope.logError(*error, "BACKUP_FAILED");
+            ok = false;
+        }
+    }
+
+    m_db.rollback();
+    closeConnection();
+    if (!ok) {
+        return false;
+    }
+
+    scope.logSuccess({
+        {"backupId", manifest->id},
+        {"tipId", tip.id},
+        {"archives", archives},
+        {"tables", manifest->tables.size()},
+        {"rows", totalRows(*manifest)},
+        {"bytes", QFileInfo(outputPath).size()},
+        {"durationMs", timer.elapsed()}
+    });
+    return true;
+}
+
+bool BackupService::exportArchive(RequestScope& scope, const QString& filePath, const BackupManifest* parent,
+                                  BackupManifest* manifest, QString* error)
+{
+    if (!openConnection(error)) {
+        scope.logError(*error, "DB_CONNECTION_FAILED");
+        return false;
+    }
+
+    // Every table from the same snapshot, so the archive is consistent
+    // even while the app keeps writing
+    QHash<QString, QStringList> columns;
+    if (!m_db.transaction()
+        || !exec("SET TRANSACTION ISOLATION LEVEL REPEATABLE READ, READ ONLY", error)
+        || !readSnapshot(manifest, &columns, error)) {
+        if (error->isEmpty()) {
+            *error = m_db.lastError().text();
+        }
+        scope.logError(*error, "SQL_EXEC_FAILED");
+        m_db.rollback();
+        closeConnection();
+        return false;
+    }
+
+    const bool ok = writeArchive(filePath, columns, parent, manifest, error);
+    m_db.rollback();
+    closeConnection();
+    if (!ok) {
+        scope.logError(*error, "BACKUP_FAILED");
+    }
+    return ok;
+}
+
+bool BackupService::readSnapshot(BackupManifest* manifest, QHash<QString, QStringList>* columns,
+                                 QString* error)
+{
+    *manifest = BackupManifest();
+    manifest->id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    manifest->createdAt = QDateTime::currentDateTimeUtc();
+
+    QSqlQuery info(m_db);
+    info.prepare(R"(
+        SELECT now()::text,
+               current_database(),
+               current_setting('server_version_num')::int,
+               (SELECT COALESCE(MAX(version), 0) FROM schema_migrations)
+    )");
+    QSqlQuery tableColumns(m_db);
+    tableColumns.prepare(R"(
+        SELECT table_name, array_to_string(array_agg(column_name::text ORDER BY ordinal_position), ',')
+        FROM information_schema.columns
+        WHERE table_schema = current_schema() AND table_name = ANY(CAST(:tables AS text[]))
+        GROUP BY table_name
+    )");
+    tableColumns.bindValue(":tables", SqlArrays::texts(tableNames()));
+    if (!SlowQueryLog::exec(info, "BackupService::readSnapshot") || !info.next()
+        || !SlowQueryLog::exec(tableColumns, "BackupService::readSnapshot")) {
+        *error = info.lastError().isValid() ? info.lastError().text() : tableColumns.lastError().text();
+        return false;
+    }
+
+    manifest->snapshotAt = info.value(0).toString();
+    manifest->database = info.value(1).toString();
+    manifest->serverVersion = info.value(2).toInt();
+    manifest->schemaVersion = info.value(3).toInt();
+    columns->clear();
+    while (tableColumns.next()) {
+        columns->insert(tableColumns.value(0).toString(), tableColumns.value(1).toString().split(','));
+    }
+    return true;
+}
+
+bool BackupService::writeArchive(const QString& filePath, const QHash<QString, QStringList>& columns,
+                                 const BackupManifest* parent, BackupManifest* manifest, QString* error)
+{
+    if (parent) {
+        manifest->kind = "incremental";
+        manifest->parentId = parent->id;
+        manifest->baseId = parent->kind == "full" ? parent->id : parent->baseId;
+    }
+
+    BackupArchiveWriter writer;
+    PgCopy copy(m_db);
+    if (!copy.isValid() || !writer.open(filePath)) {
+        *error = copy.isValid() ? writer.errorString() : copy.lastError();
+        writer.cancel();
+        return false;
+    }
+
+    for (const TableSpec& spec : tableSpecs()) {
+        // Databases created before a table existed simply lack it
+        if (!columns.contains(spec.name)) {
+            continue;
+        }
+
+        const QStringList tableColumns = columns.value(spec.name);
+        QString since;
+        QString sql = QString("COPY %1 (%2) TO STDOUT (FORMAT binary)")
+                          .arg(quoted(m_db, spec.name), columnList(m_db, tableColumns));
+        // A table the parent lacks has nothing to be a delta of. Rows that
+        // committed just after the parent's snapshot can carry an earlier
+        // timestamp, so the overlap reads them again.
+        if (parent && parent->table(spec.name) && tableColumns.contains(spec.changeColumn)) {
+            since = parent->snapshotAt;
+            const QString cutoff = QString("CAST(%1 AS timestamptz) - make_interval(secs => %2)")
+                                       .arg(literal(since))
+                                       .arg(m_overlapSeconds);
+            QString changed = QString("%1 >= %2").arg(columnList(m_db, {spec.changeColumn}), cutoff);
+            if (tableColumns.contains(spec.syncedColumn)) {
+                changed += QString(" OR %1 >= %2").arg(columnList(m_db, {spec.syncedColumn}), cutoff);
+            }
+            sql = QString("COPY (SELECT %1 FROM %2 WHERE %3) TO STDOUT (FORMAT binary)")
+                      .arg(columnList(m_db, tableColumns), quoted(m_db, spec.name), changed);
+        }
+
+        writer.beginTable(spec.name, tableColumns);
+        qint64 rows = 0;
+        if (!copy.copyOut(sql,
+                          [&writer](const char* data, int length) {
+                              return writer.append(data, length);
+                          },
+                          &rows)) {
+            *error = writer.errorString().isEmpty() ? copy.lastError() : writer.errorString();
+            writer.cancel();
+            return false;
+        }
+
+        BackupTableEntry entry = writer.endTable(rows);
+        if (!since.isEmpty()) {
+            entry.mode = "delta";
+            entry.since = since;
+        }
+        manifest->tables.append(entry);
+        emit tableExported(spec.name, rows);
+    }
+
+    if (!writer.finish(*manifest)) {
+        *error = writer.errorString();
+        writer.cancel();
+        return false;
+    }
+    return true;
+}
+
+bool BackupService::openChain(const QStringList& filePaths, QList<BackupArchiveReader*>* readers,
+                              QString* error)
+{
+    QStringList ordered;
+    if (!resolveChain(filePaths, &ordered, error)) {
+        return false;
+    }
+
+    for (const QString& path : std::as_const(ordered)) {
+        BackupArchiveReader* reader = new BackupArchiveReader;
+        readers->append(reader);
+        if (!reader->open(path) || !reader->verify()) {
+            *error = QString("%1: %2").arg(path, reader->errorString());
+            qDeleteAll(*readers);
+            readers->clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BackupService::applyChain(RequestScope& scope, const QList<BackupArchiveReader*>& readers,
+                               QString* error)
+{
+    // Tables here, and their secondary indexes; constraint indexes stay
+    QStringList present;
+    QStringList indexNames;
+    QStringList indexDefinitions;
+    {
+        QSqlQuery tables(m_db);
+        tables.prepare(R"(
+            SELECT t.name
+            FROM unnest(CAST(:tables AS text[])) WITH ORDINALITY AS t(name, position)
+            WHERE to_regclass(quote_ident(t.name)) IS NOT NULL
+            ORDER BY t.position
+        )");
+        tables.bindValue(":tables", SqlArrays::texts(tableNames()));
+        QSqlQuery indexes(m_db);
+        indexes.prepare(R"(
+            SELECT i.indexrelid::regclass::text, pg_get_indexdef(i.indexrelid)
+            FROM pg_index i
+            JOIN pg_class t ON t.oid = i.indrelid
+            WHERE t.relnamespace = current_schema()::regnamespace
+              AND t.relname = ANY(CAST(:tables AS text[]))
+              AND NOT EXISTS (SELECT 1 FROM pg_constraint c WHERE c.conindid = i.indexrelid)
+        )");
+        indexes.bindValue(":tables", SqlArrays::texts(tableNames()));
+        if (!SlowQueryLog::exec(tables, "BackupService::applyChain")
+            || !SlowQueryLog::exec(indexes, "BackupService::applyChain")) {
+            *error = tables.lastError().isValid() ? tables.lastError().text() : indexes.lastError().text();
+            scope.logError(*error, "SQL_EXEC_FAILED");
+            return false;
+        }
+        while (tables.next()) {
+            present << tables.value(0).toString();
+        }
+        while (indexes.next()) {
+            indexNames << indexes.value(0).toString();
+            indexDefinitions << indexes.value(1).toString();
+        }
+    }
+
+    for (const BackupArchiveReader* reader : readers) {
+        for (const BackupTableEntry& entry : reader->manifest().tables) {
+            if (!present.contains(entry.name)) {
+                *error = QString("Table %1 does not exist; apply the schema first").arg(entry.name);
+                scope.logError(*error, "SCHEMA_MISMATCH");
+                return false;
+            }
+        }
+    }
+
+    QStringList presentTables;
+    for (const QString& table : std::as_const(present)) {
+        presentTables << quoted(m_db, table);
+    }
+
+    // Loading into empty, index-free tables and indexing once afterwards is
+    // far cheaper than maintaining every index row by row. Tables missing
+    // from the full backup end up empty, like everything else it replaces.
+    if (!exec("SET LOCAL maintenance_work_mem = '256MB'", error)
+        || (!indexNames.isEmpty() && !exec("DROP INDEX " + indexNames.join(", "), error))
+        || !exec("TRUNCATE " + presentTables.join(", "), error)) {
+        scope.logError(*error, "SQL_EXEC_FAILED");
+        return false;
+    }
+
+    BackupArchiveReader* base = readers.first();
+    for (const BackupTableEntry& entry : base->manifest().tables) {
+        if (!loadTable(base, entry, quoted(m_db, entry.name), error)) {
+            scope.logError(*error, "RESTORE_FAILED");
+            return false;
+        }
+        emit tableRestored(entry.name, entry.rows);
+    }
+
+    for (int i = 1; i < readers.size(); ++i) {
+        for (const BackupTableEntry& entry : readers.at(i)->manifest().tables) {
+            if (!mergeTable(readers.at(i), entry, error)) {
+                scope.logError(*error, "RESTORE_FAILED");
+                return false;
+            }
+            emit tableRestored(entry.name, entry.rows);
+        }
+    }
+
+    // The foreign keys already cascade when a goal is gone from a later
+    // archive, but consolidation's scratch tables have none
+    if (readers.size() > 1 && present.contains("goals")) {
+        for (const TableSpec& spec : tableSpecs()) {
+            if (spec.goalColumn.isEmpty() || !present.contains(spec.name)) {
+                continue;
+            }
+            const QString goalColumn = columnList(m_db, {spec.goalColumn});
+            if (!exec(QString("DELETE FROM %1 t WHERE t.%2 IS NOT NULL "
+                              "AND NOT EXISTS (SELECT 1 FROM goals g WHERE g.id = t.%2)")
+                          .arg(quoted(m_db, spec.name), goalColumn),
+                      error)) {
+                scope.logError(*error, "SQL_EXEC_FAILED");
+                return false;
+            }
+        }
+    }
+
+    for (const QString& definition : std::as_const(indexDefinitions)) {
+        if (!exec(definition, error)) {
+            scope.logError(*error, "SQL_EXEC_FAILED");
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BackupService::loadTable(BackupArchiveReader* reader, const BackupTableEntry& entry,
+                              const QString& target, QString* error)
+{
+    PgCopy copy(m_db);
+    if (!copy.isValid()) {
+        *error = copy.lastError();
+        return false;
+    }
+    if (!reader->beginTable(entry)
+        || !copy.begin(QString("COPY %1 (%2) FROM STDIN (FORMAT binary)")
+                           .arg(target, columnList(m_db, entry.columns)))) {
+        *error = reader->errorString().isEmpty() ? copy.lastError() : reader->errorString();
+        return false;
+    }
+
+    QByteArray block;
+    while (true) {
+        if (!reader->readBlock(&block)) {
+            *error = reader->errorString();
+            copy.abort(*error);
+            return false;
+        }
+        if (block.isEmpty()) {
+            break;
+        }
+        if (!copy.put(block)) {
+            *error = copy.lastError();
+            copy.abort(*error);
+            return false;
+        }
+    }
+
+    qint64 rows = 0;
+    if (!copy.end(&rows)) {
+        *error = copy.lastError();
+        return false;
+    }
+    if (rows != entry.rows) {
+        *error = QString("Table %1 restored %2 rows, expected %3")
+                     .arg(entry.name).arg(rows).arg(entry.rows);
+        return false;
+    }
+    return true;
+}
+
+bool BackupService::mergeTable(BackupArchiveReader* reader, const BackupTableEntry& entry, QString* error)
+{
+    const TableSpec* spec = tableSpec(entry.name);
+    if (!spec) {
+        *error = QString("Backup has unknown table %1").arg(entry.name);
+        return false;
+    }
+
+    // COPY cannot upsert, so the rows land in a temporary table first
+    const QString table = quoted(m_db, entry.name);
+    const QString delta = quoted(m_db, "nimo_delta_" + entry.name);
+    if (!exec(QString("CREATE TEMP TABLE %1 (LIKE %2 INCLUDING DEFAULTS)").arg(delta, table), error)
+        || !loadTable(reader, entry, delta, error)) {
+        return false;
+    }
+
+    QStringList assignments;
+    for (const QString& column : entry.columns) {
+        if (!spec->key.contains(column)) {
+            assignments << QString("%1 = EXCLUDED.%1").arg(columnList(m_db, {column}));
+        }
+    }
+    const QString columns = columnList(m_db, entry.columns);
+    QString upsert = QString("INSERT INTO %1 (%2) SELECT %2 FROM %3 ON CONFLICT (%4) ")
+                         .arg(table, columns, delta, columnList(m_db, spec->key));
+    upsert += assignments.isEmpty() ? QString("DO NOTHING") : "DO UPDATE SET " + assignments.join(", ");
+    if (!exec(upsert, error)) {
+        return false;
+    }
+
+    QStringList matches;
+    for (const QString& column : spec->key) {
+        matches << QString("d.%1 = t.%1").arg(columnList(m_db, {column}));
+    }
+
+    // Rows replaced at the same key by a later one of this table
+    if (!spec->supersedes.isEmpty()
+        && !exec(QString("DELETE FROM %1 t USING %2 d WHERE %3 AND t.%4 < d.%4")
+                     .arg(quoted(m_db, spec->supersedes), delta, matches.join(" AND "),
+                          columnList(m_db, {spec->changeColumn})),
+                 error)) {
+        return false;
+    }
+
+    // A complete table also tells which rows are gone
+    if (entry.mode == "complete") {
+        if (!exec(QString("DELETE FROM %1 t WHERE NOT EXISTS (SELECT 1 FROM %2 d WHERE %3)")
+                      .arg(table, delta, matches.join(" AND ")),
+                  error)) {
+            return false;
+        }
+    }
+
+    return exec("DROP TABLE " + delta, error);
+}
+
+bool BackupService::openConnection(QString* error)
+{
+    closeConnection();
+    m_db = QSqlDatabase::cloneDatabase(m_sourceConnection, m_connectionName);
+    if (!m_db.open()) {
+        *error = m_db.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+void BackupService::closeConnection()
+{
+    if (m_db.isValid()) {
+        m_db.close();
+        m_db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(m_connectionName);
+    }
+}
+
+bool BackupService::exec(const QString& sql, QString* error)
+{
+    QSqlQuery query(m_db);
+    if (!query.exec(sql)) {
+        *error = query.lastError().text();
+        return false;
+    }
+    return true;
+}
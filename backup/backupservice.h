@@ -0,0 +1,111 @@
+#ifndef BACKUPSERVICE_H
+#define BACKUPSERVICE_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QSqlDatabase>
+#include <QStringList>
+#include "backup/backupformat.h"
+
+class BackupArchiveReader;
+class RequestScope;
+
+// Export and restore of the whole database as archives (see
+// backup/backupformat.h). Each table is streamed with COPY ... (FORMAT
+// binary) straight between the server and the file, so memory use does not
+// grow with the database. Export reads every table from one repeatable-read
+// snapshot.
+//
+// A full backup holds every row. An incremental one holds the small tables
+// in full (so hard deletes of goals carry over) and, of the others, only
+// rows whose change column (or, for rows nimo-sync pulled with the remote's
+// older timestamp, synced column) moved since its parent's snapshot,
+// re-reading a short overlap for transactions that committed after it.
+//
+// Restoring a chain (a full backup and the incrementals on top of it)
+// replaces the contents of every Nimo table in a single transaction:
+// secondary indexes are dropped, the tables truncated and COPYed from the
+// full backup, each incremental is COPYed into a temporary table and merged
+// with an upsert, then the indexes are rebuilt. Any checksum or row count
+// mismatch rolls the whole restore back. Consolidation replays a chain the
+// same way into a scratch schema and exports it as one full backup.
+//
+// All of it runs on a connection of its own, cloned from sourceConnection.
+class BackupService : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct TableSpec {
+        QString name;
+        QString changeColumn;   // empty: always backed up complete
+        QStringList key;
+        QString goalColumn;     // rows of goals gone from a later archive go with them
+        QString syncedColumn;   // local time of a nimo-sync pull, also read for deltas
+        QString supersedes;     // table whose older rows at the same key a merge removes
+    };
+
+    explicit BackupService(const QString& sourceConnection, QObject *parent = nullptr);
+    ~BackupService();
+
+    // Every table a backup covers, parents before children
+    static const QList<TableSpec>& tableSpecs();
+
+    bool exportBackup(const QString& filePath, BackupManifest* manifest, QString* error);
+    // Rows changed since the snapshot of parentPath, a full or incremental backup
+    bool exportIncremental(const QString& parentPath, const QString& filePath,
+                           BackupManifest* manifest, QString* error);
+    // Checks the archive checksum and reads the manifest without restoring
+    bool verifyBackup(const QString& filePath, BackupManifest* manifest, QString* error);
+
+    // Orders archives from the full backup to the newest incremental by
+    // their parent links; fails on gaps, forks or a missing full backup
+    static bool resolveChain(const QStringList& filePaths, QStringList* ordered, QString* error);
+
+    bool restoreBackup(const QString& filePath, BackupManifest* manifest, QString* error);
+    // manifest receives the newest archive's manifest
+    bool restoreChain(const QStringList& filePaths, BackupManifest* manifest, QString* error);
+    // Folds a chain into one full backup of its newest state, which later
+    // incrementals can use as their parent like the chain's last archive
+    bool consolidate(const QStringList& filePaths, const QString& outputPath,
+                     BackupManifest* manifest, QString* error);
+
+    int overlapSeconds() const { return m_overlapSeconds; }
+    void setOverlapSeconds(int seconds) { m_overlapSeconds = qMax(0, seconds); }
+
+signals:
+    void tableExported(const QString& table, qint64 rows);
+    void tableRestored(const QString& table, qint64 rows);
+
+private:
+    bool openConnection(QString* error);
+    void closeConnection();
+    bool exec(const QString& sql, QString* error);
+
+    // Server time and table columns as seen by the current transaction
+    bool readSnapshot(BackupManifest* manifest, QHash<QString, QStringList>* columns, QString* error);
+    // Both exports: one read-only snapshot, then writeArchive(). Failures
+    // are logged on scope.
+    bool exportArchive(RequestScope& scope, const QString& filePath, const BackupManifest* parent,
+                       BackupManifest* manifest, QString* error);
+    // Without a parent every table is written complete
+    bool writeArchive(const QString& filePath, const QHash<QString, QStringList>& columns,
+                      const BackupManifest* parent, BackupManifest* manifest, QString* error);
+    // Verifies every archive of the chain before anything is written
+    bool openChain(const QStringList& filePaths, QList<BackupArchiveReader*>* readers, QString* error);
+    // Replaces the tables in the current schema; runs inside a transaction
+    // and logs failures on scope
+    bool applyChain(RequestScope& scope, const QList<BackupArchiveReader*>& readers, QString* error);
+    // COPYs one archived table into target, checking the row count
+    bool loadTable(BackupArchiveReader* reader, const BackupTableEntry& entry,
+                   const QString& target, QString* error);
+    bool mergeTable(BackupArchiveReader* reader, const BackupTableEntry& entry, QString* error);
+
+    QString m_sourceConnection;
+    QString m_connectionName;
+    QSqlDatabase m_db;
+    int m_overlapSeconds;
+};
+
+#endif // BACKUPSERVICE_H
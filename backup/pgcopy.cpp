@@ -0,0 +1,101 @@
+#include "backup/pgcopy.h"
+#include <QSqlDriver>
+#include <QVariant>
+#include <libpq-fe.h>
+
+PgCopy::PgCopy(QSqlDatabase db)
+    : m_conn(nullptr)
+{
+    QVariant handle = db.driver() ? db.driver()->handle() : QVariant();
+    if (handle.isValid() && qstrcmp(handle.typeName(), "PGconn*") == 0) {
+        m_conn = *static_cast<PGconn* const*>(handle.data());
+    } else {
+        m_lastError = "Connection is not a QPSQL connection";
+    }
+}
+
+bool PgCopy::copyOut(const QString& sql, const std::function<bool(const char*, int)>& sink,
+                     qint64* rows)
+{
+    PGresult* result = PQexec(m_conn, sql.toUtf8().constData());
+    const bool started = PQresultStatus(result) == PGRES_COPY_OUT;
+    PQclear(result);
+    if (!started) {
+        m_lastError = QString::fromUtf8(PQerrorMessage(m_conn));
+        return false;
+    }
+
+    // One message per row; libpq hands over its own buffer each time
+    bool ok = true;
+    char* buffer = nullptr;
+    int length = 0;
+    while ((length = PQgetCopyData(m_conn, &buffer, 0)) > 0) {
+        if (ok && !sink(buffer, length)) {
+            // The rest still has to be read before the connection is usable
+            ok = false;
+            m_lastError = "Backup write failed";
+        }
+        PQfreemem(buffer);
+    }
+    if (length == -2) {
+        ok = false;
+        m_lastError = QString::fromUtf8(PQerrorMessage(m_conn));
+    }
+
+    return finishCommand(rows) && ok;
+}
+
+bool PgCopy::begin(const QString& sql)
+{
+    PGresult* result = PQexec(m_conn, sql.toUtf8().constData());
+    const bool started = PQresultStatus(result) == PGRES_COPY_IN;
+    PQclear(result);
+    if (!started) {
+        m_lastError = QString::fromUtf8(PQerrorMessage(m_conn));
+    }
+    return started;
+}
+
+bool PgCopy::put(const QByteArray& data)
+{
+    if (PQputCopyData(m_conn, data.constData(), static_cast<int>(data.size())) != 1) {
+        m_lastError = QString::fromUtf8(PQerrorMessage(m_conn));
+        return false;
+    }
+    return true;
+}
+
+bool PgCopy::end(qint64* rows)
+{
+    if (PQputCopyEnd(m_conn, nullptr) != 1) {
+        m_lastError = QString::fromUtf8(PQerrorMessage(m_conn));
+        finishCommand(nullptr);
+        return false;
+    }
+    return finishCommand(rows);
+}
+
+void PgCopy::abort(const QString& reason)
+{
+    PQputCopyEnd(m_conn, reason.toUtf8().constData());
+    finishCommand(nullptr);
+}
+
+bool PgCopy::finishCommand(qint64* rows)
+{
+    // Drain every result so the connection is usable again
+    bool ok = true;
+    PGresult* result = nullptr;
+    while ((result = PQgetResult(m_conn)) != nullptr) {
+        if (PQresultStatus(result) == PGRES_COMMAND_OK) {
+            if (rows) {
+                *rows = QByteArray(PQcmdTuples(result)).toLongLong();
+            }
+        } else {
+            ok = false;
+            m_lastError = QString::fromUtf8(PQresultErrorMessage(result));
+        }
+        PQclear(result);
+    }
+    return ok;
+}
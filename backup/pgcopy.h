@@ -0,0 +1,43 @@
+#ifndef PGCOPY_H
+#define PGCOPY_H
+
+#include <QByteArray>
+#include <QSqlDatabase>
+#include <QString>
+#include <functional>
+
+typedef struct pg_conn PGconn;
+
+// Drives the COPY protocol on the libpq connection underneath a QPSQL
+// QSqlDatabase; QSqlQuery itself cannot. Statements before and after a
+// COPY still go through QSqlQuery on the same connection, so both share one
+// transaction.
+class PgCopy
+{
+public:
+    explicit PgCopy(QSqlDatabase db);
+
+    bool isValid() const { return m_conn != nullptr; }
+
+    // COPY ... TO STDOUT; sink receives each data message as it arrives and
+    // returns false to abort
+    bool copyOut(const QString& sql, const std::function<bool(const char*, int)>& sink,
+                 qint64* rows);
+
+    // COPY ... FROM STDIN, fed by put() and finished by end()
+    bool begin(const QString& sql);
+    bool put(const QByteArray& data);
+    bool end(qint64* rows);
+    // Fails the COPY, e.g. when the input turned out to be corrupt
+    void abort(const QString& reason);
+
+    QString lastError() const { return m_lastError; }
+
+private:
+    bool finishCommand(qint64* rows);
+
+    PGconn* m_conn;
+    QString m_lastError;
+};
+
+#endif // PGCOPY_H
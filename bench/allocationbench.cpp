@@ -0,0 +1,113 @@
+#include "allocationbench.h"
+#include "benchdatabase.h"
+#include "database/databasemanager.h"
+#include "diagnostics/allocationtracker.h"
+#include "repositories/goalrepository.h"
+#include "repositories/occurrencerepository.h"
+#include "repositories/scorerepository.h"
+#include "repositories/streakrepository.h"
+#include "services/scoreservice.h"
+#include "services/dashboardservice.h"
+#include <QTest>
+#include <QFile>
+#include <QJsonDocument>
+
+void AllocationBench::initTestCase()
+{
+    if (!AllocationTracker::isEnabled()) {
+        QSKIP("Built without NIMO_ALLOC_TRACKING");
+    }
+
+    const QString budgetPath = qEnvironmentVariable("NIMO_BENCH_ALLOC_BUDGETS");
+    if (!budgetPath.isEmpty()) {
+        QFile file(budgetPath);
+        QVERIFY2(file.open(QIODevice::ReadOnly), qPrintable("Cannot read " + budgetPath));
+        m_budgets = QJsonDocument::fromJson(file.readAll()).object();
+    }
+
+    QSqlDatabase db = DatabaseManager::instance().database();
+    m_goalRepo = new GoalRepository(db);
+    m_occurrenceRepo = new OccurrenceRepository(db);
+    m_scoreRepo = new ScoreRepository(db);
+    m_streakRepo = new StreakRepository(db);
+    m_scoreService = new ScoreService(m_scoreRepo, m_occurrenceRepo, m_goalRepo);
+    m_dashboardService = new DashboardService(m_scoreRepo, m_streakRepo);
+}
+
+void AllocationBench::cleanupTestCase()
+{
+    delete m_dashboardService;
+    delete m_scoreService;
+    delete m_streakRepo;
+    delete m_scoreRepo;
+    delete m_occurrenceRepo;
+    delete m_goalRepo;
+}
+
+void AllocationBench::addRows()
+{
+    QTest::addColumn<bool>("bytes");
+    QTest::newRow("allocations") << false;
+    QTest::newRow("bytes") << true;
+}
+
+// One warm-up call fills caches (prepared statements, metric slots), then
+// a single call is counted; allocation counts do not need averaging
+void AllocationBench::measure(const QString& name, const std::function<void()>& call)
+{
+    QFETCH(bool, bytes);
+
+    call();
+    AllocationScope scope;
+    call();
+    AllocationStats stats = scope.elapsed();
+
+    qreal value = bytes ? qreal(stats.bytes) : qreal(stats.count);
+    QTest::setBenchmarkResult(value, bytes ? QTest::BytesAllocated : QTest::Events);
+
+    const QString key = bytes ? "bytes" : "allocations";
+    const QJsonValue budget = m_budgets.value(name).toObject().value(key);
+    if (!budget.isUndefined()) {
+        QVERIFY2(value <= budget.toDouble(),
+                 qPrintable(QString("%1 %2: %3 over budget %4")
+                                .arg(name, key).arg(value).arg(budget.toDouble())));
+    }
+}
+
+void AllocationBench::findByDate_data()
+{
+    addRows();
+}
+
+void AllocationBench::findByDate()
+{
+    QDate date = BenchDatabase::today().addDays(-1);
+    measure("findByDate", [this, date]() {
+        qDeleteAll(m_occurrenceRepo->findByDate(date));
+    });
+}
+
+void AllocationBench::recalculateDaily_data()
+{
+    addRows();
+}
+
+void AllocationBench::recalculateDaily()
+{
+    QDate date = BenchDatabase::today().addDays(-1);
+    measure("recalculateDaily", [this, date]() {
+        m_scoreService->recalculateDaily(date);
+    });
+}
+
+void AllocationBench::refreshDashboard_data()
+{
+    addRows();
+}
+
+void AllocationBench::refreshDashboard()
+{
+    measure("refreshDashboard", [this]() {
+        m_dashboardService->refreshDashboard();
+    });
+}
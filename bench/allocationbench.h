@@ -0,0 +1,47 @@
+#ifndef ALLOCATIONBENCH_H
+#define ALLOCATIONBENCH_H
+
+#include <QObject>
+#include <QJsonObject>
+#include <functional>
+
+class GoalRepository;
+class OccurrenceRepository;
+class ScoreRepository;
+class StreakRepository;
+class ScoreService;
+class DashboardService;
+
+// Heap allocations per call for the hot paths; needs a build configured
+// with -DNIMO_ALLOC_TRACKING=ON and is skipped otherwise. With
+// NIMO_BENCH_ALLOC_BUDGETS=<json> a call over its budget fails the run:
+//   {"findByDate": {"allocations": 4000, "bytes": 600000}, ...}
+class AllocationBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void findByDate_data();
+    void findByDate();
+    void recalculateDaily_data();
+    void recalculateDaily();
+    void refreshDashboard_data();
+    void refreshDashboard();
+
+private:
+    void addRows();
+    void measure(const QString& name, const std::function<void()>& call);
+
+    QJsonObject m_budgets;
+    GoalRepository* m_goalRepo = nullptr;
+    OccurrenceRepository* m_occurrenceRepo = nullptr;
+    ScoreRepository* m_scoreRepo = nullptr;
+    StreakRepository* m_streakRepo = nullptr;
+    ScoreService* m_scoreService = nullptr;
+    DashboardService* m_dashboardService = nullptr;
+};
+
+#endif // ALLOCATIONBENCH_H
@@ -0,0 +1,203 @@
+#include "benchdatabase.h"
+#include "database/databasemanager.h"
+#include "repositories/scorerepository.h"
+#include "repositories/streakrepository.h"
+#include <QCoreApplication>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+
+namespace
+{
+const char* kAdminConnection = "nimo_bench_admin";
+constexpr int kYears = 10;
+
+QString benchDatabaseName()
+{
+    return QString("nimo_bench_%1").arg(QCoreApplication::applicationPid());
+}
+
+QString env(const char* name, const QString& fallback)
+{
+    QString value = qEnvironmentVariable(name);
+    return value.isEmpty() ? fallback : value;
+}
+
+bool adminExec(const QString& sql, QString* error)
+{
+    QSqlDatabase admin = QSqlDatabase::addDatabase("QPSQL", kAdminConnection);
+    admin.setHostName(env("NIMO_BENCH_HOST", "localhost"));
+    admin.setPort(env("NIMO_BENCH_PORT", "5433").toInt());
+    admin.setDatabaseName("postgres");
+    admin.setUserName(env("NIMO_BENCH_USER", "postgres"));
+    admin.setPassword(env("NIMO_BENCH_PASSWORD", QString()));
+
+    bool ok = admin.open();
+    if (ok) {
+        QSqlQuery query(admin);
+        ok = query.exec(sql);
+        if (!ok && error) {
+            *error = query.lastError().text();
+        }
+    } else if (error) {
+        *error = admin.lastError().text();
+    }
+
+    admin.close();
+    admin = QSqlDatabase();
+    QSqlDatabase::removeDatabase(kAdminConnection);
+    return ok;
+}
+
+bool exec(const QString& sql, QString* error)
+{
+    QSqlQuery query(DatabaseManager::instance().database());
+    if (!query.exec(sql)) {
+        *error = query.lastError().text();
+        return false;
+    }
+    return true;
+}
+}
+
+QDate BenchDatabase::today()
+{
+    return QDate::currentDate();
+}
+
+QDate BenchDatabase::firstDay()
+{
+    return today().addYears(-kYears);
+}
+
+bool BenchDatabase::setUp(QString* error)
+{
+    QString name = benchDatabaseName();
+    adminExec(QString("DROP DATABASE IF EXISTS %1").arg(name), nullptr);
+    if (!adminExec(QString("CREATE DATABASE %1").arg(name), error)) {
+        return false;
+    }
+
+    DatabaseManager& db = DatabaseManager::instance();
+    db.setConnectionParameters(env("NIMO_BENCH_HOST", "localhost"),
+                               env("NIMO_BENCH_PORT", "5433").toInt(),
+                               name,
+                               env("NIMO_BENCH_USER", "postgres"),
+                               env("NIMO_BENCH_PASSWORD", QString()));
+
+    if (!db.initialize() || !db.applySchema()) {
+        *error = db.lastError();
+        return false;
+    }
+
+    return seed(error) && rebuildScores(error);
+}
+
+void BenchDatabase::tearDown()
+{
+    DatabaseManager::instance().shutdown();
+    if (!qEnvironmentVariableIsSet("NIMO_BENCH_KEEP")) {
+        adminExec(QString("DROP DATABASE IF EXISTS %1").arg(benchDatabaseName()), nullptr);
+    }
+}
+
+bool BenchDatabase::seed(QString* error)
+{
+    // Fixed seed: every run benchmarks the same data
+    if (!exec("SELECT setseed(0.42)", error)) {
+        return false;
+    }
+
+    // 60 daily, 20 weekly, 12 monthly and 8 yearly goals; every 7th penalised
+    QString goals = QString(R"(
+        INSERT INTO goals (title, scope, points, missing_behavior, penalty_points,
+                           category, sort_order, created_at)
+        SELECT 'Goal ' || i,
+               CASE WHEN i <= 60 THEN 'daily' WHEN i <= 80 THEN 'weekly'
+                    WHEN i <= 92 THEN 'monthly' ELSE 'yearly' END,
+               1 + i % 10,
+               CASE WHEN i % 7 = 0 THEN 'penalty' ELSE 'zero' END,
+               CASE WHEN i % 7 = 0 THEN 2 ELSE 0 END,
+               (ARRAY['health', 'work', 'learning', 'home'])[1 + i % 4],
+               i,
+               CAST('%1' AS date)
+        FROM generate_series(1, 100) AS i
+    )").arg(firstDay().toString("yyyy-MM-dd"));
+
+    // One occurrence per goal and window; past windows are resolved, the
+    // current ones pending
+    QString occurrences = QString(R"(
+        WITH windows AS (
+            SELECT g.id AS goal_id, g.scope, g.points, g.missing_behavior, g.penalty_points,
+                   CAST(CASE g.scope
+                       WHEN 'daily' THEN d
+                       WHEN 'weekly' THEN date_trunc('week', d)
+                       WHEN 'monthly' THEN date_trunc('month', d)
+                       ELSE date_trunc('year', d) END AS date) AS window_date
+            FROM goals g
+            CROSS JOIN generate_series(CAST('%1' AS date), CAST('%2' AS date),
+                                       interval '1 day') AS d
+            GROUP BY 1, 2, 3, 4, 5, 6
+        ), resolved AS (
+            SELECT w.*,
+                   CASE WHEN w.window_date = CAST(date_trunc(
+                                 CASE w.scope WHEN 'daily' THEN 'day' WHEN 'weekly' THEN 'week'
+                                              WHEN 'monthly' THEN 'month' ELSE 'year' END,
+                                 CAST('%2' AS date)) AS date) THEN 'pending'
+                        WHEN r < 0.72 THEN 'completed'
+                        WHEN r < 0.80 THEN 'skipped'
+                        ELSE 'not_completed' END AS status
+            FROM (SELECT *, random() AS r FROM windows) w
+        )
+        INSERT INTO occurrences (goal_id, date, week_start, month_start, year_start,
+                                 status, score_impact)
+        SELECT goal_id, window_date,
+               CAST(date_trunc('week', window_date) AS date),
+               CAST(date_trunc('month', window_date) AS date),
+               CAST(date_trunc('year', window_date) AS date),
+               status,
+               CASE status
+                   WHEN 'completed' THEN points
+                   WHEN 'not_completed' THEN
+                       CASE WHEN missing_behavior = 'penalty' THEN -penalty_points ELSE 0 END
+                   ELSE 0 END
+        FROM resolved
+    )").arg(firstDay().toString("yyyy-MM-dd"), today().toString("yyyy-MM-dd"));
+
+    return exec(goals, error) && exec(occurrences, error);
+}
+
+bool BenchDatabase::rebuildScores(QString* error)
+{
+    QList<QDate> days, weeks, months, years;
+    for (QDate day = firstDay(); day <= today(); day = day.addDays(1)) {
+        days.append(day);
+        if (day.dayOfWeek() == Qt::Monday) {
+            weeks.append(day);
+        }
+        if (day.day() == 1) {
+            months.append(day);
+            if (day.month() == 1) {
+                years.append(day);
+            }
+        }
+    }
+
+    ScoreRepository scores(DatabaseManager::instance().database());
+    if (!scores.rebuildDailyScores(days) || !scores.rebuildWeeklyScores(weeks)
+        || !scores.rebuildMonthlyScores(months) || !scores.rebuildYearlyScores(years)) {
+        *error = "Failed to rebuild scores";
+        return false;
+    }
+
+    StreakRepository streaks(DatabaseManager::instance().database());
+    for (const QString& scope : {"daily", "weekly", "monthly", "yearly"}) {
+        delete streaks.getOrCreateOverall(scope);
+    }
+    if (!streaks.evaluateOverallDailyStreak(80.0, firstDay(), today().addDays(-1))) {
+        *error = "Failed to replay streaks";
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,26 @@
+#ifndef BENCHDATABASE_H
+#define BENCHDATABASE_H
+
+#include <QString>
+#include <QDate>
+
+// Throwaway PostgreSQL database for the benchmarks. setUp() creates
+// nimo_bench_<pid> on the server given by NIMO_BENCH_HOST, _PORT, _USER
+// and _PASSWORD (default localhost:5433, postgres), applies the schema and
+// seeds 100 goals across all scopes with ten years of occurrences, scores
+// and streaks. tearDown() drops it unless NIMO_BENCH_KEEP is set.
+class BenchDatabase
+{
+public:
+    static bool setUp(QString* error);
+    static void tearDown();
+
+    static QDate today();
+    static QDate firstDay();
+
+private:
+    static bool seed(QString* error);
+    static bool rebuildScores(QString* error);
+};
+
+#endif // BENCHDATABASE_H
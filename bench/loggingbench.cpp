@@ -0,0 +1,116 @@
+#include "loggingbench.h"
+#include "logging/logger.h"
+#include "logging/logformat.h"
+#include "logging/binarylogformat.h"
+#include <QTest>
+
+namespace
+{
+constexpr int kRecordsPerIteration = 1000;
+
+LogRecord sampleRecord()
+{
+    LogRecord record;
+    record.level = Logger::INFO;
+    record.timestampNs = LogFormat::currentTimestampNs();
+    record.source = "ScoreRepository::upsertDailyScore";
+    record.contextId = "req_0123456789abcdef";
+    record.message = "Daily score updated";
+    record.metadata = QJsonObject{
+        {"date", "2024-03-01"},
+        {"earnedScore", 42},
+        {"completionPercentage", 87.5}
+    };
+    return record;
+}
+}
+
+void LoggingBench::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    Logger& logger = Logger::instance();
+    logger.setLogDirectory(m_dir.path());
+    logger.setConsoleEnabled(false);
+}
+
+void LoggingBench::cleanupTestCase()
+{
+    Logger& logger = Logger::instance();
+    logger.setAsyncEnabled(false);
+    logger.setFileEnabled(false);
+    logger.setLogLevel(Logger::WARN);
+}
+
+void LoggingBench::logThroughput_data()
+{
+    QTest::addColumn<bool>("async");
+    QTest::addColumn<bool>("binary");
+    QTest::newRow("sync-text") << false << false;
+    QTest::newRow("async-text") << true << false;
+    QTest::newRow("async-binary") << true << true;
+}
+
+// Cost seen by the caller for a batch of INFO records, including the final
+// flush so async mode cannot hide its write cost
+void LoggingBench::logThroughput()
+{
+    QFETCH(bool, async);
+    QFETCH(bool, binary);
+
+    Logger& logger = Logger::instance();
+    logger.setLogLevel(Logger::INFO);
+    logger.setFileEnabled(!binary);
+    logger.setBinaryEnabled(binary);
+    logger.setAsyncEnabled(async, 65536, 250, Logger::BlockWhenFull);
+
+    const QJsonObject meta{{"date", "2024-03-01"}, {"earnedScore", 42}};
+    QBENCHMARK {
+        for (int i = 0; i < kRecordsPerIteration; ++i) {
+            logger.info("LoggingBench::logThroughput", "req_bench", "Daily score updated", meta);
+        }
+        logger.flush();
+    }
+
+    logger.setAsyncEnabled(false);
+    logger.setBinaryEnabled(false);
+    QCOMPARE(logger.droppedRecordCount(), quint64(0));
+}
+
+void LoggingBench::disabledLevel()
+{
+    Logger& logger = Logger::instance();
+    logger.setLogLevel(Logger::WARN);
+    QBENCHMARK {
+        for (int i = 0; i < kRecordsPerIteration; ++i) {
+            if (logger.isEnabled(Logger::DEBUG, QStringLiteral("LoggingBench::disabledLevel"))) {
+                logger.debug("LoggingBench::disabledLevel", "req_bench", "Never written");
+            }
+        }
+    }
+}
+
+void LoggingBench::formatText()
+{
+    LogRecord record = sampleRecord();
+    qsizetype bytes = 0;
+    QBENCHMARK {
+        for (int i = 0; i < kRecordsPerIteration; ++i) {
+            bytes += LogFormat::formatRecord(record).size();
+        }
+    }
+    QVERIFY(bytes > 0);
+}
+
+void LoggingBench::writeBinary()
+{
+    LogRecord record = sampleRecord();
+    BinaryLogWriter writer;
+    QVERIFY(writer.open(m_dir.filePath("bench.nlog")));
+    QBENCHMARK {
+        for (int i = 0; i < kRecordsPerIteration; ++i) {
+            writer.write(record);
+        }
+        writer.flush();
+    }
+    writer.close();
+}
@@ -0,0 +1,25 @@
+#ifndef LOGGINGBENCH_H
+#define LOGGINGBENCH_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+class LoggingBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void logThroughput_data();
+    void logThroughput();
+    void disabledLevel();
+    void formatText();
+    void writeBinary();
+
+private:
+    QTemporaryDir m_dir;
+};
+
+#endif // LOGGINGBENCH_H
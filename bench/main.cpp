@@ -0,0 +1,132 @@
+#include "benchdatabase.h"
+#include "repositorybench.h"
+#include "servicebench.h"
+#include "loggingbench.h"
+#include "allocationbench.h"
+#include "logging/logger.h"
+#include <QCoreApplication>
+#include <QTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QXmlStreamReader>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QDateTime>
+#include <QTextStream>
+
+// Usage: nimo_bench [--json <path>] [QtTest options]
+// Runs every suite against a throwaway database and, with --json, writes
+// one result per benchmark row so runs can be compared by scripts.
+namespace
+{
+QJsonArray parseResults(const QString& suite, const QString& xmlPath)
+{
+    QJsonArray results;
+    QFile file(xmlPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return results;
+    }
+
+    QXmlStreamReader xml(&file);
+    QString function;
+    while (!xml.atEnd()) {
+        if (!xml.readNextStartElement()) {
+            continue;
+        }
+        if (xml.name() == u"TestFunction") {
+            function = xml.attributes().value("name").toString();
+        } else if (xml.name() == u"BenchmarkResult") {
+            QXmlStreamAttributes attrs = xml.attributes();
+            results.append(QJsonObject{
+                {"suite", suite},
+                {"test", function},
+                {"tag", attrs.value("tag").toString()},
+                {"metric", attrs.value("metric").toString()},
+                {"value", attrs.value("value").toDouble()},
+                {"iterations", attrs.value("iterations").toInt()}
+            });
+        }
+    }
+    return results;
+}
+
+int runSuite(QObject* suite, const QStringList& args, const QTemporaryDir& dir, QJsonArray* results)
+{
+    QString name = suite->metaObject()->className();
+    QString xmlPath = dir.filePath(name + ".xml");
+
+    QStringList suiteArgs = args;
+    suiteArgs << "-o" << xmlPath + ",xml" << "-o" << "-,txt";
+    int failures = QTest::qExec(suite, suiteArgs);
+
+    for (const QJsonValue& result : parseResults(name, xmlPath)) {
+        results->append(result);
+    }
+    return failures;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setOrganizationName("Nimo");
+    app.setApplicationName("nimo_bench");
+
+    QStringList args = app.arguments();
+    QString jsonPath;
+    int jsonIndex = args.indexOf("--json");
+    if (jsonIndex > 0 && jsonIndex + 1 < args.size()) {
+        jsonPath = args.at(jsonIndex + 1);
+        args.remove(jsonIndex, 2);
+    }
+
+    QTemporaryDir dir;
+    Logger& logger = Logger::instance();
+    logger.setLogDirectory(dir.path());
+    logger.setConsoleEnabled(false);
+    logger.setLogLevel(Logger::WARN);
+
+    QTextStream err(stderr);
+    QString error;
+    if (!BenchDatabase::setUp(&error)) {
+        err << "Failed to prepare benchmark database: " << error << Qt::endl;
+        BenchDatabase::tearDown();
+        logger.shutdown();
+        return 1;
+    }
+
+    QJsonArray results;
+    int failures = 0;
+    {
+        RepositoryBench repositories;
+        ServiceBench services;
+        LoggingBench logging;
+        AllocationBench allocations;
+        failures += runSuite(&repositories, args, dir, &results);
+        failures += runSuite(&services, args, dir, &results);
+        failures += runSuite(&logging, args, dir, &results);
+        failures += runSuite(&allocations, args, dir, &results);
+    }
+
+    BenchDatabase::tearDown();
+    logger.shutdown();
+
+    if (!jsonPath.isEmpty()) {
+        QJsonObject report{
+            {"timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate)},
+            {"qtVersion", QString::fromLatin1(qVersion())},
+            {"results", results}
+        };
+        QSaveFile file(jsonPath);
+        if (!file.open(QIODevice::WriteOnly)
+            || file.write(QJsonDocument(report).toJson()) < 0
+            || !file.commit()) {
+            err << "Failed to write " << jsonPath << Qt::endl;
+            return failures + 1;
+        }
+    }
+
+    return failures;
+}
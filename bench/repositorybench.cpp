@@ -0,0 +1,80 @@
+#include "repositorybench.h"
+#include "benchdatabase.h"
+#include "database/databasemanager.h"
+#include "repositories/occurrencerepository.h"
+#include "repositories/scorerepository.h"
+#include <QTest>
+
+void RepositoryBench::initTestCase()
+{
+    QSqlDatabase db = DatabaseManager::instance().database();
+    m_occurrenceRepo = new OccurrenceRepository(db, this);
+    m_scoreRepo = new ScoreRepository(db, this);
+}
+
+void RepositoryBench::cleanupTestCase()
+{
+    delete m_occurrenceRepo;
+    delete m_scoreRepo;
+    m_occurrenceRepo = nullptr;
+    m_scoreRepo = nullptr;
+}
+
+void RepositoryBench::findByDate()
+{
+    QDate date = BenchDatabase::today().addDays(-1);
+    int count = 0;
+    QBENCHMARK {
+        QList<Occurrence*> occurrences = m_occurrenceRepo->findByDate(date);
+        count = occurrences.size();
+        qDeleteAll(occurrences);
+    }
+    QVERIFY(count > 0);
+}
+
+void RepositoryBench::findByWeek()
+{
+    QDate weekStart = m_occurrenceRepo->calculateWeekStart(BenchDatabase::today().addDays(-7));
+    int count = 0;
+    QBENCHMARK {
+        QList<Occurrence*> occurrences = m_occurrenceRepo->findByWeek(weekStart);
+        count = occurrences.size();
+        qDeleteAll(occurrences);
+    }
+    QVERIFY(count > 0);
+}
+
+void RepositoryBench::findByYear()
+{
+    int year = BenchDatabase::today().year() - 1;
+    int count = 0;
+    QBENCHMARK {
+        QList<Occurrence*> occurrences = m_occurrenceRepo->findByYear(year);
+        count = occurrences.size();
+        qDeleteAll(occurrences);
+    }
+    QVERIFY(count > 0);
+}
+
+void RepositoryBench::getDailyScoreRange_data()
+{
+    QTest::addColumn<int>("days");
+    QTest::newRow("week") << 7;
+    QTest::newRow("month") << 30;
+    QTest::newRow("year") << 365;
+    QTest::newRow("decade") << 3650;
+}
+
+void RepositoryBench::getDailyScoreRange()
+{
+    QFETCH(int, days);
+    QDate end = BenchDatabase::today().addDays(-1);
+    QDate start = end.addDays(-(days - 1));
+    int count = 0;
+    QBENCHMARK {
+        QList<DailyScore*> scores = m_scoreRepo->getDailyScoreRange(start, end);
+        count = scores.size();
+        qDeleteAll(scores);
+    }
+    QCOMPARE(count, days);
+}
@@ -0,0 +1,28 @@
+#ifndef REPOSITORYBENCH_H
+#define REPOSITORYBENCH_H
+
+#include <QObject>
+
+class OccurrenceRepository;
+class ScoreRepository;
+
+class RepositoryBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void findByDate();
+    void findByWeek();
+    void findByYear();
+    void getDailyScoreRange_data();
+    void getDailyScoreRange();
+
+private:
+    OccurrenceRepository* m_occurrenceRepo = nullptr;
+    ScoreRepository* m_scoreRepo = nullptr;
+};
+
+#endif // REPOSITORYBENCH_H
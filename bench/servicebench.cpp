@@ -0,0 +1,84 @@
+#include "servicebench.h"
+#include "benchdatabase.h"
+#include "database/databasemanager.h"
+#include "repositories/goalrepository.h"
+#include "repositories/occurrencerepository.h"
+#include "repositories/scorerepository.h"
+#include "repositories/streakrepository.h"
+#include "services/scoreservice.h"
+#include "services/streakservice.h"
+#include "services/dashboardservice.h"
+#include <QTest>
+
+void ServiceBench::initTestCase()
+{
+    QSqlDatabase db = DatabaseManager::instance().database();
+    m_goalRepo = new GoalRepository(db);
+    m_occurrenceRepo = new OccurrenceRepository(db);
+    m_scoreRepo = new ScoreRepository(db);
+    m_streakRepo = new StreakRepository(db);
+
+    m_scoreService = new ScoreService(m_scoreRepo, m_occurrenceRepo, m_goalRepo);
+    m_streakService = new StreakService(m_streakRepo, m_scoreRepo);
+    m_dashboardService = new DashboardService(m_scoreRepo, m_streakRepo);
+}
+
+void ServiceBench::cleanupTestCase()
+{
+    delete m_dashboardService;
+    delete m_streakService;
+    delete m_scoreService;
+    delete m_streakRepo;
+    delete m_scoreRepo;
+    delete m_occurrenceRepo;
+    delete m_goalRepo;
+}
+
+// Each recalculation rewrites the same stored score, so iterations stay
+// comparable and the seeded data is left unchanged
+void ServiceBench::recalculateDaily()
+{
+    QDate date = BenchDatabase::today().addDays(-1);
+    QBENCHMARK {
+        m_scoreService->recalculateDaily(date);
+    }
+}
+
+void ServiceBench::recalculateWeekly()
+{
+    QDate date = BenchDatabase::today().addDays(-7);
+    QBENCHMARK {
+        m_scoreService->recalculateWeekly(date);
+    }
+}
+
+void ServiceBench::recalculateMonthly()
+{
+    QDate date = BenchDatabase::today().addMonths(-1);
+    QBENCHMARK {
+        m_scoreService->recalculateMonthly(date);
+    }
+}
+
+void ServiceBench::recalculateYearly()
+{
+    int year = BenchDatabase::today().year() - 1;
+    QBENCHMARK {
+        m_scoreService->recalculateYearly(year);
+    }
+}
+
+void ServiceBench::refreshDashboard()
+{
+    QBENCHMARK {
+        m_dashboardService->refreshDashboard();
+    }
+}
+
+void ServiceBench::updateStreaksForDate()
+{
+    QDate date = BenchDatabase::today().addDays(-1);
+    QBENCHMARK {
+        m_streakService->updateStreaksForDate(date);
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef SERVICEBENCH_H
+#define SERVICEBENCH_H
+
+#include <QObject>
+
+class GoalRepository;
+class OccurrenceRepository;
+class ScoreRepository;
+class StreakRepository;
+class ScoreService;
+class StreakService;
+class DashboardService;
+
+class ServiceBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void recalculateDaily();
+    void recalculateWeekly();
+    void recalculateMonthly();
+    void recalculateYearly();
+    void refreshDashboard();
+    void updateStreaksForDate();
+
+private:
+    GoalRepository* m_goalRepo = nullptr;
+    OccurrenceRepository* m_occurrenceRepo = nullptr;
+    ScoreRepository* m_scoreRepo = nullptr;
+    StreakRepository* m_streakRepo = nullptr;
+    ScoreService* m_scoreService = nullptr;
+    StreakService* m_streakService = nullptr;
+    DashboardService* m_dashboardService = nullptr;
+};
+
+#endif // SERVICEBENCH_H
@@ -0,0 +1,210 @@
+#include "database/changefeed.h"
+#include "database/slowquerylog.h"
+#include "logging/logger.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSqlError>
+#include <QSqlQuery>
+
+namespace
+{
+const char* const kChannel = "nimo_changes";
+
+// Bundled with schema.sql; the only copy of the trigger definitions
+const char* const kInstallSqlPath = ":/nimo/database/changefeed.sql";
+
+// Triggers per table times tables in changefeed.sql
+const int kTriggerCount = 3 * 6;
+}
+
+ChangeFeed::ChangeFeed(const QString& sourceConnection, QObject *parent)
+    : QObject(parent)
+    , m_sourceConnection(sourceConnection)
+    , m_connectionName(QString("%1_changefeed").arg(sourceConnection))
+    , m_listening(false)
+{
+    // Long enough to fold one sync batch or rescore into a single signal
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(100);
+    connect(&m_timer, &QTimer::timeout, this, &ChangeFeed::dispatch);
+}
+
+ChangeFeed::~ChangeFeed()
+{
+    stop();
+    m_db = QSqlDatabase();
+    if (QSqlDatabase::contains(m_connectionName)) {
+        QSqlDatabase::removeDatabase(m_connectionName);
+    }
+}
+
+bool ChangeFeed::start()
+{
+    stop();
+
+    // Reconnecting reuses the clone; its options may have changed meanwhile
+    if (QSqlDatabase::contains(m_connectionName)) {
+        m_db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(m_connectionName);
+    }
+    m_db = QSqlDatabase::cloneDatabase(m_sourceConnection, m_connectionName);
+    if (!m_db.open()) {
+        Logger::instance().error("ChangeFeed::start", "change_feed",
+                                 "Failed to open change feed connection", {
+                                     {"errorMessage", m_db.lastError().text()}
+                                 });
+        return false;
+    }
+
+    QString error;
+    QSqlQuery query(m_db);
+    query.prepare(R"(
+        SELECT current_setting('application_name'),
+               (SELECT count(*) FROM pg_trigger
+                WHERE tgname IN ('nimo_notify_insert', 'nimo_notify_update', 'nimo_notify_delete')
+                  AND NOT tgisinternal)
+    )");
+    if (!SlowQueryLog::exec(query, "ChangeFeed::start") || !query.next()) {
+        error = query.lastError().text();
+    } else {
+        // Connections cloned from the same source share it, so this is
+        // also the name the rest of the process writes under
+        m_applicationName = query.value(0).toString();
+        if (query.value(1).toInt() < kTriggerCount) {
+            installTriggers(m_db, &error);
+        }
+    }
+
+    if (error.isEmpty() && !m_db.driver()->subscribeToNotification(kChannel)) {
+        error = m_db.driver()->lastError().text();
+    }
+    if (!error.isEmpty()) {
+        Logger::instance().error("ChangeFeed::start", "change_feed",
+                                 "Failed to subscribe to change notifications", {
+                                     {"errorMessage", error}
+                                 });
+        m_db.close();
+        return false;
+    }
+
+    connect(m_db.driver(), &QSqlDriver::notification, this, &ChangeFeed::onNotification,
+            Qt::UniqueConnection);
+    setListening(true);
+
+    Logger::instance().info("ChangeFeed::start", "change_feed",
+                            "Listening for change notifications", {
+                                {"channel", kChannel},
+                                {"applicationName", m_applicationName}
+                            });
+    return true;
+}
+
+void ChangeFeed::stop()
+{
+    m_timer.stop();
+    m_pending.clear();
+    if (m_db.isOpen()) {
+        m_db.driver()->unsubscribeFromNotification(kChannel);
+        m_db.close();
+    }
+    setListening(false);
+}
+
+bool ChangeFeed::installTriggers(QSqlDatabase db, QString* error)
+{
+    QFile file(kInstallSqlPath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        *error = "Bundled change feed triggers not found";
+        return false;
+    }
+
+    // Unprepared exec sends the whole script as one simple query
+    QSqlQuery query(db);
+    if (!query.exec(QString::fromUtf8(file.readAll()))) {
+        *error = query.lastError().text();
+        return false;
+    }
+
+    Logger::instance().info("ChangeFeed::installTriggers", "change_feed",
+                            "Change notification triggers installed", {});
+    return true;
+}
+
+void ChangeFeed::onNotification(const QString& name, QSqlDriver::NotificationSource source,
+                                const QVariant& payload)
+{
+    if (name != kChannel || source == QSqlDriver::SelfSource) {
+        return;
+    }
+
+    const QJsonObject change = QJsonDocument::fromJson(payload.toString().toUtf8()).object();
+    if (change.value("app").toString() == m_applicationName) {
+        return;
+    }
+
+    const QString table = change.value("table").toString();
+    if (table.isEmpty()) {
+        return;
+    }
+
+    PendingChange& pending = m_pending[table];
+    const QJsonValue keys = change.value("keys");
+    if (!keys.isArray()) {
+        pending.all = true;
+        pending.keys.clear();
+    } else if (!pending.all) {
+        for (const QJsonValue& key : keys.toArray()) {
+            pending.keys.insert(key.toString());
+        }
+    }
+
+    if (!m_timer.isActive()) {
+        m_timer.start();
+    }
+}
+
+void ChangeFeed::dispatch()
+{
+    const QHash<QString, PendingChange> pending = std::exchange(m_pending, {});
+
+    Logger::instance().debug("ChangeFeed::dispatch", "change_feed",
+                             "Dispatching external changes", {
+                                 {"tables", QJsonArray::fromStringList(pending.keys())}
+                             });
+
+    for (auto it = pending.cbegin(); it != pending.cend(); ++it) {
+        const QString& table = it.key();
+        const PendingChange& change = it.value();
+        if (table == "goals") {
+            emit goalsChanged(QStringList(change.keys.cbegin(), change.keys.cend()), change.all);
+        } else if (table == "occurrences") {
+            emit occurrencesChanged(toDates(change.keys), change.all);
+        } else if (table.endsWith("_scores")) {
+            emit scoresChanged(table.chopped(7), toDates(change.keys), change.all);
+        }
+    }
+}
+
+void ChangeFeed::setListening(bool listening)
+{
+    if (m_listening != listening) {
+        m_listening = listening;
+        emit listeningChanged();
+    }
+}
+
+QList<QDate> ChangeFeed::toDates(const QSet<QString>& keys)
+{
+    QList<QDate> dates;
+    dates.reserve(keys.size());
+    for (const QString& key : keys) {
+        const QDate date = QDate::fromString(key, Qt::ISODate);
+        if (date.isValid()) {
+            dates.append(date);
+        }
+    }
+    std::sort(dates.begin(), dates.end());
+    return dates;
+}
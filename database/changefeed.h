@@ -0,0 +1,75 @@
+#ifndef CHANGEFEED_H
+#define CHANGEFEED_H
+
+#include <QObject>
+#include <QDate>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QSqlDatabase>
+#include <QSqlDriver>
+#include <QStringList>
+#include <QTimer>
+
+// Invalidation events for rows changed by other processes (nimo-sync, the
+// CLI tools, psql). Statement-level triggers on the synced and score tables
+// send one pg_notify per statement on the nimo_changes channel, carrying
+// the table and the keys it touched: goal ids, or window starts for
+// occurrences and scores. More than 100 keys are sent as "everything
+// changed". The feed listens on its own connection, drops what this
+// process wrote itself (its changes already reach the models through
+// service signals) and coalesces bursts into one typed signal per table.
+//
+// Notifications sent while the feed is not listening are lost; after a
+// reconnect, listeners reload as they do for DatabaseManager::connected().
+class ChangeFeed : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool listening READ isListening NOTIFY listeningChanged)
+
+public:
+    explicit ChangeFeed(const QString& sourceConnection, QObject *parent = nullptr);
+    ~ChangeFeed();
+
+    // Opens the listening connection, installing the triggers if missing
+    bool start();
+    void stop();
+    bool isListening() const { return m_listening; }
+
+    int coalesceMs() const { return m_timer.interval(); }
+    void setCoalesceMs(int ms) { m_timer.setInterval(qMax(0, ms)); }
+
+    // Creates the notify function and triggers (idempotent)
+    static bool installTriggers(QSqlDatabase db, QString* error);
+
+signals:
+    // all: too many keys to list, treat the whole table as changed
+    void goalsChanged(const QStringList& goalIds, bool all);
+    void occurrencesChanged(const QList<QDate>& windowStarts, bool all);
+    // scope is daily, weekly, monthly or yearly
+    void scoresChanged(const QString& scope, const QList<QDate>& windowStarts, bool all);
+    void listeningChanged();
+
+private:
+    struct PendingChange {
+        QSet<QString> keys;
+        bool all = false;
+    };
+
+    void onNotification(const QString& name, QSqlDriver::NotificationSource source,
+                        const QVariant& payload);
+    void dispatch();
+    void setListening(bool listening);
+    static QList<QDate> toDates(const QSet<QString>& keys);
+
+    QString m_sourceConnection;
+    QString m_connectionName;
+    QString m_applicationName;
+    QSqlDatabase m_db;
+    QTimer m_timer;
+    bool m_listening;
+    // By table, until the coalescing delay expires
+    QHash<QString, PendingChange> m_pending;
+};
+
+#endif // CHANGEFEED_H
@@ -0,0 +1,65 @@
+-- Change feed: one pg_notify per statement on nimo_changes with the table and
+-- the goal ids or window starts it touched, so caches in running apps can be
+-- invalidated when another process writes (see database/changefeed.h).
+-- Applied after schema.sql, and by ChangeFeed::start() when any trigger is
+-- missing.
+CREATE OR REPLACE FUNCTION nimo_notify_change() RETURNS trigger
+LANGUAGE plpgsql AS $fn$
+DECLARE
+    rows_name TEXT := CASE WHEN TG_OP = 'DELETE' THEN 'old_rows' ELSE 'new_rows' END;
+    changed BIGINT;
+    keys JSONB;
+BEGIN
+    EXECUTE format('SELECT count(*) FROM %I', rows_name) INTO changed;
+    IF changed = 0 THEN
+        RETURN NULL;
+    END IF;
+    -- TG_ARGV[0] is the key expression; one past the limit marks overflow
+    EXECUTE format('SELECT jsonb_agg(k) FROM (SELECT DISTINCT %s AS k FROM %I LIMIT 101) d',
+                   TG_ARGV[0], rows_name) INTO keys;
+    PERFORM pg_notify('nimo_changes', json_build_object(
+        'table', TG_TABLE_NAME,
+        'op', TG_OP,
+        'app', current_setting('application_name'),
+        'count', changed,
+        'keys', CASE WHEN jsonb_array_length(keys) > 100 THEN NULL ELSE keys END)::text);
+    RETURN NULL;
+END
+$fn$;
+
+DO $do$
+DECLARE
+    spec TEXT[];
+BEGIN
+    FOREACH spec SLICE 1 IN ARRAY ARRAY[
+        ['goals', 'id::text'],
+        ['occurrences', 'date::text'],
+        ['daily_scores', 'date::text'],
+        ['weekly_scores', 'week_start::text'],
+        ['monthly_scores', 'month_start::text'],
+        ['yearly_scores', 'year_start::text']]
+    LOOP
+        IF NOT EXISTS (SELECT 1 FROM pg_trigger
+                       WHERE tgrelid = spec[1]::regclass AND tgname = 'nimo_notify_insert') THEN
+            EXECUTE format('CREATE TRIGGER nimo_notify_insert AFTER INSERT ON %I '
+                           'REFERENCING NEW TABLE AS new_rows '
+                           'FOR EACH STATEMENT EXECUTE FUNCTION nimo_notify_change(%L)',
+                           spec[1], spec[2]);
+        END IF;
+        IF NOT EXISTS (SELECT 1 FROM pg_trigger
+                       WHERE tgrelid = spec[1]::regclass AND tgname = 'nimo_notify_update') THEN
+            EXECUTE format('CREATE TRIGGER nimo_notify_update AFTER UPDATE ON %I '
+                           'REFERENCING NEW TABLE AS new_rows '
+                           'FOR EACH STATEMENT EXECUTE FUNCTION nimo_notify_change(%L)',
+                           spec[1], spec[2]);
+        END IF;
+        IF NOT EXISTS (SELECT 1 FROM pg_trigger
+                       WHERE tgrelid = spec[1]::regclass AND tgname = 'nimo_notify_delete') THEN
+            EXECUTE format('CREATE TRIGGER nimo_notify_delete AFTER DELETE ON %I '
+                           'REFERENCING OLD TABLE AS old_rows '
+                           'FOR EACH STATEMENT EXECUTE FUNCTION nimo_notify_change(%L)',
+                           spec[1], spec[2]);
+        END IF;
+    END LOOP;
+END
+$do$;
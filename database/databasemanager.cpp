@@ -1,6 +1,9 @@
 #include "database/databasemanager.h"
+#include "database/changefeed.h"
 #include "logging/logger.h"
 #include "logging/requestcontext.h"
+#include "diagnostics/metricsregistry.h"
+#include "diagnostics/startupprofiler.h"
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QVariant>
@@ -24,6 +27,7 @@ DatabaseManager::DatabaseManager()
     , m_password("")
     , m_isConnected(false)
     , m_inTransaction(false)
+    , m_reconnectTimer(nullptr)
 {
     m_connectionId = QString("conn_%1").arg(QDateTime::currentMSecsSinceEpoch());
 }
@@ -33,6 +37,19 @@ DatabaseManager::~DatabaseManager()
     shutdown();
 }
 
+void DatabaseManager::setConnectionParameters(const QString& host, int port,
+                                              const QString& databaseName,
+                                              const QString& userName,
+                                              const QString& password)
+{
+    QMutexLocker locker(&m_mutex);
+    m_host = host;
+    m_port = port;
+    m_databaseName = databaseName;
+    m_userName = userName;
+    m_password = password;
+}
+
 bool DatabaseManager::initialize()
 {
     QMutexLocker locker(&m_mutex);
@@ -69,6 +86,7 @@ bool DatabaseManager::initialize()
                                  });
         return false;
     }
+    StartupProfiler::instance().mark("db.connect");
 
     // Get server version
     QString serverVersion = "unknown";
@@ -76,6 +94,7 @@ bool DatabaseManager::initialize()
     if (query.exec("SELECT version()") && query.next()) {
         serverVersion = query.value(0).toString();
     }
+    StartupProfiler::instance().mark("db.version");
 
     qint64 duration = QDateTime::currentMSecsSinceEpoch() - startTime;
 
@@ -96,6 +115,7 @@ bool DatabaseManager::initialize()
                                 "Migrations failed or incomplete", {});
         // Don't fail initialization if migrations fail - might be already up to date
     }
+    StartupProfiler::instance().mark("db.migrations");
 
     return true;
 }
@@ -125,13 +145,13 @@ void DatabaseManager::shutdown()
 
 bool DatabaseManager::createConnection()
 {
-    // Remove old connection if exists
+    // Reconnecting reuses the connection repositories already hold copies of
     if (QSqlDatabase::contains("nimo_main")) {
-        QSqlDatabase::removeDatabase("nimo_main");
+        m_db = QSqlDatabase::database("nimo_main", false);
+        m_db.close();
+    } else {
+        m_db = QSqlDatabase::addDatabase("QPSQL", "nimo_main");
     }
-
-    // Create new connection
-    m_db = QSqlDatabase::addDatabase("QPSQL", "nimo_main");
     m_db.setHostName(m_host);
     m_db.setPort(m_port);
     m_db.setDatabaseName(m_databaseName);
@@ -141,8 +161,11 @@ bool DatabaseManager::createConnection()
         m_db.setPassword(m_password);
     }
 
-    // Set connection options
-    m_db.setConnectOptions("connect_timeout=10");
+    // Set connection options. The application name is per process and is
+    // inherited by cloned connections, so ChangeFeed can tell our own writes
+    // from other processes'.
+    m_db.setConnectOptions(QString("connect_timeout=10;application_name=nimo-%1")
+                               .arg(QCoreApplication::applicationPid()));
 
     if (!m_db.open()) {
         m_lastError = m_db.lastError().text();
@@ -162,6 +185,48 @@ bool DatabaseManager::testConnection()
     return true;
 }
 
+void DatabaseManager::startReconnecting(int intervalMs)
+{
+    if (!m_reconnectTimer) {
+        m_reconnectTimer = new QTimer(this);
+        connect(m_reconnectTimer, &QTimer::timeout, this, [this]() {
+            if (initialize()) {
+                m_reconnectTimer->stop();
+            }
+        });
+    }
+    if (!m_reconnectTimer->isActive()) {
+        Logger::instance().info("DatabaseManager::startReconnecting", "db_reconnect",
+                                "Retrying database connection", {
+                                    {"intervalMs", intervalMs}
+                                });
+        m_reconnectTimer->start(intervalMs);
+    }
+}
+
+bool DatabaseManager::checkConnection()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_isConnected && testConnection()) {
+            return true;
+        }
+        if (!m_isConnected) {
+            return false;
+        }
+        m_isConnected = false;
+        m_inTransaction = false;
+    }
+
+    Logger::instance().warn("DatabaseManager::checkConnection", "db_reconnect",
+                            "Database connection lost", {
+                                {"errorMessage", m_lastError}
+                            });
+    emit disconnected();
+    startReconnecting();
+    return false;
+}
+
 QSqlDatabase DatabaseManager::database() const
 {
     return m_db;
@@ -203,6 +268,7 @@ bool DatabaseManager::beginTransaction()
     }
 
     m_inTransaction = true;
+    m_transactionTimer.start();
 
     Logger::instance().info("DatabaseManager::beginTransaction", txnId,
                             "Transaction started", {
@@ -228,6 +294,7 @@ bool DatabaseManager::commit()
     if (!m_db.commit()) {
         m_lastError = m_db.lastError().text();
         m_inTransaction = false;
+        recordTransaction(true, true);
 
         qint64 duration = QDateTime::currentMSecsSinceEpoch() - startTime;
         Logger::instance().error("DatabaseManager::commit", txnId,
@@ -239,6 +306,7 @@ bool DatabaseManager::commit()
     }
 
     m_inTransaction = false;
+    recordTransaction(true, false);
 
     qint64 duration = QDateTime::currentMSecsSinceEpoch() - startTime;
     Logger::instance().info("DatabaseManager::commit", txnId,
@@ -263,6 +331,7 @@ bool DatabaseManager::rollback()
     if (!m_db.rollback()) {
         m_lastError = m_db.lastError().text();
         m_inTransaction = false;
+        recordTransaction(false, true);
 
         Logger::instance().error("DatabaseManager::rollback", txnId,
                                  "Transaction rollback failed", {
@@ -272,6 +341,7 @@ bool DatabaseManager::rollback()
     }
 
     m_inTransaction = false;
+    recordTransaction(false, false);
 
     Logger::instance().info("DatabaseManager::rollback", txnId,
                             "Transaction rolled back", {});
@@ -279,6 +349,14 @@ bool DatabaseManager::rollback()
     return true;
 }
 
+void DatabaseManager::recordTransaction(bool committed, bool failed)
+{
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    metrics.recordOperation(metrics.operation("DatabaseManager::transaction"),
+                            m_transactionTimer.nsecsElapsed(), failed);
+    metrics.counter(committed ? "db.commits" : "db.rollbacks")->add();
+}
+
 bool DatabaseManager::isInTransaction() const
 {
     return m_inTransaction;
@@ -322,6 +400,37 @@ bool DatabaseManager::runMigrations()
     return true;
 }
 
+bool DatabaseManager::applySchema()
+{
+    QFile file(":/nimo/database/schema.sql");
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        m_lastError = "Bundled schema not found";
+        return false;
+    }
+
+    // Unprepared exec sends the whole script as one simple query
+    QSqlQuery query(m_db);
+    bool applied = query.exec(QString::fromUtf8(file.readAll()));
+    if (!applied) {
+        m_lastError = query.lastError().text();
+    } else {
+        applied = ChangeFeed::installTriggers(m_db, &m_lastError);
+    }
+    if (!applied) {
+        Logger::instance().error("DatabaseManager::applySchema", "db_schema",
+                                 "Failed to apply schema", {
+                                     {"errorMessage", m_lastError}
+                                 });
+        return false;
+    }
+
+    Logger::instance().info("DatabaseManager::applySchema", "db_schema",
+                            "Schema applied", {
+                                {"databaseName", m_databaseName}
+                            });
+    return true;
+}
+
 int DatabaseManager::currentSchemaVersion()
 {
     QSqlQuery query(m_db);
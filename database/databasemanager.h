@@ -7,6 +7,8 @@
 #include <QSqlError>
 #include <QString>
 #include <QMutex>
+#include <QElapsedTimer>
+#include <QTimer>
 
 class DatabaseManager : public QObject
 {
@@ -15,7 +17,11 @@ class DatabaseManager : public QObject
 public:
     static DatabaseManager& instance();
 
-    // Initialization
+    // Initialization; connection parameters must be set before initialize()
+    void setConnectionParameters(const QString& host, int port,
+                                 const QString& databaseName,
+                                 const QString& userName,
+                                 const QString& password = QString());
     bool initialize();
     void shutdown();
 
@@ -24,6 +30,12 @@ public:
     bool isConnected() const;
     QString lastError() const;
 
+    // Retries initialize() every intervalMs until it succeeds, which emits
+    // connected(). The handle from database() stays valid throughout.
+    void startReconnecting(int intervalMs = 5000);
+    // Pings the server; on failure marks the connection lost and reconnects
+    bool checkConnection();
+
     // Transaction management
     bool beginTransaction();
     bool commit();
@@ -32,6 +44,8 @@ public:
 
     // Migration management
     bool runMigrations();
+    // Creates all tables from the bundled database/schema.sql (idempotent)
+    bool applySchema();
     int currentSchemaVersion();
 
     // Connection info
@@ -55,6 +69,7 @@ private:
     bool ensureSchemaExists();
     bool executeMigration(int version, const QString& sql);
     QString loadMigrationFile(int version);
+    void recordTransaction(bool committed, bool failed);
 
     QSqlDatabase m_db;
     QString m_connectionId;
@@ -66,6 +81,8 @@ private:
     bool m_isConnected;
     bool m_inTransaction;
     QString m_lastError;
+    QElapsedTimer m_transactionTimer;
+    QTimer* m_reconnectTimer;
     QMutex m_mutex;
 };
 
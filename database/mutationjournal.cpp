@@ -0,0 +1,309 @@
+#include "database/mutationjournal.h"
+#include "logging/logger.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QUuid>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+// flush() only reaches the OS; the record is durable once this returns
+bool syncToDisk(QFile& file)
+{
+    if (!file.flush()) {
+        return false;
+    }
+#ifdef Q_OS_WIN
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+}
+
+MutationJournal& MutationJournal::instance()
+{
+    static MutationJournal instance;
+    return instance;
+}
+
+MutationJournal::MutationJournal()
+    : QObject(nullptr)
+    , m_nextSequence(1)
+    , m_appliedSinceCheckpoint(0)
+    , m_checkpointThreshold(256)
+    , m_dirty(false)
+{
+    // Group commit: appends within one interval share a single fsync
+    m_syncTimer.setSingleShot(true);
+    m_syncTimer.setInterval(50);
+    connect(&m_syncTimer, &QTimer::timeout, this, &MutationJournal::sync);
+}
+
+MutationJournal::~MutationJournal()
+{
+    close();
+}
+
+bool MutationJournal::open(const QString& path)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_filePath = path;
+    if (m_filePath.isEmpty()) {
+        QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+        m_filePath = QDir(appDataPath).filePath("mutations.journal");
+    }
+    QDir().mkpath(QFileInfo(m_filePath).absolutePath());
+
+    m_file.setFileName(m_filePath);
+    if (!m_file.open(QIODevice::ReadWrite | QIODevice::Append)) {
+        Logger::instance().error("MutationJournal::open", "journal",
+                                 "Failed to open mutation journal", {
+                                     {"path", m_filePath},
+                                     {"errorMessage", m_file.errorString()}
+                                 });
+        return false;
+    }
+
+    if (!load()) {
+        m_file.close();
+        return false;
+    }
+
+    Logger::instance().info("MutationJournal::open", "journal",
+                            "Mutation journal opened", {
+                                {"path", m_filePath},
+                                {"outstanding", m_unapplied.size()}
+                            });
+    return true;
+}
+
+bool MutationJournal::load()
+{
+    m_unapplied.clear();
+    m_nextSequence = 1;
+    m_appliedSinceCheckpoint = 0;
+
+    m_file.seek(0);
+    const QByteArray content = m_file.readAll();
+
+    // A crash mid-append leaves a partial last line; it was never synced,
+    // so it is dropped along with anything after it
+    qsizetype offset = 0;
+    while (offset < content.size()) {
+        const qsizetype end = content.indexOf('\n', offset);
+        if (end < 0) {
+            break;
+        }
+
+        QJsonParseError error;
+        const QJsonDocument document = QJsonDocument::fromJson(content.mid(offset, end - offset), &error);
+        if (error.error != QJsonParseError::NoError || !document.isObject()) {
+            break;
+        }
+
+        const QJsonObject object = document.object();
+        JournalRecord record;
+        record.sequence = static_cast<quint64>(object.value("seq").toInteger());
+        record.id = object.value("id").toString();
+        record.recordedAt = QDateTime::fromString(object.value("at").toString(), Qt::ISODateWithMs);
+        record.type = object.value("type").toString();
+        record.data = object.value("data").toObject();
+        m_unapplied.insert(record.sequence, record);
+        m_nextSequence = qMax(m_nextSequence, record.sequence + 1);
+
+        offset = end + 1;
+    }
+
+    if (offset < content.size()) {
+        Logger::instance().warn("MutationJournal::load", "journal",
+                                "Dropping torn journal tail", {
+                                    {"path", m_filePath},
+                                    {"droppedBytes", content.size() - offset}
+                                });
+        if (!m_file.resize(offset)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void MutationJournal::close()
+{
+    if (!isOpen()) {
+        return;
+    }
+    m_syncTimer.stop();
+    checkpoint();
+
+    QMutexLocker locker(&m_mutex);
+    syncLocked();
+    m_file.close();
+}
+
+bool MutationJournal::isOpen() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_file.isOpen();
+}
+
+bool MutationJournal::append(const QString& type, const QJsonObject& data, JournalRecord* appended)
+{
+    QMutexLocker locker(&m_mutex);
+
+    JournalRecord record;
+    record.sequence = m_nextSequence;
+    record.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    record.recordedAt = QDateTime::currentDateTimeUtc();
+    record.type = type;
+    record.data = data;
+
+    if (!m_file.isOpen() || m_file.write(encode(record)) < 0) {
+        Logger::instance().error("MutationJournal::append", "journal",
+                                 "Failed to append mutation", {
+                                     {"type", type},
+                                     {"errorMessage", m_file.errorString()}
+                                 });
+        return false;
+    }
+
+    m_nextSequence++;
+    m_unapplied.insert(record.sequence, record);
+    m_dirty = true;
+    if (!m_syncTimer.isActive()) {
+        m_syncTimer.start();
+    }
+    if (appended) {
+        *appended = record;
+    }
+    return true;
+}
+
+void MutationJournal::markApplied(const QList<quint64>& sequences)
+{
+    bool checkpointDue = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (quint64 sequence : sequences) {
+            if (m_unapplied.remove(sequence) > 0) {
+                m_appliedSinceCheckpoint++;
+            }
+        }
+        // Compact once a batch has settled, or as soon as nothing is left
+        checkpointDue = m_appliedSinceCheckpoint > 0
+                        && (m_unapplied.isEmpty() || m_appliedSinceCheckpoint >= m_checkpointThreshold);
+    }
+
+    // Writers call this from their own thread; the file belongs to ours
+    if (checkpointDue) {
+        QMetaObject::invokeMethod(this, [this]() { checkpoint(); }, Qt::QueuedConnection);
+    }
+}
+
+QList<JournalRecord> MutationJournal::unapplied() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_unapplied.values();
+}
+
+int MutationJournal::unappliedCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_unapplied.size();
+}
+
+bool MutationJournal::isOutstanding(quint64 sequence) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_unapplied.contains(sequence);
+}
+
+bool MutationJournal::sync()
+{
+    QMutexLocker locker(&m_mutex);
+    return syncLocked();
+}
+
+bool MutationJournal::syncLocked()
+{
+    if (!m_dirty || !m_file.isOpen()) {
+        return true;
+    }
+    if (!syncToDisk(m_file)) {
+        Logger::instance().error("MutationJournal::sync", "journal",
+                                 "Failed to sync mutation journal", {
+                                     {"errorMessage", m_file.errorString()}
+                                 });
+        return false;
+    }
+    m_dirty = false;
+    return true;
+}
+
+bool MutationJournal::checkpoint()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_file.isOpen() || m_appliedSinceCheckpoint == 0) {
+        return true;
+    }
+    syncLocked();
+
+    QSaveFile compacted(m_filePath);
+    if (!compacted.open(QIODevice::WriteOnly)) {
+        Logger::instance().error("MutationJournal::checkpoint", "journal",
+                                 "Failed to compact mutation journal", {
+                                     {"errorMessage", compacted.errorString()}
+                                 });
+        return false;
+    }
+    for (const JournalRecord& record : std::as_const(m_unapplied)) {
+        compacted.write(encode(record));
+    }
+
+    // The replace fails on Windows while the old file is still open
+    m_file.close();
+    const bool committed = compacted.commit();
+    if (!m_file.open(QIODevice::ReadWrite | QIODevice::Append)) {
+        Logger::instance().error("MutationJournal::checkpoint", "journal",
+                                 "Failed to reopen mutation journal", {
+                                     {"errorMessage", m_file.errorString()}
+                                 });
+        return false;
+    }
+    if (!committed) {
+        Logger::instance().error("MutationJournal::checkpoint", "journal",
+                                 "Failed to compact mutation journal", {
+                                     {"errorMessage", compacted.errorString()}
+                                 });
+        return false;
+    }
+
+    Logger::instance().debug("MutationJournal::checkpoint", "journal",
+                             "Mutation journal compacted", {
+                                 {"applied", m_appliedSinceCheckpoint},
+                                 {"outstanding", m_unapplied.size()}
+                             });
+    m_appliedSinceCheckpoint = 0;
+    return true;
+}
+
+QByteArray MutationJournal::encode(const JournalRecord& record)
+{
+    const QJsonObject object{
+        {"seq", static_cast<qint64>(record.sequence)},
+        {"id", record.id},
+        {"at", record.recordedAt.toString(Qt::ISODateWithMs)},
+        {"type", record.type},
+        {"data", record.data}
+    };
+    return QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n';
+}
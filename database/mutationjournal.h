@@ -0,0 +1,81 @@
+#ifndef MUTATIONJOURNAL_H
+#define MUTATIONJOURNAL_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonObject>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QTimer>
+
+struct JournalRecord {
+    quint64 sequence = 0;
+    QString id;         // uuid, recorded in applied_mutations once applied
+    QDateTime recordedAt;
+    QString type;       // occurrence.status, goal.update
+    QJsonObject data;
+};
+
+// Append-only journal of user mutations, written before the database so a
+// change survives a crash or a database that is not reachable yet. One JSON
+// record per line; appends are buffered and fsynced in batches. Records
+// stay until they are marked applied, after which a checkpoint rewrites the
+// file with only the outstanding ones. Replaying a record twice is harmless
+// because applied ids are kept in the database (applied_mutations).
+//
+// append() must be called on the thread the journal lives on; the other
+// methods are thread-safe.
+class MutationJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    static MutationJournal& instance();
+
+    // Loads outstanding records; an empty path uses the app data directory
+    bool open(const QString& path = QString());
+    // Syncs and checkpoints
+    void close();
+    bool isOpen() const;
+    QString filePath() const { return m_filePath; }
+
+    // False when the record could not be written; record is then untouched
+    bool append(const QString& type, const QJsonObject& data, JournalRecord* record = nullptr);
+    void markApplied(const QList<quint64>& sequences);
+
+    // Outstanding records in append order
+    QList<JournalRecord> unapplied() const;
+    int unappliedCount() const;
+    bool isOutstanding(quint64 sequence) const;
+
+    bool sync();
+    bool checkpoint();
+
+    void setSyncIntervalMs(int ms) { m_syncTimer.setInterval(qMax(0, ms)); }
+    void setCheckpointThreshold(int records) { m_checkpointThreshold = qMax(1, records); }
+
+private:
+    MutationJournal();
+    ~MutationJournal();
+    MutationJournal(const MutationJournal&) = delete;
+    MutationJournal& operator=(const MutationJournal&) = delete;
+
+    bool load();
+    bool syncLocked();
+    static QByteArray encode(const JournalRecord& record);
+
+    mutable QMutex m_mutex;
+    QString m_filePath;
+    QFile m_file;
+    QTimer m_syncTimer;
+    QMap<quint64, JournalRecord> m_unapplied;
+    quint64 m_nextSequence;
+    int m_appliedSinceCheckpoint;
+    int m_checkpointThreshold;
+    bool m_dirty;
+};
+
+#endif // MUTATIONJOURNAL_H
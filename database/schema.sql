@@ -0,0 +1,198 @@
+-- Nimo local database schema (PostgreSQL 13+)
+-- Mirrors the columns used by the repositories; applied by hand, by the
+-- benchmark suite and by nimo-seed on a fresh database.
+
+CREATE TABLE IF NOT EXISTS schema_migrations (
+    version     INTEGER PRIMARY KEY,
+    name        TEXT NOT NULL,
+    applied_at  TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP
+);
+
+CREATE TABLE IF NOT EXISTS goals (
+    id                UUID PRIMARY KEY DEFAULT gen_random_uuid(),
+    title             TEXT NOT NULL,
+    scope             TEXT NOT NULL CHECK (scope IN ('daily', 'weekly', 'monthly', 'yearly')),
+    points            INTEGER NOT NULL DEFAULT 0,
+    missing_behavior  TEXT NOT NULL DEFAULT 'zero' CHECK (missing_behavior IN ('zero', 'penalty')),
+    penalty_points    INTEGER NOT NULL DEFAULT 0,
+    category          TEXT,
+    notes             TEXT,
+    icon_name         TEXT,
+    color_hex         TEXT,
+    sort_order        INTEGER NOT NULL DEFAULT 0,
+    is_active         BOOLEAN NOT NULL DEFAULT true,
+    created_at        TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    updated_at        TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    deleted_at        TIMESTAMPTZ
+);
+
+CREATE INDEX IF NOT EXISTS idx_goals_scope ON goals (scope, sort_order) WHERE deleted_at IS NULL;
+CREATE INDEX IF NOT EXISTS idx_goals_updated ON goals (updated_at, id);
+
+CREATE TABLE IF NOT EXISTS occurrences (
+    id            UUID PRIMARY KEY DEFAULT gen_random_uuid(),
+    goal_id       UUID NOT NULL REFERENCES goals (id) ON DELETE CASCADE,
+    date          DATE NOT NULL,
+    week_start    DATE NOT NULL,
+    month_start   DATE NOT NULL,
+    year_start    DATE NOT NULL,
+    status        TEXT NOT NULL DEFAULT 'pending'
+                  CHECK (status IN ('pending', 'completed', 'skipped', 'not_completed')),
+    completed_at  TIMESTAMPTZ,
+    score_impact  INTEGER NOT NULL DEFAULT 0,
+    notes         TEXT,
+    created_at    TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    updated_at    TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    -- Local time of the last nimo-sync pull; updated_at keeps the remote's
+    synced_at     TIMESTAMPTZ,
+    UNIQUE (goal_id, date)
+);
+
+ALTER TABLE occurrences ADD COLUMN IF NOT EXISTS synced_at TIMESTAMPTZ;
+
+CREATE INDEX IF NOT EXISTS idx_occurrences_date ON occurrences (date);
+CREATE INDEX IF NOT EXISTS idx_occurrences_week ON occurrences (week_start);
+CREATE INDEX IF NOT EXISTS idx_occurrences_month ON occurrences (month_start);
+CREATE INDEX IF NOT EXISTS idx_occurrences_year ON occurrences (year_start);
+CREATE INDEX IF NOT EXISTS idx_occurrences_pending ON occurrences (date) WHERE status = 'pending';
+CREATE INDEX IF NOT EXISTS idx_occurrences_updated ON occurrences (updated_at, id);
+CREATE INDEX IF NOT EXISTS idx_occurrences_synced ON occurrences (synced_at) WHERE synced_at IS NOT NULL;
+
+-- Occurrences that a change of their goal's scope folded into another one
+-- or moved off their date, kept as they stood and left out of scoring.
+-- Sync and incremental backups carry them ahead of occurrences and drop
+-- any older occurrence still at the same (goal_id, date).
+CREATE TABLE IF NOT EXISTS superseded_occurrences (
+    id             UUID PRIMARY KEY DEFAULT gen_random_uuid(),
+    occurrence_id  UUID NOT NULL,
+    goal_id        UUID NOT NULL REFERENCES goals (id) ON DELETE CASCADE,
+    date           DATE NOT NULL,
+    status         TEXT NOT NULL,
+    completed_at   TIMESTAMPTZ,
+    score_impact   INTEGER NOT NULL DEFAULT 0,
+    notes          TEXT,
+    created_at     TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    updated_at     TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    -- Local time of the last nimo-sync pull, as on occurrences
+    synced_at      TIMESTAMPTZ,
+    UNIQUE (goal_id, date)
+);
+
+CREATE INDEX IF NOT EXISTS idx_superseded_occurrences_updated ON superseded_occurrences (updated_at, id);
+
+CREATE TABLE IF NOT EXISTS daily_scores (
+    date                   DATE PRIMARY KEY,
+    earned_score           INTEGER NOT NULL DEFAULT 0,
+    target_score           INTEGER NOT NULL DEFAULT 0,
+    completion_percentage  DOUBLE PRECISION NOT NULL DEFAULT 0,
+    completed_count        INTEGER NOT NULL DEFAULT 0,
+    skipped_count          INTEGER NOT NULL DEFAULT 0,
+    not_completed_count    INTEGER NOT NULL DEFAULT 0,
+    pending_count          INTEGER NOT NULL DEFAULT 0,
+    total_count            INTEGER NOT NULL DEFAULT 0,
+    perfect_day            BOOLEAN NOT NULL DEFAULT false,
+    has_negative_outcome   BOOLEAN NOT NULL DEFAULT false,
+    created_at             TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    updated_at             TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP
+);
+
+CREATE TABLE IF NOT EXISTS weekly_scores (
+    week_start             DATE PRIMARY KEY,
+    year                   INTEGER NOT NULL,
+    week_number            INTEGER NOT NULL,
+    earned_score           INTEGER NOT NULL DEFAULT 0,
+    target_score           INTEGER NOT NULL DEFAULT 0,
+    completion_percentage  DOUBLE PRECISION NOT NULL DEFAULT 0,
+    completed_count        INTEGER NOT NULL DEFAULT 0,
+    skipped_count          INTEGER NOT NULL DEFAULT 0,
+    not_completed_count    INTEGER NOT NULL DEFAULT 0,
+    pending_count          INTEGER NOT NULL DEFAULT 0,
+    total_count            INTEGER NOT NULL DEFAULT 0,
+    created_at             TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    updated_at             TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP
+);
+
+CREATE TABLE IF NOT EXISTS monthly_scores (
+    month_start            DATE PRIMARY KEY,
+    year                   INTEGER NOT NULL,
+    month                  INTEGER NOT NULL,
+    earned_score           INTEGER NOT NULL DEFAULT 0,
+    target_score           INTEGER NOT NULL DEFAULT 0,
+    completion_percentage  DOUBLE PRECISION NOT NULL DEFAULT 0,
+    completed_count        INTEGER NOT NULL DEFAULT 0,
+    skipped_count          INTEGER NOT NULL DEFAULT 0,
+    not_completed_count    INTEGER NOT NULL DEFAULT 0,
+    pending_count          INTEGER NOT NULL DEFAULT 0,
+    total_count            INTEGER NOT NULL DEFAULT 0,
+    created_at             TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    updated_at             TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP
+);
+
+CREATE TABLE IF NOT EXISTS yearly_scores (
+    year_start             DATE PRIMARY KEY,
+    year                   INTEGER NOT NULL,
+    earned_score           INTEGER NOT NULL DEFAULT 0,
+    target_score           INTEGER NOT NULL DEFAULT 0,
+    completion_percentage  DOUBLE PRECISION NOT NULL DEFAULT 0,
+    completed_count        INTEGER NOT NULL DEFAULT 0,
+    skipped_count          INTEGER NOT NULL DEFAULT 0,
+    not_completed_count    INTEGER NOT NULL DEFAULT 0,
+    pending_count          INTEGER NOT NULL DEFAULT 0,
+    total_count            INTEGER NOT NULL DEFAULT 0,
+    created_at             TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    updated_at             TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP
+);
+
+CREATE TABLE IF NOT EXISTS streaks (
+    id                 UUID PRIMARY KEY DEFAULT gen_random_uuid(),
+    goal_id            UUID REFERENCES goals (id) ON DELETE CASCADE,
+    scope              TEXT NOT NULL,
+    current_streak     INTEGER NOT NULL DEFAULT 0,
+    longest_streak     INTEGER NOT NULL DEFAULT 0,
+    last_success_date  DATE,
+    last_break_date    DATE,
+    total_successes    INTEGER NOT NULL DEFAULT 0,
+    total_failures     INTEGER NOT NULL DEFAULT 0,
+    success_rate       DOUBLE PRECISION NOT NULL DEFAULT 0,
+    created_at         TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    updated_at         TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP
+);
+
+-- One overall streak per scope, one per goal and scope
+CREATE UNIQUE INDEX IF NOT EXISTS idx_streaks_overall ON streaks (scope) WHERE goal_id IS NULL;
+CREATE UNIQUE INDEX IF NOT EXISTS idx_streaks_goal ON streaks (goal_id, scope) WHERE goal_id IS NOT NULL;
+
+-- The overall daily streak as it stood after each day it evaluated, so a
+-- rescore replays it from the first changed day instead of from scratch
+CREATE TABLE IF NOT EXISTS streak_days (
+    date               DATE PRIMARY KEY,
+    success            BOOLEAN NOT NULL,
+    current_streak     INTEGER NOT NULL,
+    longest_streak     INTEGER NOT NULL,
+    total_successes    INTEGER NOT NULL,
+    total_failures     INTEGER NOT NULL,
+    updated_at         TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP
+);
+
+-- Journal mutations already applied here, so replaying the journal after a
+-- crash or an offline period applies each one exactly once
+CREATE TABLE IF NOT EXISTS applied_mutations (
+    mutation_id  UUID PRIMARY KEY,
+    applied_at   TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP
+);
+
+-- Sync progress per remote: the (updated_at, id) of the last row moved in
+-- each direction, advanced after every batch
+CREATE TABLE IF NOT EXISTS sync_state (
+    peer          TEXT NOT NULL,
+    table_name    TEXT NOT NULL,
+    direction     TEXT NOT NULL CHECK (direction IN ('push', 'pull')),
+    watermark     TIMESTAMPTZ NOT NULL,
+    last_id       UUID NOT NULL,
+    rows_synced   BIGINT NOT NULL DEFAULT 0,
+    updated_at    TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP,
+    PRIMARY KEY (peer, table_name, direction)
+);
+
+-- Change feed triggers live in database/changefeed.sql, applied after this
+-- file by DatabaseManager::applySchema()
@@ -0,0 +1,183 @@
+#include "database/slowquerylog.h"
+#include "logging/logger.h"
+#include "logging/requestcontext.h"
+#include "diagnostics/metricsregistry.h"
+#include <QSqlDriver>
+#include <QSqlResult>
+#include <QSqlError>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+
+SlowQueryLog& SlowQueryLog::instance()
+{
+    static SlowQueryLog instance;
+    return instance;
+}
+
+SlowQueryLog::SlowQueryLog()
+    : m_thresholdMs(100)
+    , m_explainEnabled(1)
+    , m_explainIntervalMs(10 * 60 * 1000)
+    , m_maxFileBytes(10 * 1024 * 1024)
+{
+    QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    m_filePath = QDir(appDataPath).filePath("logs/slow_queries.log");
+}
+
+bool SlowQueryLog::exec(QSqlQuery& query, const char* source)
+{
+    QElapsedTimer timer;
+    timer.start();
+    bool ok = query.exec();
+    qint64 elapsedNs = timer.nsecsElapsed();
+
+    SlowQueryLog& log = instance();
+    qint64 thresholdNs = static_cast<qint64>(log.m_thresholdMs.loadRelaxed()) * 1000000;
+    if (ok && thresholdNs > 0 && elapsedNs >= thresholdNs) {
+        log.report(query, source, elapsedNs);
+    }
+    return ok;
+}
+
+void SlowQueryLog::setExplainIntervalMs(qint64 ms)
+{
+    QMutexLocker locker(&m_mutex);
+    m_explainIntervalMs = ms;
+}
+
+void SlowQueryLog::applyConfig(const QJsonObject& config)
+{
+    setThresholdMs(config.value("thresholdMs").toInt(100));
+    setExplainEnabled(config.value("explain").toBool(true));
+    setExplainIntervalMs(static_cast<qint64>(config.value("explainIntervalSec").toInt(600)) * 1000);
+}
+
+void SlowQueryLog::setLogFilePath(const QString& filePath)
+{
+    QMutexLocker locker(&m_mutex);
+    m_filePath = filePath;
+}
+
+void SlowQueryLog::report(QSqlQuery& query, const char* source, qint64 elapsedNs)
+{
+    MetricsRegistry::instance().counter("db.slowQueries")->add();
+
+    QString sql = query.lastQuery();
+
+    QJsonObject bindValues;
+    const QStringList names = query.boundValueNames();
+    for (const QString& name : names) {
+        bindValues[name] = QJsonValue::fromVariant(query.boundValue(name));
+    }
+
+    QJsonObject entry;
+    entry["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs);
+    entry["source"] = QString::fromLatin1(source);
+    entry["requestId"] = RequestContext::current();
+    entry["durationMs"] = elapsedNs / 1e6;
+    entry["thresholdMs"] = thresholdMs();
+    entry["sql"] = sql;
+    entry["bindValues"] = bindValues;
+    entry["rows"] = query.isSelect() ? query.size() : query.numRowsAffected();
+
+    // Forward-only results may still be streaming on this connection
+    if (m_explainEnabled.loadRelaxed() && !query.isForwardOnly() && shouldExplain(sql)) {
+        QString error;
+        QJsonArray plan = explain(query, &error);
+        if (error.isEmpty()) {
+            entry["plan"] = plan;
+        } else {
+            entry["explainError"] = error;
+        }
+    }
+
+    append(QJsonDocument(entry).toJson(QJsonDocument::Compact));
+
+    Logger::instance().warn(QString::fromLatin1(source), RequestContext::current(),
+                            "Slow query", {
+                                {"durationMs", elapsedNs / 1e6},
+                                {"explained", entry.contains("plan")}
+                            });
+}
+
+bool SlowQueryLog::shouldExplain(const QString& sql)
+{
+    QMutexLocker locker(&m_mutex);
+
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    auto it = m_lastExplainMs.find(sql);
+    if (it != m_lastExplainMs.end() && now - it.value() < m_explainIntervalMs) {
+        return false;
+    }
+    m_lastExplainMs.insert(sql, now);
+    return true;
+}
+
+QJsonArray SlowQueryLog::explain(const QSqlQuery& query, QString* error)
+{
+    QString sql = query.lastQuery().trimmed();
+    bool readOnly = sql.startsWith("SELECT", Qt::CaseInsensitive);
+
+    // Runs on the same connection as the slow statement. A savepoint keeps a
+    // failing EXPLAIN from aborting the caller's transaction; outside one
+    // it fails harmlessly and writes get a throwaway transaction instead.
+    QSqlQuery control(query.driver()->createResult());
+    bool usedSavepoint = control.exec("SAVEPOINT nimo_explain");
+    bool startedTransaction = false;
+    if (!usedSavepoint && !readOnly) {
+        if (!control.exec("BEGIN")) {
+            *error = control.lastError().text();
+            return QJsonArray();
+        }
+        startedTransaction = true;
+    }
+
+    QSqlQuery explainQuery(query.driver()->createResult());
+    explainQuery.prepare("EXPLAIN (ANALYZE, BUFFERS) " + sql);
+    const QStringList names = query.boundValueNames();
+    for (const QString& name : names) {
+        explainQuery.bindValue(name, query.boundValue(name));
+    }
+
+    QJsonArray plan;
+    if (explainQuery.exec()) {
+        while (explainQuery.next()) {
+            plan.append(explainQuery.value(0).toString());
+        }
+    } else {
+        *error = explainQuery.lastError().text();
+    }
+
+    if (usedSavepoint) {
+        control.exec("ROLLBACK TO SAVEPOINT nimo_explain");
+        control.exec("RELEASE SAVEPOINT nimo_explain");
+    } else if (startedTransaction) {
+        control.exec("ROLLBACK");
+    }
+
+    return plan;
+}
+
+void SlowQueryLog::append(const QByteArray& line)
+{
+    QMutexLocker locker(&m_mutex);
+
+    QFile file(m_filePath);
+    if (file.size() > m_maxFileBytes) {
+        // Keep one previous generation
+        QFile::remove(m_filePath + ".1");
+        QFile::rename(m_filePath, m_filePath + ".1");
+    }
+
+    QDir().mkpath(QFileInfo(m_filePath).absolutePath());
+    if (file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        file.write(line);
+        file.write("\n");
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef SLOWQUERYLOG_H
+#define SLOWQUERYLOG_H
+
+#include <QString>
+#include <QHash>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QSqlQuery>
+#include <QJsonArray>
+#include <QJsonObject>
+
+// Times repository statements and reports those over a threshold to a
+// dedicated JSON-lines file (slow_queries.log in the log directory). The
+// first slow run of a statement, and at most one run per explain interval
+// after that, is repeated under EXPLAIN (ANALYZE, BUFFERS) on the same
+// connection. The EXPLAIN runs inside a savepoint or transaction that is
+// rolled back, so re-running a write has no lasting effect.
+class SlowQueryLog
+{
+public:
+    static SlowQueryLog& instance();
+
+    // Drop-in for query.exec() on prepared statements
+    static bool exec(QSqlQuery& query, const char* source);
+
+    void setThresholdMs(int ms) { m_thresholdMs.storeRelaxed(ms); }
+    int thresholdMs() const { return m_thresholdMs.loadRelaxed(); }
+    void setExplainEnabled(bool enabled) { m_explainEnabled.storeRelaxed(enabled ? 1 : 0); }
+    void setExplainIntervalMs(qint64 ms);
+    void setLogFilePath(const QString& filePath);
+    // The "slowQuery" section of logging.json; missing keys reset to defaults
+    void applyConfig(const QJsonObject& config);
+
+private:
+    SlowQueryLog();
+    SlowQueryLog(const SlowQueryLog&) = delete;
+    SlowQueryLog& operator=(const SlowQueryLog&) = delete;
+
+    void report(QSqlQuery& query, const char* source, qint64 elapsedNs);
+    bool shouldExplain(const QString& sql);
+    QJsonArray explain(const QSqlQuery& query, QString* error);
+    void append(const QByteArray& line);
+
+    QAtomicInt m_thresholdMs;
+    QAtomicInt m_explainEnabled;
+    qint64 m_explainIntervalMs;
+    qint64 m_maxFileBytes;
+    QString m_filePath;
+    QHash<QString, qint64> m_lastExplainMs;
+    QMutex m_mutex;
+};
+
+#endif // SLOWQUERYLOG_H
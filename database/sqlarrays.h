@@ -0,0 +1,48 @@
+#ifndef SQLARRAYS_H
+#define SQLARRAYS_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QDate>
+
+// Helpers for binding PostgreSQL array literals through QSqlQuery.
+// QPSQL has no native array binding, so lists are passed as text and cast
+// on the server side, e.g. "unnest(CAST(:dates AS date[]))".
+namespace SqlArrays
+{
+
+inline QString dates(const QList<QDate>& values)
+{
+    QStringList parts;
+    parts.reserve(values.size());
+    for (const QDate& value : values) {
+        parts.append(value.toString("yyyy-MM-dd"));
+    }
+    return "{" + parts.join(',') + "}";
+}
+
+inline QString ints(const QList<int>& values)
+{
+    QStringList parts;
+    parts.reserve(values.size());
+    for (int value : values) {
+        parts.append(QString::number(value));
+    }
+    return "{" + parts.join(',') + "}";
+}
+
+inline QString texts(const QStringList& values)
+{
+    QStringList parts;
+    parts.reserve(values.size());
+    for (QString value : values) {
+        value.replace('\\', "\\\\").replace('"', "\\\"");
+        parts.append('"' + value + '"');
+    }
+    return "{" + parts.join(',') + "}";
+}
+
+} // namespace SqlArrays
+
+#endif // SQLARRAYS_H
@@ -0,0 +1,111 @@
+#include "diagnostics/allocationtracker.h"
+
+#if NIMO_ALLOC_TRACKING
+
+#include <cstdlib>
+#include <new>
+
+// Constant-initialised, so touching them from operator new never runs
+// thread_local constructors
+namespace
+{
+thread_local quint64 t_count = 0;
+thread_local quint64 t_bytes = 0;
+
+void* allocate(std::size_t size)
+{
+    ++t_count;
+    t_bytes += size;
+    return std::malloc(size ? size : 1);
+}
+
+void* allocateAligned(std::size_t size, std::align_val_t alignment)
+{
+    ++t_count;
+    t_bytes += size;
+    std::size_t align = static_cast<std::size_t>(alignment);
+#ifdef _MSC_VER
+    return _aligned_malloc(size ? size : 1, align);
+#else
+    // aligned_alloc wants a size that is a multiple of the alignment
+    std::size_t rounded = ((size ? size : 1) + align - 1) / align * align;
+    return std::aligned_alloc(align, rounded);
+#endif
+}
+
+void releaseAligned(void* ptr)
+{
+#ifdef _MSC_VER
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+}
+
+AllocationStats AllocationTracker::threadTotals()
+{
+    return {t_count, t_bytes};
+}
+
+void* operator new(std::size_t size)
+{
+    if (void* ptr = allocate(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (void* ptr = allocateAligned(size, alignment)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocateAligned(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::align_val_t) noexcept { releaseAligned(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { releaseAligned(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { releaseAligned(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { releaseAligned(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { releaseAligned(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { releaseAligned(ptr); }
+
+#endif // NIMO_ALLOC_TRACKING
@@ -0,0 +1,48 @@
+#ifndef ALLOCATIONTRACKER_H
+#define ALLOCATIONTRACKER_H
+
+#include <QtGlobal>
+
+// Heap allocation counting, compiled in with -DNIMO_ALLOC_TRACKING=ON.
+// The build then replaces the global operator new/delete with versions that
+// bump per-thread counters; without it everything here is a no-op that
+// reports zero.
+#ifndef NIMO_ALLOC_TRACKING
+#define NIMO_ALLOC_TRACKING 0
+#endif
+
+struct AllocationStats {
+    quint64 count = 0;
+    quint64 bytes = 0;
+};
+
+namespace AllocationTracker
+{
+constexpr bool isEnabled() { return NIMO_ALLOC_TRACKING != 0; }
+
+// Running totals for the calling thread since it started
+#if NIMO_ALLOC_TRACKING
+AllocationStats threadTotals();
+#else
+inline AllocationStats threadTotals() { return AllocationStats(); }
+#endif
+} // namespace AllocationTracker
+
+// Allocations made on the current thread since construction, including
+// any nested scopes
+class AllocationScope
+{
+public:
+    AllocationScope() : m_start(AllocationTracker::threadTotals()) {}
+
+    AllocationStats elapsed() const
+    {
+        AllocationStats now = AllocationTracker::threadTotals();
+        return {now.count - m_start.count, now.bytes - m_start.bytes};
+    }
+
+private:
+    AllocationStats m_start;
+};
+
+#endif // ALLOCATIONTRACKER_H
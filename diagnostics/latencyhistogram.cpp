@@ -0,0 +1,82 @@
+#include "diagnostics/latencyhistogram.h"
+#include <QtAlgorithms>
+#include <cmath>
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+void LatencyHistogram::record(qint64 valueNs)
+{
+    quint64 value = valueNs > 0 ? static_cast<quint64>(valueNs) : 0;
+
+    m_buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+
+    qint64 currentMax = m_max.load(std::memory_order_relaxed);
+    while (valueNs > currentMax
+           && !m_max.compare_exchange_weak(currentMax, valueNs, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset()
+{
+    for (std::atomic<quint64>& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+double LatencyHistogram::mean() const
+{
+    quint64 n = count();
+    return n > 0 ? static_cast<double>(sum()) / n : 0.0;
+}
+
+qint64 LatencyHistogram::percentile(double p) const
+{
+    quint64 total = count();
+    if (total == 0) {
+        return 0;
+    }
+
+    quint64 target = static_cast<quint64>(std::ceil(qBound(0.0, p, 100.0) / 100.0 * total));
+    target = qMax<quint64>(target, 1);
+
+    quint64 seen = 0;
+    for (int i = 0; i < BucketCount; i++) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            return qMin<qint64>(static_cast<qint64>(bucketUpperBound(i)), max());
+        }
+    }
+    return max();
+}
+
+int LatencyHistogram::bucketIndex(quint64 value)
+{
+    if (value < static_cast<quint64>(SubBuckets)) {
+        return static_cast<int>(value);
+    }
+
+    int msb = 63 - qCountLeadingZeroBits(value);
+    int shift = msb - SubBucketBits;
+    int mantissa = static_cast<int>((value >> shift) & (SubBuckets - 1));
+    return (shift + 1) * SubBuckets + mantissa;
+}
+
+quint64 LatencyHistogram::bucketUpperBound(int index)
+{
+    if (index < SubBuckets) {
+        return static_cast<quint64>(index);
+    }
+
+    int shift = index / SubBuckets - 1;
+    quint64 mantissa = static_cast<quint64>(index % SubBuckets);
+    quint64 lower = (static_cast<quint64>(SubBuckets) + mantissa) << shift;
+    return lower + ((quint64(1) << shift) - 1);
+}
@@ -0,0 +1,41 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QtGlobal>
+#include <atomic>
+
+// Lock-free log-linear histogram in the style of HdrHistogram. Each power
+// of two is split into 16 linear sub-buckets, so any recorded value is
+// reported within ~6% over the full 1 ns .. 2^63 ns range. Recording is
+// a few relaxed atomic increments; reads are approximate under concurrency.
+class LatencyHistogram
+{
+public:
+    static constexpr int SubBucketBits = 4;
+    static constexpr int SubBuckets = 1 << SubBucketBits;
+    static constexpr int BucketCount = (64 - SubBucketBits + 1) * SubBuckets;
+
+    LatencyHistogram();
+
+    void record(qint64 valueNs);
+    void reset();
+
+    quint64 count() const { return m_count.load(std::memory_order_relaxed); }
+    quint64 sum() const { return m_sum.load(std::memory_order_relaxed); }
+    qint64 max() const { return m_max.load(std::memory_order_relaxed); }
+    double mean() const;
+
+    // Upper bound of the bucket holding the given percentile (0..100)
+    qint64 percentile(double p) const;
+
+private:
+    static int bucketIndex(quint64 value);
+    static quint64 bucketUpperBound(int index);
+
+    std::atomic<quint64> m_buckets[BucketCount];
+    std::atomic<quint64> m_count;
+    std::atomic<quint64> m_sum;
+    std::atomic<qint64> m_max;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,224 @@
+#include "diagnostics/metricsregistry.h"
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <algorithm>
+
+namespace
+{
+template <typename T>
+T* findOrCreate(QReadWriteLock& lock, QHash<QString, T*>& table, const QString& name)
+{
+    {
+        QReadLocker locker(&lock);
+        T* existing = table.value(name);
+        if (existing) {
+            return existing;
+        }
+    }
+
+    QWriteLocker locker(&lock);
+    T*& slot = table[name];
+    if (!slot) {
+        slot = new T();
+    }
+    return slot;
+}
+}
+
+MetricsRegistry& MetricsRegistry::instance()
+{
+    static MetricsRegistry instance;
+    return instance;
+}
+
+MetricsRegistry::MetricsRegistry()
+    : QObject(nullptr)
+    , m_dumpTimer(nullptr)
+{
+}
+
+OperationMetrics* MetricsRegistry::operation(const QString& name)
+{
+    return findOrCreate(m_lock, m_operations, name);
+}
+
+OperationMetrics* MetricsRegistry::operation(const char* literalName)
+{
+    {
+        QReadLocker locker(&m_lock);
+        OperationMetrics* existing = m_literalOperations.value(literalName);
+        if (existing) {
+            return existing;
+        }
+    }
+
+    // Same name through either overload shares one entry
+    OperationMetrics* metrics = operation(QString::fromLatin1(literalName));
+
+    QWriteLocker locker(&m_lock);
+    m_literalOperations.insert(literalName, metrics);
+    return metrics;
+}
+
+MetricCounter* MetricsRegistry::counter(const QString& name)
+{
+    return findOrCreate(m_lock, m_counters, name);
+}
+
+MetricGauge* MetricsRegistry::gauge(const QString& name)
+{
+    return findOrCreate(m_lock, m_gauges, name);
+}
+
+void MetricsRegistry::recordOperation(OperationMetrics* metrics, qint64 durationNs,
+                                      bool failed, int rows)
+{
+    metrics->calls.add();
+    if (failed) {
+        metrics->errors.add();
+    }
+    if (rows > 0) {
+        metrics->rows.add(rows);
+    }
+    metrics->latency.record(durationNs);
+}
+
+void MetricsRegistry::recordAllocations(OperationMetrics* metrics, const AllocationStats& stats)
+{
+    metrics->allocations.add(static_cast<qint64>(stats.count));
+    metrics->allocatedBytes.add(static_cast<qint64>(stats.bytes));
+}
+
+QJsonObject MetricsRegistry::operationJson(const OperationMetrics* metrics)
+{
+    const LatencyHistogram& latency = metrics->latency;
+
+    QJsonObject json;
+    json["calls"] = metrics->calls.value();
+    json["errors"] = metrics->errors.value();
+    json["rows"] = metrics->rows.value();
+    json["p50Us"] = latency.percentile(50) / 1000.0;
+    json["p90Us"] = latency.percentile(90) / 1000.0;
+    json["p99Us"] = latency.percentile(99) / 1000.0;
+    json["maxUs"] = latency.max() / 1000.0;
+    json["meanUs"] = latency.mean() / 1000.0;
+    json["totalMs"] = static_cast<double>(latency.sum()) / 1e6;
+    if (AllocationTracker::isEnabled() && metrics->calls.value() > 0) {
+        double calls = static_cast<double>(metrics->calls.value());
+        json["allocations"] = metrics->allocations.value();
+        json["allocatedBytes"] = metrics->allocatedBytes.value();
+        json["allocationsPerCall"] = metrics->allocations.value() / calls;
+        json["bytesPerCall"] = metrics->allocatedBytes.value() / calls;
+    }
+    return json;
+}
+
+QJsonObject MetricsRegistry::snapshotJson() const
+{
+    QReadLocker locker(&m_lock);
+
+    QJsonObject operations;
+    for (auto it = m_operations.constBegin(); it != m_operations.constEnd(); ++it) {
+        operations[it.key()] = operationJson(it.value());
+    }
+
+    QJsonObject counters;
+    for (auto it = m_counters.constBegin(); it != m_counters.constEnd(); ++it) {
+        counters[it.key()] = it.value()->value();
+    }
+
+    QJsonObject gauges;
+    for (auto it = m_gauges.constBegin(); it != m_gauges.constEnd(); ++it) {
+        gauges[it.key()] = it.value()->value();
+    }
+
+    QJsonObject snapshot;
+    snapshot["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs);
+    snapshot["operations"] = operations;
+    snapshot["counters"] = counters;
+    snapshot["gauges"] = gauges;
+    return snapshot;
+}
+
+QVariantMap MetricsRegistry::snapshot() const
+{
+    return snapshotJson().toVariantMap();
+}
+
+QVariantList MetricsRegistry::hotSpots(int limit) const
+{
+    struct Entry {
+        QString name;
+        const OperationMetrics* metrics;
+        quint64 totalNs;
+    };
+
+    QList<Entry> entries;
+    {
+        QReadLocker locker(&m_lock);
+        entries.reserve(m_operations.size());
+        for (auto it = m_operations.constBegin(); it != m_operations.constEnd(); ++it) {
+            entries.append({it.key(), it.value(), it.value()->latency.sum()});
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.totalNs > b.totalNs;
+    });
+
+    QVariantList result;
+    for (int i = 0; i < entries.size() && i < limit; i++) {
+        QVariantMap item = operationJson(entries[i].metrics).toVariantMap();
+        item["name"] = entries[i].name;
+        result.append(item);
+    }
+    return result;
+}
+
+bool MetricsRegistry::dumpSnapshot(const QString& filePath) const
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(snapshotJson()).toJson(QJsonDocument::Indented));
+    return file.commit();
+}
+
+void MetricsRegistry::startPeriodicDump(const QString& filePath, int intervalMs)
+{
+    m_dumpPath = filePath;
+
+    if (!m_dumpTimer) {
+        m_dumpTimer = new QTimer(this);
+        connect(m_dumpTimer, &QTimer::timeout, this, [this]() {
+            dumpSnapshot(m_dumpPath);
+        });
+    }
+    m_dumpTimer->start(intervalMs);
+}
+
+void MetricsRegistry::stopPeriodicDump()
+{
+    if (m_dumpTimer) {
+        m_dumpTimer->stop();
+    }
+}
+
+void MetricsRegistry::reset()
+{
+    QReadLocker locker(&m_lock);
+    for (OperationMetrics* metrics : std::as_const(m_operations)) {
+        metrics->calls.reset();
+        metrics->errors.reset();
+        metrics->rows.reset();
+        metrics->latency.reset();
+        metrics->allocations.reset();
+        metrics->allocatedBytes.reset();
+    }
+    for (MetricCounter* counter : std::as_const(m_counters)) {
+        counter->reset();
+    }
+}
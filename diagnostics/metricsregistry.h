@@ -0,0 +1,99 @@
+#ifndef METRICSREGISTRY_H
+#define METRICSREGISTRY_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QVariantMap>
+#include <QVariantList>
+#include <QJsonObject>
+#include <QTimer>
+#include <atomic>
+#include "diagnostics/latencyhistogram.h"
+#include "diagnostics/allocationtracker.h"
+
+class MetricCounter
+{
+public:
+    void add(qint64 delta = 1) { m_value.fetch_add(delta, std::memory_order_relaxed); }
+    qint64 value() const { return m_value.load(std::memory_order_relaxed); }
+    void reset() { m_value.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<qint64> m_value{0};
+};
+
+class MetricGauge
+{
+public:
+    void set(qint64 value) { m_value.store(value, std::memory_order_relaxed); }
+    void add(qint64 delta) { m_value.fetch_add(delta, std::memory_order_relaxed); }
+    qint64 value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<qint64> m_value{0};
+};
+
+// Calls, errors, rows and latency for one operation (usually a
+// "Class::method" source as used by RequestScope)
+struct OperationMetrics
+{
+    MetricCounter calls;
+    MetricCounter errors;
+    MetricCounter rows;
+    LatencyHistogram latency;
+    // Only populated in NIMO_ALLOC_TRACKING builds
+    MetricCounter allocations;
+    MetricCounter allocatedBytes;
+};
+
+// Process-wide metrics. Metric objects are created on first use and live
+// until exit, so callers may cache the returned pointers; updating them is
+// lock-free. Name lookups take a shared read lock.
+class MetricsRegistry : public QObject
+{
+    Q_OBJECT
+
+public:
+    static MetricsRegistry& instance();
+
+    OperationMetrics* operation(const QString& name);
+    // Keyed on the literal's address, so it avoids building a QString
+    OperationMetrics* operation(const char* literalName);
+    MetricCounter* counter(const QString& name);
+    MetricGauge* gauge(const QString& name);
+
+    void recordOperation(OperationMetrics* metrics, qint64 durationNs,
+                         bool failed, int rows = -1);
+    void recordAllocations(OperationMetrics* metrics, const AllocationStats& stats);
+
+    QJsonObject snapshotJson() const;
+    bool dumpSnapshot(const QString& filePath) const;
+    void startPeriodicDump(const QString& filePath, int intervalMs);
+    void stopPeriodicDump();
+    void reset();
+
+    // For QML debug overlays
+    Q_INVOKABLE QVariantMap snapshot() const;
+    // Operations ordered by total time spent, largest first
+    Q_INVOKABLE QVariantList hotSpots(int limit = 10) const;
+
+private:
+    MetricsRegistry();
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    static QJsonObject operationJson(const OperationMetrics* metrics);
+
+    mutable QReadWriteLock m_lock;
+    QHash<QString, OperationMetrics*> m_operations;
+    QHash<const char*, OperationMetrics*> m_literalOperations;
+    QHash<QString, MetricCounter*> m_counters;
+    QHash<QString, MetricGauge*> m_gauges;
+
+    QTimer* m_dumpTimer;
+    QString m_dumpPath;
+};
+
+#endif // METRICSREGISTRY_H
@@ -0,0 +1,135 @@
+#include "diagnostics/startupprofiler.h"
+#include "logging/logger.h"
+#include "logging/tracer.h"
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QSysInfo>
+
+StartupProfiler& StartupProfiler::instance()
+{
+    static StartupProfiler profiler;
+    return profiler;
+}
+
+StartupProfiler::StartupProfiler()
+    : m_lastMarkNs(0)
+    , m_firstFrameNs(-1)
+    , m_budgetMs(0)
+{
+    m_clock.start();
+}
+
+void StartupProfiler::mark(const QString& phase)
+{
+    if (isFinished()) {
+        return;
+    }
+    closePhase(phase, m_clock.nsecsElapsed());
+}
+
+bool StartupProfiler::markFirstFrame()
+{
+    qint64 now = m_clock.nsecsElapsed();
+    if (!m_firstFrameNs.testAndSetOrdered(-1, now)) {
+        return false;
+    }
+    closePhase("firstFrame", now);
+    return true;
+}
+
+void StartupProfiler::closePhase(const QString& phase, qint64 nowNs)
+{
+    StartupPhase entry;
+    {
+        QMutexLocker locker(&m_mutex);
+        entry.name = phase;
+        entry.startNs = m_lastMarkNs;
+        entry.durationNs = nowNs - m_lastMarkNs;
+        m_lastMarkNs = nowNs;
+        m_phases.append(entry);
+    }
+
+    // Also shows up on the NIMO_TRACE timeline, next to the request spans
+    Tracer& tracer = Tracer::instance();
+    if (tracer.isEnabled()) {
+        TraceEvent event;
+        event.name = phase;
+        event.category = "startup";
+        event.durationNs = entry.durationNs;
+        event.startNs = tracer.nowNs() - entry.durationNs;
+        tracer.record(std::move(event));
+    }
+}
+
+QList<StartupPhase> StartupProfiler::phases() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_phases;
+}
+
+bool StartupProfiler::budgetExceeded() const
+{
+    if (m_budgetMs <= 0) {
+        return false;
+    }
+    // Not having drawn anything counts as over budget
+    qint64 firstFrame = firstFrameNs();
+    return firstFrame < 0 || firstFrame > qint64(m_budgetMs) * 1000000;
+}
+
+QJsonObject StartupProfiler::reportJson() const
+{
+    QJsonArray phaseArray;
+    for (const StartupPhase& phase : phases()) {
+        phaseArray.append(QJsonObject{
+            {"name", phase.name},
+            {"startMs", phase.startNs / 1e6},
+            {"durationMs", phase.durationNs / 1e6}
+        });
+    }
+
+    qint64 firstFrame = firstFrameNs();
+    QJsonObject report{
+        {"timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate)},
+        {"platform", QSysInfo::prettyProductName()},
+        {"firstFrameMs", firstFrame >= 0 ? QJsonValue(firstFrame / 1e6) : QJsonValue()},
+        {"phases", phaseArray}
+    };
+    if (m_budgetMs > 0) {
+        report["budgetMs"] = m_budgetMs;
+        report["withinBudget"] = !budgetExceeded();
+    }
+    return report;
+}
+
+bool StartupProfiler::writeReport(const QString& filePath) const
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(reportJson()).toJson(QJsonDocument::Indented));
+    return file.commit();
+}
+
+void StartupProfiler::logSummary() const
+{
+    QJsonObject meta;
+    for (const StartupPhase& phase : phases()) {
+        meta[phase.name] = qRound64(phase.durationNs / 1000.0) / 1000.0;
+    }
+    qint64 firstFrame = firstFrameNs();
+    meta["firstFrameMs"] = firstFrame >= 0 ? QJsonValue(firstFrame / 1e6) : QJsonValue();
+
+    Logger::instance().info("StartupProfiler", "app_start", "Startup profile", meta);
+
+    if (budgetExceeded()) {
+        Logger::instance().warn("StartupProfiler", "app_start",
+                                "Time to first frame over budget", {
+                                    {"budgetMs", m_budgetMs},
+                                    {"firstFrameMs", meta.value("firstFrameMs")}
+                                });
+    }
+}
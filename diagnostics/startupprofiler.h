@@ -0,0 +1,61 @@
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QString>
+#include <QList>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QAtomicInteger>
+
+struct StartupPhase {
+    QString name;
+    qint64 startNs = 0;     // monotonic, relative to profiler start
+    qint64 durationNs = 0;
+};
+
+// Cold-start timeline. Each mark() closes the phase that began at the
+// previous mark, so phases are recorded as sequential slices from the first
+// call to instance() (the top of main) to the first rendered frame. Marks
+// after the first frame are ignored, which keeps DatabaseManager and other
+// shared code free to mark unconditionally.
+class StartupProfiler
+{
+public:
+    static StartupProfiler& instance();
+
+    void mark(const QString& phase);
+    // Safe to call from the render thread; returns true only for the call
+    // that actually recorded the first frame
+    bool markFirstFrame();
+
+    bool isFinished() const { return m_firstFrameNs.loadAcquire() >= 0; }
+    qint64 firstFrameNs() const { return m_firstFrameNs.loadAcquire(); }
+    QList<StartupPhase> phases() const;
+
+    // Time-to-first-frame budget; 0 disables the check
+    void setBudgetMs(int budgetMs) { m_budgetMs = budgetMs; }
+    int budgetMs() const { return m_budgetMs; }
+    bool budgetExceeded() const;
+
+    QJsonObject reportJson() const;
+    bool writeReport(const QString& filePath) const;
+    // One INFO line with every phase, plus a WARN when over budget
+    void logSummary() const;
+
+private:
+    StartupProfiler();
+    StartupProfiler(const StartupProfiler&) = delete;
+    StartupProfiler& operator=(const StartupProfiler&) = delete;
+
+    void closePhase(const QString& phase, qint64 nowNs);
+
+    QElapsedTimer m_clock;
+    mutable QMutex m_mutex;
+    QList<StartupPhase> m_phases;
+    qint64 m_lastMarkNs;
+    QAtomicInteger<qint64> m_firstFrameNs;
+    int m_budgetMs;
+};
+
+#endif // STARTUPPROFILER_H
@@ -0,0 +1,148 @@
+#include "logging/asynclogwriter.h"
+#include <QMutexLocker>
+
+static constexpr int kMaxBatchSize = 1024;
+
+AsyncLogWriter::AsyncLogWriter(int capacity, int flushIntervalMs, OverflowPolicy policy,
+                               BatchSink sink, QObject *parent)
+    : QThread(parent)
+    , m_buffer(static_cast<size_t>(capacity))
+    , m_sink(std::move(sink))
+    , m_flushIntervalMs(flushIntervalMs)
+    , m_policy(policy)
+    , m_stopping(0)
+    , m_flushRequested(0)
+    , m_dropped(0)
+    , m_droppedReported(0)
+    , m_enqueued(0)
+    , m_consumed(0)
+{
+    setObjectName("AsyncLogWriter");
+}
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+    stop();
+}
+
+bool AsyncLogWriter::enqueue(LogRecord&& record, bool urgent)
+{
+    // Counted before the push, so a flush() that starts after this record
+    // is in the buffer always waits for it
+    m_enqueued.fetchAndAddOrdered(1);
+
+    if (!m_buffer.tryPush(std::move(record))) {
+        if (m_policy.loadRelaxed() == DropWhenFull) {
+            m_dropped.fetchAndAddRelaxed(1);
+            m_consumed.fetchAndAddOrdered(1);
+            return false;
+        }
+
+        // Block: keep the writer busy and retry until a slot frees up
+        do {
+            wake();
+            QThread::yieldCurrentThread();
+        } while (!m_buffer.tryPush(std::move(record)));
+    }
+
+    // Errors are written promptly; otherwise wake early only when filling up
+    if (urgent || m_buffer.sizeApprox() * 2 >= m_buffer.capacity()) {
+        wake();
+    }
+
+    return true;
+}
+
+void AsyncLogWriter::flush()
+{
+    if (!isRunning()) {
+        drain();
+        return;
+    }
+
+    // The writer may have just finished a drain that missed the newest
+    // records, so the request is repeated until they are written
+    const quint64 target = m_enqueued.loadAcquire();
+    QMutexLocker locker(&m_waitMutex);
+    while (m_consumed.loadAcquire() < target && isRunning()) {
+        m_flushRequested.storeRelease(1);
+        m_wakeup.wakeOne();
+        m_drained.wait(&m_waitMutex, 100);
+    }
+}
+
+void AsyncLogWriter::stop()
+{
+    if (!isRunning()) {
+        return;
+    }
+
+    m_stopping.storeRelease(1);
+    wake();
+    wait();
+}
+
+void AsyncLogWriter::run()
+{
+    while (!m_stopping.loadAcquire()) {
+        {
+            QMutexLocker locker(&m_waitMutex);
+            if (!m_stopping.loadAcquire() && !m_flushRequested.loadAcquire()
+                && m_buffer.sizeApprox() == 0) {
+                m_wakeup.wait(&m_waitMutex, m_flushIntervalMs.loadRelaxed());
+            }
+        }
+
+        drain();
+
+        if (m_flushRequested.loadAcquire()) {
+            QMutexLocker locker(&m_waitMutex);
+            m_flushRequested.storeRelease(0);
+            m_drained.wakeAll();
+        }
+    }
+
+    // Final drain on shutdown
+    drain();
+}
+
+void AsyncLogWriter::wake()
+{
+    // The writer tests for work and waits under m_waitMutex, so notifying
+    // under it cannot fall between the test and the wait
+    QMutexLocker locker(&m_waitMutex);
+    m_wakeup.wakeOne();
+}
+
+int AsyncLogWriter::drain()
+{
+    int total = 0;
+    QList<LogRecord> batch;
+    batch.reserve(kMaxBatchSize);
+
+    for (;;) {
+        LogRecord record;
+        while (batch.size() < kMaxBatchSize && m_buffer.tryPop(record)) {
+            batch.append(std::move(record));
+        }
+
+        quint64 dropped = m_dropped.loadRelaxed();
+        quint64 droppedSinceLast = dropped - m_droppedReported;
+
+        if (batch.isEmpty() && droppedSinceLast == 0) {
+            break;
+        }
+
+        m_droppedReported = dropped;
+        m_sink(batch, droppedSinceLast);
+        m_consumed.fetchAndAddOrdered(static_cast<quint64>(batch.size()));
+        total += batch.size();
+
+        if (batch.size() < kMaxBatchSize) {
+            break;
+        }
+        batch.clear();
+    }
+
+    return total;
+}
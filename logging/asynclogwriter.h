@@ -0,0 +1,72 @@
+#ifndef ASYNCLOGWRITER_H
+#define ASYNCLOGWRITER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInteger>
+#include <QList>
+#include <functional>
+#include "logging/logrecord.h"
+#include "logging/logringbuffer.h"
+
+// Background writer for Logger's async mode. Producers push records into a
+// lock-free ring buffer; this thread drains it in batches and hands each
+// batch to the sink, which flushes once per batch.
+class AsyncLogWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+    enum OverflowPolicy {
+        BlockWhenFull = 0,
+        DropWhenFull = 1
+    };
+
+    using BatchSink = std::function<void(const QList<LogRecord>& batch, quint64 droppedSinceLast)>;
+
+    AsyncLogWriter(int capacity, int flushIntervalMs, OverflowPolicy policy,
+                   BatchSink sink, QObject *parent = nullptr);
+    ~AsyncLogWriter();
+
+    // Called from any thread; returns false if the record was dropped
+    bool enqueue(LogRecord&& record, bool urgent);
+
+    // Drain everything queued so far and wait until it has been written
+    void flush();
+
+    // Drain and stop the thread
+    void stop();
+
+    void setFlushInterval(int ms) { m_flushIntervalMs.storeRelaxed(ms); }
+    void setOverflowPolicy(OverflowPolicy policy) { m_policy.storeRelaxed(policy); }
+    quint64 droppedCount() const { return m_dropped.loadRelaxed(); }
+    int capacity() const { return static_cast<int>(m_buffer.capacity()); }
+
+protected:
+    void run() override;
+
+private:
+    void wake();
+    int drain();
+
+    LogRingBuffer<LogRecord> m_buffer;
+    BatchSink m_sink;
+
+    QMutex m_waitMutex;
+    QWaitCondition m_wakeup;
+    QWaitCondition m_drained;
+
+    QAtomicInt m_flushIntervalMs;
+    QAtomicInt m_policy;
+    QAtomicInt m_stopping;
+    QAtomicInt m_flushRequested;
+    QAtomicInteger<quint64> m_dropped;
+    quint64 m_droppedReported;
+    // Records accepted by enqueue() and records written or dropped since;
+    // flush() waits for the second to reach the first as it saw it
+    QAtomicInteger<quint64> m_enqueued;
+    QAtomicInteger<quint64> m_consumed;
+};
+
+#endif // ASYNCLOGWRITER_H
@@ -0,0 +1,256 @@
+#include "logging/binarylogformat.h"
+#include <QCborStreamWriter>
+#include <QCborValue>
+#include <QCborMap>
+#include <QtEndian>
+
+const QByteArray BinaryLogFormat::Magic = QByteArrayLiteral("NIMOLOG");
+
+namespace
+{
+// Flush the write buffer to disk once it grows past this size
+constexpr int kPendingFlushBytes = 64 * 1024;
+}
+
+BinaryLogWriter::BinaryLogWriter()
+{
+    m_pending.reserve(kPendingFlushBytes);
+}
+
+BinaryLogWriter::~BinaryLogWriter()
+{
+    close();
+}
+
+bool BinaryLogWriter::open(const QString& filePath)
+{
+    close();
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        return false;
+    }
+
+    // Source ids are per file, so appending to an existing file starts a
+    // fresh table; redefinitions simply shadow the earlier ids
+    m_sources.clear();
+
+    if (m_file.size() == 0) {
+        m_file.write(BinaryLogFormat::Magic);
+        m_file.putChar(static_cast<char>(BinaryLogFormat::Version));
+        m_file.flush();
+    }
+
+    return true;
+}
+
+void BinaryLogWriter::close()
+{
+    if (m_file.isOpen()) {
+        flush();
+        m_file.close();
+    }
+    m_sources.clear();
+}
+
+void BinaryLogWriter::write(const LogRecord& record)
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+
+    quint32 source = sourceId(record.source);
+
+    QByteArray cbor;
+    QCborStreamWriter writer(&cbor);
+    writer.startMap(record.metadata.isEmpty() ? 6 : 7);
+    writer.append(BinaryLogFormat::KeyType);
+    writer.append(BinaryLogFormat::Entry);
+    writer.append(BinaryLogFormat::KeyTimestamp);
+    writer.append(record.timestampNs);
+    writer.append(BinaryLogFormat::KeyLevel);
+    writer.append(record.level);
+    writer.append(BinaryLogFormat::KeySource);
+    writer.append(source);
+    writer.append(BinaryLogFormat::KeyContext);
+    writer.append(record.contextId);
+    writer.append(BinaryLogFormat::KeyMessage);
+    writer.append(record.message);
+    if (!record.metadata.isEmpty()) {
+        writer.append(BinaryLogFormat::KeyMetadata);
+        QCborMap::fromJsonObject(record.metadata).toCborValue().toCbor(writer);
+    }
+    writer.endMap();
+
+    appendFrame(cbor);
+
+    if (m_pending.size() >= kPendingFlushBytes) {
+        flush();
+    }
+}
+
+void BinaryLogWriter::flush()
+{
+    if (m_file.isOpen() && !m_pending.isEmpty()) {
+        m_file.write(m_pending);
+        m_file.flush();
+    }
+    m_pending.clear();
+}
+
+quint32 BinaryLogWriter::sourceId(const QString& source)
+{
+    auto it = m_sources.constFind(source);
+    if (it != m_sources.constEnd()) {
+        return it.value();
+    }
+
+    quint32 id = static_cast<quint32>(m_sources.size());
+    m_sources.insert(source, id);
+
+    QByteArray cbor;
+    QCborStreamWriter writer(&cbor);
+    writer.startMap(3);
+    writer.append(BinaryLogFormat::KeyType);
+    writer.append(BinaryLogFormat::SourceDefinition);
+    writer.append(BinaryLogFormat::KeySourceId);
+    writer.append(id);
+    writer.append(BinaryLogFormat::KeySourceName);
+    writer.append(source);
+    writer.endMap();
+
+    appendFrame(cbor);
+    return id;
+}
+
+void BinaryLogWriter::appendFrame(const QByteArray& cbor)
+{
+    char length[4];
+    qToLittleEndian<quint32>(static_cast<quint32>(cbor.size()), length);
+    m_pending.append(length, sizeof(length));
+    m_pending.append(cbor);
+}
+
+BinaryLogReader::BinaryLogReader()
+    : m_device(nullptr)
+{
+}
+
+bool BinaryLogReader::open(const QString& filePath)
+{
+    close();
+    m_error.clear();
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_error = m_file.errorString();
+        return false;
+    }
+
+    m_device = &m_file;
+    return readHeader(filePath);
+}
+
+bool BinaryLogReader::openData(const QByteArray& data)
+{
+    close();
+    m_error.clear();
+
+    m_buffer.setData(data);
+    m_buffer.open(QIODevice::ReadOnly);
+
+    m_device = &m_buffer;
+    return readHeader("data");
+}
+
+bool BinaryLogReader::readHeader(const QString& name)
+{
+    QByteArray header = m_device->read(BinaryLogFormat::Magic.size() + 1);
+    if (!header.startsWith(BinaryLogFormat::Magic)
+        || header.size() != BinaryLogFormat::Magic.size() + 1) {
+        m_error = QString("%1 is not a binary log file").arg(name);
+        close();
+        return false;
+    }
+
+    quint8 version = static_cast<quint8>(header.at(BinaryLogFormat::Magic.size()));
+    if (version > BinaryLogFormat::Version) {
+        m_error = QString("Unsupported binary log version %1").arg(version);
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void BinaryLogReader::close()
+{
+    if (m_device && m_device->isOpen()) {
+        m_device->close();
+    }
+    m_device = nullptr;
+    m_sources.clear();
+}
+
+bool BinaryLogReader::readNext(LogRecord& record)
+{
+    QByteArray frame;
+
+    while (readFrame(frame)) {
+        QCborMap map = QCborValue::fromCbor(frame).toMap();
+        int type = static_cast<int>(map.value(BinaryLogFormat::KeyType).toInteger());
+
+        if (type == BinaryLogFormat::SourceDefinition) {
+            m_sources.insert(static_cast<quint32>(map.value(BinaryLogFormat::KeySourceId).toInteger()),
+                             map.value(BinaryLogFormat::KeySourceName).toString());
+            continue;
+        }
+
+        if (type != BinaryLogFormat::Entry) {
+            // Unknown frame types from newer writers are skipped
+            continue;
+        }
+
+        record.timestampNs = map.value(BinaryLogFormat::KeyTimestamp).toInteger();
+        record.level = static_cast<int>(map.value(BinaryLogFormat::KeyLevel).toInteger());
+        record.source = m_sources.value(static_cast<quint32>(map.value(BinaryLogFormat::KeySource).toInteger()));
+        record.contextId = map.value(BinaryLogFormat::KeyContext).toString();
+        record.message = map.value(BinaryLogFormat::KeyMessage).toString();
+        record.metadata = map.value(BinaryLogFormat::KeyMetadata).toMap().toJsonObject();
+        return true;
+    }
+
+    return false;
+}
+
+bool BinaryLogReader::readFrame(QByteArray& frame)
+{
+    if (!m_device) {
+        return false;
+    }
+
+    char length[4];
+    qint64 got = m_device->read(length, sizeof(length));
+    if (got == 0) {
+        return false;
+    }
+    if (got != sizeof(length)) {
+        // A crash mid-write can leave a torn final frame
+        m_error = "Truncated frame header";
+        return false;
+    }
+
+    quint32 size = qFromLittleEndian<quint32>(length);
+    if (size > BinaryLogFormat::MaxFrameSize) {
+        m_error = QString("Frame of %1 bytes exceeds limit").arg(size);
+        return false;
+    }
+
+    frame = m_device->read(size);
+    if (frame.size() != static_cast<int>(size)) {
+        m_error = "Truncated frame";
+        return false;
+    }
+
+    return true;
+}
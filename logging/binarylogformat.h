@@ -0,0 +1,95 @@
+#ifndef BINARYLOGFORMAT_H
+#define BINARYLOGFORMAT_H
+
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QFile>
+#include <QBuffer>
+#include "logging/logrecord.h"
+
+// Binary log files (*.nlog) are a 8-byte header ("NIMOLOG" + version)
+// followed by frames of [uint32 little-endian length][CBOR map]. Map keys
+// are small integers so a record costs a few bytes of framing:
+//
+//   source definition: {0: 1, 1: sourceId, 2: name}
+//   log entry:         {0: 2, 1: timestampNs, 2: level, 3: sourceId,
+//                       4: contextId, 5: message, 6: metadata}
+//
+// Source names are interned per file; a definition frame always precedes
+// the first entry that uses it, so every file decodes on its own.
+namespace BinaryLogFormat
+{
+enum FrameType {
+    SourceDefinition = 1,
+    Entry = 2
+};
+
+enum Key {
+    KeyType = 0,
+    KeyTimestamp = 1,
+    KeyLevel = 2,
+    KeySource = 3,
+    KeyContext = 4,
+    KeyMessage = 5,
+    KeyMetadata = 6,
+
+    // Source definition frames reuse 1 and 2 for id and name
+    KeySourceId = 1,
+    KeySourceName = 2
+};
+
+extern const QByteArray Magic;
+constexpr quint8 Version = 1;
+constexpr quint32 MaxFrameSize = 16 * 1024 * 1024;
+} // namespace BinaryLogFormat
+
+class BinaryLogWriter
+{
+public:
+    BinaryLogWriter();
+    ~BinaryLogWriter();
+
+    bool open(const QString& filePath);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+    QString fileName() const { return m_file.fileName(); }
+
+    void write(const LogRecord& record);
+    void flush();
+
+private:
+    quint32 sourceId(const QString& source);
+    void appendFrame(const QByteArray& cbor);
+
+    QFile m_file;
+    QHash<QString, quint32> m_sources;
+    QByteArray m_pending;
+};
+
+class BinaryLogReader
+{
+public:
+    BinaryLogReader();
+
+    bool open(const QString& filePath);
+    // Decode an in-memory copy, e.g. a decompressed archive
+    bool openData(const QByteArray& data);
+    void close();
+
+    // Returns false at end of file or on a corrupt frame (see errorString)
+    bool readNext(LogRecord& record);
+    QString errorString() const { return m_error; }
+
+private:
+    bool readHeader(const QString& name);
+    bool readFrame(QByteArray& frame);
+
+    QFile m_file;
+    QBuffer m_buffer;
+    QIODevice* m_device;
+    QHash<quint32, QString> m_sources;
+    QString m_error;
+};
+
+#endif // BINARYLOGFORMAT_H
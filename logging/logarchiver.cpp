@@ -0,0 +1,319 @@
+#include "logging/logarchiver.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSet>
+#include <QtEndian>
+#include <QDebug>
+#include <algorithm>
+
+namespace
+{
+const QByteArray kArchiveMagic = QByteArrayLiteral("NIMOLZ");
+constexpr char kArchiveVersion = 1;
+constexpr int kBlockSize = 256 * 1024;
+
+const QRegularExpression& logFilePattern()
+{
+    static const QRegularExpression pattern(
+        "^nimo_(\\d{4}-\\d{2}-\\d{2})\\.n?log(\\.nlz(\\.idx)?)?$");
+    return pattern;
+}
+
+const QRegularExpression& requestIdPattern()
+{
+    static const QRegularExpression pattern("req_[0-9A-Z]+");
+    return pattern;
+}
+
+QString indexPath(const QString& archivePath)
+{
+    return archivePath + ".idx";
+}
+
+// Length of the next block, ending on a line (text) or frame (binary) boundary
+qsizetype nextBlockLength(const QByteArray& data, qsizetype offset, bool binary)
+{
+    qsizetype remaining = data.size() - offset;
+    if (remaining <= kBlockSize) {
+        return remaining;
+    }
+
+    if (!binary) {
+        qsizetype newline = data.indexOf('\n', offset + kBlockSize);
+        return newline < 0 ? remaining : newline + 1 - offset;
+    }
+
+    // Binary logs: header then [uint32 LE length][payload] frames
+    qsizetype pos = offset;
+    if (offset == 0 && data.startsWith("NIMOLOG")) {
+        pos = 8;
+    }
+    while (pos - offset < kBlockSize && pos + 4 <= data.size()) {
+        quint32 frame = qFromLittleEndian<quint32>(data.constData() + pos);
+        pos += 4 + frame;
+    }
+    return qMin(pos, data.size()) - offset;
+}
+
+QJsonObject readIndex(const QString& archivePath)
+{
+    QFile file(indexPath(archivePath));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QJsonObject();
+    }
+    return QJsonDocument::fromJson(file.readAll()).object();
+}
+}
+
+LogArchiver::LogArchiver()
+{
+    // One worker keeps archival jobs ordered and off the logging threads
+    m_pool.setMaxThreadCount(1);
+}
+
+LogArchiver::~LogArchiver()
+{
+    waitForDone();
+}
+
+void LogArchiver::scheduleMaintenance(const Policy& policy)
+{
+    m_pool.start([policy]() {
+        runMaintenance(policy);
+    });
+}
+
+void LogArchiver::waitForDone()
+{
+    m_pool.waitForDone();
+}
+
+void LogArchiver::runMaintenance(const Policy& policy)
+{
+    QDir().mkpath(policy.archiveDir);
+
+    // Closed days in current/, plus uncompressed leftovers in the archive
+    QList<QFileInfo> candidates;
+    candidates += QDir(policy.currentDir).entryInfoList({"nimo_*.log", "nimo_*.nlog"}, QDir::Files);
+    candidates += QDir(policy.archiveDir).entryInfoList({"nimo_*.log", "nimo_*.nlog"}, QDir::Files);
+
+    for (const QFileInfo& info : candidates) {
+        QRegularExpressionMatch match = logFilePattern().match(info.fileName());
+        if (!match.hasMatch()) {
+            continue;
+        }
+
+        QDate fileDate = QDate::fromString(match.captured(1), "yyyy-MM-dd");
+        if (!fileDate.isValid() || fileDate >= policy.today) {
+            continue;
+        }
+
+        QString archivePath = QDir(policy.archiveDir).filePath(info.fileName() + ".nlz");
+        if (compressFile(info.absoluteFilePath(), archivePath)) {
+            QFile::remove(info.absoluteFilePath());
+        } else {
+            qWarning() << "Failed to archive log file:" << info.absoluteFilePath();
+        }
+    }
+
+    enforceRetention(policy);
+}
+
+void LogArchiver::enforceRetention(const Policy& policy)
+{
+    QDir archiveDir(policy.archiveDir);
+    QFileInfoList files = archiveDir.entryInfoList({"nimo_*"}, QDir::Files);
+
+    QDate cutoffDate = policy.today.addDays(-policy.maxDaysToKeep);
+
+    struct Entry {
+        QDate date;
+        QFileInfo info;
+    };
+    QList<Entry> kept;
+    qint64 totalBytes = 0;
+
+    for (const QFileInfo& info : files) {
+        QRegularExpressionMatch match = logFilePattern().match(info.fileName());
+        if (!match.hasMatch()) {
+            continue;
+        }
+
+        QDate fileDate = QDate::fromString(match.captured(1), "yyyy-MM-dd");
+        if (!fileDate.isValid()) {
+            continue;
+        }
+
+        if (fileDate < cutoffDate) {
+            QFile::remove(info.absoluteFilePath());
+            qDebug() << "Deleted old log file:" << info.fileName()
+                     << "Age:" << fileDate.daysTo(policy.today) << "days";
+            continue;
+        }
+
+        kept.append({fileDate, info});
+        totalBytes += info.size();
+    }
+
+    if (policy.maxTotalBytes <= 0 || totalBytes <= policy.maxTotalBytes) {
+        return;
+    }
+
+    // Over budget: drop whole days, oldest first
+    std::sort(kept.begin(), kept.end(), [](const Entry& a, const Entry& b) {
+        return a.date < b.date;
+    });
+
+    for (const Entry& entry : kept) {
+        if (totalBytes <= policy.maxTotalBytes) {
+            break;
+        }
+        if (QFile::remove(entry.info.absoluteFilePath())) {
+            totalBytes -= entry.info.size();
+            qDebug() << "Deleted log file over size budget:" << entry.info.fileName();
+        }
+    }
+}
+
+bool LogArchiver::compressFile(const QString& sourcePath, const QString& archivePath)
+{
+    QFile source(sourcePath);
+    if (!source.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QByteArray data = source.readAll();
+    source.close();
+
+    bool binary = sourcePath.endsWith(".nlog");
+
+    QSaveFile archive(archivePath);
+    if (!archive.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    archive.write(kArchiveMagic);
+    archive.putChar(kArchiveVersion);
+
+    QJsonArray blockOffsets;
+    QHash<QString, QSet<int>> requestBlocks;
+    int blockIndex = 0;
+
+    for (qsizetype offset = 0; offset < data.size(); blockIndex++) {
+        qsizetype length = nextBlockLength(data, offset, binary);
+        QByteArray raw = data.mid(offset, length);
+        QByteArray compressed = qCompress(raw, 6);
+
+        blockOffsets.append(archive.pos());
+
+        char header[8];
+        qToLittleEndian<quint32>(static_cast<quint32>(raw.size()), header);
+        qToLittleEndian<quint32>(static_cast<quint32>(compressed.size()), header + 4);
+        archive.write(header, sizeof(header));
+        archive.write(compressed);
+
+        QRegularExpressionMatchIterator it = requestIdPattern().globalMatch(QString::fromUtf8(raw));
+        while (it.hasNext()) {
+            requestBlocks[it.next().captured(0)].insert(blockIndex);
+        }
+
+        offset += length;
+    }
+
+    if (!archive.commit()) {
+        return false;
+    }
+
+    QJsonObject requests;
+    for (auto it = requestBlocks.constBegin(); it != requestBlocks.constEnd(); ++it) {
+        QList<int> blocks = it.value().values();
+        std::sort(blocks.begin(), blocks.end());
+        QJsonArray array;
+        for (int block : blocks) {
+            array.append(block);
+        }
+        requests[it.key()] = array;
+    }
+
+    QJsonObject index;
+    index["version"] = 1;
+    index["source"] = QFileInfo(sourcePath).fileName();
+    index["rawBytes"] = static_cast<qint64>(data.size());
+    index["blocks"] = blockOffsets;
+    index["requests"] = requests;
+
+    QSaveFile indexFile(indexPath(archivePath));
+    if (!indexFile.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    indexFile.write(QJsonDocument(index).toJson(QJsonDocument::Compact));
+    return indexFile.commit();
+}
+
+bool LogArchiver::archiveMayContainRequest(const QString& archivePath, const QString& requestId)
+{
+    QJsonObject index = readIndex(archivePath);
+    return index.isEmpty() || index.value("requests").toObject().contains(requestId);
+}
+
+QList<qint64> LogArchiver::blockOffsetsForRequest(const QString& archivePath, const QString& requestId)
+{
+    QJsonObject index = readIndex(archivePath);
+    QJsonArray offsets = index.value("blocks").toArray();
+
+    QList<qint64> result;
+    const QJsonArray blocks = index.value("requests").toObject().value(requestId).toArray();
+    for (const QJsonValue& block : blocks) {
+        int i = block.toInt(-1);
+        if (i >= 0 && i < offsets.size()) {
+            result.append(offsets.at(i).toInteger());
+        }
+    }
+    return result;
+}
+
+QByteArray LogArchiver::readArchive(const QString& archivePath, const QList<qint64>& blockOffsets)
+{
+    QFile archive(archivePath);
+    if (!archive.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+
+    QByteArray magic = archive.read(kArchiveMagic.size() + 1);
+    if (!magic.startsWith(kArchiveMagic)) {
+        return QByteArray();
+    }
+
+    QByteArray result;
+
+    auto readBlock = [&archive, &result]() {
+        char header[8];
+        if (archive.read(header, sizeof(header)) != sizeof(header)) {
+            return false;
+        }
+        quint32 compressedSize = qFromLittleEndian<quint32>(header + 4);
+        QByteArray compressed = archive.read(compressedSize);
+        if (compressed.size() != static_cast<qsizetype>(compressedSize)) {
+            return false;
+        }
+        result += qUncompress(compressed);
+        return true;
+    };
+
+    if (blockOffsets.isEmpty()) {
+        while (readBlock()) {
+        }
+    } else {
+        for (qint64 offset : blockOffsets) {
+            if (!archive.seek(offset) || !readBlock()) {
+                break;
+            }
+        }
+    }
+
+    return result;
+}
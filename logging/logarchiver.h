@@ -0,0 +1,53 @@
+#ifndef LOGARCHIVER_H
+#define LOGARCHIVER_H
+
+#include <QString>
+#include <QDate>
+#include <QList>
+#include <QByteArray>
+#include <QThreadPool>
+
+// Background archival of rotated log files. Logger only closes the old day
+// and opens the new one; everything else (compressing, indexing, age- and
+// size-based retention) runs here on a single worker thread.
+//
+// Archives (*.nlz) are "NIMOLZ" + version, then independent blocks of
+// [uint32 LE raw size][uint32 LE compressed size][zlib data], cut at line
+// or frame boundaries. The sidecar index (*.nlz.idx, JSON) lists block
+// offsets and, per request id, the blocks that mention it.
+class LogArchiver
+{
+public:
+    struct Policy {
+        QString currentDir;
+        QString archiveDir;
+        QDate today;
+        int maxDaysToKeep = 30;
+        qint64 maxTotalBytes = 0;   // 0 = no size limit
+    };
+
+    LogArchiver();
+    ~LogArchiver();
+
+    // Archive every closed day in currentDir and apply retention
+    void scheduleMaintenance(const Policy& policy);
+    void waitForDone();
+
+    static bool compressFile(const QString& sourcePath, const QString& archivePath);
+
+    // Index lookups; an archive without an index is treated as a match
+    static bool archiveMayContainRequest(const QString& archivePath, const QString& requestId);
+    static QList<qint64> blockOffsetsForRequest(const QString& archivePath, const QString& requestId);
+
+    // Decompress all blocks, or only those at the given offsets
+    static QByteArray readArchive(const QString& archivePath,
+                                  const QList<qint64>& blockOffsets = QList<qint64>());
+
+private:
+    static void runMaintenance(const Policy& policy);
+    static void enforceRetention(const Policy& policy);
+
+    QThreadPool m_pool;
+};
+
+#endif // LOGARCHIVER_H
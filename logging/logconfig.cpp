@@ -0,0 +1,219 @@
+#include "logging/logconfig.h"
+#include "logging/logger.h"
+#include "logging/logformat.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QStandardPaths>
+
+namespace
+{
+bool parseLevel(const QJsonValue& value, Logger::Level* level)
+{
+    int parsed = LogFormat::levelFromString(value.toString());
+    if (parsed < 0) {
+        return false;
+    }
+    *level = static_cast<Logger::Level>(parsed);
+    return true;
+}
+
+QHash<QString, Logger::Level> parseLevelMap(const QJsonObject& object, QStringList* errors)
+{
+    QHash<QString, Logger::Level> levels;
+    for (auto it = object.begin(); it != object.end(); ++it) {
+        Logger::Level level;
+        if (parseLevel(it.value(), &level)) {
+            levels.insert(it.key(), level);
+        } else {
+            errors->append(QString("Unknown level for %1").arg(it.key()));
+        }
+    }
+    return levels;
+}
+}
+
+LogConfig::LogConfig(QObject *parent)
+    : QObject(parent)
+    , m_watcher(new QFileSystemWatcher(this))
+    , m_reloadTimer(new QTimer(this))
+{
+    // Editors often write a file in several steps; apply the final state
+    m_reloadTimer->setSingleShot(true);
+    m_reloadTimer->setInterval(200);
+    connect(m_reloadTimer, &QTimer::timeout, this, &LogConfig::reload);
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, this, &LogConfig::onFileChanged);
+}
+
+bool LogConfig::load()
+{
+    m_configPath = resolveConfigPath();
+    if (m_configPath.isEmpty()) {
+        apply(QJsonObject());
+        return false;
+    }
+
+    bool ok = loadFromFile(m_configPath);
+
+    // Resources cannot be watched or edited
+    if (!m_configPath.startsWith(":")) {
+        m_watcher->addPath(m_configPath);
+    }
+    return ok;
+}
+
+bool LogConfig::loadFromFile(const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        emit configFailed(filePath, file.errorString());
+        return false;
+    }
+
+    QByteArray data = file.readAll();
+    if (data.trimmed().isEmpty()) {
+        // An empty file means "use the defaults"
+        return apply(QJsonObject());
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        QString error = parseError.error != QJsonParseError::NoError
+                            ? parseError.errorString()
+                            : QString("Root must be an object");
+        Logger::instance().warn("LogConfig::loadFromFile", "log_config",
+                                "Invalid logging config, keeping previous settings", {
+                                    {"path", filePath},
+                                    {"error", error}
+                                });
+        emit configFailed(filePath, error);
+        return false;
+    }
+
+    return apply(doc.object());
+}
+
+bool LogConfig::apply(const QJsonObject& config)
+{
+    Logger& logger = Logger::instance();
+    QStringList errors;
+
+    Logger::Level defaultLevel = Logger::INFO;
+    if (config.contains("level") && !parseLevel(config.value("level"), &defaultLevel)) {
+        errors.append("Unknown default level");
+    }
+    logger.setLogLevel(defaultLevel);
+    logger.setLevelOverrides(parseLevelMap(config.value("sources").toObject(), &errors),
+                             parseLevelMap(config.value("categories").toObject(), &errors));
+
+    QJsonObject sinks = config.value("sinks").toObject();
+    logger.setConsoleEnabled(sinks.value("console").toBool(true));
+    logger.setFileEnabled(sinks.value("file").toBool(true));
+    logger.setBinaryEnabled(sinks.value("binary").toBool(false)
+                            || qEnvironmentVariableIsSet("NIMO_LOG_BINARY"));
+
+    QJsonObject async = config.value("async").toObject();
+    logger.setAsyncEnabled(async.value("enabled").toBool(true),
+                           async.value("bufferCapacity").toInt(8192),
+                           async.value("flushIntervalMs").toInt(250),
+                           async.value("overflow").toString("drop") == "block"
+                               ? Logger::BlockWhenFull
+                               : Logger::DropWhenFull);
+
+    QJsonObject retention = config.value("retention").toObject();
+    logger.setMaxDaysToKeep(retention.value("maxDays").toInt(30));
+    logger.setMaxArchiveSize(static_cast<qint64>(retention.value("maxArchiveMB").toInt(512))
+                             * 1024 * 1024);
+
+    logger.clearSamplingRules();
+    const QJsonArray sampling = config.value("sampling").toArray();
+    for (const QJsonValue& value : sampling) {
+        QJsonObject rule = value.toObject();
+        QString source = rule.value("source").toString();
+        if (source.isEmpty()) {
+            errors.append("Sampling rule without source");
+            continue;
+        }
+        logger.setSamplingRule(source,
+                               rule.value("rate").toDouble(1.0),
+                               rule.value("maxPerSecond").toDouble(0.0),
+                               rule.value("burst").toDouble(0.0));
+    }
+    if (config.contains("suppressionSummaryMs")) {
+        logger.setSuppressionSummaryInterval(config.value("suppressionSummaryMs").toInt());
+    }
+
+    // Sections for other subsystems (slowQuery) go to their listeners
+    emit configApplied(config);
+
+    logger.info("LogConfig::apply", "log_config", "Logging configuration applied", {
+                    {"path", m_configPath},
+                    {"level", LogFormat::levelToString(defaultLevel)},
+                    {"sources", config.value("sources")},
+                    {"categories", config.value("categories")},
+                    {"warnings", QJsonArray::fromStringList(errors)}
+                });
+    return errors.isEmpty();
+}
+
+void LogConfig::onFileChanged(const QString& path)
+{
+    // Replacing the file (atomic save) drops it from the watcher
+    if (!m_watcher->files().contains(path) && QFileInfo::exists(path)) {
+        m_watcher->addPath(path);
+    }
+    m_reloadTimer->start();
+}
+
+void LogConfig::reload()
+{
+    if (!QFileInfo::exists(m_configPath)) {
+        return;
+    }
+    if (!m_watcher->files().contains(m_configPath)) {
+        m_watcher->addPath(m_configPath);
+    }
+    if (loadFromFile(m_configPath)) {
+        emit configReloaded(m_configPath);
+    }
+}
+
+QString LogConfig::resolveConfigPath()
+{
+    QString overridePath = qEnvironmentVariable("NIMO_LOG_CONFIG");
+    if (!overridePath.isEmpty()) {
+        return overridePath;
+    }
+
+    QString configDir = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
+    QString userPath = QDir(configDir).filePath("logging.json");
+    QString bundled = bundledConfigPath();
+
+    if (!QFileInfo::exists(userPath) && !bundled.isEmpty()) {
+        // Seed an editable copy; resource files come out read-only
+        QDir().mkpath(configDir);
+        if (QFile::copy(bundled, userPath)) {
+            QFile::setPermissions(userPath, QFile::ReadOwner | QFile::WriteOwner);
+        }
+    }
+
+    return QFileInfo::exists(userPath) ? userPath : bundled;
+}
+
+QString LogConfig::bundledConfigPath()
+{
+    // The QML module's resource prefix depends on the Qt policy in use
+    const QStringList candidates = {
+        ":/qt/qml/Nimo/config/logging.json",
+        ":/Nimo/config/logging.json"
+    };
+    for (const QString& candidate : candidates) {
+        if (QFile::exists(candidate)) {
+            return candidate;
+        }
+    }
+    return QString();
+}
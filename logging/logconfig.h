@@ -0,0 +1,50 @@
+#ifndef LOGCONFIG_H
+#define LOGCONFIG_H
+
+#include <QObject>
+#include <QString>
+#include <QJsonObject>
+#include <QFileSystemWatcher>
+#include <QTimer>
+
+// Loads logging settings from JSON and applies them to Logger, then keeps
+// watching the file so levels can be changed on a running instance.
+//
+// Lookup order: $NIMO_LOG_CONFIG, then logging.json in the app config
+// directory, then the defaults bundled from config/logging.json. The app
+// config copy is created from the bundled defaults on first run.
+class LogConfig : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LogConfig(QObject *parent = nullptr);
+
+    // Load, apply and start watching; returns false if the file was invalid
+    bool load();
+    bool loadFromFile(const QString& filePath);
+    bool apply(const QJsonObject& config);
+
+    QString configPath() const { return m_configPath; }
+
+signals:
+    // The whole document, for settings outside the logger; also emitted
+    // with an empty object when the defaults apply
+    void configApplied(const QJsonObject& config);
+    void configReloaded(const QString& path);
+    void configFailed(const QString& path, const QString& error);
+
+private slots:
+    void onFileChanged(const QString& path);
+    void reload();
+
+private:
+    static QString resolveConfigPath();
+    static QString bundledConfigPath();
+
+    QString m_configPath;
+    QFileSystemWatcher* m_watcher;
+    QTimer* m_reloadTimer;
+};
+
+#endif // LOGCONFIG_H
@@ -0,0 +1,116 @@
+#include "logging/logformat.h"
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QRegularExpression>
+#include <chrono>
+
+namespace LogFormat
+{
+
+qint64 currentTimestampNs()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+QString formatRecord(const LogRecord& record)
+{
+    QString fullMessage = formatLogLine(record.level, record.timestampNs,
+                                        record.source, record.contextId, record.message);
+
+    if (!record.metadata.isEmpty()) {
+        fullMessage += "\n" + formatMetadata(record.metadata);
+    }
+
+    return fullMessage;
+}
+
+QString formatLogLine(int level, qint64 timestampNs, const QString& source,
+                      const QString& contextId, const QString& message)
+{
+    return QString("[%1] [%2] [%3] [%4] > %5")
+    .arg(formatTimestamp(timestampNs))
+        .arg(levelToString(level))
+        .arg(source)
+        .arg(contextId)
+        .arg(message);
+}
+
+QString formatMetadata(const QJsonObject& metadata)
+{
+    QJsonDocument doc(metadata);
+    return QString::fromUtf8(doc.toJson(QJsonDocument::Compact));
+}
+
+QString formatTimestamp(qint64 timestampNs)
+{
+    QDateTime timestamp = QDateTime::fromMSecsSinceEpoch(timestampNs / 1000000, Qt::UTC);
+    return timestamp.toString("yyyy-MM-ddTHH:mm:ss.zzz") + "Z";
+}
+
+QString levelToString(int level)
+{
+    switch (level) {
+    case 0: return "DEBUG";
+    case 1: return "INFO";
+    case 2: return "WARN";
+    case 3: return "ERROR";
+    case 4: return "FATAL";
+    default: return "UNKNOWN";
+    }
+}
+
+int levelFromString(const QString& name)
+{
+    QString upper = name.trimmed().toUpper();
+    if (upper == "DEBUG") return 0;
+    if (upper == "INFO") return 1;
+    if (upper == "WARN" || upper == "WARNING") return 2;
+    if (upper == "ERROR") return 3;
+    if (upper == "FATAL") return 4;
+    return -1;
+}
+
+bool parseLogLine(const QString& line, LogRecord* record)
+{
+    // The message is everything after "> ", brackets included
+    static const QRegularExpression pattern(
+        "^\\[([^\\]]*)\\] \\[([A-Z]+)\\] \\[(.*?)\\] \\[([^\\]]*)\\] > (.*)$",
+        QRegularExpression::DotMatchesEverythingOption);
+
+    QRegularExpressionMatch match = pattern.match(line);
+    if (!match.hasMatch()) {
+        return false;
+    }
+
+    QDateTime timestamp = QDateTime::fromString(match.captured(1), Qt::ISODateWithMs);
+    int level = levelFromString(match.captured(2));
+    if (!timestamp.isValid() || level < 0) {
+        return false;
+    }
+
+    record->level = level;
+    record->timestampNs = timestamp.toMSecsSinceEpoch() * 1000000;
+    record->source = match.captured(3);
+    record->contextId = match.captured(4);
+    record->message = match.captured(5);
+    record->metadata = QJsonObject();
+    return true;
+}
+
+QJsonObject toJson(const LogRecord& record)
+{
+    QJsonObject object;
+    object["timestamp"] = formatTimestamp(record.timestampNs);
+    object["timestampNs"] = QString::number(record.timestampNs);
+    object["level"] = levelToString(record.level);
+    object["source"] = record.source;
+    object["contextId"] = record.contextId;
+    object["message"] = record.message;
+    if (!record.metadata.isEmpty()) {
+        object["metadata"] = record.metadata;
+    }
+    return object;
+}
+
+} // namespace LogFormat
@@ -0,0 +1,31 @@
+#ifndef LOGFORMAT_H
+#define LOGFORMAT_H
+
+#include <QString>
+#include <QJsonObject>
+#include "logging/logrecord.h"
+
+// Text rendering of log records, shared by Logger and nimo-logcat so both
+// produce byte-identical lines.
+namespace LogFormat
+{
+
+qint64 currentTimestampNs();
+
+QString formatRecord(const LogRecord& record);
+QString formatLogLine(int level, qint64 timestampNs, const QString& source,
+                      const QString& contextId, const QString& message);
+QString formatMetadata(const QJsonObject& metadata);
+QString formatTimestamp(qint64 timestampNs);
+QString levelToString(int level);
+int levelFromString(const QString& name);
+// Inverse of formatLogLine(); timestamps come back at millisecond precision.
+// The metadata line, if any, is not part of it.
+bool parseLogLine(const QString& line, LogRecord* record);
+
+// One compact JSON object per record, as emitted by "nimo-logcat --json"
+QJsonObject toJson(const LogRecord& record);
+
+} // namespace LogFormat
+
+#endif // LOGFORMAT_H
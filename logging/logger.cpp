@@ -1,11 +1,16 @@
 #include "logging/logger.h"
+#include "logging/asynclogwriter.h"
+#include "logging/binarylogformat.h"
+#include "logging/logformat.h"
+#include "logging/logarchiver.h"
 #include <QDir>
 #include <QFileInfo>
 #include <QJsonDocument>
+#include <QJsonArray>
 #include <QDebug>
 #include <QCoreApplication>
 #include <QStandardPaths>
-#include <QRegularExpression>
+#include <QMetaMethod>
 
 Logger& Logger::instance()
 {
@@ -16,11 +21,19 @@ Logger& Logger::instance()
 Logger::Logger()
     : QObject(nullptr)
     , m_minLevel(INFO)
+    , m_defaultLevel(INFO)
+    , m_levelTable(nullptr)
     , m_consoleEnabled(true)
     , m_fileEnabled(true)
+    , m_binaryEnabled(false)
     , m_maxDaysToKeep(30)
+    , m_maxArchiveBytes(512LL * 1024 * 1024)
+    , m_nextRotationMs(0)
     , m_currentLogFile(nullptr)
     , m_fileStream(nullptr)
+    , m_binaryWriter(nullptr)
+    , m_archiver(new LogArchiver())
+    , m_asyncWriter(nullptr)
 {
     // Set default log directory: AppData/Local/Nimo/logs/
     QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
@@ -32,22 +45,77 @@ Logger::Logger()
     QDir().mkpath(m_currentLogDir);
     QDir().mkpath(m_oldLogsDir);
 
-    // Open today's log file
-    QString today = QDate::currentDate().toString("yyyy-MM-dd");
-    m_lastRotationDate = today;
-    QString logFilePath = QDir(m_currentLogDir).filePath(QString("nimo_%1.log").arg(today));
-    openNewLogFile(logFilePath);
+    // Open today's log file; this also archives days left over from earlier runs
+    rotateLogFiles();
 }
 
 Logger::~Logger()
 {
+    shutdown();
+    qDeleteAll(m_retiredWriters);
     closeCurrentLogFile();
+    delete m_binaryWriter;
+    delete m_archiver;
+    delete m_levelTable.loadAcquire();
+    qDeleteAll(m_retiredLevelTables);
 }
 
 void Logger::setLogLevel(Level minLevel)
 {
     QMutexLocker locker(&m_mutex);
-    m_minLevel = minLevel;
+    m_defaultLevel = minLevel;
+
+    const LogLevelTable* current = m_levelTable.loadAcquire();
+    if (!current) {
+        m_minLevel.storeRelaxed(minLevel);
+        return;
+    }
+
+    LogLevelTable* table = new LogLevelTable(*current);
+    table->defaultLevel = minLevel;
+    publishLevelTable(table);
+}
+
+void Logger::setLevelOverrides(const QHash<QString, Level>& sources,
+                               const QHash<QString, Level>& categories)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (sources.isEmpty() && categories.isEmpty()) {
+        publishLevelTable(nullptr);
+        return;
+    }
+
+    LogLevelTable* table = new LogLevelTable();
+    table->defaultLevel = m_defaultLevel;
+    for (auto it = sources.constBegin(); it != sources.constEnd(); ++it) {
+        table->sources.insert(it.key(), it.value());
+    }
+    for (auto it = categories.constBegin(); it != categories.constEnd(); ++it) {
+        table->categories.insert(it.key(), it.value());
+    }
+    publishLevelTable(table);
+}
+
+void Logger::publishLevelTable(LogLevelTable* table)
+{
+    // The global gate is the lowest level anything may log at
+    int minLevel = m_defaultLevel;
+    if (table) {
+        for (int level : std::as_const(table->sources)) {
+            minLevel = qMin(minLevel, level);
+        }
+        for (int level : std::as_const(table->categories)) {
+            minLevel = qMin(minLevel, level);
+        }
+    }
+
+    // Readers may still hold the old table, so it is retired, not deleted
+    const LogLevelTable* previous = m_levelTable.fetchAndStoreAcquire(table);
+    if (previous) {
+        m_retiredLevelTables.append(previous);
+    }
+    m_minLevel.storeRelaxed(minLevel);
 }
 
 void Logger::setConsoleEnabled(bool enabled)
@@ -62,6 +130,26 @@ void Logger::setFileEnabled(bool enabled)
     m_fileEnabled = enabled;
 }
 
+void Logger::setBinaryEnabled(bool enabled)
+{
+    QMutexLocker locker(&m_mutex);
+    m_binaryEnabled = enabled;
+
+    if (enabled && !m_binaryWriter) {
+        m_binaryWriter = new BinaryLogWriter();
+        openBinaryLogFile(m_lastRotationDate);
+    } else if (!enabled && m_binaryWriter) {
+        delete m_binaryWriter;
+        m_binaryWriter = nullptr;
+    }
+}
+
+void Logger::setMaxArchiveSize(qint64 bytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maxArchiveBytes = bytes;
+}
+
 void Logger::setLogDirectory(const QString& dir)
 {
     QMutexLocker locker(&m_mutex);
@@ -82,30 +170,225 @@ void Logger::setMaxDaysToKeep(int days)
 void Logger::log(Level level, const QString& source, const QString& contextId,
                  const QString& message, const QJsonObject& metadata)
 {
+    if (!isEnabled(level, source)) {
+        return;
+    }
+
+    if (m_sampler.hasRules()) {
+        bool keep = m_sampler.shouldLog(level, source, contextId);
+        checkSuppressionSummary();
+        if (!keep) {
+            return;
+        }
+    }
+
+    emitRecord(level, source, contextId, message, metadata);
+}
+
+void Logger::emitRecord(Level level, const QString& source, const QString& contextId,
+                        const QString& message, const QJsonObject& metadata)
+{
+    LogRecord record;
+    record.level = level;
+    record.timestampNs = LogFormat::currentTimestampNs();
+    record.source = source;
+    record.contextId = contextId;
+    record.message = message;
+    record.metadata = metadata;
+
+    if (AsyncLogWriter* writer = m_asyncWriter.loadAcquire()) {
+        writer->enqueue(std::move(record), level >= ERROR);
+        return;
+    }
+
     QMutexLocker locker(&m_mutex);
+    writeRecord(record);
+}
+
+void Logger::setSamplingRule(const QString& source, double sampleRate,
+                             double maxPerSecond, double burst)
+{
+    LogSampler::Rule rule;
+    rule.sampleRate = sampleRate;
+    rule.maxPerSecond = maxPerSecond;
+    rule.burst = burst;
+    m_sampler.setRule(source, rule);
+}
+
+void Logger::clearSamplingRules()
+{
+    m_sampler.clearRules();
+}
+
+void Logger::setSuppressionSummaryInterval(int ms)
+{
+    m_sampler.setSummaryInterval(ms);
+}
+
+bool Logger::admitRequest(const QString& source, const QString& requestId, int records)
+{
+    if (!m_sampler.hasRules()) {
+        return true;
+    }
+    bool admitted = m_sampler.admit(source, requestId, records);
+    checkSuppressionSummary();
+    return admitted;
+}
+
+void Logger::checkSuppressionSummary()
+{
+    if (m_sampler.hasSuppressed() && m_sampler.summaryDue(QDateTime::currentMSecsSinceEpoch())) {
+        logSuppressionSummary();
+    }
+}
 
-    if (level < m_minLevel) {
+void Logger::logSuppressionSummary()
+{
+    QHash<QString, quint64> suppressed = m_sampler.takeSuppressed();
+    if (suppressed.isEmpty()) {
         return;
     }
 
-    checkDailyRotation();
+    quint64 total = 0;
+    QJsonObject bySource;
+    for (auto it = suppressed.constBegin(); it != suppressed.constEnd(); ++it) {
+        bySource[it.key()] = static_cast<qint64>(it.value());
+        total += it.value();
+    }
+
+    // The counts are gone once taken, so the summary skips the level and
+    // sampling gates that could drop it
+    emitRecord(WARN, "Logger::sampler", "logger",
+               QString("Suppressed %1 records").arg(total),
+               {{"suppressed", bySource}, {"total", static_cast<qint64>(total)}});
+}
+
+void Logger::setAsyncEnabled(bool enabled, int bufferCapacity,
+                             int flushIntervalMs, OverflowPolicy policy)
+{
+    AsyncLogWriter* current = m_asyncWriter.loadAcquire();
+
+    if (enabled && current && current->capacity() >= bufferCapacity) {
+        current->setFlushInterval(flushIntervalMs);
+        current->setOverflowPolicy(static_cast<AsyncLogWriter::OverflowPolicy>(policy));
+        return;
+    }
 
-    QString logLine = formatLogLine(level, source, contextId, message);
-    QString fullMessage = logLine;
+    // Stop routing new records to the old writer before draining it. A caller
+    // may still hold the old pointer, so it is retired rather than deleted.
+    m_asyncWriter.storeRelease(nullptr);
+    if (current) {
+        current->stop();
+        m_retiredWriters.append(current);
+    }
 
-    if (!metadata.isEmpty()) {
-        fullMessage += "\n" + formatMetadata(metadata);
+    if (!enabled) {
+        return;
     }
 
+    AsyncLogWriter* writer = new AsyncLogWriter(
+        bufferCapacity, flushIntervalMs,
+        static_cast<AsyncLogWriter::OverflowPolicy>(policy),
+        [this](const QList<LogRecord>& batch, quint64 droppedSinceLast) {
+            writeBatch(batch, droppedSinceLast);
+        });
+    writer->start(QThread::LowPriority);
+    m_asyncWriter.storeRelease(writer);
+}
+
+bool Logger::isAsyncEnabled() const
+{
+    return m_asyncWriter.loadAcquire() != nullptr;
+}
+
+quint64 Logger::droppedRecordCount() const
+{
+    AsyncLogWriter* writer = m_asyncWriter.loadAcquire();
+    return writer ? writer->droppedCount() : 0;
+}
+
+void Logger::flush()
+{
+    if (AsyncLogWriter* writer = m_asyncWriter.loadAcquire()) {
+        writer->flush();
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (m_fileStream) {
+        m_fileStream->flush();
+    }
+    if (m_binaryWriter) {
+        m_binaryWriter->flush();
+    }
+}
+
+void Logger::shutdown()
+{
+    logSuppressionSummary();
+    setAsyncEnabled(false);
+    flush();
+}
+
+void Logger::writeRecord(const LogRecord& record, bool flush)
+{
+    checkDailyRotation(record.timestampNs / 1000000);
+
+    if (m_binaryWriter) {
+        m_binaryWriter->write(record);
+        if (flush) {
+            m_binaryWriter->flush();
+        }
+    }
+
+    // Text formatting is the expensive part; skip it when nothing reads it
+    static const QMetaMethod logEmittedSignal = QMetaMethod::fromSignal(&Logger::logEmitted);
+    bool emitSignal = isSignalConnected(logEmittedSignal);
+    if (!m_consoleEnabled && !m_fileEnabled && !emitSignal) {
+        return;
+    }
+
+    QString fullMessage = LogFormat::formatRecord(record);
+
     if (m_consoleEnabled) {
         writeToConsole(fullMessage);
     }
 
     if (m_fileEnabled) {
-        writeToFile(fullMessage);
+        writeToFile(fullMessage, flush);
+    }
+
+    if (emitSignal) {
+        emit logEmitted(static_cast<Level>(record.level), fullMessage);
+    }
+}
+
+void Logger::writeBatch(const QList<LogRecord>& batch, quint64 droppedSinceLast)
+{
+    QMutexLocker locker(&m_mutex);
+
+    for (const LogRecord& record : batch) {
+        writeRecord(record, false);
+    }
+
+    if (droppedSinceLast > 0) {
+        LogRecord notice;
+        notice.level = WARN;
+        notice.timestampNs = LogFormat::currentTimestampNs();
+        notice.source = "Logger::writeBatch";
+        notice.contextId = "logger";
+        notice.message = QString("Dropped %1 log records (buffer full)").arg(droppedSinceLast);
+        notice.metadata = QJsonObject{{"dropped", static_cast<qint64>(droppedSinceLast)}};
+        writeRecord(notice, false);
     }
 
-    emit logEmitted(level, fullMessage);
+    // One flush per batch instead of one per line
+    if (m_fileStream) {
+        m_fileStream->flush();
+    }
+    if (m_binaryWriter) {
+        m_binaryWriter->flush();
+    }
 }
 
 void Logger::debug(const QString& source, const QString& contextId,
@@ -140,15 +423,24 @@ void Logger::fatal(const QString& source, const QString& contextId,
 
 void Logger::logRequest(const QString& source, const QString& requestId,
                         const QString& operation, const QString& entity,
-                        const QJsonObject& params)
+                        const QJsonObject& params,
+                        const QString& parentRequestId)
 {
+    if (!isEnabled(INFO, source)) {
+        return;
+    }
+
     QJsonObject metadata;
     metadata["requestId"] = requestId;
     metadata["operation"] = operation;
     metadata["entity"] = entity;
     metadata["params"] = params;
+    if (!parentRequestId.isEmpty()) {
+        metadata["parentRequestId"] = parentRequestId;
+    }
 
-    log(INFO, source, requestId, "[Request]", metadata);
+    // Sampling was decided once for the scope by admitRequest()
+    emitRecord(INFO, source, requestId, "[Request]", metadata);
 }
 
 void Logger::logResponse(const QString& source, const QString& requestId,
@@ -156,6 +448,10 @@ void Logger::logResponse(const QString& source, const QString& requestId,
                          qint64 durationMs, bool success,
                          const QJsonObject& result)
 {
+    if (!isEnabled(INFO, source)) {
+        return;
+    }
+
     QJsonObject metadata;
     metadata["requestId"] = requestId;
     metadata["operation"] = operation;
@@ -168,7 +464,7 @@ void Logger::logResponse(const QString& source, const QString& requestId,
     }
 
     QString message = QString("[Response]: status=%1").arg(success ? "success" : "failed");
-    log(INFO, source, requestId, message, metadata);
+    emitRecord(INFO, source, requestId, message, metadata);
 }
 
 void Logger::logError(const QString& source, const QString& requestId,
@@ -230,6 +526,10 @@ void Logger::logTransactionEnd(const QString& transactionId,
 void Logger::logQuery(const QString& source, const QString& requestId,
                       const QString& sql, const QVariantList& bindValues)
 {
+    if (!isEnabled(DEBUG, source)) {
+        return;
+    }
+
     QJsonObject metadata;
     metadata["requestId"] = requestId;
     metadata["sql"] = sql;
@@ -243,77 +543,49 @@ void Logger::logQuery(const QString& source, const QString& requestId,
     log(DEBUG, source, requestId, "Executing SQL", metadata);
 }
 
-QString Logger::formatLogLine(Level level, const QString& source,
-                              const QString& contextId, const QString& message)
-{
-    return QString("[%1] [%2] [%3] [%4] > %5")
-    .arg(getCurrentTimestamp())
-        .arg(levelToString(level))
-        .arg(source)
-        .arg(contextId)
-        .arg(message);
-}
-
-QString Logger::formatMetadata(const QJsonObject& metadata)
-{
-    QJsonDocument doc(metadata);
-    return QString::fromUtf8(doc.toJson(QJsonDocument::Compact));
-}
-
-QString Logger::getCurrentTimestamp()
-{
-    return QDateTime::currentDateTimeUtc().toString("yyyy-MM-ddTHH:mm:ss.zzz") + "Z";
-}
-
-QString Logger::levelToString(Level level)
-{
-    switch (level) {
-    case DEBUG: return "DEBUG";
-    case INFO:  return "INFO";
-    case WARN:  return "WARN";
-    case ERROR: return "ERROR";
-    case FATAL: return "FATAL";
-    default:    return "UNKNOWN";
-    }
-}
-
 void Logger::writeToConsole(const QString& message)
 {
     qDebug().noquote() << message;
 }
 
-void Logger::writeToFile(const QString& message)
+void Logger::writeToFile(const QString& message, bool flush)
 {
     if (m_fileStream) {
         *m_fileStream << message << "\n";
-        m_fileStream->flush();
+        if (flush) {
+            m_fileStream->flush();
+        }
     }
 }
 
-void Logger::checkDailyRotation()
+void Logger::checkDailyRotation(qint64 timestampMs)
 {
-    QString today = QDate::currentDate().toString("yyyy-MM-dd");
-
-    if (m_lastRotationDate != today) {
-        rotateLogFileIfNeeded();
-        m_lastRotationDate = today;
+    // Compared against the record's own timestamp, so no date work per record
+    if (timestampMs >= m_nextRotationMs) {
+        rotateLogFiles();
     }
 }
 
-void Logger::rotateLogFileIfNeeded()
+void Logger::rotateLogFiles()
 {
-    QString today = QDate::currentDate().toString("yyyy-MM-dd");
-    QString expectedFileName = QString("nimo_%1.log").arg(today);
-    QString currentLogPath = QDir(m_currentLogDir).filePath(expectedFileName);
+    QDate today = QDate::currentDate();
+    QString todayString = today.toString("yyyy-MM-dd");
+    m_nextRotationMs = QDateTime(today.addDays(1), QTime(0, 0)).toMSecsSinceEpoch();
+
+    if (m_lastRotationDate == todayString && m_currentLogFile) {
+        return;
+    }
+    m_lastRotationDate = todayString;
 
-    if (m_currentLogFile && m_currentLogFile->fileName() != currentLogPath) {
-        closeCurrentLogFile();
-        moveCurrentLogToArchive();
-        openNewLogFile(currentLogPath);
-        cleanupOldLogs();
-    } else if (!m_currentLogFile) {
-        openNewLogFile(currentLogPath);
+    // Only close and reopen here; archiving runs on the archiver's thread
+    closeCurrentLogFile();
+    openNewLogFile(QDir(m_currentLogDir).filePath(QString("nimo_%1.log").arg(todayString)));
+    if (m_binaryWriter) {
+        m_binaryWriter->close();
+        openBinaryLogFile(todayString);
     }
+
+    scheduleArchiveMaintenance();
 }
 
 void Logger::closeCurrentLogFile()
@@ -325,21 +597,20 @@ void Logger::closeCurrentLogFile()
     }
     if (m_currentLogFile) {
         m_currentLogFile->close();
+        delete m_currentLogFile;
+        m_currentLogFile = nullptr;
     }
 }
 
-void Logger::moveCurrentLogToArchive()
+void Logger::scheduleArchiveMaintenance()
 {
-    if (!m_currentLogFile) return;
-
-    QString sourceFile = m_currentLogFile->fileName();
-    QString fileName = QFileInfo(sourceFile).fileName();
-    QString destFile = QDir(m_oldLogsDir).filePath(fileName);
-
-    delete m_currentLogFile;
-    m_currentLogFile = nullptr;
-
-    QFile::rename(sourceFile, destFile);
+    LogArchiver::Policy policy;
+    policy.currentDir = m_currentLogDir;
+    policy.archiveDir = m_oldLogsDir;
+    policy.today = QDate::fromString(m_lastRotationDate, "yyyy-MM-dd");
+    policy.maxDaysToKeep = m_maxDaysToKeep;
+    policy.maxTotalBytes = m_maxArchiveBytes;
+    m_archiver->scheduleMaintenance(policy);
 }
 
 void Logger::openNewLogFile(const QString& filePath)
@@ -354,7 +625,7 @@ void Logger::openNewLogFile(const QString& filePath)
     }
 
     m_fileStream = new QTextStream(m_currentLogFile);
-    m_fileStream->setCodec("UTF-8");
+    m_fileStream->setEncoding(QStringConverter::Utf8);
 
     *m_fileStream << "=== Log started at "
                   << QDateTime::currentDateTime().toString(Qt::ISODate)
@@ -362,31 +633,10 @@ void Logger::openNewLogFile(const QString& filePath)
     m_fileStream->flush();
 }
 
-void Logger::cleanupOldLogs()
+void Logger::openBinaryLogFile(const QString& date)
 {
-    QDir oldLogsDir(m_oldLogsDir);
-    QStringList filters;
-    filters << "nimo_*.log";
-
-    QFileInfoList files = oldLogsDir.entryInfoList(filters, QDir::Files, QDir::Time | QDir::Reversed);
-
-    QDate cutoffDate = QDate::currentDate().addDays(-m_maxDaysToKeep);
-
-    for (const QFileInfo& fileInfo : files) {
-        QString fileName = fileInfo.fileName();
-        QRegularExpression datePattern("nimo_(\\d{4}-\\d{2}-\\d{2})\\.log");
-        QRegularExpressionMatch match = datePattern.match(fileName);
-
-        if (match.hasMatch()) {
-            QString dateStr = match.captured(1);
-            QDate fileDate = QDate::fromString(dateStr, "yyyy-MM-dd");
-
-            if (fileDate.isValid() && fileDate < cutoffDate) {
-                QFile::remove(fileInfo.absoluteFilePath());
-
-                qDebug() << "Deleted old log file:" << fileName
-                         << "Age:" << fileDate.daysTo(QDate::currentDate()) << "days";
-            }
-        }
+    QString filePath = QDir(m_currentLogDir).filePath(QString("nimo_%1.nlog").arg(date));
+    if (!m_binaryWriter->open(filePath)) {
+        qCritical() << "Failed to open binary log file:" << filePath;
     }
 }
@@ -6,9 +6,48 @@
 #include <QFile>
 #include <QTextStream>
 #include <QMutex>
+#include <QAtomicInt>
+#include <QAtomicPointer>
 #include <QJsonObject>
 #include <QDateTime>
 #include <QDate>
+#include <QHash>
+#include "logging/logrecord.h"
+#include "logging/logsampler.h"
+
+// Compile-time minimum level. Release builds raise it so that LOG_* macros
+// below the floor compile away entirely.
+#ifndef NIMO_LOG_MIN_LEVEL
+#define NIMO_LOG_MIN_LEVEL 0
+#endif
+
+class AsyncLogWriter;
+
+// Per-source minimum levels. A source "Class::method" matches an exact
+// entry first, then its category (the class part before "::").
+struct LogLevelTable {
+    int defaultLevel = 1;
+    QHash<QString, int> sources;
+    QHash<QString, int> categories;
+
+    int levelFor(const QString& source) const
+    {
+        auto exact = sources.constFind(source);
+        if (exact != sources.constEnd()) {
+            return exact.value();
+        }
+        int separator = source.indexOf(QLatin1String("::"));
+        if (separator > 0) {
+            auto category = categories.constFind(source.left(separator));
+            if (category != categories.constEnd()) {
+                return category.value();
+            }
+        }
+        return defaultLevel;
+    }
+};
+class BinaryLogWriter;
+class LogArchiver;
 
 class Logger : public QObject
 {
@@ -24,15 +63,62 @@ public:
     };
     Q_ENUM(Level)
 
+    enum OverflowPolicy {
+        BlockWhenFull = 0,
+        DropWhenFull = 1
+    };
+    Q_ENUM(OverflowPolicy)
+
     // Singleton access
     static Logger& instance();
 
     // Configuration
     void setLogLevel(Level minLevel);
+    bool isEnabled(Level level) const
+    {
+        return level >= NIMO_LOG_MIN_LEVEL && level >= m_minLevel.loadRelaxed();
+    }
+    // Also applies per-source overrides; the global check above stays the
+    // cheap gate and passes whenever any override could enable the record
+    bool isEnabled(Level level, const QString& source) const
+    {
+        if (!isEnabled(level)) {
+            return false;
+        }
+        const LogLevelTable* table = m_levelTable.loadAcquire();
+        return !table || level >= table->levelFor(source);
+    }
+    // Replaces all per-source and per-category overrides
+    void setLevelOverrides(const QHash<QString, Level>& sources,
+                           const QHash<QString, Level>& categories);
     void setConsoleEnabled(bool enabled);
     void setFileEnabled(bool enabled);
+    // Compact CBOR sink (nimo_YYYY-MM-DD.nlog), decoded with nimo-logcat
+    void setBinaryEnabled(bool enabled);
     void setLogDirectory(const QString& dir);
     void setMaxDaysToKeep(int days);
+    // Total size budget for compressed archives; oldest days go first
+    void setMaxArchiveSize(qint64 bytes);
+
+    // Sampling and rate limiting below WARN; see LogSampler. Suppressed
+    // records are reported in a periodic "Suppressed N records" summary.
+    void setSamplingRule(const QString& source, double sampleRate,
+                         double maxPerSecond = 0.0, double burst = 0.0);
+    void clearSamplingRules();
+    void setSuppressionSummaryInterval(int ms);
+    // Decides once per request scope whether its records are kept.
+    // logRequest() and logResponse() are not sampled again afterwards.
+    bool admitRequest(const QString& source, const QString& requestId, int records = 2);
+
+    // Async mode: callers enqueue records, a background thread writes them
+    void setAsyncEnabled(bool enabled,
+                         int bufferCapacity = 8192,
+                         int flushIntervalMs = 250,
+                         OverflowPolicy policy = DropWhenFull);
+    bool isAsyncEnabled() const;
+    quint64 droppedRecordCount() const;
+    void flush();
+    void shutdown();
 
     // Main logging interface
     void log(Level level,
@@ -56,7 +142,8 @@ public:
     // Request/Response logging helpers
     void logRequest(const QString& source, const QString& requestId,
                     const QString& operation, const QString& entity,
-                    const QJsonObject& params);
+                    const QJsonObject& params,
+                    const QString& parentRequestId = QString());
 
     void logResponse(const QString& source, const QString& requestId,
                      const QString& operation, const QString& entity,
@@ -91,33 +178,50 @@ private:
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
 
-    QString formatLogLine(Level level, const QString& source,
-                          const QString& contextId, const QString& message);
-    QString formatMetadata(const QJsonObject& metadata);
-    QString getCurrentTimestamp();
-    QString levelToString(Level level);
+    // Everything after the level and sampling checks
+    void emitRecord(Level level, const QString& source, const QString& contextId,
+                    const QString& message, const QJsonObject& metadata);
+    void writeRecord(const LogRecord& record, bool flush = true);
+    void checkSuppressionSummary();
+    void logSuppressionSummary();
+    void writeBatch(const QList<LogRecord>& batch, quint64 droppedSinceLast);
 
     void writeToConsole(const QString& message);
-    void writeToFile(const QString& message);
-    void checkDailyRotation();
-    void rotateLogFileIfNeeded();
+    void writeToFile(const QString& message, bool flush = true);
+    void checkDailyRotation(qint64 timestampMs);
+    void rotateLogFiles();
     void closeCurrentLogFile();
-    void moveCurrentLogToArchive();
+    void scheduleArchiveMaintenance();
     void openNewLogFile(const QString& filePath);
-    void cleanupOldLogs();
+    void openBinaryLogFile(const QString& date);
 
-    Level m_minLevel;
+    void publishLevelTable(LogLevelTable* table);
+
+    QAtomicInt m_minLevel;
+    int m_defaultLevel;
+    QAtomicPointer<const LogLevelTable> m_levelTable;
+    QList<const LogLevelTable*> m_retiredLevelTables;
     bool m_consoleEnabled;
     bool m_fileEnabled;
+    bool m_binaryEnabled;
     QString m_logDirectory;
     QString m_currentLogDir;
     QString m_oldLogsDir;
     int m_maxDaysToKeep;
     QString m_lastRotationDate;
+    qint64 m_maxArchiveBytes;
+    qint64 m_nextRotationMs;
 
     QFile* m_currentLogFile;
     QTextStream* m_fileStream;
+    BinaryLogWriter* m_binaryWriter;
+    LogArchiver* m_archiver;
     QMutex m_mutex;
+
+    LogSampler m_sampler;
+
+    QAtomicPointer<AsyncLogWriter> m_asyncWriter;
+    QList<AsyncLogWriter*> m_retiredWriters;
 };
 
 #endif // LOGGER_H
@@ -4,46 +4,101 @@
 #include "logger.h"
 #include "requestcontext.h"
 
+// "bool ScoreRepository::upsert(const DailyScore&)" -> "ScoreRepository::upsert",
+// the Class::method form RequestScope sources and logging.json overrides use
+inline QString logMacroSourceFromSignature(const char* signature)
+{
+    QString source = QString::fromLatin1(signature);
+    int end = source.indexOf('(');
+    if (end >= 0) {
+        source.truncate(end);
+    }
+    source = source.mid(source.lastIndexOf(' ') + 1);
+    while (source.startsWith('*') || source.startsWith('&')) {
+        source.remove(0, 1);
+    }
+    // Drop enclosing namespaces, keep class and method
+    int method = source.lastIndexOf(QLatin1String("::"));
+    if (method > 0) {
+        int owner = source.lastIndexOf(QLatin1String("::"), method - 1);
+        if (owner >= 0) {
+            source = source.mid(owner + 2);
+        }
+    }
+    return source;
+}
+
 // Helper to get source location
-#define LOG_SOURCE QString("%1::%2").arg(__FILE__).arg(__FUNCTION__)
+#define LOG_SOURCE logMacroSourceFromSignature(Q_FUNC_INFO)
+
+// Level gate: constant-folded against NIMO_LOG_MIN_LEVEL, then one runtime
+// branch. Arguments of a disabled macro are never evaluated.
+#define LOG_ENABLED(level) \
+    ((level) >= NIMO_LOG_MIN_LEVEL && Logger::instance().isEnabled(level))
+
+#define LOG_IF_ENABLED(level, statement) \
+    do { if (LOG_ENABLED(level)) { statement; } } while (0)
+
+// As LOG_IF_ENABLED, with the calling function's source in logMacroSource.
+// The signature is parsed once per call site, on its first enabled call.
+#define LOG_IF_ENABLED_AT_SOURCE(level, statement) \
+    do { \
+        if (LOG_ENABLED(level)) { \
+            static const QString logMacroSource = LOG_SOURCE; \
+            statement; \
+        } \
+    } while (0)
 
 // Basic logging macros
 #define LOG_DEBUG(contextId, message, ...) \
-Logger::instance().debug(LOG_SOURCE, contextId, message, ##__VA_ARGS__)
+    LOG_IF_ENABLED_AT_SOURCE(Logger::DEBUG, Logger::instance().debug(logMacroSource, contextId, message, ##__VA_ARGS__))
 
 #define LOG_INFO(contextId, message, ...) \
-    Logger::instance().info(LOG_SOURCE, contextId, message, ##__VA_ARGS__)
+    LOG_IF_ENABLED_AT_SOURCE(Logger::INFO, Logger::instance().info(logMacroSource, contextId, message, ##__VA_ARGS__))
 
 #define LOG_WARN(contextId, message, ...) \
-    Logger::instance().warn(LOG_SOURCE, contextId, message, ##__VA_ARGS__)
+    LOG_IF_ENABLED_AT_SOURCE(Logger::WARN, Logger::instance().warn(logMacroSource, contextId, message, ##__VA_ARGS__))
 
 #define LOG_ERROR(contextId, message, ...) \
-    Logger::instance().error(LOG_SOURCE, contextId, message, ##__VA_ARGS__)
+    LOG_IF_ENABLED_AT_SOURCE(Logger::ERROR, Logger::instance().error(logMacroSource, contextId, message, ##__VA_ARGS__))
 
 #define LOG_FATAL(contextId, message, ...) \
-    Logger::instance().fatal(LOG_SOURCE, contextId, message, ##__VA_ARGS__)
+    LOG_IF_ENABLED_AT_SOURCE(Logger::FATAL, Logger::instance().fatal(logMacroSource, contextId, message, ##__VA_ARGS__))
 
 // Request/Response macros
-#define LOG_REQUEST(requestId, operation, entity, params) \
-    Logger::instance().logRequest(LOG_SOURCE, requestId, operation, entity, params)
+#define LOG_REQUEST(requestId, operation, entity, ...) \
+    LOG_IF_ENABLED_AT_SOURCE(Logger::INFO, Logger::instance().logRequest(logMacroSource, requestId, operation, entity, \
+                                                                         QJsonObject __VA_ARGS__))
 
-#define LOG_RESPONSE(requestId, operation, entity, duration, success, result) \
-    Logger::instance().logResponse(LOG_SOURCE, requestId, operation, entity, \
-                     duration, success, result)
+#define LOG_RESPONSE(requestId, operation, entity, duration, success, ...) \
+    LOG_IF_ENABLED_AT_SOURCE(Logger::INFO, Logger::instance().logResponse(logMacroSource, requestId, operation, entity, \
+                                                                          duration, success, QJsonObject __VA_ARGS__))
 
 #define LOG_ERROR_DETAILS(requestId, operation, entity, errorMsg, errorCode, duration, stack) \
-    Logger::instance().logError(LOG_SOURCE, requestId, operation, entity, \
-                  errorMsg, errorCode, duration, stack)
+    LOG_IF_ENABLED_AT_SOURCE(Logger::ERROR, Logger::instance().logError(logMacroSource, requestId, operation, entity, \
+                                                                        errorMsg, errorCode, duration, stack))
 
-#define LOG_QUERY(requestId, sql, bindValues) \
-    Logger::instance().logQuery(LOG_SOURCE, requestId, sql, bindValues)
+// Logged under the scope's source, so a "ScoreRepository" or
+// "ScoreRepository::upsertDailyScore" DEBUG override enables that SQL. Bind
+// values are variadic so brace lists with several values survive the
+// preprocessor: LOG_QUERY(scope, sql, {a, b, c})
+#define LOG_QUERY(scope, sql, ...) \
+    do { \
+        if (LOG_ENABLED(Logger::DEBUG)) { \
+            const QString logQuerySource = (scope).source(); \
+            if (Logger::instance().isEnabled(Logger::DEBUG, logQuerySource)) { \
+                Logger::instance().logQuery(logQuerySource, (scope).requestId(), sql, \
+                                            QVariantList __VA_ARGS__); \
+            } \
+        } \
+    } while (0)
 
 // Transaction macros
 #define LOG_TXN_START(transactionId, initiatedBy, requestId) \
-    Logger::instance().logTransactionStart(transactionId, initiatedBy, requestId)
+    LOG_IF_ENABLED(Logger::INFO, Logger::instance().logTransactionStart(transactionId, initiatedBy, requestId))
 
 #define LOG_TXN_END(transactionId, requestId, duration, committed, operations) \
-    Logger::instance().logTransactionEnd(transactionId, requestId, duration, \
-                           committed, operations)
+    LOG_IF_ENABLED(Logger::INFO, Logger::instance().logTransactionEnd(transactionId, requestId, duration, \
+                                                                      committed, operations))
 
 #endif // LOGGERMACROS_H
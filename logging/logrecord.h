@@ -0,0 +1,19 @@
+#ifndef LOGRECORD_H
+#define LOGRECORD_H
+
+#include <QString>
+#include <QJsonObject>
+
+// A single log entry as captured on the calling thread. Fields are
+// implicitly shared Qt types, so moving a record through the async buffer
+// never deep-copies strings or metadata.
+struct LogRecord {
+    int level = 0;
+    qint64 timestampNs = 0;  // UTC, nanoseconds since the Unix epoch
+    QString source;
+    QString contextId;
+    QString message;
+    QJsonObject metadata;
+};
+
+#endif // LOGRECORD_H
@@ -0,0 +1,110 @@
+#ifndef LOGRINGBUFFER_H
+#define LOGRINGBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// Bounded lock-free multi-producer / single-consumer ring buffer.
+//
+// Each slot carries a sequence number: producers claim a position with a
+// CAS on the enqueue cursor and publish by bumping the slot sequence; the
+// single consumer reads slots in order and hands them back by advancing the
+// sequence by one lap. Capacity is rounded up to a power of two.
+template <typename T>
+class LogRingBuffer
+{
+public:
+    explicit LogRingBuffer(size_t capacity)
+        : m_capacity(roundUpToPowerOfTwo(capacity < 2 ? 2 : capacity))
+        , m_mask(m_capacity - 1)
+        , m_slots(new Slot[m_capacity])
+        , m_enqueuePos(0)
+        , m_dequeuePos(0)
+    {
+        for (size_t i = 0; i < m_capacity; ++i) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    LogRingBuffer(const LogRingBuffer&) = delete;
+    LogRingBuffer& operator=(const LogRingBuffer&) = delete;
+
+    // Returns false when the buffer is full
+    bool tryPush(T&& value)
+    {
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = m_slots[pos & m_mask];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = std::move(value);
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Single consumer only
+    bool tryPop(T& value)
+    {
+        size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        Slot& slot = m_slots[pos & m_mask];
+        size_t seq = slot.sequence.load(std::memory_order_acquire);
+
+        if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0) {
+            return false;
+        }
+
+        value = std::move(slot.value);
+        slot.value = T();
+        slot.sequence.store(pos + m_capacity, std::memory_order_release);
+        m_dequeuePos.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Approximate; only meaningful as a hint
+    size_t sizeApprox() const
+    {
+        size_t enqueued = m_enqueuePos.load(std::memory_order_relaxed);
+        size_t dequeued = m_dequeuePos.load(std::memory_order_relaxed);
+        return enqueued >= dequeued ? enqueued - dequeued : 0;
+    }
+
+    size_t capacity() const { return m_capacity; }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static size_t roundUpToPowerOfTwo(size_t value)
+    {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t m_capacity;
+    const size_t m_mask;
+    std::unique_ptr<Slot[]> m_slots;
+
+    // Separate cache lines for the producer and consumer cursors
+    alignas(64) std::atomic<size_t> m_enqueuePos;
+    alignas(64) std::atomic<size_t> m_dequeuePos;
+};
+
+#endif // LOGRINGBUFFER_H
@@ -0,0 +1,189 @@
+#include "logging/logsampler.h"
+#include <QDateTime>
+
+namespace
+{
+// Records at or above this level (WARN) are never sampled
+constexpr int kAlwaysKeepLevel = 2;
+}
+
+LogSampler::Bucket::Bucket(const Rule& bucketRule)
+    : rule(bucketRule)
+    , tokens(bucketRule.burst)
+    , lastRefillMs(QDateTime::currentMSecsSinceEpoch())
+{
+}
+
+bool LogSampler::Bucket::take()
+{
+    QMutexLocker locker(&mutex);
+
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    double elapsedSec = (now - lastRefillMs) / 1000.0;
+    tokens = qMin(rule.burst, tokens + elapsedSec * rule.maxPerSecond);
+    lastRefillMs = now;
+
+    if (tokens < 1.0) {
+        return false;
+    }
+    tokens -= 1.0;
+    return true;
+}
+
+LogSampler::LogSampler()
+    : m_table(nullptr)
+    , m_hasSuppressed(0)
+    , m_summaryIntervalMs(10000)
+    , m_lastSummaryMs(QDateTime::currentMSecsSinceEpoch())
+{
+}
+
+LogSampler::~LogSampler()
+{
+    delete m_table.loadAcquire();
+    qDeleteAll(m_retiredTables);
+    qDeleteAll(m_allBuckets);
+}
+
+void LogSampler::setRule(const QString& source, const Rule& rule)
+{
+    QMutexLocker locker(&m_configMutex);
+
+    Rule bucketRule = rule;
+    if (bucketRule.maxPerSecond > 0.0 && bucketRule.burst <= 0.0) {
+        bucketRule.burst = bucketRule.maxPerSecond;
+    }
+    Bucket* bucket = new Bucket(bucketRule);
+    m_allBuckets.append(bucket);
+
+    // Other sources keep their buckets, and with them their tokens
+    const RuleTable* current = m_table.loadAcquire();
+    RuleTable* table = current ? new RuleTable(*current) : new RuleTable();
+    table->buckets.insert(source, bucket);
+    publish(table);
+}
+
+void LogSampler::removeRule(const QString& source)
+{
+    QMutexLocker locker(&m_configMutex);
+
+    const RuleTable* current = m_table.loadAcquire();
+    if (!current || !current->buckets.contains(source)) {
+        return;
+    }
+    RuleTable* table = new RuleTable(*current);
+    table->buckets.remove(source);
+    if (table->buckets.isEmpty()) {
+        delete table;
+        table = nullptr;
+    }
+    publish(table);
+}
+
+void LogSampler::clearRules()
+{
+    QMutexLocker locker(&m_configMutex);
+    publish(nullptr);
+}
+
+void LogSampler::publish(RuleTable* table)
+{
+    const RuleTable* previous = m_table.fetchAndStoreAcquire(table);
+    if (previous) {
+        m_retiredTables.append(previous);
+    }
+}
+
+bool LogSampler::shouldLog(int level, const QString& source, const QString& contextId)
+{
+    if (level >= kAlwaysKeepLevel) {
+        return true;
+    }
+
+    Bucket* bucket = findBucket(m_table.loadAcquire(), source);
+    if (!bucket || keep(bucket, contextId)) {
+        return true;
+    }
+
+    countSuppressed(source, 1);
+    return false;
+}
+
+bool LogSampler::admit(const QString& source, const QString& contextId, int records)
+{
+    Bucket* bucket = findBucket(m_table.loadAcquire(), source);
+    if (!bucket || keep(bucket, contextId)) {
+        return true;
+    }
+
+    countSuppressed(source, static_cast<quint64>(records));
+    return false;
+}
+
+void LogSampler::countSuppressed(const QString& source, quint64 count)
+{
+    QMutexLocker locker(&m_suppressedMutex);
+    m_suppressed[source] += count;
+    m_hasSuppressed.storeRelaxed(1);
+}
+
+bool LogSampler::summaryDue(qint64 nowMs)
+{
+    qint64 last = m_lastSummaryMs.loadRelaxed();
+    if (nowMs - last < m_summaryIntervalMs.loadRelaxed()) {
+        return false;
+    }
+    // Only the thread that advances the timestamp emits the summary
+    return m_lastSummaryMs.testAndSetRelaxed(last, nowMs);
+}
+
+QHash<QString, quint64> LogSampler::takeSuppressed()
+{
+    QMutexLocker locker(&m_suppressedMutex);
+    QHash<QString, quint64> suppressed;
+    suppressed.swap(m_suppressed);
+    m_hasSuppressed.storeRelaxed(0);
+    return suppressed;
+}
+
+LogSampler::Bucket* LogSampler::findBucket(const RuleTable* table, const QString& source)
+{
+    if (!table) {
+        return nullptr;
+    }
+
+    auto it = table->buckets.constFind(source);
+    if (it != table->buckets.constEnd()) {
+        return it.value();
+    }
+
+    int separator = source.indexOf(QLatin1String("::"));
+    if (separator > 0) {
+        it = table->buckets.constFind(source.left(separator));
+        if (it != table->buckets.constEnd()) {
+            return it.value();
+        }
+    }
+    return nullptr;
+}
+
+bool LogSampler::keep(Bucket* bucket, const QString& contextId)
+{
+    if (!hashSampled(contextId, bucket->rule.sampleRate)) {
+        return false;
+    }
+    return bucket->rule.maxPerSecond <= 0.0 || bucket->take();
+}
+
+bool LogSampler::hashSampled(const QString& contextId, double sampleRate)
+{
+    if (sampleRate >= 1.0) {
+        return true;
+    }
+    if (sampleRate <= 0.0) {
+        return false;
+    }
+    // Fixed seed so the decision is stable across threads and processes
+    size_t hash = qHash(contextId, 0x9e3779b9u);
+    return static_cast<double>(hash % 10000) < sampleRate * 10000.0;
+}
@@ -0,0 +1,95 @@
+#ifndef LOGSAMPLER_H
+#define LOGSAMPLER_H
+
+#include <QString>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QAtomicPointer>
+
+// Per-source sampling and rate limiting for records below WARN. A rule
+// matches a full source ("ScoreRepository::upsertDailyScore") or a class
+// ("ScoreRepository"), the exact source taking precedence.
+//
+// Sampling hashes the context id; the token bucket then caps what survives
+// sampling. A request scope is decided once through admit(), so its
+// [Request] and [Response] records are kept or dropped together. Dropped
+// records are counted per source and reported through takeSuppressed().
+//
+// Rules are published as an immutable table swapped atomically, like
+// Logger's level table: a source without a rule costs one hash lookup and
+// takes no lock. Only a rate-limited bucket locks, and only its own mutex.
+class LogSampler
+{
+public:
+    struct Rule {
+        double sampleRate = 1.0;     // fraction of contexts kept, 0..1
+        double maxPerSecond = 0.0;   // token refill rate, 0 = unlimited
+        double burst = 0.0;          // bucket size, defaults to maxPerSecond
+    };
+
+    LogSampler();
+    ~LogSampler();
+
+    void setRule(const QString& source, const Rule& rule);
+    void removeRule(const QString& source);
+    void clearRules();
+    bool hasRules() const { return m_table.loadRelaxed() != nullptr; }
+
+    // Decides whether a record is written; counts it as suppressed if not
+    bool shouldLog(int level, const QString& source, const QString& contextId);
+
+    // Decides once for a whole request scope, consuming at most one token;
+    // a rejected scope counts its records as suppressed
+    bool admit(const QString& source, const QString& contextId, int records);
+
+    void countSuppressed(const QString& source, quint64 count);
+    bool hasSuppressed() const { return m_hasSuppressed.loadRelaxed() != 0; }
+
+    // Returns true at most once per interval, to the caller that should
+    // emit the summary
+    bool summaryDue(qint64 nowMs);
+    void setSummaryInterval(int ms) { m_summaryIntervalMs.storeRelaxed(ms); }
+
+    QHash<QString, quint64> takeSuppressed();
+
+private:
+    struct Bucket {
+        explicit Bucket(const Rule& bucketRule);
+
+        // Refills, then consumes one token if there is one
+        bool take();
+
+        const Rule rule;
+        QMutex mutex;
+        double tokens;
+        qint64 lastRefillMs;
+    };
+
+    struct RuleTable {
+        QHash<QString, Bucket*> buckets;
+    };
+
+    static Bucket* findBucket(const RuleTable* table, const QString& source);
+    static bool keep(Bucket* bucket, const QString& contextId);
+    static bool hashSampled(const QString& contextId, double sampleRate);
+    void publish(RuleTable* table);
+
+    // Serializes rule changes; readers only load m_table
+    QMutex m_configMutex;
+    QAtomicPointer<const RuleTable> m_table;
+    // Readers may still hold a replaced table or bucket, so both are kept
+    // until the sampler goes away; rules change rarely
+    QList<const RuleTable*> m_retiredTables;
+    QList<Bucket*> m_allBuckets;
+
+    QMutex m_suppressedMutex;
+    QHash<QString, quint64> m_suppressed;
+    QAtomicInt m_hasSuppressed;
+    QAtomicInt m_summaryIntervalMs;
+    QAtomicInteger<qint64> m_lastSummaryMs;
+};
+
+#endif // LOGSAMPLER_H
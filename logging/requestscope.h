@@ -3,9 +3,12 @@
 
 #include "logging/requestcontext.h"
 #include "logging/logger.h"
+#include "logging/tracer.h"
+#include "diagnostics/metricsregistry.h"
+#include "diagnostics/allocationtracker.h"
 #include <QString>
 #include <QJsonObject>
-#include <QDateTime>
+#include <QElapsedTimer>
 
 class RequestScope
 {
@@ -13,51 +16,182 @@ public:
     explicit RequestScope(const QString& source,
                           const QString& operation,
                           const QJsonObject& params = QJsonObject())
-        : m_requestId(RequestContext::generate()),
-        m_source(source),
+        : m_source(source),
         m_operation(operation),
-        m_startTime(QDateTime::currentMSecsSinceEpoch()),
-        m_logged(false)
+        m_span(source, "request"),
+        m_logged(false),
+        m_verbose(Logger::instance().isEnabled(Logger::INFO, source))
     {
-        RequestContext::setCurrent(m_requestId);
-        Logger::instance().logRequest(m_source, m_requestId, m_operation,
-                                      QString(), params);
+        m_timer.start();
+
+        // With INFO disabled only errors are logged, so the id is made lazily
+        if (m_verbose) {
+            m_parentRequestId = RequestContext::current();
+            m_requestId = RequestContext::generate();
+            m_ownsContext = true;
+            RequestContext::setCurrent(m_requestId);
+            m_span.setRequestId(m_requestId);
+
+            // A sampled-out request still logs errors, just not request/response
+            m_verbose = Logger::instance().admitRequest(m_source, m_requestId);
+            if (m_verbose) {
+                Logger::instance().logRequest(m_source, m_requestId, m_operation,
+                                              QString(), params, m_parentRequestId);
+            }
+        }
     }
 
     ~RequestScope()
     {
-        qint64 duration = QDateTime::currentMSecsSinceEpoch() - m_startTime;
-        if (!m_logged) {
-            Logger::instance().logResponse(m_source, m_requestId, m_operation,
-                                           QString(), duration, true, QJsonObject());
+        if (!m_logged && m_verbose) {
+            logResponse(QJsonObject());
+        }
+        MetricsRegistry& metrics = MetricsRegistry::instance();
+        OperationMetrics* operation = metrics.operation(m_source);
+        metrics.recordOperation(operation, m_timer.nsecsElapsed(), m_failed, m_rows);
+        if (AllocationTracker::isEnabled()) {
+            metrics.recordAllocations(operation, m_allocations.elapsed());
+        }
+        // Nested scopes hand the context back to the enclosing request
+        if (m_ownsContext) {
+            RequestContext::setCurrent(m_parentRequestId);
         }
-        RequestContext::clear();
     }
 
-    QString requestId() const { return m_requestId; }
+    QString requestId() const
+    {
+        if (m_requestId.isEmpty()) {
+            m_requestId = RequestContext::generate();
+        }
+        return m_requestId;
+    }
+
+    QString parentRequestId() const { return m_parentRequestId; }
+    QString source() const { return m_source; }
 
     void logSuccess(const QJsonObject& result = QJsonObject())
     {
-        qint64 duration = QDateTime::currentMSecsSinceEpoch() - m_startTime;
-        Logger::instance().logResponse(m_source, m_requestId, m_operation,
-                                       QString(), duration, true, result);
         m_logged = true;
+        m_rows = result.value("count").toInt(-1);
+        if (!m_verbose) {
+            return;
+        }
+        logResponse(result);
     }
 
     void logError(const QString& errorMessage, const QString& errorCode = QString())
     {
-        qint64 duration = QDateTime::currentMSecsSinceEpoch() - m_startTime;
-        Logger::instance().logError(m_source, m_requestId, m_operation,
-                                    QString(), errorMessage, errorCode, duration);
+        Logger::instance().logError(m_source, requestId(), m_operation,
+                                    QString(), errorMessage, errorCode,
+                                    m_timer.elapsed());
         m_logged = true;
+        m_failed = true;
     }
 
 private:
-    QString m_requestId;
+    void logResponse(QJsonObject result)
+    {
+        // Millisecond resolution hides most repository calls
+        result["durationUs"] = m_timer.nsecsElapsed() / 1000;
+        if (AllocationTracker::isEnabled()) {
+            AllocationStats allocations = m_allocations.elapsed();
+            result["allocations"] = static_cast<qint64>(allocations.count);
+            result["allocatedBytes"] = static_cast<qint64>(allocations.bytes);
+        }
+        Logger::instance().logResponse(m_source, m_requestId, m_operation,
+                                       QString(), m_timer.elapsed(), true, result);
+    }
+
+    mutable QString m_requestId;
+    QString m_parentRequestId;
     QString m_source;
     QString m_operation;
-    qint64 m_startTime;
+    TraceSpan m_span;
+    QElapsedTimer m_timer;
+    AllocationScope m_allocations;
     bool m_logged;
+    bool m_verbose;
+    bool m_ownsContext = false;
+    bool m_failed = false;
+    int m_rows = -1;
+};
+
+// Lightweight scope for hot read paths: takes string literals, builds no
+// params and logs nothing on success unless DEBUG is enabled. Errors are
+// always logged. With logging disabled it costs one level check plus the
+// metrics update.
+class LightRequestScope
+{
+public:
+    LightRequestScope(const char* source, const char* operation)
+        : m_source(source),
+        m_operation(operation),
+        m_span(source, "repository"),
+        m_verbose(Logger::instance().isEnabled(Logger::DEBUG)
+                  && Logger::instance().isEnabled(Logger::DEBUG, QString::fromLatin1(source)))
+    {
+        m_timer.start();
+    }
+
+    ~LightRequestScope()
+    {
+        MetricsRegistry& metrics = MetricsRegistry::instance();
+        OperationMetrics* operation = metrics.operation(m_source);
+        metrics.recordOperation(operation, m_timer.nsecsElapsed(), m_failed, m_rows);
+        if (AllocationTracker::isEnabled()) {
+            metrics.recordAllocations(operation, m_allocations.elapsed());
+        }
+    }
+
+    QString requestId() const
+    {
+        if (m_requestId.isEmpty()) {
+            m_requestId = RequestContext::generate();
+        }
+        return m_requestId;
+    }
+
+    QString source() const { return QString::fromLatin1(m_source); }
+
+    void logSuccess(int rows = -1)
+    {
+        m_rows = rows;
+        if (!m_verbose || !Logger::instance().admitRequest(QString::fromLatin1(m_source), requestId(), 1)) {
+            return;
+        }
+        QJsonObject result;
+        if (rows >= 0) {
+            result["count"] = rows;
+        }
+        result["durationUs"] = m_timer.nsecsElapsed() / 1000;
+        if (AllocationTracker::isEnabled()) {
+            AllocationStats allocations = m_allocations.elapsed();
+            result["allocations"] = static_cast<qint64>(allocations.count);
+            result["allocatedBytes"] = static_cast<qint64>(allocations.bytes);
+        }
+        Logger::instance().logResponse(QString::fromLatin1(m_source), requestId(),
+                                       QString::fromLatin1(m_operation), QString(),
+                                       m_timer.elapsed(), true, result);
+    }
+
+    void logError(const QString& errorMessage, const QString& errorCode = QString())
+    {
+        m_failed = true;
+        Logger::instance().logError(QString::fromLatin1(m_source), requestId(),
+                                    QString::fromLatin1(m_operation), QString(),
+                                    errorMessage, errorCode, m_timer.elapsed());
+    }
+
+private:
+    const char* m_source;
+    const char* m_operation;
+    TraceSpan m_span;
+    bool m_verbose;
+    QElapsedTimer m_timer;
+    AllocationScope m_allocations;
+    mutable QString m_requestId;
+    bool m_failed = false;
+    int m_rows = -1;
 };
 
 #endif // REQUESTSCOPE_H
@@ -0,0 +1,176 @@
+#include "logging/tracer.h"
+#include <QSaveFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QAtomicInteger>
+#include <QCoreApplication>
+
+namespace
+{
+thread_local quint64 t_currentSpanId = 0;
+thread_local quint32 t_threadIndex = 0;
+
+QAtomicInteger<quint64> s_spanCounter(0);
+QAtomicInteger<quint32> s_threadCounter(0);
+}
+
+Tracer& Tracer::instance()
+{
+    static Tracer instance;
+    return instance;
+}
+
+Tracer::Tracer()
+    : m_enabled(0)
+    , m_dropped(0)
+    , m_maxEvents(200000)
+{
+    m_clock.start();
+}
+
+void Tracer::setEnabled(bool enabled)
+{
+    m_enabled.storeRelaxed(enabled ? 1 : 0);
+}
+
+void Tracer::setMaxEvents(int maxEvents)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maxEvents = maxEvents;
+}
+
+quint64 Tracer::currentSpanId()
+{
+    return t_currentSpanId;
+}
+
+quint64 Tracer::nextSpanId()
+{
+    return s_spanCounter.fetchAndAddRelaxed(1) + 1;
+}
+
+quint32 Tracer::currentThreadIndex()
+{
+    if (t_threadIndex == 0) {
+        t_threadIndex = s_threadCounter.fetchAndAddRelaxed(1) + 1;
+    }
+    return t_threadIndex;
+}
+
+void Tracer::record(TraceEvent&& event)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_events.size() >= m_maxEvents) {
+        m_dropped.fetchAndAddRelaxed(1);
+        return;
+    }
+    m_events.append(std::move(event));
+}
+
+QList<TraceEvent> Tracer::events() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_events;
+}
+
+void Tracer::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_events.clear();
+    m_dropped.storeRelaxed(0);
+}
+
+bool Tracer::exportChromeTrace(const QString& filePath) const
+{
+    QList<TraceEvent> snapshot = events();
+
+    QJsonArray traceEvents;
+    for (const TraceEvent& event : snapshot) {
+        QJsonObject args;
+        args["spanId"] = QString::number(event.spanId);
+        if (event.parentId != 0) {
+            args["parentId"] = QString::number(event.parentId);
+        }
+        if (!event.requestId.isEmpty()) {
+            args["requestId"] = event.requestId;
+        }
+        args["durationNs"] = event.durationNs;
+
+        // Complete ("X") events; Chrome expects microseconds
+        QJsonObject json;
+        json["name"] = event.name;
+        json["cat"] = event.category;
+        json["ph"] = "X";
+        json["ts"] = event.startNs / 1000.0;
+        json["dur"] = event.durationNs / 1000.0;
+        json["pid"] = static_cast<qint64>(QCoreApplication::applicationPid());
+        json["tid"] = static_cast<qint64>(event.threadId);
+        json["args"] = args;
+        traceEvents.append(json);
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = traceEvents;
+    root["displayTimeUnit"] = "ns";
+    root["otherData"] = QJsonObject{{"droppedEvents", droppedEvents()}};
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+TraceSpan::TraceSpan(const char* name, const char* category)
+    : m_literalName(name)
+{
+    begin(category);
+}
+
+TraceSpan::TraceSpan(const QString& name, const char* category)
+    : m_literalName(nullptr)
+{
+    if (Tracer::instance().isEnabled()) {
+        m_name = name;
+    }
+    begin(category);
+}
+
+void TraceSpan::begin(const char* category)
+{
+    m_category = category;
+    m_spanId = 0;
+    m_parentId = t_currentSpanId;
+    m_startNs = 0;
+
+    if (!Tracer::instance().isEnabled()) {
+        return;
+    }
+
+    m_spanId = Tracer::nextSpanId();
+    m_startNs = Tracer::instance().nowNs();
+    t_currentSpanId = m_spanId;
+}
+
+TraceSpan::~TraceSpan()
+{
+    if (m_spanId == 0) {
+        return;
+    }
+
+    Tracer& tracer = Tracer::instance();
+    t_currentSpanId = m_parentId;
+
+    TraceEvent event;
+    event.name = m_literalName ? QString::fromLatin1(m_literalName) : m_name;
+    event.category = QString::fromLatin1(m_category);
+    event.requestId = m_requestId;
+    event.spanId = m_spanId;
+    event.parentId = m_parentId;
+    event.threadId = Tracer::currentThreadIndex();
+    event.startNs = m_startNs;
+    event.durationNs = tracer.nowNs() - m_startNs;
+    tracer.record(std::move(event));
+}
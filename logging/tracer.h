@@ -0,0 +1,95 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QString>
+#include <QList>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+
+struct TraceEvent {
+    QString name;
+    QString category;
+    QString requestId;
+    quint64 spanId = 0;
+    quint64 parentId = 0;
+    quint32 threadId = 0;
+    qint64 startNs = 0;     // monotonic, relative to tracer start
+    qint64 durationNs = 0;
+};
+
+// Collects completed spans in memory and exports them as Chrome trace-event
+// JSON (load in chrome://tracing or ui.perfetto.dev). Disabled by default;
+// a disabled tracer costs one atomic load per span.
+class Tracer
+{
+public:
+    static Tracer& instance();
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled.loadRelaxed() != 0; }
+    void setMaxEvents(int maxEvents);
+
+    // Monotonic nanoseconds since the tracer was created
+    qint64 nowNs() const { return m_clock.nsecsElapsed(); }
+
+    // Span id of the innermost open span on the calling thread (0 if none)
+    static quint64 currentSpanId();
+
+    void record(TraceEvent&& event);
+    QList<TraceEvent> events() const;
+    int droppedEvents() const { return m_dropped.loadRelaxed(); }
+    void clear();
+
+    bool exportChromeTrace(const QString& filePath) const;
+
+private:
+    Tracer();
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    friend class TraceSpan;
+    static quint64 nextSpanId();
+    static quint32 currentThreadIndex();
+
+    QElapsedTimer m_clock;
+    QAtomicInt m_enabled;
+    QAtomicInt m_dropped;
+    int m_maxEvents;
+    mutable QMutex m_mutex;
+    QList<TraceEvent> m_events;
+};
+
+// RAII span. The constructor pushes onto the calling thread's span stack
+// and the destructor pops it, so nesting follows the C++ scopes.
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char* name, const char* category = "app");
+    explicit TraceSpan(const QString& name, const char* category = "app");
+    ~TraceSpan();
+
+    void setRequestId(const QString& requestId) { m_requestId = requestId; }
+    quint64 spanId() const { return m_spanId; }
+    quint64 parentId() const { return m_parentId; }
+
+private:
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    void begin(const char* category);
+
+    const char* m_literalName;
+    QString m_name;
+    const char* m_category;
+    QString m_requestId;
+    quint64 m_spanId;
+    quint64 m_parentId;
+    qint64 m_startNs;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SPAN(name) TraceSpan TRACE_CONCAT(traceSpan_, __LINE__)(name)
+
+#endif // TRACER_H
@@ -1,27 +1,75 @@
 #include <QGuiApplication>
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
+#include <QQuickWindow>
 #include "logging/logger.h"
+#include "logging/tracer.h"
+#include "logging/logconfig.h"
+#include "diagnostics/metricsregistry.h"
+#include "diagnostics/startupprofiler.h"
 #include "database/databasemanager.h"
+#include "database/mutationjournal.h"
+#include "database/changefeed.h"
+#include "database/slowquerylog.h"
 #include "repositories/goalrepository.h"
+#include "repositories/occurrencerepository.h"
+#include "repositories/scorerepository.h"
+#include "repositories/streakrepository.h"
 #include "services/goalservice.h"
+#include "services/occurrenceservice.h"
+#include "services/scoreservice.h"
+#include "services/streakservice.h"
+#include "services/rolloverservice.h"
+#include "services/rescoringservice.h"
+#include "services/writebehindqueue.h"
+#include "models/goallistmodel.h"
+#include "models/occurrencelistmodel.h"
+#include "models/dailyscoremodel.h"
+#include "models/calendarmodel.h"
 
 int main(int argc, char *argv[])
 {
+    // Startup phases are timed from here to the first rendered frame
+    StartupProfiler& startup = StartupProfiler::instance();
+
     QGuiApplication app(argc, argv);
 
     // Set application info
     QCoreApplication::setOrganizationName("Nimo");
     QCoreApplication::setOrganizationDomain("nimo.app");
     QCoreApplication::setApplicationName("Nimo Habit Tracker");
+    startup.mark("application");
 
     // ========================================================================
     // 1. Initialize Logger
     // ========================================================================
-    Logger::instance().setLogLevel(Logger::INFO);
-    Logger::instance().setConsoleEnabled(true);
-    Logger::instance().setFileEnabled(true);
-    Logger::instance().setMaxDaysToKeep(30);
+    // Levels, sinks, buffering and sampling come from logging.json, which is
+    // watched so they can be changed while the app is running. Its
+    // slowQuery section is handed to SlowQueryLog, since logging/ does not
+    // depend on database/.
+    LogConfig* logConfig = new LogConfig();
+    QObject::connect(logConfig, &LogConfig::configApplied, [](const QJsonObject& config) {
+        SlowQueryLog::instance().applyConfig(config.value("slowQuery").toObject());
+    });
+    logConfig->load();
+
+    // NIMO_TRACE=<path> records spans and writes a Chrome trace at exit
+    const QString tracePath = qEnvironmentVariable("NIMO_TRACE");
+    Tracer::instance().setEnabled(!tracePath.isEmpty());
+
+    // NIMO_METRICS=<path> rewrites a metrics snapshot there every minute
+    const QString metricsPath = qEnvironmentVariable("NIMO_METRICS");
+    if (!metricsPath.isEmpty()) {
+        MetricsRegistry::instance().startPeriodicDump(metricsPath, 60000);
+    }
+
+    // NIMO_STARTUP_REPORT=<path> writes the cold-start report at exit.
+    // NIMO_STARTUP_BUDGET_MS fails the run (exit code 3) when the first
+    // frame is later than that; NIMO_STARTUP_EXIT quits right after it.
+    const QString startupReportPath = qEnvironmentVariable("NIMO_STARTUP_REPORT");
+    startup.setBudgetMs(qEnvironmentVariableIntValue("NIMO_STARTUP_BUDGET_MS"));
+    const bool exitAfterFirstFrame = qEnvironmentVariableIsSet("NIMO_STARTUP_EXIT");
+    startup.mark("logger");
 
     Logger::instance().info("main", "app_start", "Application starting", {
                                                                              {"version", "1.0.0"},
@@ -31,12 +79,18 @@ int main(int argc, char *argv[])
     // ========================================================================
     // 2. Initialize Database
     // ========================================================================
-    if (!DatabaseManager::instance().initialize()) {
-        Logger::instance().fatal("main", "app_start",
-                                 "Failed to initialize database", {
+    // Status changes and goal edits are journaled before they are stored,
+    // so the app can start and record changes while the database is down
+    MutationJournal::instance().open();
+    startup.mark("journal");
+
+    const bool databaseReady = DatabaseManager::instance().initialize();
+    if (!databaseReady) {
+        Logger::instance().error("main", "app_start",
+                                 "Database unavailable, starting offline", {
                                      {"error", DatabaseManager::instance().lastError()}
                                  });
-        return -1;
+        DatabaseManager::instance().startReconnecting();
     }
 
     // ========================================================================
@@ -44,13 +98,115 @@ int main(int argc, char *argv[])
     // ========================================================================
     QSqlDatabase db = DatabaseManager::instance().database();
     GoalRepository* goalRepo = new GoalRepository(db);
+    OccurrenceRepository* occurrenceRepo = new OccurrenceRepository(db);
+    ScoreRepository* scoreRepo = new ScoreRepository(db);
+    StreakRepository* streakRepo = new StreakRepository(db);
 
+    startup.mark("repositories");
     Logger::instance().info("main", "app_start", "Repositories initialized", {});
 
     // ========================================================================
     // 4. Create Services
     // ========================================================================
     GoalService* goalService = new GoalService(goalRepo);
+    OccurrenceService* occurrenceService = new OccurrenceService(occurrenceRepo);
+    ScoreService* scoreService = new ScoreService(scoreRepo, occurrenceRepo, goalRepo);
+    StreakService* streakService = new StreakService(streakRepo, scoreRepo);
+    RolloverService* rolloverService = new RolloverService(occurrenceRepo, scoreService, streakService);
+    RescoringService* rescoringService = new RescoringService(occurrenceRepo, scoreRepo,
+                                                              scoreService, streakService);
+
+    // Status changes made from the UI are stored on the writer thread
+    WriteBehindQueue* writeBehindQueue = new WriteBehindQueue();
+    occurrenceService->setWriteBehindQueue(writeBehindQueue);
+    QObject::connect(writeBehindQueue, &WriteBehindQueue::committed,
+                     scoreService, [scoreService](const Occurrence& stored) {
+                         scoreService->notifyScoresRecalculated(stored.date);
+                     });
+    QObject::connect(writeBehindQueue, &WriteBehindQueue::goalReplayed,
+                     goalService, &GoalService::notifyGoalReplayed);
+
+    // Status changes recalculate every window containing the occurrence
+    QObject::connect(occurrenceService, &OccurrenceService::scoresNeedRecalculation,
+                     scoreService, &ScoreService::recalculateForDate);
+
+    // Goal edits that change scoring rescore only that goal's history
+    QObject::connect(goalService, &GoalService::scoringRulesChanged,
+                     rescoringService, &RescoringService::rescoreGoal);
+
+    startup.mark("services");
+
+    // Create today's windows, close out expired ones and schedule midnight.
+    // Offline, this waits for the reconnect below.
+    if (databaseReady) {
+        rolloverService->start();
+    }
+    startup.mark("rollover");
+
+    // List models apply service signals as per-row diffs
+    GoalListModel* goalModel = new GoalListModel(goalService);
+    OccurrenceListModel* occurrenceModel = new OccurrenceListModel(occurrenceService, goalService);
+    DailyScoreModel* dailyScoreModel = new DailyScoreModel(scoreService);
+    CalendarModel* calendarModel = new CalendarModel(scoreService);
+
+    QObject::connect(occurrenceService, &OccurrenceService::occurrencePredicted,
+                     dailyScoreModel, &DailyScoreModel::applyPrediction);
+
+    // A new day moves the occurrence list and the score window forward
+    QObject::connect(rolloverService, &RolloverService::rolloverCompleted,
+                     occurrenceModel, [occurrenceModel, dailyScoreModel](const QDate& date) {
+                         occurrenceModel->setDate(date);
+                         dailyScoreModel->reload();
+                     });
+    // Rows written by other processes (nimo-sync, tools, psql) arrive as
+    // invalidations; the models refetch only what they show
+    ChangeFeed* changeFeed = new ChangeFeed(DatabaseManager::instance().database().connectionName());
+    QObject::connect(changeFeed, &ChangeFeed::goalsChanged,
+                     goalModel, [goalModel, occurrenceModel]() {
+                         goalModel->reload();
+                         occurrenceModel->reload();
+                     });
+    QObject::connect(changeFeed, &ChangeFeed::occurrencesChanged,
+                     occurrenceModel, [occurrenceModel](const QList<QDate>& windowStarts, bool all) {
+                         if (all || windowStarts.contains(occurrenceModel->date())) {
+                             occurrenceModel->reload();
+                         }
+                     });
+    QObject::connect(changeFeed, &ChangeFeed::scoresChanged, scoreService,
+                     [scoreService](const QString& scope, const QList<QDate>& windowStarts, bool all) {
+                         if (all) {
+                             scoreService->notifyScopeChanged(scope);
+                         } else {
+                             scoreService->notifyWindowsChanged(scope, windowStarts);
+                         }
+                     });
+    QObject::connect(scoreService, &ScoreService::scopeScoresChanged,
+                     calendarModel, [dailyScoreModel, calendarModel](const QString& scope) {
+                         if (scope == "daily") {
+                             dailyScoreModel->reload();
+                             calendarModel->invalidateAll();
+                         }
+                     });
+    if (databaseReady) {
+        changeFeed->start();
+    }
+
+    // Once the database is (back) up, catch up and refetch what was shown.
+    // Queued: connected() is emitted while DatabaseManager holds its lock.
+    QObject::connect(&DatabaseManager::instance(), &DatabaseManager::connected, rolloverService,
+                     [rolloverService, changeFeed, goalModel, occurrenceModel, dailyScoreModel,
+                      calendarModel]() {
+                         rolloverService->start();
+                         changeFeed->start();
+                         goalModel->reload();
+                         occurrenceModel->reload();
+                         dailyScoreModel->reload();
+                         calendarModel->invalidateAll();
+                     }, Qt::QueuedConnection);
+    // Rescoring can touch years of days at once; refetch rather than patch
+    QObject::connect(rescoringService, &RescoringService::goalRescored,
+                     calendarModel, &CalendarModel::invalidateAll);
+    startup.mark("models");
 
     Logger::instance().info("main", "app_start", "Services initialized", {});
 
@@ -62,7 +218,18 @@ int main(int argc, char *argv[])
     // Expose services to QML
     QQmlContext* rootContext = engine.rootContext();
     rootContext->setContextProperty("goalService", goalService);
+    rootContext->setContextProperty("occurrenceService", occurrenceService);
+    rootContext->setContextProperty("scoreService", scoreService);
+    rootContext->setContextProperty("streakService", streakService);
+    rootContext->setContextProperty("rolloverService", rolloverService);
+    rootContext->setContextProperty("writeBehindQueue", writeBehindQueue);
+    rootContext->setContextProperty("changeFeed", changeFeed);
+    rootContext->setContextProperty("goalModel", goalModel);
+    rootContext->setContextProperty("occurrenceModel", occurrenceModel);
+    rootContext->setContextProperty("dailyScoreModel", dailyScoreModel);
+    rootContext->setContextProperty("calendarModel", calendarModel);
     rootContext->setContextProperty("logger", &Logger::instance());
+    rootContext->setContextProperty("metrics", &MetricsRegistry::instance());
 
     // Load main QML file
     const QUrl url(u"qrc:/Nimo/Main.qml"_qs);
@@ -77,6 +244,23 @@ int main(int argc, char *argv[])
         Qt::QueuedConnection);
 
     engine.load(url);
+    startup.mark("qmlLoad");
+
+    // frameSwapped is emitted on the render thread
+    const QList<QObject*> rootObjects = engine.rootObjects();
+    if (QQuickWindow* window = qobject_cast<QQuickWindow*>(rootObjects.value(0))) {
+        QObject::connect(window, &QQuickWindow::frameSwapped, &app, [&app, exitAfterFirstFrame]() {
+            if (!StartupProfiler::instance().markFirstFrame()) {
+                return;
+            }
+            QMetaObject::invokeMethod(&app, [exitAfterFirstFrame]() {
+                StartupProfiler::instance().logSummary();
+                if (exitAfterFirstFrame) {
+                    QCoreApplication::quit();
+                }
+            }, Qt::QueuedConnection);
+        }, Qt::DirectConnection);
+    }
 
     Logger::instance().info("main", "app_start", "Application started successfully", {});
 
@@ -90,12 +274,49 @@ int main(int argc, char *argv[])
     // ========================================================================
     Logger::instance().info("main", "app_shutdown", "Application shutting down", {});
 
+    rolloverService->stop();
+    changeFeed->stop();
+    // Whatever the user changed last still reaches the database (or the journal)
+    writeBehindQueue->drain();
+    MutationJournal::instance().close();
+
+    if (!startupReportPath.isEmpty()) {
+        startup.writeReport(startupReportPath);
+    }
+    if (result == 0 && startup.budgetExceeded()) {
+        result = 3;
+    }
+
+    if (!tracePath.isEmpty()) {
+        Tracer::instance().exportChromeTrace(tracePath);
+    }
+    if (!metricsPath.isEmpty()) {
+        MetricsRegistry::instance().stopPeriodicDump();
+        MetricsRegistry::instance().dumpSnapshot(metricsPath);
+    }
+
+    delete changeFeed;
+    delete calendarModel;
+    delete dailyScoreModel;
+    delete occurrenceModel;
+    delete goalModel;
+    delete writeBehindQueue;
+    delete rescoringService;
+    delete rolloverService;
+    delete streakService;
+    delete scoreService;
+    delete occurrenceService;
     delete goalService;
+    delete streakRepo;
+    delete scoreRepo;
+    delete occurrenceRepo;
     delete goalRepo;
 
     DatabaseManager::instance().shutdown();
 
     Logger::instance().info("main", "app_shutdown", "Application shutdown complete", {});
+    delete logConfig;
+    Logger::instance().shutdown();
 
     return result;
 }
@@ -0,0 +1,311 @@
+#include "models/calendarmodel.h"
+#include "database/databasemanager.h"
+#include "logging/logger.h"
+#include "repositories/scorerepository.h"
+#include "services/calendarservice.h"
+#include "services/scoreservice.h"
+#include <QHash>
+#include <QSqlError>
+#include <QVariantMap>
+
+namespace
+{
+// Rows span this many years either side of the current year
+constexpr int kYearsEachWay = 100;
+// Rough heap cost of one day cell (a QVariantMap of nine entries)
+constexpr int kBytesPerDay = 640;
+
+int monthKey(int year, int month)
+{
+    return year * 12 + (month - 1);
+}
+
+QDate monthStartForKey(int key)
+{
+    return QDate(key / 12, key % 12 + 1, 1);
+}
+
+QVariantMap dayCell(const QDate& date, const QDate& monthStart, const DailyScore* score)
+{
+    QVariantMap cell{
+        {"date", date},
+        {"day", date.day()},
+        {"inMonth", date.month() == monthStart.month()},
+        {"hasScore", score != nullptr}
+    };
+    if (score) {
+        cell["earnedScore"] = score->earnedScore;
+        cell["targetScore"] = score->targetScore;
+        cell["completionPercentage"] = score->completionPercentage;
+        cell["perfectDay"] = score->perfectDay;
+        cell["hasNegativeOutcome"] = score->hasNegativeOutcome;
+    }
+    return cell;
+}
+}
+
+CalendarMonthLoader::CalendarMonthLoader(const QString& sourceConnection, QObject *parent)
+    : QObject(parent)
+    , m_sourceConnection(sourceConnection)
+    , m_connectionName("nimo_calendar")
+    , m_scoreRepo(nullptr)
+{
+}
+
+CalendarMonthLoader::~CalendarMonthLoader()
+{
+    delete m_scoreRepo;
+    m_db.close();
+    m_db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(m_connectionName);
+}
+
+void CalendarMonthLoader::open()
+{
+    // Connections are per thread; this one belongs to the calendar thread
+    m_db = QSqlDatabase::cloneDatabase(m_sourceConnection, m_connectionName);
+    if (!m_db.open()) {
+        Logger::instance().error("CalendarMonthLoader::open", "calendar",
+                                 "Failed to open calendar connection", {
+                                     {"errorMessage", m_db.lastError().text()}
+                                 });
+    }
+    m_scoreRepo = new ScoreRepository(m_db);
+}
+
+void CalendarMonthLoader::loadMonth(int key, quint64 generation)
+{
+    QDate monthStart = monthStartForKey(key);
+    QDate first;
+    QDate last;
+    CalendarService::monthGridRange(monthStart.year(), monthStart.month(), &first, &last);
+
+    // The app may have started before the database was reachable
+    if (!m_db.isOpen()) {
+        m_db.open();
+    }
+
+    QList<DailyScore*> scores = m_scoreRepo->getDailyScoreRange(first, last);
+    QHash<QDate, const DailyScore*> byDate;
+    for (const DailyScore* score : std::as_const(scores)) {
+        byDate.insert(score->date, score);
+    }
+
+    QVariantList days;
+    days.reserve(int(first.daysTo(last)) + 1);
+    for (QDate day = first; day <= last; day = day.addDays(1)) {
+        days.append(dayCell(day, monthStart, byDate.value(day)));
+    }
+    qDeleteAll(scores);
+
+    emit monthLoaded(key, generation, days);
+}
+
+CalendarModel::CalendarModel(ScoreService* scoreService, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_firstYear(QDate::currentDate().year() - kYearsEachWay)
+    , m_rowCount((2 * kYearsEachWay + 1) * 12)
+    , m_prefetchMonths(3)
+    , m_generation(0)
+    , m_lastRow(-1)
+    , m_direction(1)
+    , m_loader(new CalendarMonthLoader(DatabaseManager::instance().database().connectionName()))
+{
+    m_cache.setMaxCost(4 * 1024 * 1024);
+
+    m_loader->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::started, m_loader, &CalendarMonthLoader::open);
+    connect(&m_thread, &QThread::finished, m_loader, &QObject::deleteLater);
+    connect(m_loader, &CalendarMonthLoader::monthLoaded, this, &CalendarModel::onMonthLoaded);
+    connect(scoreService, &ScoreService::dailyScoreUpdated, this, &CalendarModel::onDailyScoreUpdated);
+
+    m_thread.setObjectName("nimo-calendar");
+    m_thread.start(QThread::LowPriority);
+}
+
+CalendarModel::~CalendarModel()
+{
+    m_thread.quit();
+    m_thread.wait();
+}
+
+int CalendarModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_rowCount;
+}
+
+QVariant CalendarModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rowCount) {
+        return QVariant();
+    }
+
+    const int row = index.row();
+    const QDate monthStart = monthStartForRow(row);
+    switch (role) {
+    case YearRole: return monthStart.year();
+    case MonthRole: return monthStart.month();
+    case Qt::DisplayRole:
+    case MonthStartRole: return monthStart;
+    case LoadedRole: return m_cache.contains(monthKey(monthStart.year(), monthStart.month()));
+    case DaysRole: break;
+    default: return QVariant();
+    }
+
+    prefetchAround(row);
+    if (const Month* month = m_cache.object(monthKey(monthStart.year(), monthStart.month()))) {
+        return month->days;
+    }
+    request(row);
+    return placeholderDays(monthStart);
+}
+
+QHash<int, QByteArray> CalendarModel::roleNames() const
+{
+    return {
+        {YearRole, "year"},
+        {MonthRole, "month"},
+        {MonthStartRole, "monthStart"},
+        {LoadedRole, "loaded"},
+        {DaysRole, "days"}
+    };
+}
+
+int CalendarModel::rowForDate(const QDate& date) const
+{
+    int row = monthKey(date.year(), date.month()) - monthKey(m_firstYear, 1);
+    return qBound(0, row, m_rowCount - 1);
+}
+
+QDate CalendarModel::monthStartForRow(int row) const
+{
+    return monthStartForKey(monthKey(m_firstYear, 1) + row);
+}
+
+void CalendarModel::setPrefetchMonths(int months)
+{
+    months = qMax(0, months);
+    if (m_prefetchMonths == months) {
+        return;
+    }
+    m_prefetchMonths = months;
+    emit prefetchMonthsChanged();
+}
+
+void CalendarModel::setCacheLimitKb(int kb)
+{
+    if (cacheLimitKb() == kb) {
+        return;
+    }
+    m_cache.setMaxCost(qMax(kBytesPerDay * 42, kb * 1024));
+    emit cacheLimitKbChanged();
+    emit cachedMonthsChanged();
+}
+
+void CalendarModel::invalidateAll()
+{
+    // Loads already in flight carry the old generation and are dropped
+    m_generation++;
+    m_cache.clear();
+    m_pending.clear();
+    m_dirty.clear();
+    emit cachedMonthsChanged();
+    emit dataChanged(index(0), index(m_rowCount - 1), {LoadedRole, DaysRole});
+}
+
+void CalendarModel::request(int row, bool reload) const
+{
+    if (row < 0 || row >= m_rowCount) {
+        return;
+    }
+    const QDate monthStart = monthStartForRow(row);
+    const int key = monthKey(monthStart.year(), monthStart.month());
+    if (m_pending.contains(key) || (!reload && m_cache.contains(key))) {
+        return;
+    }
+
+    m_pending.insert(key);
+    CalendarMonthLoader* loader = m_loader;
+    const quint64 generation = m_generation;
+    QMetaObject::invokeMethod(loader, [loader, key, generation]() {
+        loader->loadMonth(key, generation);
+    }, Qt::QueuedConnection);
+}
+
+// The view asks for rows as they come into sight, so the direction of
+// successive requests is the scroll direction
+void CalendarModel::prefetchAround(int row) const
+{
+    if (row == m_lastRow) {
+        return;
+    }
+    if (m_lastRow >= 0) {
+        m_direction = row > m_lastRow ? 1 : -1;
+    }
+    m_lastRow = row;
+
+    for (int i = 1; i <= m_prefetchMonths; ++i) {
+        request(row + m_direction * i);
+    }
+    request(row - m_direction);
+}
+
+void CalendarModel::onMonthLoaded(int key, quint64 generation, const QVariantList& days)
+{
+    if (generation != m_generation) {
+        return;
+    }
+    m_pending.remove(key);
+
+    const int row = key - monthKey(m_firstYear, 1);
+    m_cache.insert(key, new Month{days}, int(days.size()) * kBytesPerDay);
+    emit dataChanged(index(row), index(row), {LoadedRole, DaysRole});
+    emit cachedMonthsChanged();
+
+    if (m_dirty.remove(key)) {
+        request(row, true);
+    }
+}
+
+void CalendarModel::onDailyScoreUpdated(const QDate& date)
+{
+    // The day also shows in the leading or trailing cells of its neighbours
+    const int row = rowForDate(date);
+    for (int candidate = row - 1; candidate <= row + 1; ++candidate) {
+        const QDate monthStart = monthStartForRow(candidate);
+        QDate first;
+        QDate last;
+        CalendarService::monthGridRange(monthStart.year(), monthStart.month(), &first, &last);
+        if (date >= first && date <= last) {
+            invalidateMonth(candidate);
+        }
+    }
+}
+
+void CalendarModel::invalidateMonth(int row)
+{
+    if (row < 0 || row >= m_rowCount) {
+        return;
+    }
+    const QDate monthStart = monthStartForRow(row);
+    const int key = monthKey(monthStart.year(), monthStart.month());
+    if (m_pending.contains(key)) {
+        m_dirty.insert(key);
+    } else if (m_cache.contains(key)) {
+        // Keep showing the cached month until the fresh one arrives
+        request(row, true);
+    }
+}
+
+QVariantList CalendarModel::placeholderDays(const QDate& monthStart)
+{
+    QDate first;
+    QDate last;
+    CalendarService::monthGridRange(monthStart.year(), monthStart.month(), &first, &last);
+
+    QVariantList days;
+    for (QDate day = first; day <= last; day = day.addDays(1)) {
+        days.append(dayCell(day, monthStart, nullptr));
+    }
+    return days;
+}
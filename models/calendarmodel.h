@@ -0,0 +1,115 @@
+#ifndef CALENDARMODEL_H
+#define CALENDARMODEL_H
+
+#include <QAbstractListModel>
+#include <QCache>
+#include <QDate>
+#include <QSet>
+#include <QSqlDatabase>
+#include <QThread>
+#include <QVariantList>
+
+class ScoreRepository;
+class ScoreService;
+
+// Loads month grids on the calendar thread with its own connection, so
+// fetching never blocks the GUI thread.
+class CalendarMonthLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CalendarMonthLoader(const QString& sourceConnection, QObject *parent = nullptr);
+    ~CalendarMonthLoader();
+
+public slots:
+    void open();
+    void loadMonth(int key, quint64 generation);
+
+signals:
+    void monthLoaded(int key, quint64 generation, const QVariantList& days);
+
+private:
+    QString m_sourceConnection;
+    QString m_connectionName;
+    QSqlDatabase m_db;
+    ScoreRepository* m_scoreRepo;
+};
+
+// One row per month over a fixed span of years around today, so a
+// ListView can scroll as far as anyone will in practice while only the
+// months actually shown are ever fetched. Rows that are not loaded yet
+// return a grid of dates without scores and are filled in asynchronously.
+// Loaded months are kept in an LRU cache bounded by an estimated byte cost;
+// reading a row also prefetches the next months in the scroll direction.
+class CalendarModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int todayRow READ todayRow CONSTANT)
+    Q_PROPERTY(int prefetchMonths READ prefetchMonths WRITE setPrefetchMonths NOTIFY prefetchMonthsChanged)
+    Q_PROPERTY(int cacheLimitKb READ cacheLimitKb WRITE setCacheLimitKb NOTIFY cacheLimitKbChanged)
+    Q_PROPERTY(int cachedMonths READ cachedMonths NOTIFY cachedMonthsChanged)
+
+public:
+    enum Roles {
+        YearRole = Qt::UserRole + 1,
+        MonthRole,
+        MonthStartRole,
+        LoadedRole,
+        DaysRole
+    };
+    Q_ENUM(Roles)
+
+    explicit CalendarModel(ScoreService* scoreService, QObject *parent = nullptr);
+    ~CalendarModel();
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int todayRow() const { return rowForDate(QDate::currentDate()); }
+    Q_INVOKABLE int rowForDate(const QDate& date) const;
+    Q_INVOKABLE QDate monthStartForRow(int row) const;
+
+    int prefetchMonths() const { return m_prefetchMonths; }
+    void setPrefetchMonths(int months);
+    int cacheLimitKb() const { return m_cache.maxCost() / 1024; }
+    void setCacheLimitKb(int kb);
+    int cachedMonths() const { return m_cache.size(); }
+
+    // Drops every cached month, e.g. after a bulk rescore
+    Q_INVOKABLE void invalidateAll();
+
+signals:
+    void prefetchMonthsChanged();
+    void cacheLimitKbChanged();
+    void cachedMonthsChanged();
+
+private:
+    struct Month {
+        QVariantList days;
+    };
+
+    void request(int row, bool reload = false) const;
+    void prefetchAround(int row) const;
+    void onMonthLoaded(int key, quint64 generation, const QVariantList& days);
+    void onDailyScoreUpdated(const QDate& date);
+    void invalidateMonth(int row);
+    static QVariantList placeholderDays(const QDate& monthStart);
+
+    int m_firstYear;
+    int m_rowCount;
+    int m_prefetchMonths;
+    quint64 m_generation;
+    // Lazy loading from data() is logically const
+    mutable QCache<int, Month> m_cache;
+    mutable QSet<int> m_pending;
+    // Changed while a load was in flight; reloaded when it lands
+    QSet<int> m_dirty;
+    mutable int m_lastRow;
+    mutable int m_direction;
+    QThread m_thread;
+    CalendarMonthLoader* m_loader;
+};
+
+#endif // CALENDARMODEL_H
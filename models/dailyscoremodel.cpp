@@ -0,0 +1,184 @@
+#include "models/dailyscoremodel.h"
+#include <algorithm>
+
+DailyScoreModel::DailyScoreModel(ScoreService* scoreService, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_scoreService(scoreService)
+    , m_days(30)
+{
+    connect(m_scoreService, &ScoreService::dailyScoreUpdated,
+            this, &DailyScoreModel::onDailyScoreUpdated);
+    reload();
+}
+
+int DailyScoreModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_scores.size();
+}
+
+QVariant DailyScoreModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_scores.size()) {
+        return QVariant();
+    }
+
+    const DailyScore& score = m_scores.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+    case DateRole: return score.date;
+    case EarnedScoreRole: return score.earnedScore;
+    case TargetScoreRole: return score.targetScore;
+    case CompletionPercentageRole: return score.completionPercentage;
+    case CompletedCountRole: return score.completedCount;
+    case SkippedCountRole: return score.skippedCount;
+    case NotCompletedCountRole: return score.notCompletedCount;
+    case PendingCountRole: return score.pendingCount;
+    case TotalCountRole: return score.totalCount;
+    case PerfectDayRole: return score.perfectDay;
+    case HasNegativeOutcomeRole: return score.hasNegativeOutcome;
+    default: return QVariant();
+    }
+}
+
+QHash<int, QByteArray> DailyScoreModel::roleNames() const
+{
+    return {
+        {DateRole, "date"},
+        {EarnedScoreRole, "earnedScore"},
+        {TargetScoreRole, "targetScore"},
+        {CompletionPercentageRole, "completionPercentage"},
+        {CompletedCountRole, "completedCount"},
+        {SkippedCountRole, "skippedCount"},
+        {NotCompletedCountRole, "notCompletedCount"},
+        {PendingCountRole, "pendingCount"},
+        {TotalCountRole, "totalCount"},
+        {PerfectDayRole, "perfectDay"},
+        {HasNegativeOutcomeRole, "hasNegativeOutcome"}
+    };
+}
+
+void DailyScoreModel::setDays(int days)
+{
+    days = qMax(1, days);
+    if (m_days == days) {
+        return;
+    }
+    m_days = days;
+    reload();
+    emit daysChanged();
+}
+
+void DailyScoreModel::reload()
+{
+    QList<DailyScore*> scores = m_scoreService->getDailyTrend(m_days);
+
+    beginResetModel();
+    m_endDate = QDate::currentDate();
+    m_scores.clear();
+    m_scores.reserve(scores.size());
+    for (const DailyScore* score : std::as_const(scores)) {
+        m_scores.append(*score);
+    }
+    std::sort(m_scores.begin(), m_scores.end(), [](const DailyScore& a, const DailyScore& b) {
+        return a.date < b.date;
+    });
+    endResetModel();
+    emit countChanged();
+
+    qDeleteAll(scores);
+}
+
+void DailyScoreModel::onDailyScoreUpdated(const QDate& date)
+{
+    if (date > m_endDate || date < m_endDate.addDays(1 - m_days)) {
+        return;
+    }
+
+    DailyScore* score = m_scoreService->getDailyScore(date);
+    if (!score) {
+        return;
+    }
+
+    auto it = std::lower_bound(m_scores.begin(), m_scores.end(), date,
+                               [](const DailyScore& s, const QDate& d) { return s.date < d; });
+    int row = int(it - m_scores.begin());
+
+    if (it != m_scores.end() && it->date == date) {
+        const QList<int> roles = changedRoles(*it, *score);
+        if (!roles.isEmpty()) {
+            *it = *score;
+            emit dataChanged(index(row), index(row), roles);
+        }
+    } else {
+        beginInsertRows(QModelIndex(), row, row);
+        m_scores.insert(row, *score);
+        endInsertRows();
+        emit countChanged();
+    }
+
+    delete score;
+}
+
+void DailyScoreModel::applyPrediction(const Occurrence& before, const Occurrence& after,
+                                      const QString& goalScope)
+{
+    // Only daily goals count towards the daily score
+    if (goalScope != "daily") {
+        return;
+    }
+
+    auto it = std::lower_bound(m_scores.begin(), m_scores.end(), after.date,
+                               [](const DailyScore& s, const QDate& d) { return s.date < d; });
+    if (it == m_scores.end() || it->date != after.date) {
+        return;
+    }
+
+    DailyScore predicted = *it;
+    auto countFor = [&predicted](const QString& status) -> int* {
+        if (status == "completed") return &predicted.completedCount;
+        if (status == "skipped") return &predicted.skippedCount;
+        if (status == "not_completed") return &predicted.notCompletedCount;
+        if (status == "pending") return &predicted.pendingCount;
+        return nullptr;
+    };
+    if (int* count = countFor(before.status)) {
+        --*count;
+    }
+    if (int* count = countFor(after.status)) {
+        ++*count;
+    }
+
+    predicted.earnedScore += after.scoreImpact - before.scoreImpact;
+    predicted.completionPercentage = predicted.targetScore > 0
+        ? static_cast<double>(predicted.earnedScore) / predicted.targetScore * 100.0
+        : 0.0;
+    predicted.perfectDay = predicted.totalCount > 0
+        && predicted.completedCount == predicted.totalCount;
+    // Clearing it needs the other occurrences; the stored score settles that
+    if (after.scoreImpact < 0) {
+        predicted.hasNegativeOutcome = true;
+    }
+
+    const QList<int> roles = changedRoles(*it, predicted);
+    if (!roles.isEmpty()) {
+        const int row = int(it - m_scores.begin());
+        *it = predicted;
+        emit dataChanged(index(row), index(row), roles);
+    }
+}
+
+QList<int> DailyScoreModel::changedRoles(const DailyScore& before, const DailyScore& after)
+{
+    QList<int> roles;
+    if (before.earnedScore != after.earnedScore) roles << EarnedScoreRole;
+    if (before.targetScore != after.targetScore) roles << TargetScoreRole;
+    if (before.completionPercentage != after.completionPercentage) roles << CompletionPercentageRole;
+    if (before.completedCount != after.completedCount) roles << CompletedCountRole;
+    if (before.skippedCount != after.skippedCount) roles << SkippedCountRole;
+    if (before.notCompletedCount != after.notCompletedCount) roles << NotCompletedCountRole;
+    if (before.pendingCount != after.pendingCount) roles << PendingCountRole;
+    if (before.totalCount != after.totalCount) roles << TotalCountRole;
+    if (before.perfectDay != after.perfectDay) roles << PerfectDayRole;
+    if (before.hasNegativeOutcome != after.hasNegativeOutcome) roles << HasNegativeOutcomeRole;
+    return roles;
+}
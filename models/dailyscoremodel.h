@@ -0,0 +1,68 @@
+#ifndef DAILYSCOREMODEL_H
+#define DAILYSCOREMODEL_H
+
+#include <QAbstractListModel>
+#include <QDate>
+#include <QList>
+#include "services/scoreservice.h"
+#include "repositories/occurrencerepository.h"
+
+// Stored daily scores for the last `days` days, oldest first. Days without
+// a score have no row. ScoreService::dailyScoreUpdated re-reads that one
+// day and updates or inserts its row; optimistic status changes adjust the
+// row in memory until then.
+class DailyScoreModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int days READ days WRITE setDays NOTIFY daysChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    enum Roles {
+        DateRole = Qt::UserRole + 1,
+        EarnedScoreRole,
+        TargetScoreRole,
+        CompletionPercentageRole,
+        CompletedCountRole,
+        SkippedCountRole,
+        NotCompletedCountRole,
+        PendingCountRole,
+        TotalCountRole,
+        PerfectDayRole,
+        HasNegativeOutcomeRole
+    };
+    Q_ENUM(Roles)
+
+    explicit DailyScoreModel(ScoreService* scoreService, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int count() const { return m_scores.size(); }
+    int days() const { return m_days; }
+    void setDays(int days);
+
+    // Also moves the window to end today, e.g. after a rollover
+    Q_INVOKABLE void reload();
+
+    // Apply an occurrence change ahead of the recalculated score, which
+    // replaces the row through dailyScoreUpdated once it is stored
+    void applyPrediction(const Occurrence& before, const Occurrence& after,
+                         const QString& goalScope);
+
+signals:
+    void daysChanged();
+    void countChanged();
+
+private:
+    void onDailyScoreUpdated(const QDate& date);
+    static QList<int> changedRoles(const DailyScore& before, const DailyScore& after);
+
+    ScoreService* m_scoreService;
+    int m_days;
+    QDate m_endDate;
+    QList<DailyScore> m_scores;
+};
+
+#endif // DAILYSCOREMODEL_H
@@ -0,0 +1,216 @@
+#include "models/goallistmodel.h"
+#include <algorithm>
+
+GoalListModel::GoalListModel(GoalService* goalService, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_goalService(goalService)
+{
+    connect(m_goalService, &GoalService::goalCreated, this, &GoalListModel::onGoalCreated);
+    connect(m_goalService, &GoalService::goalUpdated, this, &GoalListModel::onGoalUpdated);
+    connect(m_goalService, &GoalService::goalDeleted, this, &GoalListModel::onGoalDeleted);
+    reload();
+}
+
+int GoalListModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_goals.size();
+}
+
+QVariant GoalListModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_goals.size()) {
+        return QVariant();
+    }
+
+    const Goal& goal = m_goals.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+    case TitleRole: return goal.title;
+    case IdRole: return goal.id;
+    case ScopeRole: return goal.scope;
+    case PointsRole: return goal.points;
+    case MissingBehaviorRole: return goal.missingBehavior;
+    case PenaltyPointsRole: return goal.penaltyPoints;
+    case CategoryRole: return goal.category;
+    case NotesRole: return goal.notes;
+    case IconNameRole: return goal.iconName;
+    case ColorHexRole: return goal.colorHex;
+    case SortOrderRole: return goal.sortOrder;
+    case IsActiveRole: return goal.isActive;
+    default: return QVariant();
+    }
+}
+
+QHash<int, QByteArray> GoalListModel::roleNames() const
+{
+    return {
+        {IdRole, "goalId"},
+        {TitleRole, "title"},
+        {ScopeRole, "scope"},
+        {PointsRole, "points"},
+        {MissingBehaviorRole, "missingBehavior"},
+        {PenaltyPointsRole, "penaltyPoints"},
+        {CategoryRole, "category"},
+        {NotesRole, "notes"},
+        {IconNameRole, "iconName"},
+        {ColorHexRole, "colorHex"},
+        {SortOrderRole, "sortOrder"},
+        {IsActiveRole, "isActive"}
+    };
+}
+
+void GoalListModel::setScopeFilter(const QString& scope)
+{
+    if (m_scopeFilter == scope) {
+        return;
+    }
+    m_scopeFilter = scope;
+    reload();
+    emit scopeFilterChanged();
+}
+
+void GoalListModel::reload()
+{
+    QList<Goal*> goals = m_scopeFilter.isEmpty() ? m_goalService->getAllGoals()
+                                                 : m_goalService->getGoalsByScope(m_scopeFilter);
+
+    beginResetModel();
+    m_goals.clear();
+    m_goals.reserve(goals.size());
+    for (const Goal* goal : std::as_const(goals)) {
+        m_goals.append(*goal);
+    }
+    std::stable_sort(m_goals.begin(), m_goals.end(), &GoalListModel::lessThan);
+    endResetModel();
+    emit countChanged();
+
+    qDeleteAll(goals);
+}
+
+int GoalListModel::indexOf(const QString& goalId) const
+{
+    for (int row = 0; row < m_goals.size(); ++row) {
+        if (m_goals.at(row).id == goalId) {
+            return row;
+        }
+    }
+    return -1;
+}
+
+QVariantMap GoalListModel::get(int row) const
+{
+    QVariantMap map;
+    if (row < 0 || row >= m_goals.size()) {
+        return map;
+    }
+    const QHash<int, QByteArray> roles = roleNames();
+    for (auto it = roles.cbegin(); it != roles.cend(); ++it) {
+        map.insert(QString::fromLatin1(it.value()), data(index(row), it.key()));
+    }
+    return map;
+}
+
+void GoalListModel::onGoalCreated(const Goal& goal)
+{
+    if (accepts(goal) && indexOf(goal.id) < 0) {
+        insertGoal(goal);
+    }
+}
+
+void GoalListModel::onGoalUpdated(const Goal& goal)
+{
+    int row = indexOf(goal.id);
+    if (row < 0) {
+        if (accepts(goal)) {
+            insertGoal(goal);
+        }
+        return;
+    }
+    if (!accepts(goal)) {
+        removeGoal(row);
+        return;
+    }
+
+    const QList<int> roles = changedRoles(m_goals.at(row), goal);
+    if (roles.isEmpty()) {
+        return;
+    }
+
+    // A new sort key moves the row instead of resetting the view
+    int target = insertPosition(goal, row);
+    if (target != row) {
+        beginMoveRows(QModelIndex(), row, row, QModelIndex(), target > row ? target + 1 : target);
+        m_goals.move(row, target);
+        endMoveRows();
+        row = target;
+    }
+
+    m_goals[row] = goal;
+    emit dataChanged(index(row), index(row), roles);
+}
+
+void GoalListModel::onGoalDeleted(const QString& goalId)
+{
+    int row = indexOf(goalId);
+    if (row >= 0) {
+        removeGoal(row);
+    }
+}
+
+bool GoalListModel::accepts(const Goal& goal) const
+{
+    return m_scopeFilter.isEmpty() || goal.scope == m_scopeFilter;
+}
+
+int GoalListModel::insertPosition(const Goal& goal, int skipRow) const
+{
+    int position = 0;
+    for (int row = 0; row < m_goals.size(); ++row) {
+        if (row != skipRow && lessThan(m_goals.at(row), goal)) {
+            position++;
+        }
+    }
+    return position;
+}
+
+void GoalListModel::insertGoal(const Goal& goal)
+{
+    int row = insertPosition(goal);
+    beginInsertRows(QModelIndex(), row, row);
+    m_goals.insert(row, goal);
+    endInsertRows();
+    emit countChanged();
+}
+
+void GoalListModel::removeGoal(int row)
+{
+    beginRemoveRows(QModelIndex(), row, row);
+    m_goals.removeAt(row);
+    endRemoveRows();
+    emit countChanged();
+}
+
+bool GoalListModel::lessThan(const Goal& a, const Goal& b)
+{
+    if (a.sortOrder != b.sortOrder) {
+        return a.sortOrder < b.sortOrder;
+    }
+    return a.title.localeAwareCompare(b.title) < 0;
+}
+
+QList<int> GoalListModel::changedRoles(const Goal& before, const Goal& after)
+{
+    QList<int> roles;
+    if (before.title != after.title) roles << TitleRole << Qt::DisplayRole;
+    if (before.scope != after.scope) roles << ScopeRole;
+    if (before.points != after.points) roles << PointsRole;
+    if (before.missingBehavior != after.missingBehavior) roles << MissingBehaviorRole;
+    if (before.penaltyPoints != after.penaltyPoints) roles << PenaltyPointsRole;
+    if (before.category != after.category) roles << CategoryRole;
+    if (before.notes != after.notes) roles << NotesRole;
+    if (before.iconName != after.iconName) roles << IconNameRole;
+    if (before.colorHex != after.colorHex) roles << ColorHexRole;
+    if (before.sortOrder != after.sortOrder) roles << SortOrderRole;
+    if (before.isActive != after.isActive) roles << IsActiveRole;
+    return roles;
+}
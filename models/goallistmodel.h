@@ -0,0 +1,71 @@
+#ifndef GOALLISTMODEL_H
+#define GOALLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QString>
+#include <QVariantMap>
+#include "services/goalservice.h"
+
+// Goals ordered by sortOrder then title, optionally limited to one scope.
+// Loaded once; afterwards GoalService signals are applied as single-row
+// inserts, moves, removals and dataChanged with only the roles that differ.
+class GoalListModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(QString scopeFilter READ scopeFilter WRITE setScopeFilter NOTIFY scopeFilterChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    enum Roles {
+        IdRole = Qt::UserRole + 1,
+        TitleRole,
+        ScopeRole,
+        PointsRole,
+        MissingBehaviorRole,
+        PenaltyPointsRole,
+        CategoryRole,
+        NotesRole,
+        IconNameRole,
+        ColorHexRole,
+        SortOrderRole,
+        IsActiveRole
+    };
+    Q_ENUM(Roles)
+
+    explicit GoalListModel(GoalService* goalService, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int count() const { return m_goals.size(); }
+    QString scopeFilter() const { return m_scopeFilter; }
+    void setScopeFilter(const QString& scope);
+
+    Q_INVOKABLE void reload();
+    Q_INVOKABLE int indexOf(const QString& goalId) const;
+    Q_INVOKABLE QVariantMap get(int row) const;
+
+signals:
+    void scopeFilterChanged();
+    void countChanged();
+
+private:
+    void onGoalCreated(const Goal& goal);
+    void onGoalUpdated(const Goal& goal);
+    void onGoalDeleted(const QString& goalId);
+
+    bool accepts(const Goal& goal) const;
+    int insertPosition(const Goal& goal, int skipRow = -1) const;
+    void insertGoal(const Goal& goal);
+    void removeGoal(int row);
+    static bool lessThan(const Goal& a, const Goal& b);
+    static QList<int> changedRoles(const Goal& before, const Goal& after);
+
+    GoalService* m_goalService;
+    QString m_scopeFilter;
+    QList<Goal> m_goals;
+};
+
+#endif // GOALLISTMODEL_H
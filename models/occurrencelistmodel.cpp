@@ -0,0 +1,267 @@
+#include "models/occurrencelistmodel.h"
+#include <algorithm>
+
+OccurrenceListModel::OccurrenceListModel(OccurrenceService* occurrenceService,
+                                         GoalService* goalService,
+                                         QObject *parent)
+    : QAbstractListModel(parent)
+    , m_occurrenceService(occurrenceService)
+    , m_goalService(goalService)
+    , m_date(QDate::currentDate())
+{
+    connect(m_occurrenceService, &OccurrenceService::occurrenceUpdated,
+            this, &OccurrenceListModel::onOccurrenceUpdated);
+    connect(m_goalService, &GoalService::goalCreated, this, [this](const Goal& goal) {
+        m_goals.insert(goal.id, goal);
+    });
+    connect(m_goalService, &GoalService::goalUpdated, this, &OccurrenceListModel::onGoalUpdated);
+    connect(m_goalService, &GoalService::goalDeleted, this, &OccurrenceListModel::onGoalDeleted);
+    reload();
+}
+
+int OccurrenceListModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_occurrences.size();
+}
+
+QVariant OccurrenceListModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_occurrences.size()) {
+        return QVariant();
+    }
+
+    const Occurrence& occurrence = m_occurrences.at(index.row());
+    switch (role) {
+    case IdRole: return occurrence.id;
+    case GoalIdRole: return occurrence.goalId;
+    case DateRole: return occurrence.date;
+    case StatusRole: return occurrence.status;
+    case CompletedAtRole: return occurrence.completedAt;
+    case ScoreImpactRole: return occurrence.scoreImpact;
+    case NotesRole: return occurrence.notes;
+    default: break;
+    }
+
+    const Goal goal = m_goals.value(occurrence.goalId);
+    switch (role) {
+    case Qt::DisplayRole:
+    case GoalTitleRole: return goal.title;
+    case GoalScopeRole: return goal.scope;
+    case GoalPointsRole: return goal.points;
+    case GoalCategoryRole: return goal.category;
+    case GoalIconNameRole: return goal.iconName;
+    case GoalColorHexRole: return goal.colorHex;
+    default: return QVariant();
+    }
+}
+
+QHash<int, QByteArray> OccurrenceListModel::roleNames() const
+{
+    return {
+        {IdRole, "occurrenceId"},
+        {GoalIdRole, "goalId"},
+        {DateRole, "date"},
+        {StatusRole, "status"},
+        {CompletedAtRole, "completedAt"},
+        {ScoreImpactRole, "scoreImpact"},
+        {NotesRole, "notes"},
+        {GoalTitleRole, "goalTitle"},
+        {GoalScopeRole, "goalScope"},
+        {GoalPointsRole, "goalPoints"},
+        {GoalCategoryRole, "goalCategory"},
+        {GoalIconNameRole, "goalIconName"},
+        {GoalColorHexRole, "goalColorHex"}
+    };
+}
+
+void OccurrenceListModel::setDate(const QDate& date)
+{
+    if (m_date == date) {
+        return;
+    }
+    m_date = date;
+    reload();
+    emit dateChanged();
+}
+
+void OccurrenceListModel::reload()
+{
+    QList<Goal*> goals = m_goalService->getAllGoals();
+    QList<Occurrence*> occurrences = m_occurrenceService->getOccurrencesForDate(m_date);
+
+    beginResetModel();
+    m_goals.clear();
+    for (const Goal* goal : std::as_const(goals)) {
+        m_goals.insert(goal->id, *goal);
+    }
+    m_occurrences.clear();
+    m_occurrences.reserve(occurrences.size());
+    for (const Occurrence* occurrence : std::as_const(occurrences)) {
+        if (m_goals.contains(occurrence->goalId)) {
+            m_occurrences.append(*occurrence);
+        }
+    }
+    std::stable_sort(m_occurrences.begin(), m_occurrences.end(),
+                     [this](const Occurrence& a, const Occurrence& b) { return lessThan(a, b); });
+    endResetModel();
+    emit countChanged();
+
+    qDeleteAll(occurrences);
+    qDeleteAll(goals);
+}
+
+int OccurrenceListModel::indexOf(const QString& occurrenceId) const
+{
+    for (int row = 0; row < m_occurrences.size(); ++row) {
+        if (m_occurrences.at(row).id == occurrenceId) {
+            return row;
+        }
+    }
+    return -1;
+}
+
+bool OccurrenceListModel::setStatus(int row, const QString& status)
+{
+    if (row < 0 || row >= m_occurrences.size()) {
+        return false;
+    }
+    // The row itself is updated by the resulting occurrenceUpdated signal,
+    // before the write reaches the database; a copy, as that replaces it
+    const Occurrence occurrence = m_occurrences.at(row);
+    return m_occurrenceService->setStatusOptimistic(occurrence, m_goals.value(occurrence.goalId),
+                                                    status);
+}
+
+void OccurrenceListModel::onOccurrenceUpdated(const Occurrence& occurrence)
+{
+    if (occurrence.date != m_date || !m_goals.contains(occurrence.goalId)) {
+        return;
+    }
+
+    int row = indexOf(occurrence.id);
+    if (row < 0) {
+        row = insertPosition(occurrence);
+        beginInsertRows(QModelIndex(), row, row);
+        m_occurrences.insert(row, occurrence);
+        endInsertRows();
+        emit countChanged();
+        return;
+    }
+
+    const QList<int> roles = changedRoles(m_occurrences.at(row), occurrence);
+    if (!roles.isEmpty()) {
+        m_occurrences[row] = occurrence;
+        emit dataChanged(index(row), index(row), roles);
+    }
+}
+
+void OccurrenceListModel::onGoalUpdated(const Goal& goal)
+{
+    auto it = m_goals.find(goal.id);
+    if (it == m_goals.end()) {
+        m_goals.insert(goal.id, goal);
+        return;
+    }
+
+    const QList<int> roles = changedGoalRoles(it.value(), goal);
+    const bool reorder = it.value().sortOrder != goal.sortOrder || it.value().title != goal.title;
+    it.value() = goal;
+    if (roles.isEmpty() && !reorder) {
+        return;
+    }
+
+    QStringList occurrenceIds;
+    for (const Occurrence& occurrence : std::as_const(m_occurrences)) {
+        if (occurrence.goalId == goal.id) {
+            occurrenceIds << occurrence.id;
+        }
+    }
+
+    for (const QString& occurrenceId : std::as_const(occurrenceIds)) {
+        int row = indexOf(occurrenceId);
+
+        // A new sort key moves the row instead of resetting the view
+        if (reorder) {
+            int target = movePosition(row);
+            if (target != row) {
+                beginMoveRows(QModelIndex(), row, row, QModelIndex(), target > row ? target + 1 : target);
+                m_occurrences.move(row, target);
+                endMoveRows();
+                row = target;
+            }
+        }
+
+        if (!roles.isEmpty()) {
+            emit dataChanged(index(row), index(row), roles);
+        }
+    }
+}
+
+void OccurrenceListModel::onGoalDeleted(const QString& goalId)
+{
+    m_goals.remove(goalId);
+    for (int row = m_occurrences.size() - 1; row >= 0; --row) {
+        if (m_occurrences.at(row).goalId == goalId) {
+            beginRemoveRows(QModelIndex(), row, row);
+            m_occurrences.removeAt(row);
+            endRemoveRows();
+            emit countChanged();
+        }
+    }
+}
+
+int OccurrenceListModel::insertPosition(const Occurrence& occurrence) const
+{
+    auto it = std::upper_bound(m_occurrences.cbegin(), m_occurrences.cend(), occurrence,
+                               [this](const Occurrence& a, const Occurrence& b) {
+                                   return lessThan(a, b);
+                               });
+    return int(it - m_occurrences.cbegin());
+}
+
+// Where row belongs once taken out; every other row is still in order
+int OccurrenceListModel::movePosition(int row) const
+{
+    const Occurrence& occurrence = m_occurrences.at(row);
+    int position = 0;
+    for (int other = 0; other < m_occurrences.size(); ++other) {
+        if (other != row && !lessThan(occurrence, m_occurrences.at(other))) {
+            position++;
+        }
+    }
+    return position;
+}
+
+// Same order as the goal list: sortOrder, then title
+bool OccurrenceListModel::lessThan(const Occurrence& a, const Occurrence& b) const
+{
+    const Goal goalA = m_goals.value(a.goalId);
+    const Goal goalB = m_goals.value(b.goalId);
+    if (goalA.sortOrder != goalB.sortOrder) {
+        return goalA.sortOrder < goalB.sortOrder;
+    }
+    return goalA.title.localeAwareCompare(goalB.title) < 0;
+}
+
+QList<int> OccurrenceListModel::changedRoles(const Occurrence& before, const Occurrence& after)
+{
+    QList<int> roles;
+    if (before.status != after.status) roles << StatusRole;
+    if (before.completedAt != after.completedAt) roles << CompletedAtRole;
+    if (before.scoreImpact != after.scoreImpact) roles << ScoreImpactRole;
+    if (before.notes != after.notes) roles << NotesRole;
+    if (before.date != after.date) roles << DateRole;
+    return roles;
+}
+
+QList<int> OccurrenceListModel::changedGoalRoles(const Goal& before, const Goal& after)
+{
+    QList<int> roles;
+    if (before.title != after.title) roles << GoalTitleRole << Qt::DisplayRole;
+    if (before.scope != after.scope) roles << GoalScopeRole;
+    if (before.points != after.points) roles << GoalPointsRole;
+    if (before.category != after.category) roles << GoalCategoryRole;
+    if (before.iconName != after.iconName) roles << GoalIconNameRole;
+    if (before.colorHex != after.colorHex) roles << GoalColorHexRole;
+    return roles;
+}
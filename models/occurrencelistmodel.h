@@ -0,0 +1,76 @@
+#ifndef OCCURRENCELISTMODEL_H
+#define OCCURRENCELISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QDate>
+#include <QHash>
+#include <QList>
+#include "services/occurrenceservice.h"
+#include "services/goalservice.h"
+
+// One day's occurrences joined with their goals, in goal order. A status
+// change arrives as OccurrenceService::occurrenceUpdated and repaints only
+// that row's changed roles; goal edits update the joined roles in place.
+class OccurrenceListModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(QDate date READ date WRITE setDate NOTIFY dateChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    enum Roles {
+        IdRole = Qt::UserRole + 1,
+        GoalIdRole,
+        DateRole,
+        StatusRole,
+        CompletedAtRole,
+        ScoreImpactRole,
+        NotesRole,
+        GoalTitleRole,
+        GoalScopeRole,
+        GoalPointsRole,
+        GoalCategoryRole,
+        GoalIconNameRole,
+        GoalColorHexRole
+    };
+    Q_ENUM(Roles)
+
+    OccurrenceListModel(OccurrenceService* occurrenceService,
+                        GoalService* goalService,
+                        QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int count() const { return m_occurrences.size(); }
+    QDate date() const { return m_date; }
+    void setDate(const QDate& date);
+
+    Q_INVOKABLE void reload();
+    Q_INVOKABLE int indexOf(const QString& occurrenceId) const;
+    Q_INVOKABLE bool setStatus(int row, const QString& status);
+
+signals:
+    void dateChanged();
+    void countChanged();
+
+private:
+    void onOccurrenceUpdated(const Occurrence& occurrence);
+    void onGoalUpdated(const Goal& goal);
+    void onGoalDeleted(const QString& goalId);
+
+    int insertPosition(const Occurrence& occurrence) const;
+    int movePosition(int row) const;
+    bool lessThan(const Occurrence& a, const Occurrence& b) const;
+    static QList<int> changedRoles(const Occurrence& before, const Occurrence& after);
+    static QList<int> changedGoalRoles(const Goal& before, const Goal& after);
+
+    OccurrenceService* m_occurrenceService;
+    GoalService* m_goalService;
+    QDate m_date;
+    QList<Occurrence> m_occurrences;
+    QHash<QString, Goal> m_goals;
+};
+
+#endif // OCCURRENCELISTMODEL_H
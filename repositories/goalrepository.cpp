@@ -1,4 +1,5 @@
 #include "repositories/goalrepository.h"
+#include "database/slowquerylog.h"
 #include "logging/logger.h"
 #include "logging/requestscope.h"
 #include "logging/loggermacros.h"
@@ -39,11 +40,11 @@ Goal* GoalRepository::create(const Goal& goal)
     query.bindValue(":id", goalId);
     bindGoalValues(query, goal);
 
-    LOG_QUERY(scope.requestId(), sql, {
+    LOG_QUERY(scope, sql, {
                                           goalId, goal.title, goal.scope, goal.points
                                       });
 
-    if (!query.exec()) {
+    if (!SlowQueryLog::exec(query, "GoalRepository::create")) {
         scope.logError(query.lastError().text(), "DB_INSERT_FAILED");
         return nullptr;
     }
@@ -68,9 +69,7 @@ Goal* GoalRepository::create(const Goal& goal)
 
 Goal* GoalRepository::findById(const QString& id)
 {
-    RequestScope scope("GoalRepository::findById", "READ", {
-                                                               {"goalId", id}
-                                                           });
+    LightRequestScope scope("GoalRepository::findById", "READ");
 
     QString sql = "SELECT * FROM goals WHERE id = :id AND deleted_at IS NULL";
 
@@ -78,9 +77,9 @@ Goal* GoalRepository::findById(const QString& id)
     query.prepare(sql);
     query.bindValue(":id", id);
 
-    LOG_QUERY(scope.requestId(), sql, {id});
+    LOG_QUERY(scope, sql, {id});
 
-    if (!query.exec()) {
+    if (!SlowQueryLog::exec(query, "GoalRepository::findById")) {
         scope.logError(query.lastError().text(), "SQL_EXEC_FAILED");
         return nullptr;
     }
@@ -92,24 +91,21 @@ Goal* GoalRepository::findById(const QString& id)
 
     Goal* goal = mapFromRecord(query.record());
 
-    scope.logSuccess({
-        {"goalId", goal->id},
-        {"title", goal->title}
-    });
+    scope.logSuccess(1);
 
     return goal;
 }
 
 QList<Goal*> GoalRepository::findAll()
 {
-    RequestScope scope("GoalRepository::findAll", "READ", {});
+    LightRequestScope scope("GoalRepository::findAll", "READ");
 
     QString sql = "SELECT * FROM goals WHERE deleted_at IS NULL ORDER BY scope, sort_order, created_at";
 
     QSqlQuery query(m_db);
-    LOG_QUERY(scope.requestId(), sql, {});
+    LOG_QUERY(scope, sql, {});
 
-    if (!query.exec()) {
+    if (!SlowQueryLog::exec(query, "GoalRepository::findAll")) {
         scope.logError(query.lastError().text(), "SQL_EXEC_FAILED");
         return QList<Goal*>();
     }
@@ -119,18 +115,14 @@ QList<Goal*> GoalRepository::findAll()
         goals.append(mapFromRecord(query.record()));
     }
 
-    scope.logSuccess({
-        {"count", goals.size()}
-    });
+    scope.logSuccess(goals.size());
 
     return goals;
 }
 
 QList<Goal*> GoalRepository::findByScope(const QString& scope)
 {
-    RequestScope reqScope("GoalRepository::findByScope", "READ", {
-                                                                     {"scope", scope}
-                                                                 });
+    LightRequestScope reqScope("GoalRepository::findByScope", "READ");
 
     QString sql = "SELECT * FROM goals WHERE scope = :scope AND deleted_at IS NULL "
                   "ORDER BY sort_order, created_at";
@@ -139,9 +131,9 @@ QList<Goal*> GoalRepository::findByScope(const QString& scope)
     query.prepare(sql);
     query.bindValue(":scope", scope);
 
-    LOG_QUERY(reqScope.requestId(), sql, {scope});
+    LOG_QUERY(reqScope, sql, {scope});
 
-    if (!query.exec()) {
+    if (!SlowQueryLog::exec(query, "GoalRepository::findByScope")) {
         reqScope.logError(query.lastError().text(), "SQL_EXEC_FAILED");
         return QList<Goal*>();
     }
@@ -151,25 +143,22 @@ QList<Goal*> GoalRepository::findByScope(const QString& scope)
         goals.append(mapFromRecord(query.record()));
     }
 
-    reqScope.logSuccess({
-        {"scope", scope},
-        {"count", goals.size()}
-    });
+    reqScope.logSuccess(goals.size());
 
     return goals;
 }
 
 QList<Goal*> GoalRepository::findActiveGoals()
 {
-    RequestScope scope("GoalRepository::findActiveGoals", "READ", {});
+    LightRequestScope scope("GoalRepository::findActiveGoals", "READ");
 
     QString sql = "SELECT * FROM goals WHERE is_active = true AND deleted_at IS NULL "
                   "ORDER BY scope, sort_order, created_at";
 
     QSqlQuery query(m_db);
-    LOG_QUERY(scope.requestId(), sql, {});
+    LOG_QUERY(scope, sql, {});
 
-    if (!query.exec()) {
+    if (!SlowQueryLog::exec(query, "GoalRepository::findActiveGoals")) {
         scope.logError(query.lastError().text(), "SQL_EXEC_FAILED");
         return QList<Goal*>();
     }
@@ -179,9 +168,7 @@ QList<Goal*> GoalRepository::findActiveGoals()
         goals.append(mapFromRecord(query.record()));
     }
 
-    scope.logSuccess({
-        {"count", goals.size()}
-    });
+    scope.logSuccess(goals.size());
 
     return goals;
 }
@@ -215,9 +202,9 @@ bool GoalRepository::update(const Goal& goal)
     query.bindValue(":id", goal.id);
     bindGoalValues(query, goal);
 
-    LOG_QUERY(scope.requestId(), sql, {goal.id, goal.title});
+    LOG_QUERY(scope, sql, {goal.id, goal.title});
 
-    if (!query.exec()) {
+    if (!SlowQueryLog::exec(query, "GoalRepository::update")) {
         scope.logError(query.lastError().text(), "DB_UPDATE_FAILED");
         return false;
     }
@@ -243,15 +230,20 @@ bool GoalRepository::softDelete(const QString& id)
                                                                    {"goalId", id}
                                                                });
 
-    QString sql = "UPDATE goals SET deleted_at = CURRENT_TIMESTAMP WHERE id = :id AND deleted_at IS NULL";
+    // updated_at moves too, so sync carries the tombstone
+    QString sql = R"(
+        UPDATE goals
+        SET deleted_at = CURRENT_TIMESTAMP, updated_at = CURRENT_TIMESTAMP
+        WHERE id = :id AND deleted_at IS NULL
+    )";
 
     QSqlQuery query(m_db);
     query.prepare(sql);
     query.bindValue(":id", id);
 
-    LOG_QUERY(scope.requestId(), sql, {id});
+    LOG_QUERY(scope, sql, {id});
 
-    if (!query.exec()) {
+    if (!SlowQueryLog::exec(query, "GoalRepository::softDelete")) {
         scope.logError(query.lastError().text(), "DB_DELETE_FAILED");
         return false;
     }
@@ -283,9 +275,9 @@ bool GoalRepository::hardDelete(const QString& id)
     query.prepare(sql);
     query.bindValue(":id", id);
 
-    LOG_QUERY(scope.requestId(), sql, {id});
+    LOG_QUERY(scope, sql, {id});
 
-    if (!query.exec()) {
+    if (!SlowQueryLog::exec(query, "GoalRepository::hardDelete")) {
         scope.logError(query.lastError().text(), "DB_DELETE_FAILED");
         return false;
     }
@@ -313,7 +305,7 @@ int GoalRepository::countByScope(const QString& scope)
     query.prepare(sql);
     query.bindValue(":scope", scope);
 
-    if (!query.exec() || !query.next()) {
+    if (!SlowQueryLog::exec(query, "GoalRepository::countByScope") || !query.next()) {
         return 0;
     }
 
@@ -328,7 +320,7 @@ bool GoalRepository::exists(const QString& id)
     query.prepare(sql);
     query.bindValue(":id", id);
 
-    if (!query.exec() || !query.next()) {
+    if (!SlowQueryLog::exec(query, "GoalRepository::exists") || !query.next()) {
         return false;
     }
 
@@ -354,6 +346,42 @@ Goal* GoalRepository::mapFromRecord(const QSqlRecord& record)
     return goal;
 }
 
+QJsonObject GoalRepository::toJson(const Goal& goal)
+{
+    return {
+        {"id", goal.id},
+        {"title", goal.title},
+        {"scope", goal.scope},
+        {"points", goal.points},
+        {"missing_behavior", goal.missingBehavior},
+        {"penalty_points", goal.penaltyPoints},
+        {"category", goal.category},
+        {"notes", goal.notes},
+        {"icon_name", goal.iconName},
+        {"color_hex", goal.colorHex},
+        {"sort_order", goal.sortOrder},
+        {"is_active", goal.isActive}
+    };
+}
+
+Goal GoalRepository::fromJson(const QJsonObject& object)
+{
+    Goal goal;
+    goal.id = object.value("id").toString();
+    goal.title = object.value("title").toString();
+    goal.scope = object.value("scope").toString();
+    goal.points = object.value("points").toInt();
+    goal.missingBehavior = object.value("missing_behavior").toString();
+    goal.penaltyPoints = object.value("penalty_points").toInt();
+    goal.category = object.value("category").toString();
+    goal.notes = object.value("notes").toString();
+    goal.iconName = object.value("icon_name").toString();
+    goal.colorHex = object.value("color_hex").toString();
+    goal.sortOrder = object.value("sort_order").toInt();
+    goal.isActive = object.value("is_active").toBool(true);
+    return goal;
+}
+
 void GoalRepository::bindGoalValues(QSqlQuery& query, const Goal& goal)
 {
     query.bindValue(":title", goal.title);
@@ -45,6 +45,10 @@ public:
     int countByScope(const QString& scope);
     bool exists(const QString& id);
 
+    // Column-named JSON, as journaled for offline goal edits
+    static QJsonObject toJson(const Goal& goal);
+    static Goal fromJson(const QJsonObject& object);
+
 signals:
     void goalCreated(const QString& goalId);
     void goalUpdated(const QString& goalId);
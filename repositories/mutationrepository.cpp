@@ -0,0 +1,78 @@
+#include "repositories/mutationrepository.h"
+#include "database/slowquerylog.h"
+#include "database/sqlarrays.h"
+#include "logging/requestscope.h"
+#include "logging/loggermacros.h"
+#include <QSqlQuery>
+#include <QSqlError>
+
+MutationRepository::MutationRepository(QSqlDatabase db, QObject *parent)
+    : QObject(parent)
+    , m_db(db)
+{
+}
+
+bool MutationRepository::ensureSchema()
+{
+    QSqlQuery query(m_db);
+    query.prepare(R"(
+        CREATE TABLE IF NOT EXISTS applied_mutations (
+            mutation_id  UUID PRIMARY KEY,
+            applied_at   TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP
+        )
+    )");
+    return SlowQueryLog::exec(query, "MutationRepository::ensureSchema");
+}
+
+int MutationRepository::claim(const QStringList& mutationIds)
+{
+    if (mutationIds.isEmpty()) {
+        return 0;
+    }
+
+    LightRequestScope scope("MutationRepository::claim", "INSERT");
+
+    QString sql = R"(
+        INSERT INTO applied_mutations (mutation_id)
+        SELECT unnest(CAST(:ids AS uuid[]))
+        ON CONFLICT (mutation_id) DO NOTHING
+    )";
+
+    QSqlQuery query(m_db);
+    query.prepare(sql);
+    query.bindValue(":ids", SqlArrays::texts(mutationIds));
+
+    LOG_QUERY(scope, sql, {mutationIds.join(',')});
+
+    if (!SlowQueryLog::exec(query, "MutationRepository::claim")) {
+        scope.logError(query.lastError().text(), "SQL_EXEC_FAILED");
+        return -1;
+    }
+
+    int claimed = query.numRowsAffected();
+    scope.logSuccess(claimed);
+    return claimed;
+}
+
+bool MutationRepository::pruneAppliedBefore(const QDateTime& cutoff)
+{
+    RequestScope scope("MutationRepository::pruneAppliedBefore", "DELETE", {
+                                                                               {"cutoff", cutoff.toString(Qt::ISODate)}
+                                                                           });
+
+    QString sql = "DELETE FROM applied_mutations WHERE applied_at < :cutoff";
+
+    QSqlQuery query(m_db);
+    query.prepare(sql);
+    query.bindValue(":cutoff", cutoff);
+
+    LOG_QUERY(scope, sql, {cutoff});
+
+    if (!SlowQueryLog::exec(query, "MutationRepository::pruneAppliedBefore")) {
+        scope.logError(query.lastError().text(), "SQL_EXEC_FAILED");
+        return false;
+    }
+
+    scope.logSuccess({{"count", query.numRowsAffected()}});
+    return true;
+}
@@ -0,0 +1,33 @@
+#ifndef MUTATIONREPOSITORY_H
+#define MUTATIONREPOSITORY_H
+
+#include <QObject>
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+
+// Ids of journal mutations already applied to this database. Claiming an id
+// in the same transaction as the change it describes makes journal replay
+// idempotent: a claim that inserts nothing means the change is already in.
+class MutationRepository : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MutationRepository(QSqlDatabase db, QObject *parent = nullptr);
+
+    // Creates applied_mutations on databases set up before it existed
+    bool ensureSchema();
+
+    // Number of ids that were not applied before, -1 on error
+    int claim(const QStringList& mutationIds);
+
+    // Journals are compacted long before this; keeps the table small
+    bool pruneAppliedBefore(const QDateTime& cutoff);
+
+private:
+    QSqlDatabase m_db;
+};
+
+#endif // MUTATIONREPOSITORY_H
@@ -1,60 +1,736 @@
-#ifndef OCCURRENCEREPOSITORY_H
-#define OCCURRENCEREPOSITORY_H
-
-#include <QObject>
-#include <QSqlDatabase>
-#include <QString>
-#include <QList>
-#include <QDate>
-
-struct Occurrence {
-    QString id;
-    QString goalId;
-    QDate date;
-    QDate weekStart;
-    QDate monthStart;
-    QDate yearStart;
-    QString status;  // pending, completed, skipped, not_completed
-    QDateTime completedAt;
-    int scoreImpact;
-    QString notes;
-};
-
-class OccurrenceRepository : public QObject
-{
-    Q_OBJECT
-
-public:
-    explicit OccurrenceRepository(QSqlDatabase db, QObject *parent = nullptr);
-
-    // CRUD
-    Occurrence* create(const Occurrence& occurrence);
-    Occurrence* findById(const QString& id);
-    bool update(const Occurrence& occurrence);
-    bool updateStatus(const QString& id, const QString& status);
-
-    // Queries by time window
-    QList<Occurrence*> findByDate(const QDate& date);
-    QList<Occurrence*> findByWeek(const QDate& weekStart);
-    QList<Occurrence*> findByMonth(const QDate& monthStart);
-    QList<Occurrence*> findByYear(int year);
-
-    // Get or create
-    Occurrence* getOrCreate(const QString& goalId, const QDate& date, const QString& scope);
-
-    // Batch operations
-    void generateOccurrencesForDate(const QDate& date, const QList<QString>& goalIds);
-
-signals:
-    void occurrenceStatusChanged(const QString& occurrenceId);
-
-private:
-    Occurrence* mapFromRecord(const QSqlRecord& record);
-    QDate calculateWeekStart(const QDate& date);
-    QDate calculateMonthStart(const QDate& date);
-    QDate calculateYearStart(const QDate& date);
-
-    QSqlDatabase m_db;
-};
-
-#endif // OCCURRENCEREPOSITORY_H
+#include "repositories/occurrencerepository.h"
+#include "database/slowquerylog.h"
+#include "logging/logger.h"
+#include "logging/requestscope.h"
+#include "logging/loggermacros.h"
+#include "database/sqlarrays.h"
+#include <QHash>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QSqlError>
+#include <QVariant>
+#include <QUuid>
+
+// Score impact of an occurrence for a given status, derived from its goal:
+// completed applies points, not_completed applies the penalty (if configured),
+// skipped and pending apply nothing.
+static QString scoreImpactExpression(const QString& statusExpression)
+{
+    return QString(R"(
+        CASE %1
+            WHEN 'completed' THEN g.points
+            WHEN 'not_completed' THEN
+                CASE WHEN g.missing_behavior = 'penalty' THEN -g.penalty_points ELSE 0 END
+            ELSE 0
+        END
+    )").arg(statusExpression);
+}
+
+OccurrenceRepository::OccurrenceRepository(QSqlDatabase db, QObject *parent)
+    : QObject(parent)
+    , m_db(db)
+{
+}
+
+Occurrence* OccurrenceRepository::create(const Occurrence& occurrence)
+{
+    RequestScope scope("OccurrenceRepository::create", "CREATE", {
+                                                                     {"goalId", occurrence.goalId},
+                                                                     {"date", occurrence.date.toString("yyyy-MM-dd")}
+                                                                 });
+
+    QString sql = R"(
+        INSERT INTO occurrences (
+            id, goal_id, date, week_start, month_start, year_start,
+            status, completed_at, score_impact, notes
+        ) VALUES (
+            :id, :goal_id, :date, :week_start, :month_start, :year_start,
+            :status, :completed_at, :score_impact, :notes
+        ) RETURNING id
+    )";
+
+    QSqlQuery query(m_db);
+    query.prepare(sql);
+
+    QString occurrenceId = occurrence.id.isEmpty() ?
+                               QUuid::createUuid().toString(QUuid::WithoutBraces) : occurrence.id;
+
+    query.bindValue(":id", occurrenceId);
+    query.bindValue(":goal_id", occurrence.goalId);
+    query.bindValue(":date", occurrence.date);
+    query.bindValue(":week_start", calculateWeekStart(occurrence.date));
+    query.bindValue(":month_start", calculateMonthStart(occurrence.date));
+    query.bindValue(":year_start", calculateYearStart(occurrence.date));
+    query.bindValue(":status", occurrence.status.isEmpty() ? QString("pending") : occurrence.status);
+    query.bindValue(":completed_at", occurrence.completedAt.isValid() ?
+                                         occurrence.completedAt : QVariant(QVariant::DateTime));
+    query.bindValue(":score_impact", occurrence.scoreImpact);
+    query.bindValue(":notes", occurrence.notes);
+
+    LOG_QUERY(scope, sql, {occurrenceId, occurrence.goalId, occurrence.date});
+
+    if (!SlowQueryLog::exec(query, "OccurrenceRepository::create") || !query.next()) {
+        scope.logError(query.lastError().text(), "DB_INSERT_FAILED");
+        return nullptr;
+    }
+
+    QString newId = query.value(0).toString();
+    scope.logSuccess({{"occurrenceId", newId}});
+
+    return findById(newId);
+}
+
+Occurrence* OccurrenceRepository::findById(const QString& id)
+{
+    LightRequestScope scope("OccurrenceRepository::findById", "READ");
+
+    QString sql = "SELECT * FROM occurrences WHERE id = :id";
+
+    QSqlQuery query(m_db);
+    query.prepare(sql);
+    query.bindValue(":id", id);
+
+    LOG_QUERY(scope, sql, {id});
+
+    if (!SlowQueryLog::exec(query, "OccurrenceRepository::findById")) {
+        scope.logError(query.lastError().text(), "SQL_EXEC_FAILED");
+        return nullptr;
+    }
+
+    if (!query.next()) {
+        scope.logError("Occurrence not found", "NOT_FOUND");
+        return nullptr;
+    }
+
+    Occurrence* occurrence = mapFromRecord(query.record());
+
+    scope.logSuccess(1);
+
+    return occurrence;
+}
+
+bool OccurrenceRepository::update(const Occurrence& occurrence)
+{
+    RequestScope scope("OccurrenceRepository::update", "UPDATE", {
+                                                                     {"occurrenceId", occurrence.id}
+                                                                 });
+
+    QString sql = R"(
+        UPDATE occurrences SET
+            status = :status,
+            completed_at = :completed_at,
+            score_impact = :score_impact,
+            notes = :notes,
+            updated_at = CURRENT_TIMESTAMP
+        WHERE id = :id
+    )";
+
+    QSqlQuery query(m_db);
+    query.prepare(sql);
+    query.bindValue(":id", occurrence.id);
+    query.bindValue(":status", occurrence.status);
+    query.bindValue(":completed_at", occurrence.completedAt.isValid() ?
+                                         occurrence.completedAt : QVariant(QVariant::DateTime));
+    query.bindValue(":score_impact", occurrence.scoreImpact);
+    query.bindValue(":notes", occurrence.notes);
+
+    LOG_QUERY(scope, sql, {occurrence.id, occurrence.status});
+
+    if (!SlowQueryLog::exec(query, "OccurrenceRepository::update")) {
+        scope.logError(query.lastError().text(), "DB_UPDATE_FAILED");
+        return false;
+    }
+
+    int rowsAffected = query.numRowsAffected();
+    if (rowsAffected == 0) {
+        scope.logError("Occurrence not found", "NOT_FOUND");
+        return false;
+    }
+
+    scope.logSuccess({
+        {"occurrenceId", occurrence.id},
+        {"rowsAffected", rowsAffected}
+    });
+
+    emit occurrenceStatusChanged(occurrence.id);
+    return true;
+}
+
+bool OccurrenceRepository::updateStatus(const QString& id, const QString& status)
+{
+    RequestScope scope("OccurrenceRepository::updateStatus", "UPDATE", {
+                                                                           {"occurrenceId", id},
+                                                                           {"status", status}
+                                                                       });
+
+    QString sql = QString(R"(
+        UPDATE occurrences o SET
+            status = :status,
+            score_impact = %1,
+            completed_at = CASE WHEN :status = 'completed' THEN CURRENT_TIMESTAMP ELSE NULL END,
+            updated_at = CURRENT_TIMESTAMP
+        FROM goals g
+        WHERE g.id = o.goal_id AND o.id = :id
+    )").arg(scoreImpactExpression(":status"));
+
+    QSqlQuery query(m_db);
+    query.prepare(sql);
+    query.bindValue(":id", id);
+    query.bindValue(":status", status);
+
+    LOG_QUERY(scope, sql, {id, status});
+
+    if (!SlowQueryLog::exec(query, "OccurrenceRepository::updateStatus")) {
+        scope.logError(query.lastError().text(), "DB_UPDATE_FAILED");
+        return false;
+    }
+
+    int rowsAffected = query.numRowsAffected();
+    if (rowsAffected == 0) {
+        scope.logError("Occurrence not found", "NOT_FOUND");
+        return false;
+    }
+
+    scope.logSuccess({
+        {"occurrenceId", id},
+        {"status", status}
+    });
+
+    emit occurrenceStatusChanged(id);
+    return true;
+}
+
+QList<Occurrence*> OccurrenceRepository::findByDate(const QDate& date)
+{
+    return findByWindow("daily", "date", date);
+}
+
+QList<Occurrence*> OccurrenceRepository::findByWeek(const QDate& weekStart)
+{
+    return findByWindow("weekly", "week_start", weekStart);
+}
+
+QList<Occurrence*> OccurrenceRepository::findByMonth(const QDate& monthStart)
+{
+    return findByWindow("monthly", "month_start", monthStart);
+}
+
+QList<Occurrence*> OccurrenceRepository::findByYear(int year)
+{
+    return findByWindow("yearly", "year_start", QDate(year, 1, 1));
+}
+
+Occurrence* OccurrenceRepository::getOrCreate(const QString& goalId, const QDate& date, const QString& scope)
+{
+    QDate windowDate = date;
+    if (scope == "weekly") {
+        windowDate = calculateWeekStart(date);
+    } else if (scope == "monthly") {
+        windowDate = calculateMonthStart(date);
+    } else if (scope == "yearly") {
+        windowDate = calculateYearStart(date);
+    }
+
+    QSqlQuery query(m_db);
+    query.prepare("SELECT * FROM occurrences WHERE goal_id = :goal_id AND date = :date");
+    query.bindValue(":goal_id", goalId);
+    query.bindValue(":date", windowDate);
+
+    if (SlowQueryLog::exec(query, "OccurrenceRepository::getOrCreate") && query.next()) {
+        return mapFromRecord(query.record());
+    }
+
+    Occurrence occurrence;
+    occurrence.goalId = goalId;
+    occurrence.date = windowDate;
+    occurrence.status = "pending";
+    occurrence.scoreImpact = 0;
+
+    return create(occurrence);
+}
+
+void OccurrenceRepository::generateOccurrencesForDate(const QDate& date, const QList<QString>& goalIds)
+{
+    RequestScope scope("OccurrenceRepository::generateOccurrencesForDate", "CREATE", {
+                                                                                         {"date", date.toString("yyyy-MM-dd")},
+                                                                                         {"goalCount", goalIds.size()}
+                                                                                     });
+
+    QString sql = R"(
+        INSERT INTO occurrences (
+            id, goal_id, date, week_start, month_start, year_start, status, score_impact
+        )
+        SELECT gen_random_uuid(), w.goal_id, w.window_date,
+               CAST(date_trunc('week', w.window_date) AS date),
+               CAST(date_trunc('month', w.window_date) AS date),
+               CAST(date_trunc('year', w.window_date) AS date),
+               'pending', 0
+        FROM (
+            SELECT g.id AS goal_id,
+                   CASE g.scope
+                       WHEN 'weekly'  THEN CAST(date_trunc('week', CAST(:date AS date)) AS date)
+                       WHEN 'monthly' THEN CAST(date_trunc('month', CAST(:date AS date)) AS date)
+                       WHEN 'yearly'  THEN CAST(date_trunc('year', CAST(:date AS date)) AS date)
+                       ELSE CAST(:date AS date)
+                   END AS window_date
+            FROM goals g
+            WHERE CAST(g.id AS text) = ANY(CAST(:goal_ids AS text[]))
+              AND g.deleted_at IS NULL
+        ) w
+        WHERE NOT EXISTS (
+            SELECT 1 FROM occurrences o
+            WHERE o.goal_id = w.goal_id AND o.date = w.window_date
+        )
+    )";
+
+    QSqlQuery query(m_db);
+    query.prepare(sql);
+    query.bindValue(":date", date);
+    query.bindValue(":goal_ids", SqlArrays::texts(goalIds));
+
+    LOG_QUERY(scope, sql, {date, goalIds.size()});
+
+    if (!SlowQueryLog::exec(query, "OccurrenceRepository::generateOccurrencesForDate")) {
+        scope.logError(query.lastError().text(), "DB_INSERT_FAILED");
+        return;
+    }
+
+    scope.logSuccess({{"created", query.numRowsAffected()}});
+}
+
+bool OccurrenceRepository::generateOccurrencesForRange(const QDate& from, const QDate& to,
+                                                       QList<OccurrenceWindow>* windows)
+{
+    RequestScope scope("OccurrenceRepository::generateOccurrencesForRange", "CREATE", {
+                                                                                          {"from", from.toString("yyyy-MM-dd")},
+                                                                                          {"to", to.toString("yyyy-MM-dd")}
+                                                                                      });
+
+    // Expand every active goal over the days in range, collapse the days to
+    // the goal's window, and insert whatever windows are still missing.
+    // Goals only get windows from the day they were created.
+    QString sql = R"(
+        WITH days AS (
+            SELECT CAST(d AS date) AS day
+            FROM generate_series(CAST(:from AS date), CAST(:to AS date), interval '1 day') AS d
+        ), windows AS (
+            SELECT DISTINCT g.id AS goal_id,
+                   CASE g.scope
+                       WHEN 'weekly'  THEN CAST(date_trunc('week', days.day) AS date)
+                       WHEN 'monthly' THEN CAST(date_trunc('month', days.day) AS date)
+                       WHEN 'yearly'  THEN CAST(date_trunc('year', days.day) AS date)
+                       ELSE days.day
+                   END AS window_date
+            FROM goals g
+            CROSS JOIN days
+            WHERE g.is_active = true
+              AND g.deleted_at IS NULL
+              AND CAST(g.created_at AS date) <= days.day
+        ), inserted AS (
+            INSERT INTO occurrences (
+                id, goal_id, date, week_start, month_start, year_start, status, score_impact
+            )
+            SELECT gen_random_uuid(), w.goal_id, w.window_date,
+                   CAST(date_trunc('week', w.window_date) AS date),
+                   CAST(date_trunc('month', w.window_date) AS date),
+                   CAST(date_trunc('year', w.window_date) AS date),
+                   'pending', 0
+            FROM windows w
+            WHERE NOT EXISTS (
+                SELECT 1 FROM occurrences o
+                WHERE o.goal_id = w.goal_id AND o.date = w.window_date
+            )
+            RETURNING goal_id, date
+        )
+        SELECT g.scope, i.date AS window_start, COUNT(*) AS affected
+        FROM inserted i
+        JOIN goals g ON g.id = i.goal_id
+        GROUP BY g.scope, i.date
+    )";
+
+    QSqlQuery query(m_db);
+    query.prepare(sql);
+    query.bindValue(":from", from);
+    query.bindValue(":to", to);
+
+    LOG_QUERY(scope, sql, {from, to});
+
+    if (!SlowQueryLog::exec(query, "OccurrenceRepository::generateOccurrencesForRange")) {
+        scope.logError(query.lastError().text(), "DB_INSERT_FAILED");
+        return false;
+    }
+
+    *windows = readWindows(query);
+
+    scope.logSuccess({
+        {"windows", windows->size()}
+    });
+
+    return true;
+}
+
+bool OccurrenceRepository::finalizeExpiredOccurrences(const QDate& today, QList<OccurrenceWindow>* windows,
+                                                      int* finalizedCount)
+{
+    RequestScope scope("OccurrenceRepository::finalizeExpiredOccurrences", "UPDATE", {
+                                                                                         {"today", today.toString("yyyy-MM-dd")}
+                                                                                     });
+
+    // A window has expired once the day after its last day has started.
+    QString sql = QString(R"(
+        WITH expired AS (
+            UPDATE occurrences o SET
+                status = 'not_completed',
+                score_impact = %1,
+                updated_at = CURRENT_TIMESTAMP
+            FROM goals g
+            WHERE g.id = o.goal_id
+              AND o.status = 'pending'
+              AND CASE g.scope
+                      WHEN 'weekly'  THEN o.week_start + 7
+                      WHEN 'monthly' THEN CAST(o.month_start + interval '1 month' AS date)
+                      WHEN 'yearly'  THEN CAST(o.year_start + interval '1 year' AS date)
+                      ELSE o.date + 1
+                  END <= CAST(:today AS date)
+            RETURNING g.scope, o.date
+        )
+        SELECT scope, date AS window_start, COUNT(*) AS affected
+        FROM expired
+        GROUP BY scope, date
+    )").arg(scoreImpactExpression("'not_completed'"));
+
+    QSqlQuery query(m_db);
+    query.prepare(sql);
+    query.bindValue(":today", today);
+
+    LOG_QUERY(scope, sql, {today});
+
+    if (!SlowQueryLog::exec(query, "OccurrenceRepository::finalizeExpiredOccurrences")) {
+        scope.logError(query.lastError().text(), "DB_UPDATE_FAILED");
+        return false;
+    }
+
+    int total = 0;
+    *windows = readWindows(query, &total);
+
+    if (finalizedCount) {
+        *finalizedCount = total;
+    }
+
+    scope.logSuccess({
+        {"windows", windows->size()},
+        {"finalized", total}
+    });
+
+    return true;
+}
+
+bool OccurrenceRepository::rescoreGoalOccurrences(const QString& goalId,
+                                                  bool includeUnchangedWindows,
+                                                  QList<OccurrenceWindowDelta>* deltas)
+{
+    RequestScope scope("OccurrenceRepository::rescoreGoalOccurrences", "UPDATE", {
+                                                                                     {"goalId", goalId}
+                                                                                 });
+
+    // Only rows whose impact actually changes are written; the per-window
+    // sums come back from the same statement.
+    QString sql = QString(R"(
+        WITH changes AS (
+            SELECT o.id, g.scope, o.date AS window_start,
+                   o.score_impact AS old_impact,
+                   %1 AS new_impact
+            FROM occurrences o
+            JOIN goals g ON g.id = o.goal_id
+            WHERE o.goal_id = :goal_id
+        ), updated AS (
+            UPDATE occurrences o SET
+                score_impact = c.new_impact,
+                updated_at = CURRENT_TIMESTAMP
+            FROM changes c
+            WHERE o.id = c.id AND c.new_impact <> c.old_impact
+            RETURNING o.id, c.new_impact - c.old_impact AS delta
+        )
+        SELECT c.scope, c.window_start,
+               COALESCE(SUM(u.delta), 0) AS delta,
+               COUNT(u.id) AS rescored
+        FROM changes c
+        LEFT JOIN updated u ON u.id = c.id
+        GROUP BY c.scope, c.window_start
+        HAVING COUNT(u.id) > 0 OR :include_unchanged
+    )").arg(scoreImpactExpression("o.status"));
+
+    QSqlQuery query(m_db);
+    query.prepare(sql);
+    query.bindValue(":goal_id", goalId);
+    query.bindValue(":include_unchanged", includeUnchangedWindows);
+
+    LOG_QUERY(scope, sql, {goalId, includeUnchangedWindows});
+
+    if (!SlowQueryLog::exec(query, "OccurrenceRepository::rescoreGoalOccurrences")) {
+        scope.logError(query.lastError().text(), "DB_UPDATE_FAILED");
+        return false;
+    }
+
+    int rescored = 0;
+    int windows = 0;
+    while (query.next()) {
+        OccurrenceWindowDelta delta;
+        delta.scope = query.value("scope").toString();
+        delta.windowStart = query.value("window_start").toDate();
+        delta.earnedDelta = query.value("delta").toInt();
+        delta.rescoredCount = query.value("rescored").toInt();
+        rescored += delta.rescoredCount;
+        windows++;
+        if (deltas) {
+            deltas->append(delta);
+        }
+    }
+
+    scope.logSuccess({
+        {"goalId", goalId},
+        {"windows", windows},
+        {"rescored", rescored}
+    });
+
+    return true;
+}
+
+QDate OccurrenceRepository::calculateWeekStart(const QDate& date)
+{
+    // ISO 8601: Monday is day 1
+    return date.addDays(1 - date.dayOfWeek());
+}
+
+QDate OccurrenceRepository::calculateMonthStart(const QDate& date)
+{
+    return QDate(date.year(), date.month(), 1);
+}
+
+QDate OccurrenceRepository::calculateYearStart(const QDate& date)
+{
+    return QDate(date.year(), 1, 1);
+}
+
+QDate OccurrenceRepository::calculateWindowStart(const QString& scope, const QDate& date)
+{
+    if (scope == "weekly") {
+        return calculateWeekStart(date);
+    }
+    if (scope == "monthly") {
+        return calculateMonthStart(date);
+    }
+    if (scope == "yearly") {
+        return calculateYearStart(date);
+    }
+    return date;
+}
+
+bool OccurrenceRepository::rewindowGoalOccurrences(const QString& goalId, const QString& scope,
+                                                   QList<QDate>* oldWindows, QList<QDate>* newWindows)
+{
+    RequestScope reqScope("OccurrenceRepository::rewindowGoalOccurrences", "UPDATE", {
+                                                                                        {"goalId", goalId},
+                                                                                        {"scope", scope}
+                                                                                    });
+
+    QString sql = "SELECT id, date, status FROM occurrences WHERE goal_id = :goal_id ORDER BY date";
+
+    QSqlQuery query(m_db);
+    query.prepare(sql);
+    query.bindValue(":goal_id", goalId);
+
+    LOG_QUERY(reqScope, sql, {goalId});
+
+    if (!SlowQueryLog::exec(query, "OccurrenceRepository::rewindowGoalOccurrences")) {
+        reqScope.logError(query.lastError().text(), "SQL_EXEC_FAILED");
+        return false;
+    }
+
+    // A coarser scope folds several occurrences into one window: a
+    // completed one wins, otherwise the most recent. A finer scope keeps
+    // each occurrence in the window holding its date.
+    struct Kept {
+        QString id;
+        QDate date;
+        QString status;
+    };
+    QHash<QDate, Kept> kept;
+    QStringList removedIds;
+    while (query.next()) {
+        Kept occurrence{query.value(0).toString(), query.value(1).toDate(), query.value(2).toString()};
+        QDate windowStart = calculateWindowStart(scope, occurrence.date);
+        oldWindows->append(occurrence.date);
+
+        auto existing = kept.find(windowStart);
+        if (existing == kept.end()) {
+            kept.insert(windowStart, occurrence);
+            newWindows->append(windowStart);
+        } else if (existing->status == "completed" && occurrence.status != "completed") {
+            removedIds.append(occurrence.id);
+        } else {
+            removedIds.append(existing->id);
+            *existing = occurrence;
+        }
+    }
+
+    QStringList movedIds;
+    QList<QDate> fromDates;
+    QList<QDate> dates;
+    QList<QDate> weekStarts;
+    QList<QDate> monthStarts;
+    QList<QDate> yearStarts;
+    for (auto it = kept.cbegin(); it != kept.cend(); ++it) {
+        if (it->date == it.key()) {
+            continue;
+        }
+        movedIds.append(it->id);
+        fromDates.append(it->date);
+        dates.append(it.key());
+        weekStarts.append(calculateWeekStart(it.key()));
+        monthStarts.append(calculateMonthStart(it.key()));
+        yearStarts.append(calculateYearStart(it.key()));
+    }
+
+    // Every (goal_id, date) left empty is recorded in superseded_occurrences
+    // with the occurrence as it stood, so the history survives and sync and
+    // backups can remove the key elsewhere. Folded occurrences go first so
+    // the moves never meet them on (goal_id, date); window starts map to
+    // themselves, so two kept occurrences never collide either.
+    const QString supersedeSql = R"(
+        INSERT INTO superseded_occurrences
+            (occurrence_id, goal_id, date, status, completed_at, score_impact, notes, created_at)
+        SELECT id, goal_id, %1, status, completed_at, score_impact, notes, created_at
+        FROM %2
+        ON CONFLICT (goal_id, date) DO UPDATE SET
+            occurrence_id = EXCLUDED.occurrence_id,
+            status = EXCLUDED.status,
+            completed_at = EXCLUDED.completed_at,
+            score_impact = EXCLUDED.score_impact,
+            notes = EXCLUDED.notes,
+            created_at = EXCLUDED.created_at,
+            updated_at = CURRENT_TIMESTAMP
+    )";
+
+    if (!removedIds.isEmpty()) {
+        QString foldSql = "WITH folded AS ("
+                          "DELETE FROM occurrences WHERE id = ANY(CAST(:ids AS uuid[])) RETURNING *) "
+                          + QString(supersedeSql).arg("date", "folded");
+        QSqlQuery foldQuery(m_db);
+        foldQuery.prepare(foldSql);
+        foldQuery.bindValue(":ids", SqlArrays::texts(removedIds));
+
+        LOG_QUERY(reqScope, foldSql, {removedIds.size()});
+
+        if (!SlowQueryLog::exec(foldQuery, "OccurrenceRepository::rewindowGoalOccurrences")) {
+            reqScope.logError(foldQuery.lastError().text(), "DB_DELETE_FAILED");
+            return false;
+        }
+    }
+
+    if (!movedIds.isEmpty()) {
+        QString moveSql = R"(
+            WITH moved AS (
+                UPDATE occurrences o SET
+                    date = m.date,
+                    week_start = m.week_start,
+                    month_start = m.month_start,
+                    year_start = m.year_start,
+                    updated_at = CURRENT_TIMESTAMP
+                FROM unnest(CAST(:ids AS uuid[]), CAST(:from_dates AS date[]), CAST(:dates AS date[]),
+                            CAST(:week_starts AS date[]), CAST(:month_starts AS date[]),
+                            CAST(:year_starts AS date[]))
+                     AS m(id, from_date, date, week_start, month_start, year_start)
+                WHERE o.id = m.id
+                RETURNING o.*, m.from_date
+            )
+        )" + QString(supersedeSql).arg("from_date", "moved");
+        QSqlQuery moveQuery(m_db);
+        moveQuery.prepare(moveSql);
+        moveQuery.bindValue(":ids", SqlArrays::texts(movedIds));
+        moveQuery.bindValue(":from_dates", SqlArrays::dates(fromDates));
+        moveQuery.bindValue(":dates", SqlArrays::dates(dates));
+        moveQuery.bindValue(":week_starts", SqlArrays::dates(weekStarts));
+        moveQuery.bindValue(":month_starts", SqlArrays::dates(monthStarts));
+        moveQuery.bindValue(":year_starts", SqlArrays::dates(yearStarts));
+
+        LOG_QUERY(reqScope, moveSql, {movedIds.size()});
+
+        if (!SlowQueryLog::exec(moveQuery, "OccurrenceRepository::rewindowGoalOccurrences")) {
+            reqScope.logError(moveQuery.lastError().text(), "DB_UPDATE_FAILED");
+            return false;
+        }
+    }
+
+    reqScope.logSuccess({
+        {"goalId", goalId},
+        {"moved", movedIds.size()},
+        {"folded", removedIds.size()}
+    });
+    return true;
+}
+
+QList<Occurrence*> OccurrenceRepository::findByWindow(const QString& scope,
+                                                      const QString& column,
+                                                      const QDate& windowStart)
+{
+    LightRequestScope reqScope("OccurrenceRepository::findByWindow", "READ");
+
+    QString sql = QString("SELECT o.* FROM occurrences o "
+                          "JOIN goals g ON g.id = o.goal_id "
+                          "WHERE o.%1 = :window_start AND g.scope = :scope AND g.deleted_at IS NULL "
+                          "ORDER BY g.sort_order, g.created_at").arg(column);
+
+    QSqlQuery query(m_db);
+    query.prepare(sql);
+    query.bindValue(":window_start", windowStart);
+    query.bindValue(":scope", scope);
+
+    LOG_QUERY(reqScope, sql, {windowStart, scope});
+
+    if (!SlowQueryLog::exec(query, "OccurrenceRepository::findByWindow")) {
+        reqScope.logError(query.lastError().text(), "SQL_EXEC_FAILED");
+        return QList<Occurrence*>();
+    }
+
+    QList<Occurrence*> occurrences;
+    while (query.next()) {
+        occurrences.append(mapFromRecord(query.record()));
+    }
+
+    reqScope.logSuccess(occurrences.size());
+
+    return occurrences;
+}
+
+QList<OccurrenceWindow> OccurrenceRepository::readWindows(QSqlQuery& query, int* affected)
+{
+    QList<OccurrenceWindow> windows;
+    while (query.next()) {
+        OccurrenceWindow window;
+        window.scope = query.value("scope").toString();
+        window.windowStart = query.value("window_start").toDate();
+        windows.append(window);
+        if (affected) {
+            *affected += query.value("affected").toInt();
+        }
+    }
+    return windows;
+}
+
+Occurrence* OccurrenceRepository::mapFromRecord(const QSqlRecord& record)
+{
+    Occurrence* occurrence = new Occurrence();
+    occurrence->id = record.value("id").toString();
+    occurrence->goalId = record.value("goal_id").toString();
+    occurrence->date = record.value("date").toDate();
+    occurrence->weekStart = record.value("week_start").toDate();
+    occurrence->monthStart = record.value("month_start").toDate();
+    occurrence->yearStart = record.value("year_start").toDate();
+    occurrence->status = record.value("status").toString();
+    occurrence->completedAt = record.value("completed_at").toDateTime();
+    occurrence->scoreImpact = record.value("score_impact").toInt();
+    occurrence->notes = record.value("notes").toString();
+
+    return occurrence;
+}
@@ -6,6 +6,8 @@
 #include <QString>
 #include <QList>
 #include <QDate>
+#include <QDateTime>
+#include <QSqlQuery>
 
 struct Occurrence {
     QString id;
@@ -20,6 +22,21 @@ struct Occurrence {
     QString notes;
 };
 
+// A scoring window touched by a bulk operation. windowStart is the occurrence
+// date for daily goals and the week/month/year start for the other scopes.
+struct OccurrenceWindow {
+    QString scope;
+    QDate windowStart;
+};
+
+// Net change of earned score in one window after a goal was rescored.
+struct OccurrenceWindowDelta {
+    QString scope;
+    QDate windowStart;
+    int earnedDelta;
+    int rescoredCount;
+};
+
 class OccurrenceRepository : public QObject
 {
     Q_OBJECT
@@ -45,14 +62,36 @@ public:
     // Batch operations
     void generateOccurrencesForDate(const QDate& date, const QList<QString>& goalIds);
 
+    // Set-based rollover operations (one statement each). They return false
+    // on failure and hand the touched windows back through windows.
+    bool generateOccurrencesForRange(const QDate& from, const QDate& to, QList<OccurrenceWindow>* windows);
+    bool finalizeExpiredOccurrences(const QDate& today, QList<OccurrenceWindow>* windows,
+                                    int* finalizedCount = nullptr);
+
+    // Re-derive score_impact for one goal's occurrences (one statement).
+    // Returns false on failure; the per-window sums go to deltas.
+    bool rescoreGoalOccurrences(const QString& goalId, bool includeUnchangedWindows,
+                                QList<OccurrenceWindowDelta>* deltas = nullptr);
+    // Moves one goal's occurrences onto the windows of its new scope, one
+    // occurrence per window; the dates they leave are kept in
+    // superseded_occurrences. Receives the window starts left and entered.
+    bool rewindowGoalOccurrences(const QString& goalId, const QString& scope,
+                                 QList<QDate>* oldWindows, QList<QDate>* newWindows);
+
+    // Window helpers
+    QDate calculateWeekStart(const QDate& date);
+    QDate calculateMonthStart(const QDate& date);
+    QDate calculateYearStart(const QDate& date);
+    QDate calculateWindowStart(const QString& scope, const QDate& date);
+
 signals:
     void occurrenceStatusChanged(const QString& occurrenceId);
 
 private:
     Occurrence* mapFromRecord(const QSqlRecord& record);
-    QDate calculateWeekStart(const QDate& date);
-    QDate calculateMonthStart(const QDate& date);
-    QDate calculateYearStart(const QDate& date);
+    QList<Occurrence*> findByWindow(const QString& scope, const QString& column, const QDate& windowStart);
+    // Reads (scope, window_start[, affected]) rows; sums affected if asked
+    QList<OccurrenceWindow> readWindows(QSqlQuery& query, int* affected = nullptr);
 
     QSqlDatabase m_db;
 };
@@ -1,7 +1,9 @@
 #include "repositories/scorerepository.h"
+#include "database/slowquerylog.h"
 #include "logging/logger.h"
 #include "logging/requestscope.h"
 #include "logging/loggermacros.h"
+#include "database/sqlarrays.h"
 #include <QSqlQuery>
 #include <QSqlRecord>
 #include <QSqlError>
@@ -56,9 +58,9 @@ bool ScoreRepository::upsertDailyScore(const DailyScore& score)
     query.bindValue(":perfect", score.perfectDay);
     query.bindValue(":negative", score.hasNegativeOutcome);
 
-    LOG_QUERY(scope.requestId(), sql, {score.date, score.earnedScore});
+    LOG_QUERY(scope, sql, {score.date, score.earnedScore});
 
-    if (!query.exec()) {
+    if (!SlowQueryLog::exec(query, "ScoreRepository::upsertDailyScore")) {
         scope.logError(query.lastError().text(), "DB_UPSERT_FAILED");
         return false;
     }
@@ -107,7 +109,7 @@ bool ScoreRepository::upsertWeeklyScore(const WeeklyScore& score)
     query.bindValue(":pending", score.pendingCount);
     query.bindValue(":total", score.totalCount);
 
-    return query.exec();
+    return SlowQueryLog::exec(query, "ScoreRepository::upsertWeeklyScore");
 }
 
 bool ScoreRepository::upsertMonthlyScore(const MonthlyScore& score)
@@ -146,7 +148,7 @@ bool ScoreRepository::upsertMonthlyScore(const MonthlyScore& score)
     query.bindValue(":pending", score.pendingCount);
     query.bindValue(":total", score.totalCount);
 
-    return query.exec();
+    return SlowQueryLog::exec(query, "ScoreRepository::upsertMonthlyScore");
 }
 
 bool ScoreRepository::upsertYearlyScore(const YearlyScore& score)
@@ -184,7 +186,135 @@ bool ScoreRepository::upsertYearlyScore(const YearlyScore& score)
     query.bindValue(":pending", score.pendingCount);
     query.bindValue(":total", score.totalCount);
 
-    return query.exec();
+    return SlowQueryLog::exec(query, "ScoreRepository::upsertYearlyScore");
+}
+
+bool ScoreRepository::rebuildDailyScores(const QList<QDate>& dates)
+{
+    return rebuildScores("daily", dates);
+}
+
+bool ScoreRepository::rebuildWeeklyScores(const QList<QDate>& weekStarts)
+{
+    return rebuildScores("weekly", weekStarts);
+}
+
+bool ScoreRepository::rebuildMonthlyScores(const QList<QDate>& monthStarts)
+{
+    return rebuildScores("monthly", monthStarts);
+}
+
+bool ScoreRepository::rebuildYearlyScores(const QList<QDate>& yearStarts)
+{
+    return rebuildScores("yearly", yearStarts);
+}
+
+bool ScoreRepository::applyScoreDeltas(const QString& scope,
+                                       const QList<QDate>& windowStarts,
+                                       const QList<int>& earnedDeltas,
+                                       int targetDelta,
+                                       QList<DailyOutcomeChange>* outcomeChanges)
+{
+    if (windowStarts.isEmpty()) {
+        return true;
+    }
+
+    RequestScope reqScope("ScoreRepository::applyScoreDeltas", "UPDATE", {
+                                                                            {"scope", scope},
+                                                                            {"windows", windowStarts.size()},
+                                                                            {"targetDelta", targetDelta}
+                                                                        });
+
+    QString table = "daily_scores";
+    QString keyColumn = "date";
+    if (scope == "weekly") {
+        table = "weekly_scores";
+        keyColumn = "week_start";
+    } else if (scope == "monthly") {
+        table = "monthly_scores";
+        keyColumn = "month_start";
+    } else if (scope == "yearly") {
+        table = "yearly_scores";
+        keyColumn = "year_start";
+    }
+
+    bool isDaily = (table == "daily_scores");
+
+    // Rows that were never calculated are left alone; they pick up the new
+    // values the first time their window is recalculated.
+    QString negativeUpdate = isDaily ? QString(R"(
+            has_negative_outcome = EXISTS (
+                SELECT 1 FROM occurrences o
+                JOIN goals g ON g.id = o.goal_id AND g.scope = 'daily' AND g.deleted_at IS NULL
+                WHERE o.date = s.date AND o.status = 'not_completed' AND o.score_impact < 0
+            ),)") : QString();
+
+    QString sql = QString(R"(
+        WITH v AS (
+            SELECT CAST(w AS date) AS window_start, d AS delta
+            FROM unnest(CAST(:windows AS date[]), CAST(:deltas AS int[])) AS t(w, d)
+        ), previous AS (
+            SELECT s.%2 AS window_start, s.completion_percentage, %3 AS negative
+            FROM %1 s
+            JOIN v ON v.window_start = s.%2
+        ), adjusted AS (
+            UPDATE %1 s SET
+                earned_score = s.earned_score + v.delta,
+                target_score = s.target_score + :target_delta,
+                completion_percentage = CASE
+                    WHEN s.target_score + :target_delta > 0
+                    THEN (s.earned_score + v.delta) * 100.0 / (s.target_score + :target_delta)
+                    ELSE 0
+                END,%4
+                updated_at = CURRENT_TIMESTAMP
+            FROM v
+            WHERE s.%2 = v.window_start
+            RETURNING s.%2 AS window_start, s.completion_percentage, %5 AS negative
+        )
+        SELECT a.window_start,
+               p.completion_percentage AS old_percentage, a.completion_percentage AS new_percentage,
+               p.negative AS old_negative, a.negative AS new_negative
+        FROM adjusted a
+        JOIN previous p ON p.window_start = a.window_start
+    )").arg(table,
+             keyColumn,
+             isDaily ? QString("s.has_negative_outcome") : QString("false"),
+             negativeUpdate,
+             isDaily ? QString("s.has_negative_outcome") : QString("false"));
+
+    QSqlQuery query(m_db);
+    query.prepare(sql);
+    query.bindValue(":windows", SqlArrays::dates(windowStarts));
+    query.bindValue(":deltas", SqlArrays::ints(earnedDeltas));
+    query.bindValue(":target_delta", targetDelta);
+
+    LOG_QUERY(reqScope, sql, {scope, windowStarts.size(), targetDelta});
+
+    if (!SlowQueryLog::exec(query, "ScoreRepository::applyScoreDeltas")) {
+        reqScope.logError(query.lastError().text(), "DB_UPDATE_FAILED");
+        return false;
+    }
+
+    int adjusted = 0;
+    while (query.next()) {
+        adjusted++;
+        if (isDaily && outcomeChanges) {
+            DailyOutcomeChange change;
+            change.date = query.value("window_start").toDate();
+            change.oldPercentage = query.value("old_percentage").toDouble();
+            change.newPercentage = query.value("new_percentage").toDouble();
+            change.oldNegative = query.value("old_negative").toBool();
+            change.newNegative = query.value("new_negative").toBool();
+            outcomeChanges->append(change);
+        }
+    }
+
+    reqScope.logSuccess({
+        {"scope", scope},
+        {"rowsAffected", adjusted}
+    });
+
+    return true;
 }
 
 DailyScore* ScoreRepository::getDailyScore(const QDate& date)
@@ -195,7 +325,7 @@ DailyScore* ScoreRepository::getDailyScore(const QDate& date)
     query.prepare(sql);
     query.bindValue(":date", date);
 
-    if (!query.exec() || !query.next()) {
+    if (!SlowQueryLog::exec(query, "ScoreRepository::getDailyScore") || !query.next()) {
         return nullptr;
     }
 
@@ -210,7 +340,7 @@ WeeklyScore* ScoreRepository::getWeeklyScore(const QDate& weekStart)
     query.prepare(sql);
     query.bindValue(":week_start", weekStart);
 
-    if (!query.exec() || !query.next()) {
+    if (!SlowQueryLog::exec(query, "ScoreRepository::getWeeklyScore") || !query.next()) {
         return nullptr;
     }
 
@@ -225,7 +355,7 @@ MonthlyScore* ScoreRepository::getMonthlyScore(const QDate& monthStart)
     query.prepare(sql);
     query.bindValue(":month_start", monthStart);
 
-    if (!query.exec() || !query.next()) {
+    if (!SlowQueryLog::exec(query, "ScoreRepository::getMonthlyScore") || !query.next()) {
         return nullptr;
     }
 
@@ -241,7 +371,7 @@ YearlyScore* ScoreRepository::getYearlyScore(int year)
     query.prepare(sql);
     query.bindValue(":year_start", yearStart);
 
-    if (!query.exec() || !query.next()) {
+    if (!SlowQueryLog::exec(query, "ScoreRepository::getYearlyScore") || !query.next()) {
         return nullptr;
     }
 
@@ -258,7 +388,7 @@ QList<DailyScore*> ScoreRepository::getDailyScoreRange(const QDate& start, const
     query.bindValue(":end", end);
 
     QList<DailyScore*> scores;
-    if (query.exec()) {
+    if (SlowQueryLog::exec(query, "ScoreRepository::getDailyScoreRange")) {
         while (query.next()) {
             scores.append(mapDailyFromRecord(query.record()));
         }
@@ -276,7 +406,7 @@ QList<WeeklyScore*> ScoreRepository::getWeeklyScoreRange(int weekCount)
     query.bindValue(":limit", weekCount);
 
     QList<WeeklyScore*> scores;
-    if (query.exec()) {
+    if (SlowQueryLog::exec(query, "ScoreRepository::getWeeklyScoreRange")) {
         while (query.next()) {
             scores.append(mapWeeklyFromRecord(query.record()));
         }
@@ -294,7 +424,7 @@ QList<MonthlyScore*> ScoreRepository::getMonthlyScoreRange(int monthCount)
     query.bindValue(":limit", monthCount);
 
     QList<MonthlyScore*> scores;
-    if (query.exec()) {
+    if (SlowQueryLog::exec(query, "ScoreRepository::getMonthlyScoreRange")) {
         while (query.next()) {
             scores.append(mapMonthlyFromRecord(query.record()));
         }
@@ -303,6 +433,52 @@ QList<MonthlyScore*> ScoreRepository::getMonthlyScoreRange(int monthCount)
     return scores;
 }
 
+QList<QPointF> ScoreRepository::getDailySeries(const QDate& start, const QDate& end,
+                                               const QString& metric)
+{
+    LightRequestScope scope("ScoreRepository::getDailySeries", "READ");
+
+    // Column names cannot be bound; only the two known metrics are accepted
+    QString sql = metric == "earned"
+        ? R"(
+        SELECT date, earned_score FROM daily_scores
+        WHERE date >= :start AND date <= :end
+        ORDER BY date
+    )"
+        : R"(
+        SELECT date, completion_percentage FROM daily_scores
+        WHERE date >= :start AND date <= :end
+        ORDER BY date
+    )";
+
+    QSqlQuery query(m_db);
+    query.setForwardOnly(true);
+    query.prepare(sql);
+    query.bindValue(":start", start);
+    query.bindValue(":end", end);
+
+    LOG_QUERY(scope, sql, {start.toString("yyyy-MM-dd"), end.toString("yyyy-MM-dd")});
+
+    QList<QPointF> series;
+    if (!SlowQueryLog::exec(query, "ScoreRepository::getDailySeries")) {
+        scope.logError(query.lastError().text(), "SQL_EXEC_FAILED");
+        return series;
+    }
+
+    // Local-midnight timestamps would shift with DST; days are laid out on
+    // a UTC axis so consecutive points are exactly one day apart
+    constexpr qint64 kUnixEpochJulianDay = 2440588;
+    constexpr qint64 kMsPerDay = 86400000;
+    series.reserve(qMax<qint64>(0, start.daysTo(end) + 1));
+    while (query.next()) {
+        qint64 day = query.value(0).toDate().toJulianDay() - kUnixEpochJulianDay;
+        series.append(QPointF(double(day * kMsPerDay), query.value(1).toDouble()));
+    }
+
+    scope.logSuccess(series.size());
+    return series;
+}
+
 DailyScore* ScoreRepository::mapDailyFromRecord(const QSqlRecord& record)
 {
     DailyScore* score = new DailyScore();
@@ -373,3 +549,127 @@ YearlyScore* ScoreRepository::mapYearlyFromRecord(const QSqlRecord& record)
 
     return score;
 }
+
+bool ScoreRepository::rebuildScores(const QString& scope, const QList<QDate>& windowStarts)
+{
+    if (windowStarts.isEmpty()) {
+        return true;
+    }
+
+    RequestScope reqScope("ScoreRepository::rebuildScores", "UPSERT", {
+                                                                         {"scope", scope},
+                                                                         {"windows", windowStarts.size()}
+                                                                     });
+
+    // Mirrors ScoreService::calculateFromOccurrences: target is the sum of
+    // positive points of the scope's goals, earned is the sum of score impacts.
+    QString table;
+    QString occurrenceColumn;
+    QString keyColumn;
+    QString extraColumns;
+    QString extraValues;
+    QString extraUpdates;
+
+    if (scope == "weekly") {
+        table = "weekly_scores";
+        occurrenceColumn = "week_start";
+        keyColumn = "week_start";
+        extraColumns = "year, week_number,";
+        extraValues = "CAST(EXTRACT(YEAR FROM c.window_start) AS int), "
+                      "CAST(EXTRACT(WEEK FROM c.window_start) AS int),";
+    } else if (scope == "monthly") {
+        table = "monthly_scores";
+        occurrenceColumn = "month_start";
+        keyColumn = "month_start";
+        extraColumns = "year, month,";
+        extraValues = "CAST(EXTRACT(YEAR FROM c.window_start) AS int), "
+                      "CAST(EXTRACT(MONTH FROM c.window_start) AS int),";
+    } else if (scope == "yearly") {
+        table = "yearly_scores";
+        occurrenceColumn = "year_start";
+        keyColumn = "year_start";
+        extraColumns = "year,";
+        extraValues = "CAST(EXTRACT(YEAR FROM c.window_start) AS int),";
+    } else {
+        table = "daily_scores";
+        occurrenceColumn = "date";
+        keyColumn = "date";
+        extraUpdates = ", perfect_day = EXCLUDED.perfect_day, "
+                       "has_negative_outcome = EXCLUDED.has_negative_outcome";
+    }
+
+    bool isDaily = (table == "daily_scores");
+
+    QString sql = QString(R"(
+        WITH windows AS (
+            SELECT DISTINCT CAST(w AS date) AS window_start
+            FROM unnest(CAST(:windows AS date[])) AS w
+        ), target AS (
+            SELECT COALESCE(SUM(points), 0) AS target_score
+            FROM goals
+            WHERE scope = :scope AND deleted_at IS NULL AND points > 0
+        ), calc AS (
+            SELECT w.window_start,
+                   COALESCE(SUM(o.score_impact), 0) AS earned,
+                   COUNT(o.id) FILTER (WHERE o.status = 'completed') AS completed,
+                   COUNT(o.id) FILTER (WHERE o.status = 'skipped') AS skipped,
+                   COUNT(o.id) FILTER (WHERE o.status = 'not_completed') AS not_completed,
+                   COUNT(o.id) FILTER (WHERE o.status = 'pending') AS pending,
+                   COUNT(o.id) AS total,
+                   COALESCE(BOOL_OR(o.status = 'not_completed' AND o.score_impact < 0), false) AS negative
+            FROM windows w
+            LEFT JOIN (occurrences o
+                       JOIN goals g ON g.id = o.goal_id AND g.scope = :scope AND g.deleted_at IS NULL)
+                ON o.%2 = w.window_start
+            GROUP BY w.window_start
+        )
+        INSERT INTO %1 (
+            %3, %4 earned_score, target_score, completion_percentage,
+            completed_count, skipped_count, not_completed_count, pending_count, total_count
+            %5
+        )
+        SELECT c.window_start, %6 c.earned, t.target_score,
+               CASE WHEN t.target_score > 0 THEN c.earned * 100.0 / t.target_score ELSE 0 END,
+               c.completed, c.skipped, c.not_completed, c.pending, c.total
+               %7
+        FROM calc c
+        CROSS JOIN target t
+        ON CONFLICT (%3) DO UPDATE SET
+            earned_score = EXCLUDED.earned_score,
+            target_score = EXCLUDED.target_score,
+            completion_percentage = EXCLUDED.completion_percentage,
+            completed_count = EXCLUDED.completed_count,
+            skipped_count = EXCLUDED.skipped_count,
+            not_completed_count = EXCLUDED.not_completed_count,
+            pending_count = EXCLUDED.pending_count,
+            total_count = EXCLUDED.total_count,
+            updated_at = CURRENT_TIMESTAMP
+            %8
+    )").arg(table,
+             occurrenceColumn,
+             keyColumn,
+             extraColumns,
+             isDaily ? QString(", perfect_day, has_negative_outcome") : QString(),
+             extraValues,
+             isDaily ? QString(", (c.completed = c.total AND c.total > 0), c.negative") : QString(),
+             extraUpdates);
+
+    QSqlQuery query(m_db);
+    query.prepare(sql);
+    query.bindValue(":windows", SqlArrays::dates(windowStarts));
+    query.bindValue(":scope", scope);
+
+    LOG_QUERY(reqScope, sql, {scope, windowStarts.size()});
+
+    if (!SlowQueryLog::exec(query, "ScoreRepository::rebuildScores")) {
+        reqScope.logError(query.lastError().text(), "DB_UPSERT_FAILED");
+        return false;
+    }
+
+    reqScope.logSuccess({
+        {"scope", scope},
+        {"rowsAffected", query.numRowsAffected()}
+    });
+
+    return true;
+}
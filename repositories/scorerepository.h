@@ -6,6 +6,7 @@
 #include <QString>
 #include <QDate>
 #include <QList>
+#include <QPointF>
 
 struct DailyScore {
     QDate date;
@@ -62,6 +63,15 @@ struct YearlyScore {
     int totalCount;
 };
 
+// Streak-relevant outcome of a day before and after an in-place adjustment.
+struct DailyOutcomeChange {
+    QDate date;
+    double oldPercentage;
+    double newPercentage;
+    bool oldNegative;
+    bool newNegative;
+};
+
 class ScoreRepository : public QObject
 {
     Q_OBJECT
@@ -75,6 +85,20 @@ public:
     bool upsertMonthlyScore(const MonthlyScore& score);
     bool upsertYearlyScore(const YearlyScore& score);
 
+    // Set-based recalculation of many windows in one statement
+    bool rebuildDailyScores(const QList<QDate>& dates);
+    bool rebuildWeeklyScores(const QList<QDate>& weekStarts);
+    bool rebuildMonthlyScores(const QList<QDate>& monthStarts);
+    bool rebuildYearlyScores(const QList<QDate>& yearStarts);
+
+    // Adjust existing rows in place by per-window earned deltas and a shared
+    // target delta. Daily adjustments report how each day's outcome changed.
+    bool applyScoreDeltas(const QString& scope,
+                          const QList<QDate>& windowStarts,
+                          const QList<int>& earnedDeltas,
+                          int targetDelta,
+                          QList<DailyOutcomeChange>* outcomeChanges = nullptr);
+
     // Fetch scores
     DailyScore* getDailyScore(const QDate& date);
     WeeklyScore* getWeeklyScore(const QDate& weekStart);
@@ -86,7 +110,15 @@ public:
     QList<WeeklyScore*> getWeeklyScoreRange(int weekCount);
     QList<MonthlyScore*> getMonthlyScoreRange(int monthCount);
 
+    // Packed (ms since epoch, value) pairs in date order, for long-range
+    // charts that downsample before handing points to QML. metric is
+    // "completion" (completion_percentage) or "earned" (earned_score).
+    QList<QPointF> getDailySeries(const QDate& start, const QDate& end,
+                                  const QString& metric = "completion");
+
 private:
+    bool rebuildScores(const QString& scope, const QList<QDate>& windowStarts);
+
     DailyScore* mapDailyFromRecord(const QSqlRecord& record);
     WeeklyScore* mapWeeklyFromRecord(const QSqlRecord& record);
     MonthlyScore* mapMonthlyFromRecord(const QSqlRecord& record);
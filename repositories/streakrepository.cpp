@@ -1,4 +1,5 @@
 #include "repositories/streakrepository.h"
+#include "database/slowquerylog.h"
 #include "logging/logger.h"
 #include "logging/requestscope.h"
 #include "logging/loggermacros.h"
@@ -50,9 +51,9 @@ Streak* StreakRepository::create(const Streak& streak)
     query.bindValue(":failures", streak.totalFailures);
     query.bindValue(":rate", streak.successRate);
 
-    LOG_QUERY(scope.requestId(), sql, {streakId, streak.scope});
+    LOG_QUERY(scope, sql, {streakId, streak.scope});
 
-    if (!query.exec() || !query.next()) {
+    if (!SlowQueryLog::exec(query, "StreakRepository::create") || !query.next()) {
         scope.logError(query.lastError().text(), "DB_INSERT_FAILED");
         return nullptr;
     }
@@ -71,7 +72,7 @@ Streak* StreakRepository::findById(const QString& id)
     query.prepare(sql);
     query.bindValue(":id", id);
 
-    if (!query.exec() || !query.next()) {
+    if (!SlowQueryLog::exec(query, "StreakRepository::findById") || !query.next()) {
         return nullptr;
     }
 
@@ -87,7 +88,7 @@ Streak* StreakRepository::findByGoalAndScope(const QString& goalId, const QStrin
     query.bindValue(":goal_id", goalId);
     query.bindValue(":scope", scope);
 
-    if (!query.exec() || !query.next()) {
+    if (!SlowQueryLog::exec(query, "StreakRepository::findByGoalAndScope") || !query.next()) {
         return nullptr;
     }
 
@@ -102,7 +103,7 @@ Streak* StreakRepository::findOverallByScope(const QString& scope)
     query.prepare(sql);
     query.bindValue(":scope", scope);
 
-    if (!query.exec() || !query.next()) {
+    if (!SlowQueryLog::exec(query, "StreakRepository::findOverallByScope") || !query.next()) {
         return nullptr;
     }
 
@@ -141,9 +142,9 @@ bool StreakRepository::update(const Streak& streak)
     query.bindValue(":failures", streak.totalFailures);
     query.bindValue(":rate", streak.successRate);
 
-    LOG_QUERY(scope.requestId(), sql, {streak.id});
+    LOG_QUERY(scope, sql, {streak.id});
 
-    if (!query.exec()) {
+    if (!SlowQueryLog::exec(query, "StreakRepository::update")) {
         scope.logError(query.lastError().text(), "DB_UPDATE_FAILED");
         return false;
     }
@@ -190,6 +191,173 @@ Streak* StreakRepository::getOrCreateOverall(const QString& scope)
     return create(streak);
 }
 
+bool StreakRepository::recordOverallDailyDay(const QDate& date, bool success, const Streak& streak)
+{
+    RequestScope scope("StreakRepository::recordOverallDailyDay", "UPDATE", {
+                                                                               {"date", date.toString("yyyy-MM-dd")}
+                                                                           });
+
+    QString sql = R"(
+        INSERT INTO streak_days (date, success, current_streak, longest_streak,
+                                 total_successes, total_failures)
+        VALUES (:date, :success, :current, :longest, :successes, :failures)
+        ON CONFLICT (date) DO UPDATE SET
+            success = EXCLUDED.success,
+            current_streak = EXCLUDED.current_streak,
+            longest_streak = EXCLUDED.longest_streak,
+            total_successes = EXCLUDED.total_successes,
+            total_failures = EXCLUDED.total_failures,
+            updated_at = CURRENT_TIMESTAMP
+    )";
+
+    QSqlQuery query(m_db);
+    query.prepare(sql);
+    query.bindValue(":date", date);
+    query.bindValue(":success", success);
+    query.bindValue(":current", streak.currentStreak);
+    query.bindValue(":longest", streak.longestStreak);
+    query.bindValue(":successes", streak.totalSuccesses);
+    query.bindValue(":failures", streak.totalFailures);
+
+    LOG_QUERY(scope, sql, {date, success});
+
+    if (!SlowQueryLog::exec(query, "StreakRepository::recordOverallDailyDay")) {
+        scope.logError(query.lastError().text(), "DB_UPDATE_FAILED");
+        return false;
+    }
+
+    scope.logSuccess({{"date", date.toString("yyyy-MM-dd")}});
+    return true;
+}
+
+bool StreakRepository::replayOverallDailyStreak(double successThreshold, const QDate& from,
+                                                const QDate& upTo)
+{
+    RequestScope scope("StreakRepository::replayOverallDailyStreak", "UPDATE", {
+                                                                                  {"threshold", successThreshold},
+                                                                                  {"from", from.toString("yyyy-MM-dd")},
+                                                                                  {"upTo", upTo.toString("yyyy-MM-dd")}
+                                                                              });
+
+    // Only days the streak evaluated (those in streak_days) count. Every
+    // failure starts a new run; the run before the first failure continues
+    // the seed's current streak.
+    QString sql = R"(
+        WITH seed AS (
+            SELECT COALESCE(MAX(current_streak), 0) AS current_streak,
+                   COALESCE(MAX(longest_streak), 0) AS longest_streak,
+                   COALESCE(MAX(total_successes), 0) AS total_successes,
+                   COALESCE(MAX(total_failures), 0) AS total_failures
+            FROM (SELECT * FROM streak_days WHERE date < :from ORDER BY date DESC LIMIT 1) prior
+        ), outcomes AS (
+            SELECT d.date,
+                   (s.completion_percentage >= :threshold AND NOT s.has_negative_outcome) AS success
+            FROM streak_days d
+            JOIN daily_scores s ON s.date = d.date
+            WHERE d.date >= :from AND d.date <= :up_to
+        ), runs AS (
+            SELECT date, success,
+                   SUM(CASE WHEN success THEN 0 ELSE 1 END) OVER (ORDER BY date) AS run_id,
+                   COUNT(*) FILTER (WHERE success) OVER (ORDER BY date) AS successes,
+                   COUNT(*) FILTER (WHERE NOT success) OVER (ORDER BY date) AS failures
+            FROM outcomes
+        ), states AS (
+            SELECT r.date, r.success,
+                   CASE WHEN NOT r.success THEN 0
+                        ELSE COUNT(*) FILTER (WHERE r.success)
+                                 OVER (PARTITION BY r.run_id ORDER BY r.date)
+                             + CASE WHEN r.run_id = 0 THEN seed.current_streak ELSE 0 END
+                   END AS current_streak,
+                   seed.longest_streak AS seed_longest,
+                   seed.total_successes + r.successes AS total_successes,
+                   seed.total_failures + r.failures AS total_failures
+            FROM runs r
+            CROSS JOIN seed
+        ), replayed AS (
+            SELECT date, success, current_streak, total_successes, total_failures,
+                   GREATEST(seed_longest, MAX(current_streak) OVER (ORDER BY date)) AS longest_streak
+            FROM states
+        ), stored AS (
+            UPDATE streak_days d SET
+                success = r.success,
+                current_streak = r.current_streak,
+                longest_streak = r.longest_streak,
+                total_successes = r.total_successes,
+                total_failures = r.total_failures,
+                updated_at = CURRENT_TIMESTAMP
+            FROM replayed r
+            WHERE d.date = r.date
+        )
+        UPDATE streaks s SET
+            current_streak = l.current_streak,
+            longest_streak = l.longest_streak,
+            last_success_date = COALESCE(
+                (SELECT MAX(date) FROM replayed WHERE success),
+                (SELECT MAX(date) FROM streak_days WHERE date < :from AND success)),
+            last_break_date = COALESCE(
+                (SELECT MAX(date) FROM replayed WHERE NOT success),
+                (SELECT MAX(date) FROM streak_days WHERE date < :from AND NOT success)),
+            total_successes = l.total_successes,
+            total_failures = l.total_failures,
+            success_rate = CASE WHEN l.total_successes + l.total_failures > 0
+                                THEN l.total_successes * 100.0 / (l.total_successes + l.total_failures)
+                                ELSE 0 END,
+            updated_at = CURRENT_TIMESTAMP
+        FROM (SELECT * FROM replayed ORDER BY date DESC LIMIT 1) l
+        WHERE s.goal_id IS NULL AND s.scope = 'daily'
+    )";
+
+    QSqlQuery query(m_db);
+    query.prepare(sql);
+    query.bindValue(":threshold", successThreshold);
+    query.bindValue(":from", from);
+    query.bindValue(":up_to", upTo);
+
+    LOG_QUERY(scope, sql, {successThreshold, from, upTo});
+
+    if (!SlowQueryLog::exec(query, "StreakRepository::replayOverallDailyStreak")) {
+        scope.logError(query.lastError().text(), "DB_UPDATE_FAILED");
+        return false;
+    }
+
+    scope.logSuccess({{"rowsAffected", query.numRowsAffected()}});
+    return true;
+}
+
+bool StreakRepository::evaluateOverallDailyStreak(double successThreshold, const QDate& from,
+                                                  const QDate& upTo)
+{
+    RequestScope scope("StreakRepository::evaluateOverallDailyStreak", "UPDATE", {
+                                                                                    {"from", from.toString("yyyy-MM-dd")},
+                                                                                    {"upTo", upTo.toString("yyyy-MM-dd")}
+                                                                                });
+
+    // Placeholder states; the replay fills them in
+    QString sql = R"(
+        INSERT INTO streak_days (date, success, current_streak, longest_streak,
+                                 total_successes, total_failures)
+        SELECT date, false, 0, 0, 0, 0
+        FROM daily_scores
+        WHERE date >= :from AND date <= :up_to
+        ON CONFLICT (date) DO NOTHING
+    )";
+
+    QSqlQuery query(m_db);
+    query.prepare(sql);
+    query.bindValue(":from", from);
+    query.bindValue(":up_to", upTo);
+
+    LOG_QUERY(scope, sql, {from, upTo});
+
+    if (!SlowQueryLog::exec(query, "StreakRepository::evaluateOverallDailyStreak")) {
+        scope.logError(query.lastError().text(), "DB_UPDATE_FAILED");
+        return false;
+    }
+
+    scope.logSuccess({{"rowsAffected", query.numRowsAffected()}});
+    return replayOverallDailyStreak(successThreshold, from, upTo);
+}
+
 Streak* StreakRepository::mapFromRecord(const QSqlRecord& record)
 {
     Streak* streak = new Streak();
@@ -37,6 +37,15 @@ public:
     Streak* getOrCreate(const QString& goalId, const QString& scope);
     Streak* getOrCreateOverall(const QString& scope);
 
+    // Stores the overall daily streak as it stands after evaluating date
+    bool recordOverallDailyDay(const QDate& date, bool success, const Streak& streak);
+    // Replays the overall daily streak over the recorded days from..upTo,
+    // starting from the state recorded for the day before from
+    bool replayOverallDailyStreak(double successThreshold, const QDate& from, const QDate& upTo);
+    // Counts every daily score in from..upTo as evaluated, then replays
+    // them; for generated histories
+    bool evaluateOverallDailyStreak(double successThreshold, const QDate& from, const QDate& upTo);
+
 private:
     Streak* mapFromRecord(const QSqlRecord& record);
 
@@ -17,6 +17,9 @@ public:
     Q_INVOKABLE QList<DailyScore*> getMonthCalendar(int year, int month);
     Q_INVOKABLE QList<DailyScore*> getWeekCalendar(const QDate& weekStart);
 
+    // Monday-to-Sunday range of whole weeks covering the month
+    static void monthGridRange(int year, int month, QDate* firstMonday, QDate* lastSunday);
+
     // Date helpers
     Q_INVOKABLE QDate getWeekStart(const QDate& date);
     Q_INVOKABLE QDate getMonthStart(const QDate& date);
@@ -1,6 +1,8 @@
 #include "services/goalservice.h"
 #include "logging/logger.h"
 #include "logging/requestscope.h"
+#include "database/databasemanager.h"
+#include "database/mutationjournal.h"
 #include <QRegularExpression>
 
 GoalService::GoalService(GoalRepository* goalRepo, QObject *parent)
@@ -12,7 +14,8 @@ GoalService::GoalService(GoalRepository* goalRepo, QObject *parent)
             this, [this](const QString& goalId) {
                 Goal* goal = m_goalRepo->findById(goalId);
                 if (goal) {
-                    emit goalCreated(goal);
+                    emit goalCreated(*goal);
+                    delete goal;
                 }
             });
 
@@ -20,7 +23,8 @@ GoalService::GoalService(GoalRepository* goalRepo, QObject *parent)
             this, [this](const QString& goalId) {
                 Goal* goal = m_goalRepo->findById(goalId);
                 if (goal) {
-                    emit goalUpdated(goal);
+                    emit goalUpdated(*goal);
+                    delete goal;
                 }
             });
 
@@ -155,8 +159,29 @@ bool GoalService::updateGoal(Goal* goal)
         return false;
     }
 
-    // Check if goal exists
-    if (!m_goalRepo->exists(goal->id)) {
+    if (!DatabaseManager::instance().isConnected() && journalUpdate(*goal)) {
+        scope.logSuccess({
+            {"goalId", goal->id},
+            {"journaled", true}
+        });
+        return true;
+    }
+
+    // Check if goal exists (keeping the stored version to detect scoring changes)
+    Goal* existing = m_goalRepo->findById(goal->id);
+    if (!existing) {
+        if (!DatabaseManager::instance().checkConnection()) {
+            if (journalUpdate(*goal)) {
+                scope.logSuccess({
+                    {"goalId", goal->id},
+                    {"journaled", true}
+                });
+                return true;
+            }
+            scope.logError("Database unavailable and journal write failed", "JOURNAL_FAILED");
+            emit errorOccurred("Failed to save goal offline");
+            return false;
+        }
         scope.logError("Goal does not exist", "NOT_FOUND");
         emit errorOccurred("Goal not found");
         return false;
@@ -168,16 +193,54 @@ bool GoalService::updateGoal(Goal* goal)
     if (!success) {
         scope.logError("Failed to update goal in repository", "UPDATE_FAILED");
         emit errorOccurred("Failed to update goal");
+        delete existing;
         return false;
     }
 
+    bool rescore = scoringChanged(*existing, *goal);
+
     scope.logSuccess({
-        {"goalId", goal->id}
+        {"goalId", goal->id},
+        {"scoringChanged", rescore}
     });
 
+    if (rescore) {
+        emit scoringRulesChanged(goal->id, existing->scope, goal->scope,
+                                 existing->points, goal->points);
+    }
+
+    delete existing;
     return true;
 }
 
+bool GoalService::journalUpdate(const Goal& goal)
+{
+    MutationJournal& journal = MutationJournal::instance();
+    // Not reported as saved unless the edit is on disk
+    if (!journal.isOpen() || !journal.append("goal.update", GoalRepository::toJson(goal))) {
+        return false;
+    }
+    emit goalUpdated(goal);
+    return true;
+}
+
+void GoalService::notifyGoalReplayed(const Goal& before, const Goal& after)
+{
+    emit goalUpdated(after);
+    if (scoringChanged(before, after)) {
+        emit scoringRulesChanged(after.id, before.scope, after.scope,
+                                 before.points, after.points);
+    }
+}
+
+bool GoalService::scoringChanged(const Goal& before, const Goal& after)
+{
+    return before.points != after.points
+           || before.penaltyPoints != after.penaltyPoints
+           || before.missingBehavior != after.missingBehavior
+           || before.scope != after.scope;
+}
+
 bool GoalService::deleteGoal(const QString& goalId)
 {
     RequestScope scope("GoalService::deleteGoal", "DELETE", {
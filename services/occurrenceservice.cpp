@@ -1,21 +1,25 @@
 #include "services/occurrenceservice.h"
 #include "logging/logger.h"
 #include "logging/requestscope.h"
+#include "services/writebehindqueue.h"
+#include <QDateTime>
 
 OccurrenceService::OccurrenceService(OccurrenceRepository* occurrenceRepo, QObject *parent)
     : QObject(parent)
     , m_occurrenceRepo(occurrenceRepo)
+    , m_writeBehindQueue(nullptr)
 {
     connect(m_occurrenceRepo, &OccurrenceRepository::occurrenceStatusChanged,
             this, [this](const QString& occurrenceId) {
                 Occurrence* occurrence = m_occurrenceRepo->findById(occurrenceId);
                 if (occurrence) {
-                    emit occurrenceUpdated(occurrence);
+                    emit occurrenceUpdated(*occurrence);
 
                     // Trigger score recalculation
                     if (occurrence->date.isValid()) {
                         emit scoresNeedRecalculation(occurrence->date);
                     }
+                    delete occurrence;
                 }
             });
 }
@@ -65,6 +69,76 @@ bool OccurrenceService::setStatus(const QString& occurrenceId, const QString& st
     return true;
 }
 
+void OccurrenceService::setWriteBehindQueue(WriteBehindQueue* queue)
+{
+    if (m_writeBehindQueue) {
+        disconnect(m_writeBehindQueue, nullptr, this, nullptr);
+    }
+    m_writeBehindQueue = queue;
+    if (!queue) {
+        return;
+    }
+
+    // Stored rows replace the prediction (completed_at comes from the server)
+    connect(queue, &WriteBehindQueue::committed, this, [this](const Occurrence& stored) {
+        if (!stored.id.isEmpty()) {
+            emit occurrenceUpdated(stored);
+        }
+    });
+    connect(queue, &WriteBehindQueue::rolledBack, this,
+            [this](const Occurrence& optimistic, const Occurrence& restored,
+                   const QString& goalScope, const QString& error) {
+                emit occurrencePredicted(optimistic, restored, goalScope);
+                emit occurrenceUpdated(restored);
+                emit statusWriteFailed(restored.id, error);
+            });
+}
+
+bool OccurrenceService::setStatusOptimistic(const Occurrence& current, const Goal& goal,
+                                            const QString& status)
+{
+    if (!m_writeBehindQueue) {
+        return setStatus(current.id, status);
+    }
+
+    QStringList validStatuses = {"pending", "completed", "skipped", "not_completed"};
+    if (!validStatuses.contains(status)) {
+        Logger::instance().warn("OccurrenceService::setStatusOptimistic", "validation",
+                                "Invalid status", {
+                                    {"occurrenceId", current.id},
+                                    {"status", status}
+                                });
+        return false;
+    }
+    if (current.status == status) {
+        return true;
+    }
+
+    // current may refer to a row that listeners of occurrenceUpdated
+    // overwrite with the prediction; the queue needs the confirmed state
+    const Occurrence confirmed = current;
+    Occurrence predicted = confirmed;
+    predicted.status = status;
+    predicted.scoreImpact = predictedScoreImpact(goal, status);
+    predicted.completedAt = status == "completed" ? QDateTime::currentDateTime() : QDateTime();
+
+    emit occurrencePredicted(confirmed, predicted, goal.scope);
+    emit occurrenceUpdated(predicted);
+    m_writeBehindQueue->enqueueStatus(confirmed, predicted, goal.scope);
+    return true;
+}
+
+int OccurrenceService::predictedScoreImpact(const Goal& goal, const QString& status)
+{
+    if (status == "completed") {
+        return goal.points;
+    }
+    if (status == "not_completed" && goal.missingBehavior == "penalty") {
+        return -goal.penaltyPoints;
+    }
+    return 0;
+}
+
 QList<Occurrence*> OccurrenceService::getOccurrencesForDate(const QDate& date)
 {
     return m_occurrenceRepo->findByDate(date);
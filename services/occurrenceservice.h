@@ -6,6 +6,9 @@
 #include <QDate>
 #include <QList>
 #include "repositories/occurrencerepository.h"
+#include "repositories/goalrepository.h"
+
+class WriteBehindQueue;
 
 class OccurrenceService : public QObject
 {
@@ -20,6 +23,15 @@ public:
     bool markNotCompleted(const QString& occurrenceId);
     bool setStatus(const QString& occurrenceId, const QString& status);
 
+    // Optimistic status change: emits the predicted row at once and stores
+    // it through the write-behind queue. Falls back to setStatus() when no
+    // queue is set.
+    void setWriteBehindQueue(WriteBehindQueue* queue);
+    bool setStatusOptimistic(const Occurrence& current, const Goal& goal, const QString& status);
+
+    // Same rule as the score_impact the repository stores
+    static int predictedScoreImpact(const Goal& goal, const QString& status);
+
     // Queries
     QList<Occurrence*> getOccurrencesForDate(const QDate& date);
     QList<Occurrence*> getOccurrencesForWeek(const QDate& date);
@@ -30,11 +42,18 @@ public:
     void ensureOccurrencesExist(const QDate& date, const QList<Goal*>& goals);
 
 signals:
-    void occurrenceUpdated(Occurrence* occurrence);
+    // Receivers copy what they need; the occurrence is freed after emission
+    void occurrenceUpdated(const Occurrence& occurrence);
     void scoresNeedRecalculation(const QDate& date);
+    // A change shown before it is stored (or undone after a failed write),
+    // for in-memory aggregates to apply ahead of the recalculated scores
+    void occurrencePredicted(const Occurrence& before, const Occurrence& after,
+                             const QString& goalScope);
+    void statusWriteFailed(const QString& occurrenceId, const QString& error);
 
 private:
     OccurrenceRepository* m_occurrenceRepo;
+    WriteBehindQueue* m_writeBehindQueue;
 };
 
 #endif // OCCURRENCESERVICE_H
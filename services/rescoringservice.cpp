@@ -0,0 +1,109 @@
+#include "services/rescoringservice.h"
+#include "database/databasemanager.h"
+#include "logging/logger.h"
+#include "logging/requestscope.h"
+
+RescoringService::RescoringService(OccurrenceRepository* occurrenceRepo,
+                                   ScoreRepository* scoreRepo,
+                                   ScoreService* scoreService,
+                                   StreakService* streakService,
+                                   QObject *parent)
+    : QObject(parent)
+    , m_occurrenceRepo(occurrenceRepo)
+    , m_scoreRepo(scoreRepo)
+    , m_scoreService(scoreService)
+    , m_streakService(streakService)
+{
+}
+
+bool RescoringService::rescoreGoal(const QString& goalId,
+                                   const QString& oldScope,
+                                   const QString& newScope,
+                                   int oldPoints,
+                                   int newPoints)
+{
+    RequestScope scope("RescoringService::rescoreGoal", "RESCORE", {
+                                                                      {"goalId", goalId},
+                                                                      {"oldPoints", oldPoints},
+                                                                      {"newPoints", newPoints},
+                                                                      {"scopeChanged", oldScope != newScope}
+                                                                  });
+
+    // Only positive points count towards a window's target
+    int targetDelta = qMax(newPoints, 0) - qMax(oldPoints, 0);
+    bool scopeChanged = (oldScope != newScope);
+
+    DatabaseManager& db = DatabaseManager::instance();
+    bool ownsTransaction = !db.isInTransaction() && db.beginTransaction();
+
+    bool success = true;
+    int windowsAdjusted = 0;
+    QList<DailyOutcomeChange> outcomeChanges;
+
+    if (scopeChanged) {
+        // Occurrences move onto the new scope's windows first. The old
+        // windows lose them and the new ones gain them, so both sides are
+        // recalculated in full at their own keys.
+        QList<QDate> oldWindows;
+        QList<QDate> newWindows;
+        success = m_occurrenceRepo->rewindowGoalOccurrences(goalId, newScope, &oldWindows, &newWindows);
+        if (success) {
+            // Impacts follow the edited points; the full recalculation
+            // below makes the returned deltas unnecessary
+            success = m_occurrenceRepo->rescoreGoalOccurrences(goalId, false);
+        }
+        if (success) {
+            QList<OccurrenceWindow> windows;
+            for (const QDate& windowStart : std::as_const(oldWindows)) {
+                windows.append({oldScope, windowStart});
+            }
+            for (const QDate& windowStart : std::as_const(newWindows)) {
+                windows.append({newScope, windowStart});
+            }
+            windowsAdjusted = windows.size();
+            success = m_scoreService->recalculateWindows(windows);
+        }
+    } else {
+        QList<OccurrenceWindowDelta> deltas;
+        success = m_occurrenceRepo->rescoreGoalOccurrences(goalId, targetDelta != 0, &deltas);
+        if (success && !deltas.isEmpty()) {
+            QList<QDate> windowStarts;
+            QList<int> earnedDeltas;
+            windowStarts.reserve(deltas.size());
+            earnedDeltas.reserve(deltas.size());
+            for (const OccurrenceWindowDelta& delta : deltas) {
+                windowStarts.append(delta.windowStart);
+                earnedDeltas.append(delta.earnedDelta);
+            }
+            windowsAdjusted = deltas.size();
+            success = m_scoreRepo->applyScoreDeltas(newScope, windowStarts, earnedDeltas,
+                                                    targetDelta, &outcomeChanges);
+        }
+    }
+
+    if (!success) {
+        if (ownsTransaction) {
+            db.rollback();
+        }
+        scope.logError("Failed to adjust window scores", "RESCORE_FAILED");
+        return false;
+    }
+
+    if (ownsTransaction && !db.commit()) {
+        scope.logError(db.lastError(), "COMMIT_FAILED");
+        return false;
+    }
+
+    if (m_streakService && !outcomeChanges.isEmpty()) {
+        m_streakService->applyDailyOutcomeChanges(outcomeChanges);
+    }
+
+    scope.logSuccess({
+        {"goalId", goalId},
+        {"windowsAdjusted", windowsAdjusted},
+        {"outcomeChanges", outcomeChanges.size()}
+    });
+
+    emit goalRescored(goalId, windowsAdjusted);
+    return true;
+}
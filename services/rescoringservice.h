@@ -0,0 +1,39 @@
+#ifndef RESCORINGSERVICE_H
+#define RESCORINGSERVICE_H
+
+#include <QObject>
+#include <QString>
+#include "repositories/occurrencerepository.h"
+#include "repositories/scorerepository.h"
+#include "services/scoreservice.h"
+#include "services/streakservice.h"
+
+class RescoringService : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RescoringService(OccurrenceRepository* occurrenceRepo,
+                              ScoreRepository* scoreRepo,
+                              ScoreService* scoreService,
+                              StreakService* streakService,
+                              QObject *parent = nullptr);
+
+    // Bring one goal's history in line with its current scoring rules
+    bool rescoreGoal(const QString& goalId,
+                     const QString& oldScope,
+                     const QString& newScope,
+                     int oldPoints,
+                     int newPoints);
+
+signals:
+    void goalRescored(const QString& goalId, int windowsAdjusted);
+
+private:
+    OccurrenceRepository* m_occurrenceRepo;
+    ScoreRepository* m_scoreRepo;
+    ScoreService* m_scoreService;
+    StreakService* m_streakService;
+};
+
+#endif // RESCORINGSERVICE_H
@@ -0,0 +1,149 @@
+#include "services/rolloverservice.h"
+#include "database/databasemanager.h"
+#include "logging/logger.h"
+#include "logging/requestscope.h"
+#include <QDateTime>
+#include <QSettings>
+
+RolloverService::RolloverService(OccurrenceRepository* occurrenceRepo,
+                                 ScoreService* scoreService,
+                                 StreakService* streakService,
+                                 QObject *parent)
+    : QObject(parent)
+    , m_occurrenceRepo(occurrenceRepo)
+    , m_scoreService(scoreService)
+    , m_streakService(streakService)
+    , m_timer(new QTimer(this))
+    , m_maxCatchUpDays(366)
+{
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::VeryCoarseTimer);
+    connect(m_timer, &QTimer::timeout, this, &RolloverService::onTimerFired);
+}
+
+void RolloverService::start()
+{
+    // Startup catch-up covers every day missed since the last run
+    runRollover(QDate::currentDate());
+    scheduleNextRollover();
+}
+
+void RolloverService::stop()
+{
+    m_timer->stop();
+}
+
+bool RolloverService::runRollover()
+{
+    return runRollover(QDate::currentDate());
+}
+
+bool RolloverService::runRollover(const QDate& today)
+{
+    QDate lastDate = lastRolloverDate();
+    QDate earliest = today.addDays(-m_maxCatchUpDays);
+
+    // Generate windows for every day not yet seen, at least today's
+    QDate from = today;
+    if (lastDate.isValid() && lastDate < today) {
+        from = qMax(lastDate.addDays(1), earliest);
+    }
+
+    RequestScope scope("RolloverService::runRollover", "ROLLOVER", {
+                                                                      {"today", today.toString("yyyy-MM-dd")},
+                                                                      {"from", from.toString("yyyy-MM-dd")},
+                                                                      {"lastRollover", lastDate.toString("yyyy-MM-dd")}
+                                                                  });
+
+    DatabaseManager& db = DatabaseManager::instance();
+    bool ownsTransaction = !db.isInTransaction() && db.beginTransaction();
+
+    // A failure here must not look like a day with nothing to do: the
+    // watermark below would move past days that were never generated
+    QList<OccurrenceWindow> generated;
+    QList<OccurrenceWindow> finalized;
+    int finalizedCount = 0;
+    if (!m_occurrenceRepo->generateOccurrencesForRange(from, today, &generated)
+        || !m_occurrenceRepo->finalizeExpiredOccurrences(today, &finalized, &finalizedCount)) {
+        if (ownsTransaction) {
+            db.rollback();
+        }
+        scope.logError("Failed to generate or finalize occurrences", "ROLLOVER_FAILED");
+        emit rolloverFailed("Failed to generate or finalize occurrences");
+        return false;
+    }
+
+    QList<OccurrenceWindow> affected = generated + finalized;
+    if (!m_scoreService->recalculateWindows(affected)) {
+        if (ownsTransaction) {
+            db.rollback();
+        }
+        scope.logError("Failed to recalculate affected windows", "RECALCULATION_FAILED");
+        emit rolloverFailed("Failed to recalculate affected windows");
+        return false;
+    }
+
+    if (ownsTransaction && !db.commit()) {
+        scope.logError(db.lastError(), "COMMIT_FAILED");
+        emit rolloverFailed(db.lastError());
+        return false;
+    }
+
+    // Each day closes exactly once: the last rollover day and any missed days
+    int streakDays = 0;
+    if (m_streakService && lastDate.isValid() && lastDate < today) {
+        streakDays = m_streakService->updateStreaksForRange(qMax(lastDate, earliest), today.addDays(-1));
+    }
+
+    setLastRolloverDate(today);
+
+    scope.logSuccess({
+        {"windowsGenerated", generated.size()},
+        {"windowsFinalized", finalized.size()},
+        {"occurrencesFinalized", finalizedCount},
+        {"streakDays", streakDays}
+    });
+
+    emit rolloverCompleted(today, generated.size(), finalizedCount);
+    return true;
+}
+
+QDate RolloverService::lastRolloverDate() const
+{
+    QSettings settings;
+    return QDate::fromString(settings.value("rollover/lastDate").toString(), "yyyy-MM-dd");
+}
+
+void RolloverService::setLastRolloverDate(const QDate& date)
+{
+    QSettings settings;
+    settings.setValue("rollover/lastDate", date.toString("yyyy-MM-dd"));
+}
+
+void RolloverService::onTimerFired()
+{
+    QDate today = QDate::currentDate();
+
+    // Timers can fire slightly early or after a suspend; only roll on a new day
+    if (lastRolloverDate() != today) {
+        runRollover(today);
+    }
+
+    scheduleNextRollover();
+}
+
+void RolloverService::scheduleNextRollover()
+{
+    // Day, week, month and year windows all begin at local midnight
+    QDateTime now = QDateTime::currentDateTime();
+    QDateTime nextMidnight(now.date().addDays(1), QTime(0, 0));
+    qint64 msecs = now.msecsTo(nextMidnight) + 1000;
+
+    m_timer->start(static_cast<int>(qMin<qint64>(msecs, 24LL * 60 * 60 * 1000)));
+
+    Logger::instance().info("RolloverService::scheduleNextRollover", "rollover",
+                            "Next rollover scheduled", {
+                                {"at", nextMidnight.toString(Qt::ISODate)},
+                                {"inMs", msecs}
+                            });
+}
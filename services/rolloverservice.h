@@ -0,0 +1,50 @@
+#ifndef ROLLOVERSERVICE_H
+#define ROLLOVERSERVICE_H
+
+#include <QObject>
+#include <QDate>
+#include <QTimer>
+#include "repositories/occurrencerepository.h"
+#include "services/scoreservice.h"
+#include "services/streakservice.h"
+
+class RolloverService : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RolloverService(OccurrenceRepository* occurrenceRepo,
+                             ScoreService* scoreService,
+                             StreakService* streakService,
+                             QObject *parent = nullptr);
+
+    // Catch up on missed days and schedule the next midnight rollover
+    void start();
+    void stop();
+
+    // Run a rollover for the given day (idempotent)
+    Q_INVOKABLE bool runRollover();
+    bool runRollover(const QDate& today);
+
+    QDate lastRolloverDate() const;
+    void setMaxCatchUpDays(int days) { m_maxCatchUpDays = days; }
+
+signals:
+    void rolloverCompleted(const QDate& date, int windowsGenerated, int occurrencesFinalized);
+    void rolloverFailed(const QString& error);
+
+private slots:
+    void onTimerFired();
+
+private:
+    void scheduleNextRollover();
+    void setLastRolloverDate(const QDate& date);
+
+    OccurrenceRepository* m_occurrenceRepo;
+    ScoreService* m_scoreService;
+    StreakService* m_streakService;
+    QTimer* m_timer;
+    int m_maxCatchUpDays;
+};
+
+#endif // ROLLOVERSERVICE_H
@@ -1,6 +1,11 @@
 #include "services/scoreservice.h"
 #include "logging/logger.h"
 #include "logging/requestscope.h"
+#include "logging/tracer.h"
+#include "services/seriesdownsampler.h"
+#include <QMap>
+#include <QSet>
+#include <algorithm>
 
 ScoreService::ScoreService(ScoreRepository* scoreRepo,
                           OccurrenceRepository* occurrenceRepo,
@@ -118,6 +123,43 @@ void ScoreService::recalculateMonthly(const QDate& date)
     qDeleteAll(goals);
 }
 
+void ScoreService::recalculateForDate(const QDate& date)
+{
+    TRACE_SPAN("scoresNeedRecalculation");
+    recalculateDaily(date);
+    recalculateWeekly(date);
+    recalculateMonthly(date);
+    recalculateYearly(date.year());
+}
+
+void ScoreService::notifyScoresRecalculated(const QDate& date)
+{
+    emit dailyScoreUpdated(date);
+    emit weeklyScoreUpdated(m_occurrenceRepo->calculateWeekStart(date));
+    emit monthlyScoreUpdated(m_occurrenceRepo->calculateMonthStart(date));
+    emit yearlyScoreUpdated(date.year());
+}
+
+void ScoreService::notifyWindowsChanged(const QString& scope, const QList<QDate>& windowStarts)
+{
+    for (const QDate& windowStart : windowStarts) {
+        if (scope == "daily") {
+            emit dailyScoreUpdated(windowStart);
+        } else if (scope == "weekly") {
+            emit weeklyScoreUpdated(windowStart);
+        } else if (scope == "monthly") {
+            emit monthlyScoreUpdated(windowStart);
+        } else if (scope == "yearly") {
+            emit yearlyScoreUpdated(windowStart.year());
+        }
+    }
+}
+
+void ScoreService::notifyScopeChanged(const QString& scope)
+{
+    emit scopeScoresChanged(scope);
+}
+
 void ScoreService::recalculateYearly(int year)
 {
     QList<Occurrence*> occurrences = m_occurrenceRepo->findByYear(year);
@@ -145,6 +187,60 @@ void ScoreService::recalculateYearly(int year)
     qDeleteAll(goals);
 }
 
+bool ScoreService::recalculateWindows(const QList<OccurrenceWindow>& windows)
+{
+    RequestScope scope("ScoreService::recalculateWindows", "CALCULATE", {
+        {"windows", windows.size()}
+    });
+
+    // Deduplicate per scope so each window is recalculated exactly once
+    QMap<QString, QSet<QDate>> byScope;
+    for (const OccurrenceWindow& window : windows) {
+        byScope[window.scope].insert(window.windowStart);
+    }
+
+    QList<QDate> daily = byScope.value("daily").values();
+    QList<QDate> weekly = byScope.value("weekly").values();
+    QList<QDate> monthly = byScope.value("monthly").values();
+    QList<QDate> yearly = byScope.value("yearly").values();
+    std::sort(daily.begin(), daily.end());
+    std::sort(weekly.begin(), weekly.end());
+    std::sort(monthly.begin(), monthly.end());
+    std::sort(yearly.begin(), yearly.end());
+
+    bool success = m_scoreRepo->rebuildDailyScores(daily)
+                   && m_scoreRepo->rebuildWeeklyScores(weekly)
+                   && m_scoreRepo->rebuildMonthlyScores(monthly)
+                   && m_scoreRepo->rebuildYearlyScores(yearly);
+
+    if (!success) {
+        scope.logError("Failed to rebuild window scores", "SAVE_FAILED");
+        return false;
+    }
+
+    for (const QDate& date : daily) {
+        emit dailyScoreUpdated(date);
+    }
+    for (const QDate& weekStart : weekly) {
+        emit weeklyScoreUpdated(weekStart);
+    }
+    for (const QDate& monthStart : monthly) {
+        emit monthlyScoreUpdated(monthStart);
+    }
+    for (const QDate& yearStart : yearly) {
+        emit yearlyScoreUpdated(yearStart.year());
+    }
+
+    scope.logSuccess({
+        {"daily", daily.size()},
+        {"weekly", weekly.size()},
+        {"monthly", monthly.size()},
+        {"yearly", yearly.size()}
+    });
+
+    return true;
+}
+
 DailyScore* ScoreService::getDailyScore(const QDate& date)
 {
     return m_scoreRepo->getDailyScore(date);
@@ -174,6 +270,36 @@ QList<DailyScore*> ScoreService::getDailyTrend(int days)
     return m_scoreRepo->getDailyScoreRange(start, end);
 }
 
+QList<QPointF> ScoreService::getDailyTrendSeries(int days, int maxPoints,
+                                                 const QString& method,
+                                                 const QString& metric)
+{
+    TRACE_SPAN("ScoreService::getDailyTrendSeries");
+
+    QDate end = QDate::currentDate();
+    QDate start = end.addDays(-days + 1);
+    QList<QPointF> series = m_scoreRepo->getDailySeries(start, end, metric);
+
+    if (method == "minmax") {
+        return SeriesDownsampler::minMax(series, maxPoints);
+    }
+    return SeriesDownsampler::lttb(series, maxPoints);
+}
+
+QVariantList ScoreService::getDailyTrendPoints(int days, int maxPoints,
+                                               const QString& method,
+                                               const QString& metric)
+{
+    QList<QPointF> series = getDailyTrendSeries(days, maxPoints, method, metric);
+
+    QVariantList points;
+    points.reserve(series.size());
+    for (const QPointF& point : series) {
+        points.append(point);
+    }
+    return points;
+}
+
 QList<WeeklyScore*> ScoreService::getWeeklyTrend(int weeks)
 {
     return m_scoreRepo->getWeeklyScoreRange(weeks);
@@ -3,6 +3,8 @@
 
 #include <QObject>
 #include <QDate>
+#include <QPointF>
+#include <QVariantList>
 #include "repositories/scorerepository.h"
 #include "repositories/occurrencerepository.h"
 #include "repositories/goalrepository.h"
@@ -22,6 +24,17 @@ public:
     void recalculateWeekly(const QDate& date);
     void recalculateMonthly(const QDate& date);
     void recalculateYearly(int year);
+    // Every window containing the date, as after an occurrence status change
+    void recalculateForDate(const QDate& date);
+    // Windows containing the date were recalculated on another connection
+    void notifyScoresRecalculated(const QDate& date);
+    // Stored windows of one scope were changed by another process
+    void notifyWindowsChanged(const QString& scope, const QList<QDate>& windowStarts);
+    // Too many windows of one scope changed to list; everything shown for it is stale
+    void notifyScopeChanged(const QString& scope);
+
+    // Recalculate many windows at once (one statement per scope)
+    bool recalculateWindows(const QList<OccurrenceWindow>& windows);
 
     // Score queries
     DailyScore* getDailyScore(const QDate& date);
@@ -34,11 +47,22 @@ public:
     QList<WeeklyScore*> getWeeklyTrend(int weeks);
     QList<MonthlyScore*> getMonthlyTrend(int months);
 
+    // Long-range trend reduced to at most maxPoints for a chart of that
+    // width. method is "lttb" (shape) or "minmax" (keeps spikes); metric is
+    // "completion" or "earned". x is ms since epoch on a UTC day axis.
+    QList<QPointF> getDailyTrendSeries(int days, int maxPoints,
+                                       const QString& method = "lttb",
+                                       const QString& metric = "completion");
+    Q_INVOKABLE QVariantList getDailyTrendPoints(int days, int maxPoints,
+                                                 const QString& method = "lttb",
+                                                 const QString& metric = "completion");
+
 signals:
     void dailyScoreUpdated(const QDate& date);
     void weeklyScoreUpdated(const QDate& weekStart);
     void monthlyScoreUpdated(const QDate& monthStart);
     void yearlyScoreUpdated(int year);
+    void scopeScoresChanged(const QString& scope);
 
 private:
     struct ScoreCalculation {
@@ -0,0 +1,105 @@
+#include "services/seriesdownsampler.h"
+#include <cmath>
+
+namespace SeriesDownsampler
+{
+
+QList<QPointF> lttb(const QList<QPointF>& points, int maxPoints)
+{
+    const qsizetype count = points.size();
+    if (maxPoints >= count || maxPoints < 3) {
+        return maxPoints < 3 && count > 2 ? QList<QPointF>{points.first(), points.last()} : points;
+    }
+
+    QList<QPointF> sampled;
+    sampled.reserve(maxPoints);
+    sampled.append(points.first());
+
+    // Interior points are split into maxPoints - 2 buckets; each keeps the
+    // point forming the largest triangle with the previously kept point and
+    // the average of the next bucket
+    const double bucketSize = double(count - 2) / (maxPoints - 2);
+    const QPointF* data = points.constData();
+    qsizetype previous = 0;
+
+    for (int bucket = 0; bucket < maxPoints - 2; ++bucket) {
+        const qsizetype start = qsizetype(std::floor(bucket * bucketSize)) + 1;
+        const qsizetype end = qMin(qsizetype(std::floor((bucket + 1) * bucketSize)) + 1, count - 1);
+
+        const qsizetype nextStart = end;
+        const qsizetype nextEnd = qMin(qsizetype(std::floor((bucket + 2) * bucketSize)) + 1, count);
+        double averageX = 0.0;
+        double averageY = 0.0;
+        for (qsizetype i = nextStart; i < nextEnd; ++i) {
+            averageX += data[i].x();
+            averageY += data[i].y();
+        }
+        const qsizetype nextCount = qMax<qsizetype>(1, nextEnd - nextStart);
+        averageX /= nextCount;
+        averageY /= nextCount;
+
+        const double ax = data[previous].x();
+        const double ay = data[previous].y();
+        double largestArea = -1.0;
+        qsizetype selected = start;
+        for (qsizetype i = start; i < end; ++i) {
+            const double area = std::abs((ax - averageX) * (data[i].y() - ay)
+                                         - (ax - data[i].x()) * (averageY - ay));
+            if (area > largestArea) {
+                largestArea = area;
+                selected = i;
+            }
+        }
+
+        sampled.append(data[selected]);
+        previous = selected;
+    }
+
+    sampled.append(points.last());
+    return sampled;
+}
+
+QList<QPointF> minMax(const QList<QPointF>& points, int maxPoints)
+{
+    const qsizetype count = points.size();
+    if (maxPoints >= count || maxPoints < 4) {
+        return maxPoints < 4 && count > 2 ? QList<QPointF>{points.first(), points.last()} : points;
+    }
+
+    QList<QPointF> sampled;
+    sampled.reserve(maxPoints);
+    sampled.append(points.first());
+
+    const int buckets = (maxPoints - 2) / 2;
+    const double bucketSize = double(count - 2) / buckets;
+    const QPointF* data = points.constData();
+
+    for (int bucket = 0; bucket < buckets; ++bucket) {
+        const qsizetype start = qsizetype(std::floor(bucket * bucketSize)) + 1;
+        const qsizetype end = qMin(qsizetype(std::floor((bucket + 1) * bucketSize)) + 1, count - 1);
+        if (start >= end) {
+            continue;
+        }
+
+        qsizetype low = start;
+        qsizetype high = start;
+        for (qsizetype i = start + 1; i < end; ++i) {
+            if (data[i].y() < data[low].y()) {
+                low = i;
+            }
+            if (data[i].y() > data[high].y()) {
+                high = i;
+            }
+        }
+
+        sampled.append(data[qMin(low, high)]);
+        if (low != high) {
+            sampled.append(data[qMax(low, high)]);
+        }
+    }
+
+    sampled.append(points.last());
+    return sampled;
+}
+
+} // namespace SeriesDownsampler
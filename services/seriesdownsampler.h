@@ -0,0 +1,22 @@
+#ifndef SERIESDOWNSAMPLER_H
+#define SERIESDOWNSAMPLER_H
+
+#include <QList>
+#include <QPointF>
+
+// Reduces an x-ordered series to at most maxPoints points for charting.
+// Both keep the first and last point; series already small enough are
+// returned unchanged.
+namespace SeriesDownsampler
+{
+
+// Largest-Triangle-Three-Buckets: keeps the visual shape of the line
+QList<QPointF> lttb(const QList<QPointF>& points, int maxPoints);
+
+// Minimum and maximum of each bucket, in x order: keeps every spike, at
+// two points per bucket
+QList<QPointF> minMax(const QList<QPointF>& points, int maxPoints);
+
+} // namespace SeriesDownsampler
+
+#endif // SERIESDOWNSAMPLER_H
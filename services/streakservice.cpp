@@ -2,6 +2,9 @@
 #include "logging/logger.h"
 #include "logging/requestscope.h"
 
+// Minimum daily completion percentage that keeps a streak alive
+static constexpr double kStreakThreshold = 80.0;
+
 StreakService::StreakService(StreakRepository* streakRepo,
                              ScoreRepository* scoreRepo,
                              QObject *parent)
@@ -33,8 +36,9 @@ void StreakService::updateStreaksForDate(const QDate& date)
     }
 
     // Check if streak should break
-    if (shouldBreakStreak(dailyScore->completionPercentage) ||
-        dailyScore->hasNegativeOutcome) {
+    bool success = !shouldBreakStreak(dailyScore->completionPercentage) &&
+                   !dailyScore->hasNegativeOutcome;
+    if (!success) {
         // Break streak
         streak->currentStreak = 0;
         streak->lastBreakDate = date;
@@ -58,8 +62,8 @@ void StreakService::updateStreaksForDate(const QDate& date)
         streak->successRate = (static_cast<double>(streak->totalSuccesses) / total) * 100.0;
     }
 
-    // Save streak
-    if (m_streakRepo->update(*streak)) {
+    // Save streak, and its state after this day for later replays
+    if (m_streakRepo->update(*streak) && m_streakRepo->recordOverallDailyDay(date, success, *streak)) {
         emit streakUpdated(streak->id);
         scope.logSuccess({
             {"currentStreak", streak->currentStreak},
@@ -73,12 +77,81 @@ void StreakService::updateStreaksForDate(const QDate& date)
     delete streak;
 }
 
+int StreakService::updateStreaksForRange(const QDate& from, const QDate& to)
+{
+    // Days without a daily score had nothing scheduled and do not count.
+    // The range comes newest first; streaks close oldest first.
+    QList<DailyScore*> scores = m_scoreRepo->getDailyScoreRange(from, to);
+    for (auto it = scores.crbegin(); it != scores.crend(); ++it) {
+        updateStreaksForDate((*it)->date);
+    }
+
+    const int updated = scores.size();
+
+    qDeleteAll(scores);
+    return updated;
+}
+
 void StreakService::updateStreakForGoal(const QString& goalId, const QDate& date)
 {
     // Similar logic for goal-specific streaks
     // Implementation can be added later
 }
 
+void StreakService::applyDailyOutcomeChanges(const QList<DailyOutcomeChange>& changes)
+{
+    int flipped = 0;
+    QDate firstFlipped;
+    for (const DailyOutcomeChange& change : changes) {
+        bool wasBroken = shouldBreakStreak(change.oldPercentage) || change.oldNegative;
+        bool isBroken = shouldBreakStreak(change.newPercentage) || change.newNegative;
+        if (wasBroken != isBroken) {
+            flipped++;
+            if (!firstFlipped.isValid() || change.date < firstFlipped) {
+                firstFlipped = change.date;
+            }
+        }
+    }
+
+    if (flipped == 0) {
+        return;
+    }
+
+    RequestScope scope("StreakService::applyDailyOutcomeChanges", "UPDATE", {
+                                                                                {"flippedDays", flipped}
+                                                                            });
+
+    Streak* streak = m_streakRepo->findOverallByScope("daily");
+    if (!streak) {
+        scope.logSuccess({{"replayed", false}});
+        return;
+    }
+
+    // Replay from the first flipped day up to the last day the streak has
+    // already evaluated; earlier days keep their recorded state
+    QDate evaluatedUpTo = streak->lastSuccessDate;
+    if (streak->lastBreakDate.isValid() &&
+        (!evaluatedUpTo.isValid() || streak->lastBreakDate > evaluatedUpTo)) {
+        evaluatedUpTo = streak->lastBreakDate;
+    }
+
+    bool replay = evaluatedUpTo.isValid() && firstFlipped <= evaluatedUpTo;
+    if (replay &&
+        m_streakRepo->replayOverallDailyStreak(kStreakThreshold, firstFlipped, evaluatedUpTo)) {
+        emit streakUpdated(streak->id);
+        scope.logSuccess({
+            {"replayed", true},
+            {"from", firstFlipped.toString("yyyy-MM-dd")}
+        });
+    } else if (replay) {
+        scope.logError("Failed to replay daily streak", "UPDATE_FAILED");
+    } else {
+        scope.logSuccess({{"replayed", false}});
+    }
+
+    delete streak;
+}
+
 Streak* StreakService::getDailyStreak()
 {
     return m_streakRepo->getOrCreateOverall("daily");
@@ -107,7 +180,7 @@ Streak* StreakService::getGoalStreak(const QString& goalId, const QString& scope
 bool StreakService::shouldBreakStreak(double completionPercentage)
 {
     // Break streak if completion is below 80%
-    return completionPercentage < 80.0;
+    return completionPercentage < kStreakThreshold;
 }
 
 bool StreakService::hasNegativeOutcome(const QDate& date)
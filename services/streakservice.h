@@ -17,8 +17,13 @@ public:
 
     // Streak updates
     void updateStreaksForDate(const QDate& date);
+    // Closes each day in [from, to] that has a daily score; returns how many
+    int updateStreaksForRange(const QDate& from, const QDate& to);
     void updateStreakForGoal(const QString& goalId, const QDate& date);
 
+    // Replay the daily streak only if an adjustment flipped a day's outcome
+    void applyDailyOutcomeChanges(const QList<DailyOutcomeChange>& changes);
+
     // Streak queries
     Streak* getDailyStreak();
     Streak* getWeeklyStreak();
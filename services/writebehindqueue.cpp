@@ -0,0 +1,484 @@
+#include "services/writebehindqueue.h"
+#include "database/databasemanager.h"
+#include "logging/logger.h"
+#include "logging/requestscope.h"
+#include "repositories/mutationrepository.h"
+#include "repositories/scorerepository.h"
+#include "services/scoreservice.h"
+#include <QSqlError>
+#include <QSqlQuery>
+
+MutationWriter::MutationWriter(const QString& sourceConnection, QObject *parent)
+    : QObject(parent)
+    , m_sourceConnection(sourceConnection)
+    , m_connectionName("nimo_writer")
+    , m_occurrenceRepo(nullptr)
+    , m_goalRepo(nullptr)
+    , m_scoreRepo(nullptr)
+    , m_scoreService(nullptr)
+    , m_mutationRepo(nullptr)
+    , m_replayNeeded(true)
+{
+}
+
+MutationWriter::~MutationWriter()
+{
+    delete m_scoreService;
+    delete m_mutationRepo;
+    delete m_scoreRepo;
+    delete m_goalRepo;
+    delete m_occurrenceRepo;
+    m_db.close();
+    m_db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(m_connectionName);
+}
+
+void MutationWriter::open()
+{
+    // Connections are per thread; this one belongs to the writer thread
+    m_db = QSqlDatabase::cloneDatabase(m_sourceConnection, m_connectionName);
+    m_occurrenceRepo = new OccurrenceRepository(m_db);
+    m_goalRepo = new GoalRepository(m_db);
+    m_scoreRepo = new ScoreRepository(m_db);
+    m_scoreService = new ScoreService(m_scoreRepo, m_occurrenceRepo, m_goalRepo);
+    m_mutationRepo = new MutationRepository(m_db);
+
+    if (!ensureConnected()) {
+        Logger::instance().warn("MutationWriter::open", "write_behind",
+                                "Writer connection unavailable, journaling only", {
+                                    {"errorMessage", m_db.lastError().text()}
+                                });
+        return;
+    }
+    m_mutationRepo->pruneAppliedBefore(QDateTime::currentDateTimeUtc().addDays(-30));
+
+    // Whatever the last run journaled but never stored goes in first
+    replayJournal();
+}
+
+bool MutationWriter::ensureConnected()
+{
+    if (m_db.isOpen()) {
+        QSqlQuery ping(m_db);
+        if (ping.exec("SELECT 1")) {
+            return true;
+        }
+        m_db.close();
+    }
+    if (!m_db.open()) {
+        return false;
+    }
+    m_mutationRepo->ensureSchema();
+    return true;
+}
+
+void MutationWriter::writeStatus(quint64 sequence, const QString& occurrenceId,
+                                 const QString& status, const QDate& date,
+                                 const QStringList& mutationIds,
+                                 const QList<quint64>& journalSequences)
+{
+    RequestScope scope("MutationWriter::writeStatus", "UPDATE", {
+                                                                    {"occurrenceId", occurrenceId},
+                                                                    {"status", status},
+                                                                    {"sequence", QString::number(sequence)}
+                                                                });
+
+    // Older journaled changes must land before this one
+    if (m_replayNeeded && !replayJournal()) {
+        scope.logError("Database unavailable", "DEFERRED");
+        emit deferred(sequence, "Database unavailable");
+        return;
+    }
+
+    QString error;
+    if (!applyStatus(occurrenceId, status, date, mutationIds, &error)) {
+        if (!ensureConnected()) {
+            m_replayNeeded = true;
+            scope.logError(error, "DEFERRED");
+            emit deferred(sequence, error);
+            return;
+        }
+        // Rejected by the database; replaying it would fail the same way
+        MutationJournal::instance().markApplied(journalSequences);
+        scope.logError(error, "UPDATE_FAILED");
+        emit written(sequence, false, Occurrence(), error);
+        return;
+    }
+    MutationJournal::instance().markApplied(journalSequences);
+
+    Occurrence stored;
+    if (Occurrence* occurrence = m_occurrenceRepo->findById(occurrenceId)) {
+        stored = *occurrence;
+        delete occurrence;
+    }
+
+    scope.logSuccess({
+        {"occurrenceId", occurrenceId},
+        {"newStatus", status}
+    });
+    emit written(sequence, true, stored, QString());
+}
+
+bool MutationWriter::applyStatus(const QString& occurrenceId, const QString& status,
+                                 const QDate& date, const QStringList& mutationIds,
+                                 QString* error)
+{
+    // The status, its claim and the scores it changes commit together
+    if (!m_db.transaction()) {
+        *error = m_db.lastError().text();
+        return false;
+    }
+
+    int claimed = m_mutationRepo->claim(mutationIds);
+    if (claimed < 0) {
+        m_db.rollback();
+        *error = "Failed to record applied mutation";
+        return false;
+    }
+    // Already stored by a journal replay
+    if (claimed == 0 && !mutationIds.isEmpty()) {
+        m_db.commit();
+        return true;
+    }
+
+    if (!m_occurrenceRepo->updateStatus(occurrenceId, status)) {
+        m_db.rollback();
+        *error = "Failed to update occurrence status";
+        return false;
+    }
+
+    // Every window holding the date, one rebuild per scope
+    const QList<OccurrenceWindow> windows = {
+        {"daily", date},
+        {"weekly", m_occurrenceRepo->calculateWeekStart(date)},
+        {"monthly", m_occurrenceRepo->calculateMonthStart(date)},
+        {"yearly", m_occurrenceRepo->calculateYearStart(date)}
+    };
+    if (!m_scoreService->recalculateWindows(windows)) {
+        m_db.rollback();
+        *error = "Failed to recalculate scores";
+        return false;
+    }
+
+    if (!m_db.commit()) {
+        *error = m_db.lastError().text();
+        m_db.rollback();
+        return false;
+    }
+    return true;
+}
+
+bool MutationWriter::applyRecord(const JournalRecord& record, QString* error)
+{
+    if (record.type == "occurrence.status") {
+        const QString occurrenceId = record.data.value("occurrenceId").toString();
+        const QDate date = QDate::fromString(record.data.value("date").toString(), Qt::ISODate);
+        if (!applyStatus(occurrenceId, record.data.value("status").toString(), date,
+                         {record.id}, error)) {
+            return false;
+        }
+        if (Occurrence* stored = m_occurrenceRepo->findById(occurrenceId)) {
+            emit occurrenceReplayed(*stored);
+            delete stored;
+        }
+        return true;
+    }
+
+    if (record.type == "goal.update") {
+        const Goal goal = GoalRepository::fromJson(record.data);
+        Goal* existing = m_goalRepo->findById(goal.id);
+        if (!existing) {
+            *error = "Goal not found";
+            return false;
+        }
+        const Goal before = *existing;
+        delete existing;
+
+        if (!m_db.transaction()) {
+            *error = m_db.lastError().text();
+            return false;
+        }
+        int claimed = m_mutationRepo->claim({record.id});
+        if (claimed < 0 || (claimed > 0 && !m_goalRepo->update(goal))) {
+            m_db.rollback();
+            *error = "Failed to update goal";
+            return false;
+        }
+        if (!m_db.commit()) {
+            *error = m_db.lastError().text();
+            m_db.rollback();
+            return false;
+        }
+        if (claimed > 0) {
+            emit goalReplayed(before, goal);
+        }
+        return true;
+    }
+
+    *error = "Unknown mutation type: " + record.type;
+    return false;
+}
+
+bool MutationWriter::replayJournal()
+{
+    MutationJournal& journal = MutationJournal::instance();
+    const QList<JournalRecord> records = journal.isOpen() ? journal.unapplied() : QList<JournalRecord>();
+    if (records.isEmpty()) {
+        m_replayNeeded = false;
+        return true;
+    }
+    if (!ensureConnected()) {
+        m_replayNeeded = true;
+        return false;
+    }
+
+    RequestScope scope("MutationWriter::replayJournal", "REPLAY", {
+                                                                      {"records", records.size()}
+                                                                  });
+
+    int applied = 0;
+    int rejected = 0;
+    for (const JournalRecord& record : records) {
+        QString error;
+        if (applyRecord(record, &error)) {
+            applied++;
+        } else if (!ensureConnected()) {
+            m_replayNeeded = true;
+            scope.logError(error, "DEFERRED");
+            return false;
+        } else {
+            rejected++;
+            Logger::instance().warn("MutationWriter::replayJournal", "write_behind",
+                                    "Dropping rejected journal record", {
+                                        {"mutationId", record.id},
+                                        {"type", record.type},
+                                        {"errorMessage", error}
+                                    });
+        }
+        journal.markApplied({record.sequence});
+    }
+
+    m_replayNeeded = false;
+    scope.logSuccess({
+        {"applied", applied},
+        {"rejected", rejected}
+    });
+    emit replayFinished(applied, rejected);
+    return true;
+}
+
+WriteBehindQueue::WriteBehindQueue(QObject *parent)
+    : QObject(parent)
+    , m_writer(new MutationWriter(DatabaseManager::instance().database().connectionName()))
+    , m_sequence(0)
+    , m_drained(false)
+    , m_offline(false)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(250);
+    connect(&m_timer, &QTimer::timeout, this, &WriteBehindQueue::flush);
+
+    m_writer->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::started, m_writer, &MutationWriter::open);
+    connect(&m_thread, &QThread::finished, m_writer, &QObject::deleteLater);
+    connect(m_writer, &MutationWriter::written, this, &WriteBehindQueue::onWritten);
+    connect(m_writer, &MutationWriter::deferred, this, &WriteBehindQueue::onDeferred);
+    connect(m_writer, &MutationWriter::occurrenceReplayed, this, &WriteBehindQueue::onOccurrenceReplayed);
+    connect(m_writer, &MutationWriter::goalReplayed, this, &WriteBehindQueue::goalReplayed);
+    connect(m_writer, &MutationWriter::replayFinished, this, [this]() { setOffline(false); });
+
+    // The journal goes in as soon as the database is back
+    connect(&DatabaseManager::instance(), &DatabaseManager::connected,
+            this, &WriteBehindQueue::replayJournal);
+
+    m_thread.setObjectName("nimo-writer");
+    m_thread.start();
+}
+
+WriteBehindQueue::~WriteBehindQueue()
+{
+    drain();
+}
+
+void WriteBehindQueue::enqueueStatus(const Occurrence& confirmed, const Occurrence& optimistic,
+                                     const QString& goalScope)
+{
+    const QString& id = optimistic.id;
+    if (!m_confirmed.contains(id)) {
+        m_confirmed.insert(id, confirmed);
+    }
+
+    // Journaled before anything else, so a crash cannot lose the change.
+    // Without a journal the write is only queued in memory.
+    MutationJournal& journal = MutationJournal::instance();
+    JournalRecord record;
+    bool journaled = journal.isOpen()
+                     && journal.append("occurrence.status", {
+                                           {"occurrenceId", id},
+                                           {"status", optimistic.status},
+                                           {"date", optimistic.date.toString(Qt::ISODate)}
+                                       }, &record);
+
+    StatusWrite& write = m_pending[id];
+    if (write.optimistic.id.isEmpty()) {
+        write.goalScope = goalScope;
+        m_pendingOrder.append(id);
+        emit pendingCountChanged();
+    }
+    write.optimistic = optimistic;
+    if (journaled) {
+        write.mutationIds.append(record.id);
+        write.journalSequences.append(record.sequence);
+    }
+
+    // Toggled back to the stored status before anything was sent (and
+    // before a replay could apply any of it): nothing to write
+    bool unsent = !m_latest.contains(id) && optimistic.status == m_confirmed.value(id).status;
+    for (quint64 sequence : std::as_const(write.journalSequences)) {
+        unsent = unsent && journal.isOutstanding(sequence);
+    }
+    if (unsent) {
+        journal.markApplied(write.journalSequences);
+        m_pending.remove(id);
+        m_pendingOrder.removeOne(id);
+        emit pendingCountChanged();
+        emit committed(m_confirmed.take(id));
+        return;
+    }
+
+    if (!m_timer.isActive()) {
+        m_timer.start();
+    }
+}
+
+void WriteBehindQueue::flush()
+{
+    m_timer.stop();
+    if (m_pendingOrder.isEmpty()) {
+        return;
+    }
+
+    MutationWriter* writer = m_writer;
+    for (const QString& id : std::as_const(m_pendingOrder)) {
+        const StatusWrite write = m_pending.take(id);
+        const quint64 sequence = ++m_sequence;
+        m_inFlight.insert(sequence, write);
+        m_latest.insert(id, sequence);
+
+        const QString status = write.optimistic.status;
+        const QDate date = write.optimistic.date;
+        const QStringList mutationIds = write.mutationIds;
+        const QList<quint64> journalSequences = write.journalSequences;
+        QMetaObject::invokeMethod(writer, [=]() {
+            writer->writeStatus(sequence, id, status, date, mutationIds, journalSequences);
+        }, Qt::QueuedConnection);
+    }
+    m_pendingOrder.clear();
+}
+
+void WriteBehindQueue::replayJournal()
+{
+    MutationWriter* writer = m_writer;
+    QMetaObject::invokeMethod(writer, [writer]() { writer->replayJournal(); }, Qt::QueuedConnection);
+}
+
+void WriteBehindQueue::drain()
+{
+    if (m_drained) {
+        return;
+    }
+    m_drained = true;
+    flush();
+
+    // Queued calls run in order, so the thread stops after the last write
+    QThread* thread = &m_thread;
+    QMetaObject::invokeMethod(m_writer, [thread]() { thread->quit(); }, Qt::QueuedConnection);
+    m_thread.wait();
+}
+
+bool WriteBehindQueue::settle(const QString& occurrenceId, quint64 sequence)
+{
+    // A newer write of the same occurrence decides what ends up shown
+    if (m_latest.value(occurrenceId) != sequence || m_pending.contains(occurrenceId)) {
+        return false;
+    }
+    m_latest.remove(occurrenceId);
+    return true;
+}
+
+void WriteBehindQueue::onWritten(quint64 sequence, bool success, const Occurrence& stored,
+                                 const QString& error)
+{
+    auto inFlight = m_inFlight.find(sequence);
+    if (inFlight == m_inFlight.end()) {
+        return;
+    }
+    const StatusWrite write = inFlight.value();
+    m_inFlight.erase(inFlight);
+    emit pendingCountChanged();
+
+    const QString& id = write.optimistic.id;
+    if (success) {
+        setOffline(false);
+        m_confirmed.insert(id, stored);
+    }
+    if (!settle(id, sequence)) {
+        return;
+    }
+    const Occurrence restored = m_confirmed.take(id);
+
+    if (success) {
+        emit committed(stored);
+        return;
+    }
+
+    Logger::instance().warn("WriteBehindQueue::onWritten", "write_behind",
+                            "Status write failed, rolling back", {
+                                {"occurrenceId", id},
+                                {"status", write.optimistic.status},
+                                {"restoredStatus", restored.status},
+                                {"errorMessage", error}
+                            });
+    emit rolledBack(write.optimistic, restored, write.goalScope, error);
+}
+
+void WriteBehindQueue::onDeferred(quint64 sequence, const QString& error)
+{
+    auto inFlight = m_inFlight.find(sequence);
+    if (inFlight == m_inFlight.end()) {
+        return;
+    }
+    const QString id = inFlight->optimistic.id;
+    m_inFlight.erase(inFlight);
+    emit pendingCountChanged();
+
+    if (!m_offline) {
+        Logger::instance().warn("WriteBehindQueue::onDeferred", "write_behind",
+                                "Database unavailable, keeping changes in the journal", {
+                                    {"errorMessage", error}
+                                });
+    }
+    setOffline(true);
+
+    // The change stays shown; the journal replay stores it later
+    if (settle(id, sequence)) {
+        m_confirmed.remove(id);
+    }
+}
+
+void WriteBehindQueue::onOccurrenceReplayed(const Occurrence& stored)
+{
+    // Rows with newer writes outstanding are settled by those
+    if (m_latest.contains(stored.id) || m_pending.contains(stored.id)) {
+        return;
+    }
+    emit committed(stored);
+}
+
+void WriteBehindQueue::setOffline(bool offline)
+{
+    if (m_offline != offline) {
+        m_offline = offline;
+        emit offlineChanged();
+    }
+}
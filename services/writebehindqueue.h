@@ -0,0 +1,142 @@
+#ifndef WRITEBEHINDQUEUE_H
+#define WRITEBEHINDQUEUE_H
+
+#include <QObject>
+#include <QDate>
+#include <QHash>
+#include <QList>
+#include <QSqlDatabase>
+#include <QStringList>
+#include <QThread>
+#include <QTimer>
+#include "database/mutationjournal.h"
+#include "repositories/occurrencerepository.h"
+#include "repositories/goalrepository.h"
+
+class MutationRepository;
+class ScoreRepository;
+class ScoreService;
+
+// Applies mutations on the writer thread with its own connection and
+// repositories. Each one is claimed in applied_mutations in the same
+// transaction as the change, so a journal record is never applied twice.
+// When the database cannot be reached, writes are deferred and the journal
+// is replayed in order once it can be, before anything newer is written.
+class MutationWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MutationWriter(const QString& sourceConnection, QObject *parent = nullptr);
+    ~MutationWriter();
+
+public slots:
+    void open();
+    void writeStatus(quint64 sequence, const QString& occurrenceId, const QString& status,
+                     const QDate& date, const QStringList& mutationIds,
+                     const QList<quint64>& journalSequences);
+    // Applies every outstanding journal record; false if still unreachable
+    bool replayJournal();
+
+signals:
+    void written(quint64 sequence, bool success, const Occurrence& stored, const QString& error);
+    // Kept in the journal until the database is back
+    void deferred(quint64 sequence, const QString& error);
+    void occurrenceReplayed(const Occurrence& stored);
+    void goalReplayed(const Goal& before, const Goal& after);
+    void replayFinished(int applied, int rejected);
+
+private:
+    bool ensureConnected();
+    bool applyStatus(const QString& occurrenceId, const QString& status, const QDate& date,
+                     const QStringList& mutationIds, QString* error);
+    bool applyRecord(const JournalRecord& record, QString* error);
+
+    QString m_sourceConnection;
+    QString m_connectionName;
+    QSqlDatabase m_db;
+    OccurrenceRepository* m_occurrenceRepo;
+    GoalRepository* m_goalRepo;
+    ScoreRepository* m_scoreRepo;
+    ScoreService* m_scoreService;
+    MutationRepository* m_mutationRepo;
+    bool m_replayNeeded;
+};
+
+// Ordered write-behind queue for occurrence status changes. Callers show
+// the new status at once and enqueue it here; it is journaled immediately,
+// then held for a short coalescing delay so repeated toggles of one
+// occurrence collapse into a single write (or none, when it ends where it
+// started). Writes run in order on the writer thread. Once the last
+// outstanding write of an occurrence settles, committed() carries the
+// stored row, or rolledBack() the state to restore when the database
+// rejected it. Writes that could not reach the database stay shown and
+// journaled, and settle through committed() when the journal is replayed.
+class WriteBehindQueue : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int pendingCount READ pendingCount NOTIFY pendingCountChanged)
+    Q_PROPERTY(bool offline READ isOffline NOTIFY offlineChanged)
+
+public:
+    explicit WriteBehindQueue(QObject *parent = nullptr);
+    ~WriteBehindQueue();
+
+    // confirmed is the row as last stored, optimistic the row now shown
+    void enqueueStatus(const Occurrence& confirmed, const Occurrence& optimistic,
+                       const QString& goalScope);
+
+    int pendingCount() const { return m_pending.size() + m_inFlight.size(); }
+    bool isOffline() const { return m_offline; }
+    int coalesceMs() const { return m_timer.interval(); }
+    void setCoalesceMs(int ms) { m_timer.setInterval(qMax(0, ms)); }
+
+    // Send everything still waiting for the coalescing delay
+    Q_INVOKABLE void flush();
+    // Apply journaled mutations, e.g. once the database is reachable again
+    Q_INVOKABLE void replayJournal();
+    // Flush and block until the writer has finished, e.g. at shutdown
+    void drain();
+
+signals:
+    void committed(const Occurrence& stored);
+    void rolledBack(const Occurrence& optimistic, const Occurrence& restored,
+                    const QString& goalScope, const QString& error);
+    void goalReplayed(const Goal& before, const Goal& after);
+    void pendingCountChanged();
+    void offlineChanged();
+
+private:
+    struct StatusWrite {
+        Occurrence optimistic;
+        QString goalScope;
+        QStringList mutationIds;
+        QList<quint64> journalSequences;
+    };
+
+    void onWritten(quint64 sequence, bool success, const Occurrence& stored, const QString& error);
+    void onDeferred(quint64 sequence, const QString& error);
+    void onOccurrenceReplayed(const Occurrence& stored);
+    void setOffline(bool offline);
+    // Forgets the outstanding write if it is the occurrence's last one
+    bool settle(const QString& occurrenceId, quint64 sequence);
+
+    MutationWriter* m_writer;
+    QThread m_thread;
+    QTimer m_timer;
+    quint64 m_sequence;
+    bool m_drained;
+    bool m_offline;
+
+    // Waiting for the coalescing delay, in first-enqueued order
+    QHash<QString, StatusWrite> m_pending;
+    QList<QString> m_pendingOrder;
+    // Sent to the writer, by sequence
+    QHash<quint64, StatusWrite> m_inFlight;
+    // Last sequence sent per occurrence; older results never settle it
+    QHash<QString, quint64> m_latest;
+    // Stored state of every occurrence with writes outstanding
+    QHash<QString, Occurrence> m_confirmed;
+};
+
+#endif // WRITEBEHINDQUEUE_H
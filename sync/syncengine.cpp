@@ -0,0 +1,614 @@
+#include "sync/syncengine.h"
+#include "database/databasemanager.h"
+#include "database/slowquerylog.h"
+#include "logging/logger.h"
+#include "logging/requestscope.h"
+#include "logging/loggermacros.h"
+#include "services/rescoringservice.h"
+#include "services/scoreservice.h"
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QSqlError>
+#include <QSqlQuery>
+
+namespace
+{
+// Keyset start before any row: updated_at is NOT NULL, so every row sorts after it
+const char* const kBeginning = "-infinity";
+const char* const kNilUuid = "00000000-0000-0000-0000-000000000000";
+}
+
+SyncEngine::SyncEngine(QSqlDatabase local, QSqlDatabase remote, const QString& peer,
+                       QObject *parent)
+    : QObject(parent)
+    , m_local(local)
+    , m_remote(remote)
+    , m_peer(peer)
+    , m_batchRows(2000)
+    , m_overlapSeconds(60)
+    , m_scoreService(nullptr)
+    , m_rescoringService(nullptr)
+{
+}
+
+const QList<SyncEngine::TableSpec>& SyncEngine::tables()
+{
+    // Parents first, so a pushed or pulled occurrence finds its goal; rows
+    // whose parent was hard-deleted on the target are dropped.
+    // Occurrences merge on (goal_id, date): rollover creates the same window
+    // on every device under a different id. Superseded occurrences go
+    // before them, so a key a rescope vacated is cleared on the target
+    // before the occurrence that moved off it arrives under the same id.
+    static const QList<TableSpec> specs{
+        {"goals",
+         {"id", "title", "scope", "points", "missing_behavior", "penalty_points", "category",
+          "notes", "icon_name", "color_hex", "sort_order", "is_active", "created_at",
+          "updated_at", "deleted_at"},
+         "id", QString(), false, QString(), QString(), true},
+        {"superseded_occurrences",
+         {"id", "occurrence_id", "goal_id", "date", "status", "completed_at", "score_impact",
+          "notes", "created_at", "updated_at"},
+         "goal_id, date", "goal_id IN (SELECT id FROM goals)", false, "synced_at", "occurrences"},
+        {"occurrences",
+         {"id", "goal_id", "date", "week_start", "month_start", "year_start", "status",
+          "completed_at", "score_impact", "notes", "created_at", "updated_at"},
+         "goal_id, date", "goal_id IN (SELECT id FROM goals)", true, "synced_at"}
+    };
+    return specs;
+}
+
+bool SyncEngine::ensureSchema(QString* error)
+{
+    QSqlQuery query(m_local);
+    query.prepare(R"(
+        CREATE TABLE IF NOT EXISTS sync_state (
+            peer          TEXT NOT NULL,
+            table_name    TEXT NOT NULL,
+            direction     TEXT NOT NULL CHECK (direction IN ('push', 'pull')),
+            watermark     TIMESTAMPTZ NOT NULL,
+            last_id       UUID NOT NULL,
+            rows_synced   BIGINT NOT NULL DEFAULT 0,
+            updated_at    TIMESTAMPTZ NOT NULL DEFAULT CURRENT_TIMESTAMP,
+            PRIMARY KEY (peer, table_name, direction)
+        )
+    )");
+    if (!SlowQueryLog::exec(query, "SyncEngine::ensureSchema")) {
+        *error = query.lastError().text();
+        return false;
+    }
+
+    // The keyset scans walk these on both sides
+    for (QSqlDatabase db : {m_local, m_remote}) {
+        for (const TableSpec& table : tables()) {
+            QSqlQuery index(db);
+            index.prepare(QString("CREATE INDEX IF NOT EXISTS idx_%1_updated ON %1 (updated_at, id)")
+                              .arg(table.name));
+            if (!SlowQueryLog::exec(index, "SyncEngine::ensureSchema")) {
+                *error = index.lastError().text();
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool SyncEngine::resetWatermarks(QString* error)
+{
+    RequestScope scope("SyncEngine::resetWatermarks", "DELETE", {
+                                                                    {"peer", m_peer}
+                                                                });
+
+    QString sql = "DELETE FROM sync_state WHERE peer = :peer";
+
+    QSqlQuery query(m_local);
+    query.prepare(sql);
+    query.bindValue(":peer", m_peer);
+
+    LOG_QUERY(scope, sql, {m_peer});
+
+    if (!SlowQueryLog::exec(query, "SyncEngine::resetWatermarks")) {
+        *error = query.lastError().text();
+        scope.logError(*error, "SQL_EXEC_FAILED");
+        return false;
+    }
+
+    scope.logSuccess({{"count", query.numRowsAffected()}});
+    return true;
+}
+
+bool SyncEngine::sync(QString* error)
+{
+    return push(error) && pull(error);
+}
+
+bool SyncEngine::push(QString* error)
+{
+    for (const TableSpec& table : tables()) {
+        if (!pushTable(table, error)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SyncEngine::pull(QString* error)
+{
+    for (const TableSpec& table : tables()) {
+        if (!pullTable(table, error)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SyncEngine::pushTable(const TableSpec& table, QString* error)
+{
+    RequestScope scope("SyncEngine::pushTable", "SYNC", {
+                                                            {"peer", m_peer},
+                                                            {"table", table.name}
+                                                        });
+
+    SyncTableReport report;
+    report.table = table.name;
+    report.direction = "push";
+    QElapsedTimer timer;
+    timer.start();
+
+    QString since;
+    QString afterId;
+    if (!loadWatermark(table.name, report.direction, &since, &afterId, error)) {
+        scope.logError(*error, "SYNC_FAILED");
+        return false;
+    }
+
+    // Only the first batch reaches back over the overlap; later batches
+    // continue from the exact key of the previous one
+    int overlapSeconds = m_overlapSeconds;
+    const QString sql = upsertSql(table, false);
+    while (true) {
+        QString rows;
+        int count = 0;
+        QString lastUpdatedAt;
+        QString lastId;
+        if (!readBatch(m_local, table, since, afterId, overlapSeconds, &rows, &count,
+                       &lastUpdatedAt, &lastId, &report, error)) {
+            scope.logError(*error, "SYNC_FAILED");
+            return false;
+        }
+        overlapSeconds = 0;
+        if (count == 0) {
+            break;
+        }
+
+        QSqlQuery upsert(m_remote);
+        upsert.prepare(QString("%1 SELECT count(*) FROM upserted").arg(sql));
+        upsert.bindValue(":rows", rows);
+        if (!exec(upsert, "SyncEngine::pushTable", &report, error)) {
+            scope.logError(*error, "SYNC_FAILED");
+            return false;
+        }
+        if (upsert.next()) {
+            report.applied += upsert.value(0).toInt();
+        }
+
+        // The remote has committed, so a crash from here on repeats at most
+        // this batch, which then changes nothing
+        if (!storeWatermark(table.name, report.direction, lastUpdatedAt, lastId, count,
+                            &report, error)) {
+            scope.logError(*error, "SYNC_FAILED");
+            return false;
+        }
+
+        report.rows += count;
+        report.batches++;
+        emit batchSynced(table.name, report.direction, count);
+
+        since = lastUpdatedAt;
+        afterId = lastId;
+        if (count < m_batchRows) {
+            break;
+        }
+    }
+
+    report.elapsedMs = timer.elapsed();
+    m_report.append(report);
+    scope.logSuccess({
+        {"rows", report.rows},
+        {"applied", report.applied},
+        {"batches", report.batches},
+        {"roundTrips", report.roundTrips}
+    });
+    return true;
+}
+
+bool SyncEngine::pullTable(const TableSpec& table, QString* error)
+{
+    RequestScope scope("SyncEngine::pullTable", "SYNC", {
+                                                            {"peer", m_peer},
+                                                            {"table", table.name}
+                                                        });
+
+    SyncTableReport report;
+    report.table = table.name;
+    report.direction = "pull";
+    QElapsedTimer timer;
+    timer.start();
+
+    QString since;
+    QString afterId;
+    if (!loadWatermark(table.name, report.direction, &since, &afterId, error)) {
+        scope.logError(*error, "SYNC_FAILED");
+        return false;
+    }
+
+    // Rows and watermark land in one statement, so the local side can never
+    // hold a batch without its watermark or the other way round
+    QString sql = upsertSql(table, true) + R"(
+        , watermark AS (
+            INSERT INTO sync_state (peer, table_name, direction, watermark, last_id, rows_synced)
+            VALUES (:peer, :table, 'pull', CAST(:watermark AS timestamptz), CAST(:last_id AS uuid), :count)
+            ON CONFLICT (peer, table_name, direction) DO UPDATE
+            SET watermark = EXCLUDED.watermark,
+                last_id = EXCLUDED.last_id,
+                rows_synced = sync_state.rows_synced + EXCLUDED.rows_synced,
+                updated_at = CURRENT_TIMESTAMP
+        )
+    )";
+    if (table.windowed) {
+        sql += R"(
+        SELECT g.scope, u.date, count(*)
+        FROM upserted u
+        JOIN goals g ON g.id = u.goal_id
+        GROUP BY g.scope, u.date
+        )";
+    } else if (table.rescored) {
+        // Sub-statements share one snapshot, so before still reads the
+        // goals as they were ahead of the upsert
+        sql += R"(
+        , before AS (
+            SELECT id, scope, points, penalty_points, missing_behavior
+            FROM goals
+            WHERE id IN (SELECT id FROM upserted)
+        )
+        SELECT u.id, b.scope, u.scope, b.points, u.points,
+               b.id IS NOT NULL
+               AND (b.scope, b.points, b.penalty_points, b.missing_behavior)
+                   IS DISTINCT FROM (u.scope, u.points, u.penalty_points, u.missing_behavior)
+        FROM upserted u
+        LEFT JOIN before b ON b.id = u.id
+        )";
+    } else {
+        sql += "SELECT NULL, NULL, count(*) FROM upserted";
+    }
+
+    DatabaseManager& db = DatabaseManager::instance();
+    int windowCount = 0;
+    int rescoredGoals = 0;
+    int overlapSeconds = m_overlapSeconds;
+    while (true) {
+        QString rows;
+        int count = 0;
+        QString lastUpdatedAt;
+        QString lastId;
+        if (!readBatch(m_remote, table, since, afterId, overlapSeconds, &rows, &count,
+                       &lastUpdatedAt, &lastId, &report, error)) {
+            scope.logError(*error, "SYNC_FAILED");
+            return false;
+        }
+        overlapSeconds = 0;
+        if (count == 0) {
+            break;
+        }
+
+        // The batch, its watermark and the scores it changes commit together
+        bool ownsTransaction = !db.isInTransaction() && db.beginTransaction();
+
+        QSqlQuery upsert(m_local);
+        upsert.prepare(sql);
+        upsert.bindValue(":rows", rows);
+        upsert.bindValue(":peer", m_peer);
+        upsert.bindValue(":table", table.name);
+        upsert.bindValue(":watermark", lastUpdatedAt);
+        upsert.bindValue(":last_id", lastId);
+        upsert.bindValue(":count", count);
+        bool applied = exec(upsert, "SyncEngine::pullTable", &report, error);
+
+        struct GoalChange {
+            QString id;
+            QString oldScope;
+            QString newScope;
+            int oldPoints;
+            int newPoints;
+        };
+        QList<OccurrenceWindow> windows;
+        QList<GoalChange> goalChanges;
+        while (applied && upsert.next()) {
+            if (table.rescored) {
+                report.applied++;
+                if (upsert.value(5).toBool()) {
+                    goalChanges.append({upsert.value(0).toString(), upsert.value(1).toString(),
+                                        upsert.value(2).toString(), upsert.value(3).toInt(),
+                                        upsert.value(4).toInt()});
+                }
+            } else {
+                report.applied += upsert.value(2).toInt();
+                if (table.windowed) {
+                    windows.append({upsert.value(0).toString(), upsert.value(1).toDate()});
+                }
+            }
+        }
+
+        if (applied && m_scoreService && !windows.isEmpty()
+            && !m_scoreService->recalculateWindows(windows)) {
+            *error = "Failed to recalculate scores for pulled occurrences";
+            applied = false;
+        }
+        // Before the occurrences are pulled, so the goal's own occurrences
+        // move to the new scope's windows here as they did on the remote
+        if (applied && m_rescoringService) {
+            for (const GoalChange& change : std::as_const(goalChanges)) {
+                if (!m_rescoringService->rescoreGoal(change.id, change.oldScope, change.newScope,
+                                                     change.oldPoints, change.newPoints)) {
+                    *error = QString("Failed to rescore pulled goal %1").arg(change.id);
+                    applied = false;
+                    break;
+                }
+            }
+        }
+
+        if (!applied) {
+            if (ownsTransaction) {
+                db.rollback();
+            }
+            scope.logError(*error, "SYNC_FAILED");
+            return false;
+        }
+        if (ownsTransaction && !db.commit()) {
+            *error = db.lastError();
+            scope.logError(*error, "COMMIT_FAILED");
+            return false;
+        }
+        windowCount += windows.size();
+        rescoredGoals += goalChanges.size();
+
+        report.rows += count;
+        report.batches++;
+        emit batchSynced(table.name, report.direction, count);
+
+        since = lastUpdatedAt;
+        afterId = lastId;
+        if (count < m_batchRows) {
+            break;
+        }
+    }
+
+    report.elapsedMs = timer.elapsed();
+    m_report.append(report);
+    scope.logSuccess({
+        {"rows", report.rows},
+        {"applied", report.applied},
+        {"batches", report.batches},
+        {"roundTrips", report.roundTrips},
+        {"windows", windowCount},
+        {"rescoredGoals", rescoredGoals}
+    });
+    return true;
+}
+
+bool SyncEngine::loadWatermark(const QString& table, const QString& direction,
+                               QString* watermark, QString* lastId, QString* error)
+{
+    LightRequestScope scope("SyncEngine::loadWatermark", "READ");
+
+    // As text, so the microseconds survive the round trip through QString
+    QString sql = R"(
+        SELECT watermark::text, last_id::text
+        FROM sync_state
+        WHERE peer = :peer AND table_name = :table AND direction = :direction
+    )";
+
+    QSqlQuery query(m_local);
+    query.prepare(sql);
+    query.bindValue(":peer", m_peer);
+    query.bindValue(":table", table);
+    query.bindValue(":direction", direction);
+
+    LOG_QUERY(scope, sql, {m_peer, table, direction});
+
+    if (!SlowQueryLog::exec(query, "SyncEngine::loadWatermark")) {
+        *error = query.lastError().text();
+        scope.logError(*error, "SQL_EXEC_FAILED");
+        return false;
+    }
+
+    if (query.next()) {
+        *watermark = query.value(0).toString();
+        *lastId = query.value(1).toString();
+    } else {
+        *watermark = kBeginning;
+        *lastId = kNilUuid;
+    }
+    scope.logSuccess(1);
+    return true;
+}
+
+bool SyncEngine::storeWatermark(const QString& table, const QString& direction,
+                                const QString& watermark, const QString& lastId, int rows,
+                                SyncTableReport* report, QString* error)
+{
+    QSqlQuery query(m_local);
+    query.prepare(R"(
+        INSERT INTO sync_state (peer, table_name, direction, watermark, last_id, rows_synced)
+        VALUES (:peer, :table, :direction, CAST(:watermark AS timestamptz), CAST(:last_id AS uuid), :count)
+        ON CONFLICT (peer, table_name, direction) DO UPDATE
+        SET watermark = EXCLUDED.watermark,
+            last_id = EXCLUDED.last_id,
+            rows_synced = sync_state.rows_synced + EXCLUDED.rows_synced,
+            updated_at = CURRENT_TIMESTAMP
+    )");
+    query.bindValue(":peer", m_peer);
+    query.bindValue(":table", table);
+    query.bindValue(":direction", direction);
+    query.bindValue(":watermark", watermark);
+    query.bindValue(":last_id", lastId);
+    query.bindValue(":count", rows);
+    return exec(query, "SyncEngine::storeWatermark", report, error);
+}
+
+bool SyncEngine::readBatch(QSqlDatabase& source, const TableSpec& table,
+                           const QString& since, const QString& afterId, int overlapSeconds,
+                           QString* rows, int* count, QString* lastUpdatedAt, QString* lastId,
+                           SyncTableReport* report, QString* error)
+{
+    // The whole batch comes back as one json value in one row, instead of a
+    // row per record for QSqlQuery to walk
+    QSqlQuery query(source);
+    query.setForwardOnly(true);
+    query.prepare(QString(R"(
+        WITH batch AS (
+            SELECT %1
+            FROM %2
+            WHERE (updated_at, id) > (CAST(:since AS timestamptz) - make_interval(secs => :overlap),
+                                      CAST(:after_id AS uuid))
+            ORDER BY updated_at, id
+            LIMIT :limit
+        )
+        SELECT COALESCE(json_agg(batch ORDER BY updated_at, id), '[]')::text,
+               count(*),
+               (array_agg(updated_at::text ORDER BY updated_at DESC, id DESC))[1],
+               (array_agg(id::text ORDER BY updated_at DESC, id DESC))[1]
+        FROM batch
+    )").arg(table.columns.join(", "), table.name));
+    query.bindValue(":since", since);
+    query.bindValue(":overlap", overlapSeconds);
+    // Restarting inside the overlap would skip rows that share a timestamp
+    query.bindValue(":after_id", overlapSeconds > 0 ? QString(kNilUuid) : afterId);
+    query.bindValue(":limit", m_batchRows);
+
+    if (!exec(query, "SyncEngine::readBatch", report, error)) {
+        return false;
+    }
+    if (!query.next()) {
+        *error = "Batch query returned no row";
+        return false;
+    }
+
+    *rows = query.value(0).toString();
+    *count = query.value(1).toInt();
+    *lastUpdatedAt = query.value(2).toString();
+    *lastId = query.value(3).toString();
+    return true;
+}
+
+QString SyncEngine::upsertSql(const TableSpec& table, bool pull)
+{
+    QString columns = table.columns.join(", ");
+    QString values = columns;
+
+    QStringList assignments;
+    for (const QString& column : table.columns) {
+        if (column != "id" && !table.conflictKey.split(", ").contains(column)) {
+            assignments << QString("%1 = EXCLUDED.%1").arg(column);
+        }
+    }
+
+    // Pulled rows keep the remote updated_at, which can be older than the
+    // last backup's snapshot; the local stamp is what incrementals read
+    if (pull && !table.syncedColumn.isEmpty()) {
+        columns += ", " + table.syncedColumn;
+        values += ", CURRENT_TIMESTAMP";
+        assignments << QString("%1 = CURRENT_TIMESTAMP").arg(table.syncedColumn);
+    }
+
+    // Older rows of the superseded table at an applied key go with it
+    QString supersede;
+    QString returning = table.windowed ? "goal_id, date" : "id";
+    if (table.rescored) {
+        returning = "id, scope, points, penalty_points, missing_behavior";
+    }
+    if (!table.supersedes.isEmpty()) {
+        QStringList matches;
+        for (const QString& column : table.conflictKey.split(", ")) {
+            matches << QString("s.%1 = u.%1").arg(column);
+        }
+        supersede = QString(R"(
+        , superseded AS (
+            DELETE FROM %1 s
+            USING upserted u
+            WHERE %2 AND s.updated_at < u.updated_at
+        ))").arg(table.supersedes, matches.join(" AND "));
+        returning = table.conflictKey + ", updated_at";
+    }
+
+    // Last write wins; equal timestamps mean the row is already here
+    return QString(R"(
+        WITH upserted AS (
+            INSERT INTO %1 AS t (%2)
+            SELECT %7
+            FROM json_populate_recordset(NULL::%1, CAST(:rows AS json))
+            %6
+            ON CONFLICT (%3) DO UPDATE
+            SET %4
+            WHERE t.updated_at < EXCLUDED.updated_at
+            RETURNING %5
+        )%8
+    )").arg(table.name, columns, table.conflictKey, assignments.join(",\n                "),
+            returning,
+            table.parentFilter.isEmpty() ? QString() : "WHERE " + table.parentFilter,
+            values, supersede);
+}
+
+bool SyncEngine::exec(QSqlQuery& query, const char* source, SyncTableReport* report, QString* error)
+{
+    report->roundTrips++;
+    if (!SlowQueryLog::exec(query, source)) {
+        *error = query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+QJsonObject SyncEngine::reportJson() const
+{
+    QJsonArray tables;
+    int roundTrips = 0;
+    for (const SyncTableReport& report : m_report) {
+        tables.append(QJsonObject{
+            {"table", report.table},
+            {"direction", report.direction},
+            {"rows", report.rows},
+            {"applied", report.applied},
+            {"batches", report.batches},
+            {"roundTrips", report.roundTrips},
+            {"elapsedMs", report.elapsedMs}
+        });
+        roundTrips += report.roundTrips;
+    }
+
+    return QJsonObject{
+        {"peer", m_peer},
+        {"batchRows", m_batchRows},
+        {"overlapSeconds", m_overlapSeconds},
+        {"roundTrips", roundTrips},
+        {"tables", tables}
+    };
+}
+
+QString SyncEngine::reportText() const
+{
+    QString text = QString("Sync with %1\n").arg(m_peer);
+    int roundTrips = 0;
+    for (const SyncTableReport& report : m_report) {
+        text += QString("  %1 %2: %3 rows, %4 applied, %5 batches, %6 round trips, %7 ms\n")
+                    .arg(report.direction, -4)
+                    .arg(report.table, -11)
+                    .arg(report.rows)
+                    .arg(report.applied)
+                    .arg(report.batches)
+                    .arg(report.roundTrips)
+                    .arg(report.elapsedMs);
+        roundTrips += report.roundTrips;
+    }
+    text += QString("  total round trips: %1\n").arg(roundTrips);
+    return text;
+}
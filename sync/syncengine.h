@@ -0,0 +1,117 @@
+#ifndef SYNCENGINE_H
+#define SYNCENGINE_H
+
+#include <QObject>
+#include <QJsonObject>
+#include <QList>
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+#include "repositories/occurrencerepository.h"
+
+class RescoringService;
+class ScoreService;
+
+struct SyncTableReport {
+    QString table;
+    QString direction;  // push, pull
+    int rows = 0;       // read from the source
+    int applied = 0;    // won last-write-wins on the target
+    int batches = 0;
+    int roundTrips = 0;
+    qint64 elapsedMs = 0;
+};
+
+// Delta sync between the local database and a remote with the same schema
+// (Supabase or any PostgreSQL), last-write-wins on updated_at. Soft deletes
+// travel as rows with deleted_at set; occurrences a change of scope removed
+// travel as superseded_occurrences rows, which delete older occurrences at
+// the same (goal_id, date) on the target.
+//
+// Changed rows are found through a (updated_at, id) high-water mark per
+// table, direction and peer, stored in the local sync_state table. Each
+// batch is read as one json_agg value and written as one multi-row upsert,
+// so a batch costs one round trip per side however many rows it holds. The
+// watermark advances after every batch, so an interrupted sync resumes
+// where it stopped; a pull writes its watermark in the same statement as
+// the rows. Each run re-reads a short overlap before the watermark to pick
+// up rows from transactions that committed late; re-applying them is a
+// no-op.
+//
+// Derived tables (scores, streaks) are not synced. Each pulled batch
+// recalculates the windows of its occurrences (with a ScoreService set) and
+// rescores goals whose scoring fields it changed (with a RescoringService
+// set) in the transaction that stores the batch and its watermark, so a
+// failure leaves the batch to be pulled again. local must be
+// DatabaseManager's connection, whose transactions those services share.
+class SyncEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    // peer identifies the remote, so switching remotes starts over
+    SyncEngine(QSqlDatabase local, QSqlDatabase remote, const QString& peer,
+               QObject *parent = nullptr);
+
+    void setBatchRows(int rows) { m_batchRows = qMax(1, rows); }
+    void setOverlapSeconds(int seconds) { m_overlapSeconds = qMax(0, seconds); }
+    void setScoreService(ScoreService* scoreService) { m_scoreService = scoreService; }
+    void setRescoringService(RescoringService* rescoringService) { m_rescoringService = rescoringService; }
+
+    // Creates sync_state on databases set up before it existed
+    bool ensureSchema(QString* error);
+    bool resetWatermarks(QString* error);
+
+    // Push then pull, parents before children
+    bool sync(QString* error);
+    bool push(QString* error);
+    bool pull(QString* error);
+
+    QList<SyncTableReport> report() const { return m_report; }
+    QJsonObject reportJson() const;
+    QString reportText() const;
+
+signals:
+    void batchSynced(const QString& table, const QString& direction, int rows);
+
+private:
+    struct TableSpec {
+        QString name;
+        QStringList columns;
+        QString conflictKey;
+        QString parentFilter;  // rows failing it are skipped on the target
+        bool windowed;  // pulled rows change score windows
+        QString syncedColumn;  // set to local time on pull, for incremental backups
+        QString supersedes;  // table whose older rows at the same key an upsert removes
+        bool rescored = false;  // pulled changes to scoring fields rescore the goal
+    };
+
+    static const QList<TableSpec>& tables();
+
+    bool pushTable(const TableSpec& table, QString* error);
+    bool pullTable(const TableSpec& table, QString* error);
+
+    bool loadWatermark(const QString& table, const QString& direction,
+                       QString* watermark, QString* lastId, QString* error);
+    bool storeWatermark(const QString& table, const QString& direction,
+                        const QString& watermark, const QString& lastId, int rows,
+                        SyncTableReport* report, QString* error);
+    bool readBatch(QSqlDatabase& source, const TableSpec& table,
+                   const QString& since, const QString& afterId, int overlapSeconds,
+                   QString* rows, int* count, QString* lastUpdatedAt, QString* lastId,
+                   SyncTableReport* report, QString* error);
+    static QString upsertSql(const TableSpec& table, bool pull);
+
+    bool exec(QSqlQuery& query, const char* source, SyncTableReport* report, QString* error);
+
+    QSqlDatabase m_local;
+    QSqlDatabase m_remote;
+    QString m_peer;
+    int m_batchRows;
+    int m_overlapSeconds;
+    ScoreService* m_scoreService;
+    RescoringService* m_rescoringService;
+    QList<SyncTableReport> m_report;
+};
+
+#endif // SYNCENGINE_H
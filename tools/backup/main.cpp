@@ -0,0 +1,156 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <cstdio>
+#include "backup/backupservice.h"
+#include "database/databasemanager.h"
+#include "logging/logger.h"
+#include "logging/logformat.h"
+
+namespace
+{
+void printManifest(const BackupManifest& manifest, const QString& filePath, qint64 elapsedMs)
+{
+    printf("Backup %s (%s) of %s, snapshot %s\n", qPrintable(manifest.id), qPrintable(manifest.kind),
+           qPrintable(manifest.database), qPrintable(manifest.snapshotAt));
+    if (!manifest.parentId.isEmpty()) {
+        printf("  parent %s, base %s\n", qPrintable(manifest.parentId), qPrintable(manifest.baseId));
+    }
+    qint64 rows = 0;
+    qint64 rawBytes = 0;
+    for (const BackupTableEntry& entry : manifest.tables) {
+        printf("  %-18s %-8s %10lld rows %12lld bytes raw %12lld compressed\n", qPrintable(entry.name),
+               qPrintable(entry.mode), static_cast<long long>(entry.rows),
+               static_cast<long long>(entry.rawBytes), static_cast<long long>(entry.compressedBytes));
+        rows += entry.rows;
+        rawBytes += entry.rawBytes;
+    }
+    printf("  %lld rows, %lld bytes raw, %lld bytes on disk, %lld ms\n", static_cast<long long>(rows),
+           static_cast<long long>(rawBytes), static_cast<long long>(QFileInfo(filePath).size()),
+           static_cast<long long>(elapsedMs));
+}
+}
+
+// nimo-backup: export, verify and restore whole-database archives. Export
+// runs against a live database; restore replaces every Nimo table, so stop
+// the app first or it will hold locks the restore waits for.
+//
+// A daily routine: one full export, then
+//   nimo-backup export day2.nimobak --incremental-from day1.nimobak
+// each day after, each on top of the previous one. Restore takes the whole
+// chain in any order; consolidate folds it into one full backup (written
+// to --output) that the next incremental can build on instead.
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("Nimo");
+    QCoreApplication::setApplicationName("nimo-backup");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Export, verify or restore a Nimo backup archive");
+    parser.addHelpOption();
+    parser.addPositionalArgument("command", "export, verify, restore or consolidate");
+    parser.addPositionalArgument("files", "Archive path (*.nimobak); restore and consolidate take "
+                                          "a full backup and its incrementals", "files...");
+
+    QCommandLineOption hostOption("host", "Database host", "host", "localhost");
+    QCommandLineOption portOption("port", "Database port", "port", "5433");
+    QCommandLineOption databaseOption(QStringList() << "d" << "database",
+                                      "Database to use", "name", "nimo");
+    QCommandLineOption userOption(QStringList() << "U" << "user", "Database user", "user", "postgres");
+    QCommandLineOption passwordOption("password", "Database password (or PGPASSWORD)", "password");
+    QCommandLineOption applySchemaOption("apply-schema",
+                                         "Create the tables before restoring into an empty database");
+    QCommandLineOption logLevelOption("log-level", "Logger level during the run", "level", "WARN");
+    QCommandLineOption incrementalOption("incremental-from",
+                                         "Export only what changed since this backup", "parent");
+    QCommandLineOption overlapOption("overlap", "Seconds re-read before the parent's snapshot",
+                                     "seconds", "300");
+    QCommandLineOption outputOption(QStringList() << "o" << "output",
+                                    "Consolidated backup to write", "path");
+    QCommandLineOption jsonOption("json", "Write the manifest as JSON", "path");
+
+    parser.addOptions({hostOption, portOption, databaseOption, userOption, passwordOption,
+                       applySchemaOption, incrementalOption, overlapOption, outputOption,
+                       logLevelOption, jsonOption});
+    parser.process(app);
+
+    const QStringList arguments = parser.positionalArguments();
+    const QString command = arguments.value(0);
+    const QStringList filePaths = arguments.mid(1);
+    const bool chain = command == "restore" || command == "consolidate";
+    if (!QStringList({"export", "verify", "restore", "consolidate"}).contains(command)
+        || filePaths.isEmpty() || (!chain && filePaths.size() != 1)
+        || (command == "consolidate" && !parser.isSet(outputOption))) {
+        parser.showHelp(1);
+    }
+    const QString filePath = command == "consolidate" ? parser.value(outputOption) : filePaths.last();
+
+    int level = LogFormat::levelFromString(parser.value(logLevelOption));
+    if (level < 0) {
+        fprintf(stderr, "Unknown --log-level: %s\n", qPrintable(parser.value(logLevelOption)));
+        return 1;
+    }
+    Logger::instance().setLogLevel(static_cast<Logger::Level>(level));
+    Logger::instance().setConsoleEnabled(false);
+
+    DatabaseManager& manager = DatabaseManager::instance();
+    if (command != "verify") {
+        manager.setConnectionParameters(parser.value(hostOption), parser.value(portOption).toInt(),
+                                        parser.value(databaseOption), parser.value(userOption),
+                                        parser.value(passwordOption));
+        if (!manager.initialize()) {
+            fprintf(stderr, "Failed to connect: %s\n", qPrintable(manager.lastError()));
+            return 1;
+        }
+        if (command == "restore" && parser.isSet(applySchemaOption) && !manager.applySchema()) {
+            fprintf(stderr, "Failed to apply schema: %s\n", qPrintable(manager.lastError()));
+            return 1;
+        }
+    }
+
+    BackupService service(manager.database().connectionName());
+    service.setOverlapSeconds(parser.value(overlapOption).toInt());
+    BackupManifest manifest;
+    QString error;
+    QElapsedTimer timer;
+    timer.start();
+
+    bool ok = false;
+    if (command == "export" && parser.isSet(incrementalOption)) {
+        ok = service.exportIncremental(parser.value(incrementalOption), filePath, &manifest, &error);
+    } else if (command == "export") {
+        ok = service.exportBackup(filePath, &manifest, &error);
+    } else if (command == "verify") {
+        ok = service.verifyBackup(filePath, &manifest, &error);
+    } else if (command == "restore") {
+        ok = service.restoreChain(filePaths, &manifest, &error);
+    } else {
+        ok = service.consolidate(filePaths, filePath, &manifest, &error);
+    }
+
+    int exitCode = 0;
+    if (ok) {
+        printManifest(manifest, filePath, timer.elapsed());
+    } else {
+        fprintf(stderr, "%s failed: %s\n", qPrintable(command), qPrintable(error));
+        exitCode = 1;
+    }
+
+    if (ok && parser.isSet(jsonOption)) {
+        QSaveFile file(parser.value(jsonOption));
+        if (!file.open(QIODevice::WriteOnly)
+            || file.write(QJsonDocument(manifest.toJson()).toJson()) < 0
+            || !file.commit()) {
+            fprintf(stderr, "Failed to write %s\n", qPrintable(parser.value(jsonOption)));
+            exitCode = 1;
+        }
+    }
+
+    manager.shutdown();
+    Logger::instance().shutdown();
+    return exitCode;
+}
@@ -0,0 +1,287 @@
+#include "tools/loadsim/loadsimulator.h"
+#include "database/databasemanager.h"
+#include "diagnostics/metricsregistry.h"
+#include "repositories/goalrepository.h"
+#include "repositories/occurrencerepository.h"
+#include "repositories/scorerepository.h"
+#include "services/occurrenceservice.h"
+#include "services/scoreservice.h"
+#include "tools/seed/datasetgenerator.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QThread>
+#include <QThreadPool>
+
+namespace
+{
+const QStringList kStatuses{"pending", "completed", "skipped", "not_completed"};
+
+QJsonObject histogramJson(const LatencyHistogram& histogram)
+{
+    return QJsonObject{
+        {"count", static_cast<qint64>(histogram.count())},
+        {"p50Ms", histogram.percentile(50) / 1e6},
+        {"p90Ms", histogram.percentile(90) / 1e6},
+        {"p99Ms", histogram.percentile(99) / 1e6},
+        {"maxMs", histogram.max() / 1e6},
+        {"meanMs", histogram.mean() / 1e6}
+    };
+}
+
+QString histogramLine(const QString& name, const LatencyHistogram& histogram)
+{
+    return QString("%1 p50 %2 ms  p90 %3 ms  p99 %4 ms  max %5 ms\n")
+        .arg(name, -22)
+        .arg(histogram.percentile(50) / 1e6, 8, 'f', 2)
+        .arg(histogram.percentile(90) / 1e6, 8, 'f', 2)
+        .arg(histogram.percentile(99) / 1e6, 8, 'f', 2)
+        .arg(histogram.max() / 1e6, 8, 'f', 2);
+}
+}
+
+LoadSimulator::LoadSimulator(const LoadOptions& options)
+    : m_options(options)
+    , m_clicks(0)
+    , m_failures(0)
+{
+    if (!m_options.date.isValid()) {
+        m_options.date = QDate::currentDate();
+    }
+}
+
+// One click per line: "<offsetMs> <status> [<occurrence-id> | #<index>]".
+// Blank lines and lines starting with '#' are ignored.
+bool LoadSimulator::parseScript(const QString& filePath, QList<LoadStep>* steps, QString* error)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        *error = file.errorString();
+        return false;
+    }
+
+    int lineNumber = 0;
+    while (!file.atEnd()) {
+        const QString line = QString::fromUtf8(file.readLine()).trimmed();
+        lineNumber++;
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+
+        const QStringList fields = line.split(' ', Qt::SkipEmptyParts);
+        LoadStep step;
+        bool ok = false;
+        step.offsetMs = fields.value(0).toLongLong(&ok);
+        step.status = fields.value(1);
+        if (ok && fields.size() > 2) {
+            const QString target = fields.at(2);
+            if (target.startsWith('#')) {
+                step.occurrenceIndex = target.mid(1).toInt(&ok);
+            } else {
+                step.occurrenceId = target;
+            }
+        }
+        if (!ok || step.offsetMs < 0 || !kStatuses.contains(step.status) || fields.size() > 3) {
+            *error = QString("%1:%2: expected \"<offsetMs> <status> [<id>|#<index>]\"")
+                         .arg(filePath).arg(lineNumber);
+            return false;
+        }
+        steps->append(step);
+    }
+    return true;
+}
+
+QList<LoadStep> LoadSimulator::randomSteps(int worker, int occurrenceCount) const
+{
+    SplitMix64 rng(m_options.seed ^ (quint64(worker) + 1) * 0x9e3779b97f4a7c15ULL);
+
+    int totalWeight = 0;
+    for (int weight : m_options.statusMix) {
+        totalWeight += weight;
+    }
+
+    QList<LoadStep> steps;
+    const double intervalMs = 1000.0 / qMax(0.001, m_options.clicksPerSecond);
+    for (int i = 0; i < m_options.clicks; ++i) {
+        LoadStep step;
+        step.offsetMs = qint64(i * intervalMs);
+        step.occurrenceIndex = rng.range(0, occurrenceCount - 1);
+
+        int pick = rng.range(0, qMax(1, totalWeight) - 1);
+        for (auto it = m_options.statusMix.cbegin(); it != m_options.statusMix.cend(); ++it) {
+            pick -= it.value();
+            if (pick < 0) {
+                step.status = it.key();
+                break;
+            }
+        }
+        if (step.status.isEmpty()) {
+            step.status = "completed";
+        }
+        steps.append(step);
+    }
+    return steps;
+}
+
+bool LoadSimulator::run(QString* error)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(m_options.concurrency);
+    for (int worker = 0; worker < m_options.concurrency; ++worker) {
+        pool.start([this, worker, error]() {
+            QString workerError;
+            if (!runWorker(worker, &workerError)) {
+                QMutexLocker locker(&m_errorMutex);
+                *error = workerError;
+            }
+        });
+    }
+    pool.waitForDone();
+
+    m_elapsedNs = timer.nsecsElapsed();
+    return error->isEmpty();
+}
+
+bool LoadSimulator::runWorker(int worker, QString* error)
+{
+    const QString connectionName = QString("nimo_loadsim_%1").arg(worker);
+    bool ok = true;
+    {
+        // The name overload is the one that may be cloned from another thread
+        QSqlDatabase db = QSqlDatabase::cloneDatabase(
+            DatabaseManager::instance().database().connectionName(), connectionName);
+        if (!db.open()) {
+            *error = db.lastError().text();
+            ok = false;
+        }
+
+        GoalRepository goalRepo(db);
+        OccurrenceRepository occurrenceRepo(db);
+        ScoreRepository scoreRepo(db);
+        OccurrenceService occurrenceService(&occurrenceRepo);
+        ScoreService scoreService(&scoreRepo, &occurrenceRepo, &goalRepo);
+
+        // Same cascade as the app
+        QObject::connect(&occurrenceService, &OccurrenceService::scoresNeedRecalculation,
+                         &scoreService, &ScoreService::recalculateForDate);
+
+        QList<Occurrence*> occurrences;
+        if (ok) {
+            occurrences = occurrenceRepo.findByDate(m_options.date);
+            if (occurrences.isEmpty()) {
+                *error = "No occurrences on " + m_options.date.toString("yyyy-MM-dd");
+                ok = false;
+            }
+        }
+
+        QElapsedTimer clock;
+        qint64 dailyScoreNs = -1;
+        QObject::connect(&scoreService, &ScoreService::dailyScoreUpdated,
+                         [&clock, &dailyScoreNs](const QDate&) {
+                             if (dailyScoreNs < 0) {
+                                 dailyScoreNs = clock.nsecsElapsed();
+                             }
+                         });
+
+        const QList<LoadStep> steps = !ok ? QList<LoadStep>()
+                                          : m_options.script.isEmpty()
+                                                ? randomSteps(worker, occurrences.size())
+                                                : m_options.script;
+
+        QHash<QString, QString> originalStatus;
+        int nextInList = 0;
+        clock.start();
+        for (const LoadStep& step : steps) {
+            QString id = step.occurrenceId;
+            if (id.isEmpty()) {
+                int index = step.occurrenceIndex >= 0 ? step.occurrenceIndex : nextInList++;
+                id = occurrences.at(index % occurrences.size())->id;
+            }
+            if (!originalStatus.contains(id)) {
+                for (const Occurrence* occurrence : std::as_const(occurrences)) {
+                    if (occurrence->id == id) {
+                        originalStatus.insert(id, occurrence->status);
+                        break;
+                    }
+                }
+            }
+
+            const qint64 scheduledNs = step.offsetMs * 1000000;
+            qint64 waitNs = scheduledNs - clock.nsecsElapsed();
+            if (waitNs > 0) {
+                QThread::usleep(static_cast<unsigned long>(waitNs / 1000));
+            }
+
+            const qint64 startNs = clock.nsecsElapsed();
+            dailyScoreNs = -1;
+            bool changed = occurrenceService.setStatus(id, step.status);
+            const qint64 endNs = clock.nsecsElapsed();
+
+            m_clicks.fetchAndAddRelaxed(1);
+            m_scheduleLag.record(qMax<qint64>(0, startNs - scheduledNs));
+            m_serviceTime.record(endNs - startNs);
+            m_clickToCascadeEnd.record(endNs - scheduledNs);
+            if (changed && dailyScoreNs >= 0) {
+                m_clickToDailyScore.record(dailyScoreNs - scheduledNs);
+            } else {
+                m_failures.fetchAndAddRelaxed(1);
+            }
+        }
+
+        // Put the day back so runs can be repeated against the same data
+        if (m_options.restore) {
+            for (auto it = originalStatus.cbegin(); it != originalStatus.cend(); ++it) {
+                occurrenceService.setStatus(it.key(), it.value());
+            }
+        }
+
+        qDeleteAll(occurrences);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return ok;
+}
+
+QJsonObject LoadSimulator::reportJson() const
+{
+    const double seconds = m_elapsedNs / 1e9;
+    QJsonObject report{
+        {"date", m_options.date.toString("yyyy-MM-dd")},
+        {"concurrency", m_options.concurrency},
+        {"mode", m_options.script.isEmpty() ? "random" : "script"},
+        {"clicks", m_clicks.loadRelaxed()},
+        {"failures", m_failures.loadRelaxed()},
+        {"elapsedSec", seconds},
+        {"clicksPerSecond", seconds > 0 ? m_clicks.loadRelaxed() / seconds : 0.0},
+        {"clickToDailyScore", histogramJson(m_clickToDailyScore)},
+        {"clickToCascadeEnd", histogramJson(m_clickToCascadeEnd)},
+        {"serviceTime", histogramJson(m_serviceTime)},
+        {"scheduleLag", histogramJson(m_scheduleLag)}
+    };
+
+    // Where the cascade spends its time, from the RequestScope metrics
+    report["operations"] = QJsonArray::fromVariantList(MetricsRegistry::instance().hotSpots(15));
+    return report;
+}
+
+QString LoadSimulator::reportText() const
+{
+    const double seconds = m_elapsedNs / 1e9;
+    QString text = QString("%1 clicks (%2 failed) in %3 s, %4 clicks/s, %5 worker(s)\n")
+                       .arg(m_clicks.loadRelaxed())
+                       .arg(m_failures.loadRelaxed())
+                       .arg(seconds, 0, 'f', 2)
+                       .arg(seconds > 0 ? m_clicks.loadRelaxed() / seconds : 0.0, 0, 'f', 1)
+                       .arg(m_options.concurrency);
+    text += histogramLine("click -> dailyScore", m_clickToDailyScore);
+    text += histogramLine("click -> cascade end", m_clickToCascadeEnd);
+    text += histogramLine("service time", m_serviceTime);
+    text += histogramLine("schedule lag", m_scheduleLag);
+    return text;
+}
@@ -0,0 +1,66 @@
+#ifndef LOADSIMULATOR_H
+#define LOADSIMULATOR_H
+
+#include <QDate>
+#include <QJsonObject>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QAtomicInteger>
+#include "diagnostics/latencyhistogram.h"
+
+// One click: offset from the start of the run, the new status and the
+// occurrence it applies to. An empty target means "the next occurrence in
+// the day's list", like a user ticking down the list.
+struct LoadStep {
+    qint64 offsetMs = 0;
+    QString status;
+    QString occurrenceId;
+    int occurrenceIndex = -1;
+};
+
+struct LoadOptions {
+    QDate date;
+    int concurrency = 1;
+    double clicksPerSecond = 10.0;   // per worker, random mode
+    int clicks = 200;                // per worker, random mode
+    quint64 seed = 1;
+    QMap<QString, int> statusMix{{"completed", 70}, {"skipped", 10},
+                                 {"not_completed", 10}, {"pending", 10}};
+    QList<LoadStep> script;          // replayed by every worker when set
+    bool restore = true;
+};
+
+// Replays status-change storms through the real service stack. Each worker
+// owns a cloned connection and its own repositories and services, wired
+// like main.cpp, and drives OccurrenceService::setStatus on a fixed
+// schedule. Latencies are measured from the scheduled click time, so a
+// worker falling behind shows up as latency rather than a slower rate.
+class LoadSimulator
+{
+public:
+    explicit LoadSimulator(const LoadOptions& options);
+
+    static bool parseScript(const QString& filePath, QList<LoadStep>* steps, QString* error);
+
+    bool run(QString* error);
+    QJsonObject reportJson() const;
+    QString reportText() const;
+
+private:
+    bool runWorker(int worker, QString* error);
+    QList<LoadStep> randomSteps(int worker, int occurrenceCount) const;
+
+    LoadOptions m_options;
+    LatencyHistogram m_clickToDailyScore;
+    LatencyHistogram m_clickToCascadeEnd;
+    LatencyHistogram m_serviceTime;
+    LatencyHistogram m_scheduleLag;
+    QAtomicInteger<qint64> m_clicks;
+    QAtomicInteger<qint64> m_failures;
+    qint64 m_elapsedNs = 0;
+    QMutex m_errorMutex;
+};
+
+#endif // LOADSIMULATOR_H
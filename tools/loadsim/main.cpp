@@ -0,0 +1,126 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <cstdio>
+#include "database/databasemanager.h"
+#include "logging/logger.h"
+#include "logging/logformat.h"
+#include "tools/loadsim/loadsimulator.h"
+
+// nimo-loadsim: headless status-change storms against a Nimo database.
+// Random mode picks occurrences and statuses from a seeded stream at a
+// fixed rate; --script replays a recorded sequence instead. Run it against
+// a database filled by nimo-seed; the touched occurrences are restored
+// afterwards unless --no-restore is given.
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("Nimo");
+    QCoreApplication::setApplicationName("nimo-loadsim");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replay occurrence status-change storms through the service stack");
+    parser.addHelpOption();
+
+    QCommandLineOption hostOption("host", "Database host", "host", "localhost");
+    QCommandLineOption portOption("port", "Database port", "port", "5433");
+    QCommandLineOption databaseOption(QStringList() << "d" << "database",
+                                      "Database to use", "name", "nimo_seed");
+    QCommandLineOption userOption(QStringList() << "U" << "user", "Database user", "user", "postgres");
+    QCommandLineOption passwordOption("password", "Database password (or PGPASSWORD)", "password");
+
+    QCommandLineOption dateOption("date", "Day whose occurrences are clicked (default today)", "date");
+    QCommandLineOption concurrencyOption(QStringList() << "c" << "concurrency",
+                                         "Simulated users, one connection each", "n", "1");
+    QCommandLineOption rateOption(QStringList() << "r" << "rate", "Clicks per second per user", "n", "10");
+    QCommandLineOption clicksOption(QStringList() << "n" << "clicks", "Clicks per user", "n", "200");
+    QCommandLineOption seedOption(QStringList() << "s" << "seed", "Random seed", "n", "1");
+    QCommandLineOption statusesOption("statuses", "Status weights", "completed=70,...",
+                                      "completed=70,skipped=10,not_completed=10,pending=10");
+    QCommandLineOption scriptOption("script", "Replay \"<offsetMs> <status> [<id>|#<index>]\" lines",
+                                    "file");
+    QCommandLineOption noRestoreOption("no-restore", "Leave the clicked statuses in place");
+    QCommandLineOption logLevelOption("log-level", "Logger level during the run", "level", "WARN");
+    QCommandLineOption jsonOption("json", "Write the report as JSON", "path");
+
+    parser.addOptions({hostOption, portOption, databaseOption, userOption, passwordOption,
+                       dateOption, concurrencyOption, rateOption, clicksOption, seedOption,
+                       statusesOption, scriptOption, noRestoreOption, logLevelOption, jsonOption});
+    parser.process(app);
+
+    LoadOptions options;
+    QString error;
+    options.date = parser.isSet(dateOption)
+                       ? QDate::fromString(parser.value(dateOption), "yyyy-MM-dd")
+                       : QDate::currentDate();
+    options.concurrency = qMax(1, parser.value(concurrencyOption).toInt());
+    options.clicksPerSecond = parser.value(rateOption).toDouble();
+    options.clicks = qMax(1, parser.value(clicksOption).toInt());
+    options.seed = parser.value(seedOption).toULongLong();
+    options.restore = !parser.isSet(noRestoreOption);
+
+    if (!options.date.isValid() || options.clicksPerSecond <= 0) {
+        fprintf(stderr, "Invalid --date or --rate\n");
+        return 1;
+    }
+
+    options.statusMix.clear();
+    for (const QString& part : parser.value(statusesOption).split(',', Qt::SkipEmptyParts)) {
+        QStringList pair = part.split('=');
+        bool ok = false;
+        int weight = pair.value(1).toInt(&ok);
+        const QStringList statuses{"pending", "completed", "skipped", "not_completed"};
+        if (pair.size() != 2 || !ok || weight < 0 || !statuses.contains(pair.at(0))) {
+            fprintf(stderr, "Invalid --statuses entry: %s\n", qPrintable(part));
+            return 1;
+        }
+        options.statusMix.insert(pair.at(0), weight);
+    }
+
+    if (parser.isSet(scriptOption)
+        && !LoadSimulator::parseScript(parser.value(scriptOption), &options.script, &error)) {
+        fprintf(stderr, "Invalid script: %s\n", qPrintable(error));
+        return 1;
+    }
+
+    int level = LogFormat::levelFromString(parser.value(logLevelOption));
+    if (level < 0) {
+        fprintf(stderr, "Unknown --log-level: %s\n", qPrintable(parser.value(logLevelOption)));
+        return 1;
+    }
+    Logger::instance().setLogLevel(static_cast<Logger::Level>(level));
+    Logger::instance().setConsoleEnabled(false);
+
+    DatabaseManager& manager = DatabaseManager::instance();
+    manager.setConnectionParameters(parser.value(hostOption), parser.value(portOption).toInt(),
+                                    parser.value(databaseOption), parser.value(userOption),
+                                    parser.value(passwordOption));
+    if (!manager.initialize()) {
+        fprintf(stderr, "Failed to connect: %s\n", qPrintable(manager.lastError()));
+        return 1;
+    }
+
+    LoadSimulator simulator(options);
+    int exitCode = 0;
+    if (!simulator.run(&error)) {
+        fprintf(stderr, "Simulation failed: %s\n", qPrintable(error));
+        exitCode = 1;
+    }
+
+    printf("%s", qPrintable(simulator.reportText()));
+
+    if (parser.isSet(jsonOption)) {
+        QSaveFile file(parser.value(jsonOption));
+        if (!file.open(QIODevice::WriteOnly)
+            || file.write(QJsonDocument(simulator.reportJson()).toJson()) < 0
+            || !file.commit()) {
+            fprintf(stderr, "Failed to write %s\n", qPrintable(parser.value(jsonOption)));
+            exitCode = 1;
+        }
+    }
+
+    manager.shutdown();
+    Logger::instance().shutdown();
+    return exitCode;
+}
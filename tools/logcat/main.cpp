@@ -0,0 +1,149 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <cstdio>
+#include "logging/binarylogformat.h"
+#include "logging/logformat.h"
+#include "logging/logarchiver.h"
+
+// nimo-logcat: decodes binary *.nlog files into the text log format (or
+// one JSON object per line), optionally filtered by request id and level.
+// Compressed archives (*.nlz) are read too; with --request, archives whose
+// index does not mention the id are skipped without decompressing.
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("nimo-logcat");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Decode Nimo binary log files");
+    parser.addHelpOption();
+    parser.addPositionalArgument("files", "Binary logs (*.nlog) or archives (*.nlz) to decode",
+                                 "<file>...");
+
+    QCommandLineOption requestOption(QStringList() << "r" << "request",
+                                     "Only show records for this request id", "id");
+    QCommandLineOption levelOption(QStringList() << "l" << "level",
+                                   "Minimum level (DEBUG, INFO, WARN, ERROR, FATAL)", "level");
+    QCommandLineOption jsonOption(QStringList() << "j" << "json",
+                                  "Emit one JSON object per record");
+    parser.addOption(requestOption);
+    parser.addOption(levelOption);
+    parser.addOption(jsonOption);
+    parser.process(app);
+
+    const QStringList files = parser.positionalArguments();
+    if (files.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    int minLevel = 0;
+    if (parser.isSet(levelOption)) {
+        minLevel = LogFormat::levelFromString(parser.value(levelOption));
+        if (minLevel < 0) {
+            fprintf(stderr, "Unknown level: %s\n", qPrintable(parser.value(levelOption)));
+            return 1;
+        }
+    }
+
+    const QString requestId = parser.value(requestOption);
+    const bool json = parser.isSet(jsonOption);
+
+    QTextStream out(stdout);
+    int exitCode = 0;
+
+    auto writeRecord = [&](const LogRecord& record) {
+        if (record.level < minLevel) {
+            return;
+        }
+        // Request ids appear as the context id or in request metadata
+        if (!requestId.isEmpty()
+            && record.contextId != requestId
+            && record.metadata.value("requestId").toString() != requestId) {
+            return;
+        }
+
+        if (json) {
+            out << QJsonDocument(LogFormat::toJson(record)).toJson(QJsonDocument::Compact) << "\n";
+        } else {
+            out << LogFormat::formatRecord(record) << "\n";
+        }
+    };
+
+    for (const QString& file : files) {
+        bool archived = file.endsWith(".nlz");
+        if (archived && !requestId.isEmpty()
+            && !LogArchiver::archiveMayContainRequest(file, requestId)) {
+            continue;
+        }
+
+        // Text archives are parsed back into records, narrowed to the
+        // indexed blocks first, so --level and --json apply to them too
+        if (archived && !file.endsWith(".nlog.nlz")) {
+            QList<qint64> blocks;
+            if (!requestId.isEmpty()) {
+                blocks = LogArchiver::blockOffsetsForRequest(file, requestId);
+            }
+            const QList<QByteArray> lines = LogArchiver::readArchive(file, blocks).split('\n');
+            LogRecord record;
+            bool pending = false;
+            int unparsed = 0;
+            for (const QByteArray& line : lines) {
+                if (line.isEmpty()) {
+                    continue;
+                }
+                // Metadata lines follow the record line they belong to
+                if (line.startsWith('{')) {
+                    if (pending) {
+                        record.metadata = QJsonDocument::fromJson(line).object();
+                    }
+                    continue;
+                }
+                LogRecord next;
+                if (LogFormat::parseLogLine(QString::fromUtf8(line), &next)) {
+                    if (pending) {
+                        writeRecord(record);
+                    }
+                    record = next;
+                    pending = true;
+                } else if (pending) {
+                    // Messages with line breaks continue on the next lines
+                    record.message += "\n" + QString::fromUtf8(line);
+                } else {
+                    unparsed++;
+                }
+            }
+            if (pending) {
+                writeRecord(record);
+            }
+            if (unparsed > 0) {
+                fprintf(stderr, "%s: skipped %d unparsable lines\n", qPrintable(file), unparsed);
+            }
+            continue;
+        }
+
+        BinaryLogReader reader;
+        bool opened = archived ? reader.openData(LogArchiver::readArchive(file))
+                               : reader.open(file);
+        if (!opened) {
+            fprintf(stderr, "%s\n", qPrintable(reader.errorString()));
+            exitCode = 1;
+            continue;
+        }
+
+        LogRecord record;
+        while (reader.readNext(record)) {
+            writeRecord(record);
+        }
+
+        if (!reader.errorString().isEmpty()) {
+            fprintf(stderr, "%s: %s\n", qPrintable(file), qPrintable(reader.errorString()));
+            exitCode = 1;
+        }
+    }
+
+    out.flush();
+    return exitCode;
+}
@@ -0,0 +1,53 @@
+#include "tools/seed/copyloader.h"
+#include <QSqlDriver>
+#include <QVariant>
+#include <libpq-fe.h>
+
+namespace
+{
+constexpr int kChunkSize = 1 << 20;
+}
+
+CopyLoader::CopyLoader(QSqlDatabase db)
+    : m_db(db)
+{
+}
+
+bool CopyLoader::copy(const QString& table, const QString& columns, const QByteArray& rows)
+{
+    QVariant handle = m_db.driver()->handle();
+    if (!handle.isValid() || qstrcmp(handle.typeName(), "PGconn*") != 0) {
+        m_lastError = "Connection is not a QPSQL connection";
+        return false;
+    }
+    PGconn* conn = *static_cast<PGconn* const*>(handle.data());
+
+    QByteArray sql = QString("COPY %1 (%2) FROM STDIN").arg(table, columns).toUtf8();
+    PGresult* result = PQexec(conn, sql.constData());
+    bool started = PQresultStatus(result) == PGRES_COPY_IN;
+    PQclear(result);
+    if (!started) {
+        m_lastError = QString::fromUtf8(PQerrorMessage(conn));
+        return false;
+    }
+
+    bool ok = true;
+    for (qsizetype offset = 0; ok && offset < rows.size(); offset += kChunkSize) {
+        int length = int(qMin<qsizetype>(kChunkSize, rows.size() - offset));
+        ok = PQputCopyData(conn, rows.constData() + offset, length) == 1;
+    }
+    ok = PQputCopyEnd(conn, ok ? nullptr : "nimo-seed aborted") == 1 && ok;
+
+    // Drain every result so the connection is usable again
+    while ((result = PQgetResult(conn)) != nullptr) {
+        if (PQresultStatus(result) != PGRES_COMMAND_OK) {
+            ok = false;
+        }
+        PQclear(result);
+    }
+
+    if (!ok) {
+        m_lastError = QString::fromUtf8(PQerrorMessage(conn));
+    }
+    return ok;
+}
@@ -0,0 +1,23 @@
+#ifndef COPYLOADER_H
+#define COPYLOADER_H
+
+#include <QByteArray>
+#include <QSqlDatabase>
+#include <QString>
+
+// Streams COPY ... FROM STDIN text through the libpq connection underneath
+// a QPSQL QSqlDatabase; QSqlQuery itself cannot drive the COPY protocol.
+class CopyLoader
+{
+public:
+    explicit CopyLoader(QSqlDatabase db);
+
+    bool copy(const QString& table, const QString& columns, const QByteArray& rows);
+    QString lastError() const { return m_lastError; }
+
+private:
+    QSqlDatabase m_db;
+    QString m_lastError;
+};
+
+#endif // COPYLOADER_H
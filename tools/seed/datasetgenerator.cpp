@@ -0,0 +1,244 @@
+#include "tools/seed/datasetgenerator.h"
+#include <QDateTime>
+#include <QTimeZone>
+
+namespace
+{
+// Namespace for goal ids: uuidv5(seed/index) keeps ids stable across runs
+const QUuid kGoalNamespace("8c1f6a52-3f2e-4b8e-9a57-2d6c0e1b7f41");
+
+const QMap<QString, QStringList> kHabits{
+    {"health", {"Drink water", "Take vitamins", "Sleep by 23:00", "Floss", "Meditate"}},
+    {"fitness", {"Run", "Stretch", "Strength training", "Walk 10k steps", "Cycle"}},
+    {"work", {"Inbox zero", "Plan the day", "Deep work block", "Review goals", "Ship something"}},
+    {"learning", {"Read", "Practice language", "Online course", "Write notes", "Practice piano"}},
+    {"home", {"Tidy up", "Cook dinner", "Water plants", "Laundry", "Budget review"}},
+    {"social", {"Call family", "Meet a friend", "Write a letter", "Volunteer", "Date night"}}
+};
+
+const QStringList kVices{"sugar", "social media", "snoozing", "takeaway", "doomscrolling",
+                         "smoking", "impulse buys", "late coffee"};
+
+QString escapeCopy(QString value)
+{
+    return value.replace('\\', "\\\\").replace('\t', "\\t").replace('\n', "\\n");
+}
+
+QByteArray timestamp(const QDate& date, int seconds)
+{
+    QDateTime value(date, QTime(0, 0), QTimeZone::UTC);
+    return value.addSecs(seconds).toString(Qt::ISODate).toLatin1();
+}
+
+QDate windowStart(const QString& scope, const QDate& date)
+{
+    if (scope == "weekly") {
+        return date.addDays(1 - date.dayOfWeek());
+    }
+    if (scope == "monthly") {
+        return QDate(date.year(), date.month(), 1);
+    }
+    if (scope == "yearly") {
+        return QDate(date.year(), 1, 1);
+    }
+    return date;
+}
+
+QDate nextWindow(const QString& scope, const QDate& start)
+{
+    if (scope == "weekly") {
+        return start.addDays(7);
+    }
+    if (scope == "monthly") {
+        return start.addMonths(1);
+    }
+    if (scope == "yearly") {
+        return start.addYears(1);
+    }
+    return start.addDays(1);
+}
+
+quint64 goalSeed(quint64 seed, int index)
+{
+    return seed ^ (quint64(index) + 1) * 0xd1b54a32d192ed03ULL;
+}
+}
+
+DatasetGenerator::DatasetGenerator(const DatasetOptions& options)
+    : m_options(options)
+{
+    if (!m_options.endDate.isValid()) {
+        m_options.endDate = QDate::currentDate();
+    }
+    m_goals = buildGoals();
+}
+
+QDate DatasetGenerator::firstDate() const
+{
+    return m_options.endDate.addYears(-m_options.years).addDays(1);
+}
+
+QString DatasetGenerator::goalsCopyColumns()
+{
+    return "id, title, scope, points, missing_behavior, penalty_points, category, "
+           "sort_order, is_active, created_at, updated_at";
+}
+
+QString DatasetGenerator::occurrencesCopyColumns()
+{
+    return "id, goal_id, date, week_start, month_start, year_start, status, "
+           "completed_at, score_impact, created_at, updated_at";
+}
+
+QString DatasetGenerator::pickWeighted(const QMap<QString, int>& weights, SplitMix64& rng) const
+{
+    int total = 0;
+    for (int weight : weights) {
+        total += qMax(0, weight);
+    }
+    if (total == 0) {
+        return weights.isEmpty() ? QString() : weights.firstKey();
+    }
+
+    int pick = rng.range(0, total - 1);
+    for (auto it = weights.cbegin(); it != weights.cend(); ++it) {
+        pick -= qMax(0, it.value());
+        if (pick < 0) {
+            return it.key();
+        }
+    }
+    return weights.lastKey();
+}
+
+// Each goal draws from its own stream, so goal N is identical whatever the
+// total goal count or the number of loader threads
+QList<SeedGoal> DatasetGenerator::buildGoals() const
+{
+    QList<SeedGoal> goals;
+    goals.reserve(m_options.goalCount);
+
+    const int historyDays = int(firstDate().daysTo(m_options.endDate)) + 1;
+
+    for (int i = 0; i < m_options.goalCount; ++i) {
+        SplitMix64 rng(goalSeed(m_options.seed, i));
+        SeedGoal goal;
+        goal.index = i;
+        goal.id = QUuid::createUuidV5(kGoalNamespace,
+                                      QString("%1/goal/%2").arg(m_options.seed).arg(i));
+        goal.scope = pickWeighted(m_options.scopeMix, rng);
+        goal.profile = pickWeighted(m_options.profileMix, rng);
+        goal.category = m_options.categories.isEmpty()
+                            ? QString()
+                            : m_options.categories.at(rng.range(0, m_options.categories.size() - 1));
+        goal.points = rng.range(m_options.minPoints, m_options.maxPoints);
+
+        bool negative = rng.uniform() < m_options.negativeRatio;
+        if (negative) {
+            goal.title = "Avoid " + kVices.at(rng.range(0, kVices.size() - 1));
+            goal.missingBehavior = "penalty";
+            goal.penaltyPoints = rng.range(goal.points, goal.points * 2);
+        } else {
+            QStringList habits = kHabits.value(goal.category, kHabits.value("health"));
+            goal.title = habits.at(rng.range(0, habits.size() - 1));
+            goal.missingBehavior = "zero";
+        }
+        goal.title += QString(" #%1").arg(i + 1);
+
+        // Negative habits are the ones users slip on most
+        goal.adherence = 0.60 + 0.32 * rng.uniform() - (negative ? 0.15 : 0.0);
+
+        // Goals are added over the first fifth of the history
+        goal.startDate = firstDate().addDays(rng.range(0, qMax(0, historyDays / 5)));
+        goals.append(goal);
+    }
+    return goals;
+}
+
+QByteArray DatasetGenerator::goalsCopyData() const
+{
+    QByteArray out;
+    for (const SeedGoal& goal : m_goals) {
+        QByteArray created = timestamp(goal.startDate, 8 * 3600);
+        out += goal.id.toByteArray(QUuid::WithoutBraces) + '\t'
+               + escapeCopy(goal.title).toUtf8() + '\t'
+               + goal.scope.toLatin1() + '\t'
+               + QByteArray::number(goal.points) + '\t'
+               + goal.missingBehavior.toLatin1() + '\t'
+               + QByteArray::number(goal.penaltyPoints) + '\t'
+               + (goal.category.isEmpty() ? QByteArray("\\N") : escapeCopy(goal.category).toUtf8()) + '\t'
+               + QByteArray::number(goal.index) + '\t'
+               + "t\t" + created + '\t' + created + '\n';
+    }
+    return out;
+}
+
+QString DatasetGenerator::statusFor(const SeedGoal& goal, const QDate& windowStart,
+                                    SplitMix64& rng, bool* onStreak) const
+{
+    double probability = goal.adherence;
+    if (goal.profile == "streaky") {
+        // Two-state chain: long good runs, shorter lapses
+        if (*onStreak && rng.uniform() < 1.0 / 18.0) {
+            *onStreak = false;
+        } else if (!*onStreak && rng.uniform() < 1.0 / 6.0) {
+            *onStreak = true;
+        }
+        probability = *onStreak ? 0.95 : 0.20;
+    } else if (goal.profile == "weekend" && goal.scope == "daily"
+               && windowStart.dayOfWeek() >= Qt::Saturday) {
+        probability *= 0.45;
+    }
+
+    double roll = rng.uniform();
+    if (roll < probability) {
+        return "completed";
+    }
+    // A fifth of the misses are explicit skips
+    return roll < probability + (1.0 - probability) * 0.2 ? "skipped" : "not_completed";
+}
+
+int DatasetGenerator::appendOccurrences(const SeedGoal& goal, QByteArray* out) const
+{
+    SplitMix64 rng(goalSeed(m_options.seed, goal.index) ^ 0x6a09e667f3bcc909ULL);
+    const QByteArray goalId = goal.id.toByteArray(QUuid::WithoutBraces);
+    const QDate currentWindow = windowStart(goal.scope, m_options.endDate);
+    bool onStreak = true;
+    int rows = 0;
+
+    for (QDate start = windowStart(goal.scope, goal.startDate); start <= currentWindow;
+         start = nextWindow(goal.scope, start)) {
+        QDate end = nextWindow(goal.scope, start);
+        const QString dateText = start.toString("yyyy-MM-dd");
+
+        QString status = start == currentWindow ? QString("pending")
+                                                : statusFor(goal, start, rng, &onStreak);
+        int impact = 0;
+        QByteArray completedAt("\\N");
+        QByteArray created = timestamp(start, 0);
+        QByteArray updated = created;
+        if (status == "completed") {
+            impact = goal.points;
+            QDate day = start.addDays(rng.range(0, int(start.daysTo(end)) - 1));
+            completedAt = timestamp(day, rng.range(6 * 3600, 23 * 3600));
+            updated = completedAt;
+        } else if (status != "pending") {
+            if (status == "not_completed" && goal.missingBehavior == "penalty") {
+                impact = -goal.penaltyPoints;
+            }
+            updated = timestamp(end, 0);
+        }
+
+        *out += QUuid::createUuidV5(goal.id, dateText).toByteArray(QUuid::WithoutBraces) + '\t'
+                + goalId + '\t'
+                + dateText.toLatin1() + '\t'
+                + start.addDays(1 - start.dayOfWeek()).toString("yyyy-MM-dd").toLatin1() + '\t'
+                + QDate(start.year(), start.month(), 1).toString("yyyy-MM-dd").toLatin1() + '\t'
+                + QDate(start.year(), 1, 1).toString("yyyy-MM-dd").toLatin1() + '\t'
+                + status.toLatin1() + '\t'
+                + completedAt + '\t'
+                + QByteArray::number(impact) + '\t'
+                + created + '\t' + updated + '\n';
+        rows++;
+    }
+    return rows;
+}
@@ -0,0 +1,94 @@
+#ifndef DATASETGENERATOR_H
+#define DATASETGENERATOR_H
+
+#include <QByteArray>
+#include <QDate>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QUuid>
+
+// Shape of a synthetic dataset. Everything generated is a pure function of
+// these options, so the same seed and end date always yield the same rows.
+struct DatasetOptions {
+    quint64 seed = 1;
+    int goalCount = 100;
+    int years = 5;
+    QDate endDate;
+    // Relative weights; missing entries count as zero
+    QMap<QString, int> scopeMix{{"daily", 60}, {"weekly", 20}, {"monthly", 12}, {"yearly", 8}};
+    QMap<QString, int> profileMix{{"steady", 50}, {"streaky", 30}, {"weekend", 20}};
+    QStringList categories{"health", "fitness", "work", "learning", "home", "social"};
+    int minPoints = 1;
+    int maxPoints = 10;
+    // Share of goals the user is trying to stop doing: penalised when missed
+    double negativeRatio = 0.15;
+};
+
+struct SeedGoal {
+    int index = 0;
+    QUuid id;
+    QString title;
+    QString scope;
+    QString category;
+    QString profile;
+    int points = 0;
+    QString missingBehavior;
+    int penaltyPoints = 0;
+    double adherence = 0.0;
+    QDate startDate;
+};
+
+// Small, fast and reproducible across platforms, unlike std::mt19937 with
+// the standard distributions
+class SplitMix64
+{
+public:
+    explicit SplitMix64(quint64 seed) : m_state(seed) {}
+
+    quint64 next()
+    {
+        quint64 z = (m_state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [0, 1)
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+    int range(int min, int max) { return min + int(next() % quint64(max - min + 1)); }
+
+private:
+    quint64 m_state;
+};
+
+class DatasetGenerator
+{
+public:
+    explicit DatasetGenerator(const DatasetOptions& options);
+
+    QDate firstDate() const;
+    QList<SeedGoal> goals() const { return m_goals; }
+
+    // COPY text rows; the column lists match goalsCopyColumns() and
+    // occurrencesCopyColumns()
+    QByteArray goalsCopyData() const;
+    static QString goalsCopyColumns();
+    static QString occurrencesCopyColumns();
+
+    // Appends one goal's occurrences; independent of any other goal, so
+    // goals can be generated on any thread in any order
+    int appendOccurrences(const SeedGoal& goal, QByteArray* out) const;
+
+private:
+    QList<SeedGoal> buildGoals() const;
+    QString pickWeighted(const QMap<QString, int>& weights, SplitMix64& rng) const;
+    QString statusFor(const SeedGoal& goal, const QDate& windowStart,
+                      SplitMix64& rng, bool* onStreak) const;
+
+    DatasetOptions m_options;
+    QList<SeedGoal> m_goals;
+};
+
+#endif // DATASETGENERATOR_H
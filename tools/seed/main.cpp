@@ -0,0 +1,358 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QAtomicInteger>
+#include <QMutex>
+#include <QSqlDatabase>
+#include <QSqlDriver>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QThread>
+#include <QThreadPool>
+#include <cstdio>
+#include "database/databasemanager.h"
+#include "logging/logger.h"
+#include "repositories/scorerepository.h"
+#include "repositories/streakrepository.h"
+#include "tools/seed/copyloader.h"
+#include "tools/seed/datasetgenerator.h"
+
+// nimo-seed: fills a Nimo database with a reproducible synthetic history.
+// Goals and their occurrences are a pure function of --seed and --end, and
+// occurrences are streamed with COPY from several connections in parallel.
+// Scores and the overall streak are then rebuilt with the app's own
+// set-based repository code, so the result is what the app would compute.
+namespace
+{
+struct ConnectionParams {
+    QString host;
+    int port = 5433;
+    QString database;
+    QString user;
+    QString password;
+};
+
+bool parseWeights(const QString& text, const QStringList& allowed, QMap<QString, int>* weights)
+{
+    QMap<QString, int> parsed;
+    for (const QString& part : text.split(',', Qt::SkipEmptyParts)) {
+        QStringList pair = part.split('=');
+        bool ok = false;
+        int weight = pair.size() == 2 ? pair.at(1).toInt(&ok) : 0;
+        if (!ok || weight < 0 || !allowed.contains(pair.at(0).trimmed())) {
+            return false;
+        }
+        parsed.insert(pair.at(0).trimmed(), weight);
+    }
+    if (parsed.isEmpty()) {
+        return false;
+    }
+    *weights = parsed;
+    return true;
+}
+
+QSqlDatabase openConnection(const QString& name, const ConnectionParams& params,
+                            const QString& database)
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase("QPSQL", name);
+    db.setHostName(params.host);
+    db.setPort(params.port);
+    db.setDatabaseName(database);
+    db.setUserName(params.user);
+    db.setPassword(params.password);
+    db.open();
+    return db;
+}
+
+bool createDatabaseIfMissing(const ConnectionParams& params, QString* error)
+{
+    bool ok = false;
+    {
+        QSqlDatabase admin = openConnection("nimo_seed_admin", params, "postgres");
+        QSqlQuery query(admin);
+        query.prepare("SELECT 1 FROM pg_database WHERE datname = :name");
+        query.bindValue(":name", params.database);
+        if (!admin.isOpen()) {
+            *error = admin.lastError().text();
+        } else if (!query.exec()) {
+            *error = query.lastError().text();
+        } else if (query.next()) {
+            ok = true;
+        } else {
+            // Identifiers cannot be bound; quote through the driver
+            ok = query.exec("CREATE DATABASE " + admin.driver()->escapeIdentifier(
+                                params.database, QSqlDriver::TableName));
+            if (!ok) {
+                *error = query.lastError().text();
+            }
+        }
+    }
+    QSqlDatabase::removeDatabase("nimo_seed_admin");
+    return ok;
+}
+
+bool exec(QSqlDatabase db, const QString& sql, QString* error)
+{
+    QSqlQuery query(db);
+    if (!query.exec(sql)) {
+        *error = query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+// Occurrences for every goal with index % jobs == worker, COPYed whenever
+// the buffer reaches batchRows
+qint64 loadOccurrences(const DatasetGenerator& generator, const ConnectionParams& params,
+                       int worker, int jobs, int batchRows, QString* error)
+{
+    const QString name = QString("nimo_seed_%1").arg(worker);
+    qint64 total = 0;
+    {
+        QSqlDatabase db = openConnection(name, params, params.database);
+        if (!db.isOpen()) {
+            *error = db.lastError().text();
+            total = -1;
+        } else if (!exec(db, "SET synchronous_commit = off", error)) {
+            total = -1;
+        }
+
+        CopyLoader loader(db);
+        QByteArray buffer;
+        int buffered = 0;
+        const QList<SeedGoal> goals = generator.goals();
+        for (int i = worker; total >= 0 && i < goals.size(); i += jobs) {
+            buffered += generator.appendOccurrences(goals.at(i), &buffer);
+            bool last = i + jobs >= goals.size();
+            if (buffered >= batchRows || (last && buffered > 0)) {
+                if (!loader.copy("occurrences", DatasetGenerator::occurrencesCopyColumns(), buffer)) {
+                    *error = loader.lastError();
+                    total = -1;
+                    break;
+                }
+                total += buffered;
+                buffer.clear();
+                buffered = 0;
+            }
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(name);
+    return total;
+}
+
+bool rebuildScores(const DatasetGenerator& generator, const QDate& endDate)
+{
+    ScoreRepository scores(DatabaseManager::instance().database());
+
+    // One year per statement keeps the array parameters a sane size
+    for (QDate yearStart(generator.firstDate().year(), 1, 1); yearStart <= endDate;
+         yearStart = yearStart.addYears(1)) {
+        QList<QDate> days, weeks, months;
+        for (QDate day = yearStart; day < yearStart.addYears(1) && day <= endDate;
+             day = day.addDays(1)) {
+            days.append(day);
+            if (day.dayOfWeek() == Qt::Monday) {
+                weeks.append(day);
+            }
+            if (day.day() == 1) {
+                months.append(day);
+            }
+        }
+        if (!scores.rebuildDailyScores(days) || !scores.rebuildWeeklyScores(weeks)
+            || !scores.rebuildMonthlyScores(months) || !scores.rebuildYearlyScores({yearStart})) {
+            return false;
+        }
+    }
+
+    StreakRepository streaks(DatabaseManager::instance().database());
+    for (const QString& scope : {"daily", "weekly", "monthly", "yearly"}) {
+        delete streaks.getOrCreateOverall(scope);
+    }
+    // Same threshold as StreakService; today is still open
+    return streaks.evaluateOverallDailyStreak(80.0, generator.firstDate(), endDate.addDays(-1));
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("Nimo");
+    QCoreApplication::setApplicationName("nimo-seed");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Generate a reproducible synthetic Nimo history");
+    parser.addHelpOption();
+
+    QCommandLineOption hostOption("host", "Database host", "host", "localhost");
+    QCommandLineOption portOption("port", "Database port", "port", "5433");
+    QCommandLineOption databaseOption(QStringList() << "d" << "database",
+                                      "Database to fill", "name", "nimo_seed");
+    QCommandLineOption userOption(QStringList() << "U" << "user", "Database user", "user", "postgres");
+    QCommandLineOption passwordOption("password", "Database password (or PGPASSWORD)", "password");
+    QCommandLineOption createOption("create", "Create the database and schema if missing");
+    QCommandLineOption resetOption("reset", "Empty all Nimo tables before seeding");
+
+    QCommandLineOption seedOption(QStringList() << "s" << "seed", "Random seed", "n", "1");
+    QCommandLineOption goalsOption(QStringList() << "g" << "goals", "Number of goals", "n", "100");
+    QCommandLineOption yearsOption(QStringList() << "y" << "years", "Years of history", "n", "5");
+    QCommandLineOption endOption("end", "Last day of history, yyyy-MM-dd (default today)", "date");
+    QCommandLineOption scopesOption("scopes", "Scope weights", "daily=60,weekly=20,...",
+                                    "daily=60,weekly=20,monthly=12,yearly=8");
+    QCommandLineOption profilesOption("profiles", "Completion behaviour weights",
+                                      "steady=50,streaky=30,weekend=20",
+                                      "steady=50,streaky=30,weekend=20");
+    QCommandLineOption categoriesOption("categories", "Comma-separated categories", "list",
+                                        "health,fitness,work,learning,home,social");
+    QCommandLineOption pointsOption("points", "Point range per goal", "min-max", "1-10");
+    QCommandLineOption negativeOption("negative", "Share of negative (penalised) habits", "ratio",
+                                      "0.15");
+    QCommandLineOption jobsOption(QStringList() << "j" << "jobs", "Parallel COPY connections", "n",
+                                  QString::number(qMax(1, QThread::idealThreadCount())));
+    QCommandLineOption batchOption("batch-rows", "Rows per COPY batch", "n", "50000");
+    QCommandLineOption skipScoresOption("skip-scores", "Do not rebuild scores and streaks");
+
+    parser.addOptions({hostOption, portOption, databaseOption, userOption, passwordOption,
+                       createOption, resetOption, seedOption, goalsOption, yearsOption,
+                       endOption, scopesOption, profilesOption, categoriesOption, pointsOption,
+                       negativeOption, jobsOption, batchOption, skipScoresOption});
+    parser.process(app);
+
+    DatasetOptions options;
+    bool ok = true;
+    options.seed = parser.value(seedOption).toULongLong(&ok);
+    options.goalCount = ok ? parser.value(goalsOption).toInt(&ok) : 0;
+    options.years = ok ? parser.value(yearsOption).toInt(&ok) : 0;
+    if (!ok || options.goalCount <= 0 || options.years <= 0) {
+        fprintf(stderr, "--seed, --goals and --years must be positive integers\n");
+        return 1;
+    }
+
+    options.endDate = parser.isSet(endOption)
+                          ? QDate::fromString(parser.value(endOption), "yyyy-MM-dd")
+                          : QDate::currentDate();
+    if (!options.endDate.isValid()) {
+        fprintf(stderr, "Invalid --end date: %s\n", qPrintable(parser.value(endOption)));
+        return 1;
+    }
+
+    if (!parseWeights(parser.value(scopesOption), {"daily", "weekly", "monthly", "yearly"},
+                      &options.scopeMix)
+        || !parseWeights(parser.value(profilesOption), {"steady", "streaky", "weekend"},
+                         &options.profileMix)) {
+        fprintf(stderr, "Invalid --scopes or --profiles weights\n");
+        return 1;
+    }
+
+    options.categories = parser.value(categoriesOption).split(',', Qt::SkipEmptyParts);
+    QStringList points = parser.value(pointsOption).split('-');
+    options.minPoints = points.value(0).toInt();
+    options.maxPoints = points.value(1, points.value(0)).toInt();
+    options.negativeRatio = parser.value(negativeOption).toDouble();
+    if (options.minPoints <= 0 || options.maxPoints < options.minPoints) {
+        fprintf(stderr, "Invalid --points range: %s\n", qPrintable(parser.value(pointsOption)));
+        return 1;
+    }
+
+    const int jobs = qMax(1, parser.value(jobsOption).toInt());
+    const int batchRows = qMax(1000, parser.value(batchOption).toInt());
+
+    ConnectionParams params;
+    params.host = parser.value(hostOption);
+    params.port = parser.value(portOption).toInt();
+    params.database = parser.value(databaseOption);
+    params.user = parser.value(userOption);
+    params.password = parser.value(passwordOption);
+
+    Logger::instance().setLogLevel(Logger::WARN);
+    Logger::instance().setConsoleEnabled(false);
+
+    QString error;
+    if (parser.isSet(createOption) && !createDatabaseIfMissing(params, &error)) {
+        fprintf(stderr, "Failed to create database: %s\n", qPrintable(error));
+        return 1;
+    }
+
+    DatabaseManager& manager = DatabaseManager::instance();
+    manager.setConnectionParameters(params.host, params.port, params.database,
+                                    params.user, params.password);
+    if (!manager.initialize() || !manager.applySchema()) {
+        fprintf(stderr, "Failed to prepare database: %s\n", qPrintable(manager.lastError()));
+        return 1;
+    }
+    QSqlDatabase db = manager.database();
+
+    int exitCode = 1;
+    QElapsedTimer timer;
+    timer.start();
+    DatasetGenerator generator(options);
+
+    QSqlQuery existing(db);
+    if (parser.isSet(resetOption)) {
+        ok = exec(db, "TRUNCATE goals, occurrences, superseded_occurrences, daily_scores, weekly_scores, "
+                      "monthly_scores, yearly_scores, streaks, streak_days", &error);
+    } else {
+        ok = existing.exec("SELECT EXISTS (SELECT 1 FROM goals)") && existing.next();
+        if (ok && existing.value(0).toBool()) {
+            error = "Database already has goals; use --reset to replace them";
+            ok = false;
+        } else if (!ok) {
+            error = existing.lastError().text();
+        }
+    }
+
+    CopyLoader loader(db);
+    if (ok && !loader.copy("goals", DatasetGenerator::goalsCopyColumns(), generator.goalsCopyData())) {
+        error = loader.lastError();
+        ok = false;
+    }
+
+    QAtomicInteger<qint64> occurrenceRows = 0;
+    if (ok) {
+        QMutex errorMutex;
+        QThreadPool pool;
+        pool.setMaxThreadCount(jobs);
+        for (int worker = 0; worker < jobs; ++worker) {
+            pool.start([&, worker]() {
+                QString workerError;
+                qint64 rows = loadOccurrences(generator, params, worker, jobs, batchRows, &workerError);
+                if (rows < 0) {
+                    QMutexLocker locker(&errorMutex);
+                    error = workerError;
+                } else {
+                    occurrenceRows.fetchAndAddRelaxed(rows);
+                }
+            });
+        }
+        pool.waitForDone();
+        ok = error.isEmpty();
+    }
+    qint64 loadMs = timer.elapsed();
+
+    if (ok) {
+        ok = exec(db, "ANALYZE", &error);
+    }
+    if (ok && !parser.isSet(skipScoresOption) && !rebuildScores(generator, options.endDate)) {
+        error = "Failed to rebuild scores and streaks";
+        ok = false;
+    }
+
+    if (ok) {
+        printf("Seed %llu, %s to %s: %d goals, %lld occurrences loaded in %lld ms (%lld ms total)\n",
+               static_cast<unsigned long long>(options.seed),
+               qPrintable(generator.firstDate().toString("yyyy-MM-dd")),
+               qPrintable(options.endDate.toString("yyyy-MM-dd")),
+               options.goalCount,
+               static_cast<long long>(occurrenceRows.loadRelaxed()),
+               static_cast<long long>(loadMs),
+               static_cast<long long>(timer.elapsed()));
+        exitCode = 0;
+    } else {
+        fprintf(stderr, "Seeding failed: %s\n", qPrintable(error));
+    }
+
+    existing.finish();
+    manager.shutdown();
+    Logger::instance().shutdown();
+    return exitCode;
+}
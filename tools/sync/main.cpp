@@ -0,0 +1,182 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <cstdio>
+#include "database/changefeed.h"
+#include "database/databasemanager.h"
+#include "logging/logger.h"
+#include "logging/logformat.h"
+#include "repositories/goalrepository.h"
+#include "repositories/occurrencerepository.h"
+#include "repositories/scorerepository.h"
+#include "services/rescoringservice.h"
+#include "services/scoreservice.h"
+#include "sync/syncengine.h"
+
+namespace
+{
+const char* const kRemoteConnection = "nimo_sync_remote";
+
+// Creates the synced tables on an empty remote from the bundled schema
+bool initRemote(QSqlDatabase remote, QString* error)
+{
+    QFile file(":/nimo/database/schema.sql");
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        *error = "Bundled schema not found";
+        return false;
+    }
+    QSqlQuery query(remote);
+    if (!query.exec(QString::fromUtf8(file.readAll()))) {
+        *error = query.lastError().text();
+        return false;
+    }
+    return ChangeFeed::installTriggers(remote, error);
+}
+}
+
+// nimo-sync: pushes local goal and occurrence changes to a remote Nimo
+// schema (Supabase, or a second local PostgreSQL standing in for it) and
+// pulls the remote's changes back, last-write-wins on updated_at. Progress
+// is kept per remote in the local sync_state table, so a run that is
+// interrupted picks up where it stopped.
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("Nimo");
+    QCoreApplication::setApplicationName("nimo-sync");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Sync goals and occurrences with a remote Nimo database");
+    parser.addHelpOption();
+
+    QCommandLineOption hostOption("host", "Local database host", "host", "localhost");
+    QCommandLineOption portOption("port", "Local database port", "port", "5433");
+    QCommandLineOption databaseOption(QStringList() << "d" << "database",
+                                      "Local database", "name", "nimo");
+    QCommandLineOption userOption(QStringList() << "U" << "user", "Local database user", "user", "postgres");
+    QCommandLineOption passwordOption("password", "Local database password (or PGPASSWORD)", "password");
+
+    QCommandLineOption remoteHostOption("remote-host", "Remote database host", "host");
+    QCommandLineOption remotePortOption("remote-port", "Remote database port", "port", "5432");
+    QCommandLineOption remoteDatabaseOption("remote-database", "Remote database", "name", "postgres");
+    QCommandLineOption remoteUserOption("remote-user", "Remote database user", "user", "postgres");
+    QCommandLineOption remotePasswordOption("remote-password", "Remote database password", "password");
+    QCommandLineOption remoteOptionsOption("remote-options",
+                                           "Remote connection options, e.g. sslmode=require", "options");
+
+    QCommandLineOption batchOption(QStringList() << "b" << "batch-rows", "Rows per batch", "n", "2000");
+    QCommandLineOption overlapOption("overlap", "Seconds re-read before each watermark", "s", "60");
+    QCommandLineOption pushOnlyOption("push-only", "Only push local changes");
+    QCommandLineOption pullOnlyOption("pull-only", "Only pull remote changes");
+    QCommandLineOption resetOption("reset", "Forget the watermarks for this remote and sync everything");
+    QCommandLineOption initRemoteOption("init-remote", "Apply the bundled schema to the remote first");
+    QCommandLineOption logLevelOption("log-level", "Logger level during the run", "level", "WARN");
+    QCommandLineOption jsonOption("json", "Write the report as JSON", "path");
+
+    parser.addOptions({hostOption, portOption, databaseOption, userOption, passwordOption,
+                       remoteHostOption, remotePortOption, remoteDatabaseOption, remoteUserOption,
+                       remotePasswordOption, remoteOptionsOption, batchOption, overlapOption,
+                       pushOnlyOption, pullOnlyOption, resetOption, initRemoteOption,
+                       logLevelOption, jsonOption});
+    parser.process(app);
+
+    if (!parser.isSet(remoteHostOption)) {
+        fprintf(stderr, "--remote-host is required\n");
+        return 1;
+    }
+    if (parser.isSet(pushOnlyOption) && parser.isSet(pullOnlyOption)) {
+        fprintf(stderr, "--push-only and --pull-only are exclusive\n");
+        return 1;
+    }
+
+    int level = LogFormat::levelFromString(parser.value(logLevelOption));
+    if (level < 0) {
+        fprintf(stderr, "Unknown --log-level: %s\n", qPrintable(parser.value(logLevelOption)));
+        return 1;
+    }
+    Logger::instance().setLogLevel(static_cast<Logger::Level>(level));
+    Logger::instance().setConsoleEnabled(false);
+
+    DatabaseManager& manager = DatabaseManager::instance();
+    manager.setConnectionParameters(parser.value(hostOption), parser.value(portOption).toInt(),
+                                    parser.value(databaseOption), parser.value(userOption),
+                                    parser.value(passwordOption));
+    // Pulls stamp occurrences.synced_at, which older local schemas lack
+    if (!manager.initialize() || !manager.applySchema()) {
+        fprintf(stderr, "Failed to connect: %s\n", qPrintable(manager.lastError()));
+        return 1;
+    }
+
+    int exitCode = 0;
+    {
+        QSqlDatabase remote = QSqlDatabase::addDatabase("QPSQL", kRemoteConnection);
+        remote.setHostName(parser.value(remoteHostOption));
+        remote.setPort(parser.value(remotePortOption).toInt());
+        remote.setDatabaseName(parser.value(remoteDatabaseOption));
+        remote.setUserName(parser.value(remoteUserOption));
+        remote.setPassword(parser.value(remotePasswordOption));
+        remote.setConnectOptions(parser.value(remoteOptionsOption));
+
+        QString error;
+        if (!remote.open()) {
+            fprintf(stderr, "Failed to connect to remote: %s\n", qPrintable(remote.lastError().text()));
+            exitCode = 1;
+        } else if (parser.isSet(initRemoteOption) && !initRemote(remote, &error)) {
+            fprintf(stderr, "Failed to initialize remote: %s\n", qPrintable(error));
+            exitCode = 1;
+        }
+
+        if (exitCode == 0) {
+            QSqlDatabase local = manager.database();
+            GoalRepository goalRepo(local);
+            OccurrenceRepository occurrenceRepo(local);
+            ScoreRepository scoreRepo(local);
+            ScoreService scoreService(&scoreRepo, &occurrenceRepo, &goalRepo);
+            RescoringService rescoringService(&occurrenceRepo, &scoreRepo, &scoreService, nullptr);
+
+            const QString peer = QString("%1:%2/%3").arg(remote.hostName())
+                                     .arg(remote.port())
+                                     .arg(remote.databaseName());
+            SyncEngine engine(local, remote, peer);
+            engine.setBatchRows(parser.value(batchOption).toInt());
+            engine.setOverlapSeconds(parser.value(overlapOption).toInt());
+            engine.setScoreService(&scoreService);
+            engine.setRescoringService(&rescoringService);
+
+            bool ok = engine.ensureSchema(&error)
+                      && (!parser.isSet(resetOption) || engine.resetWatermarks(&error));
+            if (ok && !parser.isSet(pullOnlyOption)) {
+                ok = engine.push(&error);
+            }
+            if (ok && !parser.isSet(pushOnlyOption)) {
+                ok = engine.pull(&error);
+            }
+            if (!ok) {
+                fprintf(stderr, "Sync failed: %s\n", qPrintable(error));
+                exitCode = 1;
+            }
+
+            printf("%s", qPrintable(engine.reportText()));
+
+            if (parser.isSet(jsonOption)) {
+                QSaveFile file(parser.value(jsonOption));
+                if (!file.open(QIODevice::WriteOnly)
+                    || file.write(QJsonDocument(engine.reportJson()).toJson()) < 0
+                    || !file.commit()) {
+                    fprintf(stderr, "Failed to write %s\n", qPrintable(parser.value(jsonOption)));
+                    exitCode = 1;
+                }
+            }
+        }
+        remote.close();
+    }
+    QSqlDatabase::removeDatabase(kRemoteConnection);
+
+    manager.shutdown();
+    Logger::instance().shutdown();
+    return exitCode;
+}